@@ -36,8 +36,38 @@ namespace Utils {
 
     struct Config {
         bool enableLogFile;
+        bool enableMultiCoreProcessing;
+        int modulationControlRate;
+        int maxLatencyCompensationSamples;
+        bool enableMonoChains;
+        bool enableChainSleeping;
+        int renderAheadBlocks;
+        int maxSeriesPipelineStages;
+        int undoHistoryBudgetMB;
+        bool enableBackgroundRestore;
+        bool loadInactivePluginsLast;
+        bool reusePluginsOnRestore;
+        int standbyCrossfadeMs;
 
-        Config() : enableLogFile(false) { }
+        // Opt in, as sessions saved in the binary format can't be opened by older versions
+        bool enableBinarySessionFormat;
+        bool compressSessionState;
+
+        Config() : enableLogFile(false),
+                   enableMultiCoreProcessing(true),
+                   modulationControlRate(0),
+                   maxLatencyCompensationSamples(16384),
+                   enableMonoChains(false),
+                   enableChainSleeping(false),
+                   renderAheadBlocks(0),
+                   maxSeriesPipelineStages(1),
+                   undoHistoryBudgetMB(64),
+                   enableBackgroundRestore(false),
+                   loadInactivePluginsLast(true),
+                   reusePluginsOnRestore(true),
+                   standbyCrossfadeMs(50),
+                   enableBinarySessionFormat(false),
+                   compressSessionState(false) { }
     };
 
     inline Config LoadConfig() {
@@ -65,6 +95,104 @@ namespace Utils {
             }
         }
 
+        if (json.hasProperty("enableMultiCoreProcessing")) {
+            const juce::var& enableMultiCoreProcessing = json["enableMultiCoreProcessing"];
+            if (enableMultiCoreProcessing.isBool()) {
+                config.enableMultiCoreProcessing = enableMultiCoreProcessing;
+            }
+        }
+
+        if (json.hasProperty("modulationControlRate")) {
+            const juce::var& modulationControlRate = json["modulationControlRate"];
+            if (modulationControlRate.isInt() && static_cast<int>(modulationControlRate) >= 0) {
+                config.modulationControlRate = modulationControlRate;
+            }
+        }
+
+        if (json.hasProperty("maxLatencyCompensationSamples")) {
+            const juce::var& maxLatencyCompensationSamples = json["maxLatencyCompensationSamples"];
+            if (maxLatencyCompensationSamples.isInt() && static_cast<int>(maxLatencyCompensationSamples) >= 0) {
+                config.maxLatencyCompensationSamples = maxLatencyCompensationSamples;
+            }
+        }
+
+        if (json.hasProperty("enableMonoChains")) {
+            const juce::var& enableMonoChains = json["enableMonoChains"];
+            if (enableMonoChains.isBool()) {
+                config.enableMonoChains = enableMonoChains;
+            }
+        }
+
+        if (json.hasProperty("enableChainSleeping")) {
+            const juce::var& enableChainSleeping = json["enableChainSleeping"];
+            if (enableChainSleeping.isBool()) {
+                config.enableChainSleeping = enableChainSleeping;
+            }
+        }
+
+        if (json.hasProperty("renderAheadBlocks")) {
+            const juce::var& renderAheadBlocks = json["renderAheadBlocks"];
+            if (renderAheadBlocks.isInt() && static_cast<int>(renderAheadBlocks) >= 0) {
+                config.renderAheadBlocks = renderAheadBlocks;
+            }
+        }
+
+        if (json.hasProperty("maxSeriesPipelineStages")) {
+            const juce::var& maxSeriesPipelineStages = json["maxSeriesPipelineStages"];
+            if (maxSeriesPipelineStages.isInt() && static_cast<int>(maxSeriesPipelineStages) >= 1) {
+                config.maxSeriesPipelineStages = maxSeriesPipelineStages;
+            }
+        }
+
+        if (json.hasProperty("undoHistoryBudgetMB")) {
+            const juce::var& undoHistoryBudgetMB = json["undoHistoryBudgetMB"];
+            if (undoHistoryBudgetMB.isInt() && static_cast<int>(undoHistoryBudgetMB) >= 1) {
+                config.undoHistoryBudgetMB = undoHistoryBudgetMB;
+            }
+        }
+
+        if (json.hasProperty("enableBackgroundRestore")) {
+            const juce::var& enableBackgroundRestore = json["enableBackgroundRestore"];
+            if (enableBackgroundRestore.isBool()) {
+                config.enableBackgroundRestore = enableBackgroundRestore;
+            }
+        }
+
+        if (json.hasProperty("loadInactivePluginsLast")) {
+            const juce::var& loadInactivePluginsLast = json["loadInactivePluginsLast"];
+            if (loadInactivePluginsLast.isBool()) {
+                config.loadInactivePluginsLast = loadInactivePluginsLast;
+            }
+        }
+
+        if (json.hasProperty("reusePluginsOnRestore")) {
+            const juce::var& reusePluginsOnRestore = json["reusePluginsOnRestore"];
+            if (reusePluginsOnRestore.isBool()) {
+                config.reusePluginsOnRestore = reusePluginsOnRestore;
+            }
+        }
+
+        if (json.hasProperty("standbyCrossfadeMs")) {
+            const juce::var& standbyCrossfadeMs = json["standbyCrossfadeMs"];
+            if (standbyCrossfadeMs.isInt() && static_cast<int>(standbyCrossfadeMs) >= 0) {
+                config.standbyCrossfadeMs = standbyCrossfadeMs;
+            }
+        }
+
+        if (json.hasProperty("enableBinarySessionFormat")) {
+            const juce::var& enableBinarySessionFormat = json["enableBinarySessionFormat"];
+            if (enableBinarySessionFormat.isBool()) {
+                config.enableBinarySessionFormat = enableBinarySessionFormat;
+            }
+        }
+
+        if (json.hasProperty("compressSessionState")) {
+            const juce::var& compressSessionState = json["compressSessionState"];
+            if (compressSessionState.isBool()) {
+                config.compressSessionState = compressSessionState;
+            }
+        }
+
         return config;
     }
 }
@@ -0,0 +1,259 @@
+#include "ChainPipeline.hpp"
+
+namespace {
+    void copyChannels(const juce::AudioBuffer<float>& source, juce::AudioBuffer<float>& destination) {
+        const int numChannels {std::min(source.getNumChannels(), destination.getNumChannels())};
+        const int numSamples {std::min(source.getNumSamples(), destination.getNumSamples())};
+
+        for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+            destination.copyFrom(channelIndex, 0, source, channelIndex, 0, numSamples);
+        }
+    }
+}
+
+std::atomic<int> ChainPipeline::_defaultMaxNumStages {1};
+
+ChainPipeline::InFlight::InFlight(int numChannels, int blockSize, int maxNumStages, int numStages) :
+        firstBufferIndex(0),
+        numBuffersInFlight(numStages - 1),
+        // Room for the latency and a block passing through it (AbstractFifo can only hold one less
+        // than its size)
+        pendingFifo(maxNumStages * blockSize + 1),
+        isEmpty(true) {
+    for (int index {0}; index < MAX_NUM_STAGES; index++) {
+        // Only allocate what the maximum number of stages could use
+        buffers[index].setSize(numChannels, index < maxNumStages ? blockSize : 0);
+        buffers[index].clear();
+        midiBuffers[index].ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+    }
+
+    pendingBuffer.setSize(numChannels, pendingFifo.getTotalSize());
+    pendingBuffer.clear();
+}
+
+ChainPipeline::ChainPipeline() :
+        _maxNumStages(1),
+        _numStages(1),
+        _numChannels(0),
+        _blockSize(0),
+        _inFlight(std::make_shared<InFlight>(0, 0, 1, 1)) {
+    _stageStarts.fill(0);
+}
+
+void ChainPipeline::prepare(int numChannels, int blockSize, int maxNumStages) {
+    _maxNumStages = std::clamp(maxNumStages, 1, MAX_NUM_STAGES);
+    _numStages = std::min(_numStages, _maxNumStages);
+    _numChannels = numChannels;
+    _blockSize = blockSize;
+
+    _inFlight = std::make_shared<InFlight>(_numChannels, _blockSize, _maxNumStages, _numStages);
+}
+
+void ChainPipeline::compile(const ChainRenderPlan& plan) {
+    const int numOps {static_cast<int>(plan.ops.size())};
+
+    // Find the cost of each plugin, falling back to the average for those that haven't been
+    // measured yet
+    int numPlugins {0};
+    int numMeasuredPlugins {0};
+    double totalMeasuredCost {0};
+
+    for (const RenderOp& op : plan.ops) {
+        if (op.type == RENDER_OP_TYPE::PLUGIN) {
+            numPlugins++;
+
+            const float cost {static_cast<ChainSlotPlugin*>(op.slot)->processingCost.load(std::memory_order_relaxed)};
+            if (cost > 0) {
+                numMeasuredPlugins++;
+                totalMeasuredCost += cost;
+            }
+        }
+    }
+
+    const double defaultCost {numMeasuredPlugins > 0 ? totalMeasuredCost / numMeasuredPlugins : 1.0};
+    auto getCost = [defaultCost](const RenderOp& op) {
+        if (op.type != RENDER_OP_TYPE::PLUGIN) {
+            // Gain stages are cheap enough to ignore
+            return 0.0;
+        }
+
+        const float cost {static_cast<ChainSlotPlugin*>(op.slot)->processingCost.load(std::memory_order_relaxed)};
+        return cost > 0 ? static_cast<double>(cost) : defaultCost;
+    };
+
+    double totalCost {0};
+    for (const RenderOp& op : plan.ops) {
+        totalCost += getCost(op);
+    }
+
+    const int newNumStages {std::clamp(numPlugins, 1, _maxNumStages)};
+    if (newNumStages != _numStages) {
+        // The audio in flight no longer lines up with the stages, start again from silence rather
+        // than touching the buffers the audio thread may still be using
+        _numStages = newNumStages;
+        _inFlight = std::make_shared<InFlight>(_numChannels, _blockSize, _maxNumStages, _numStages);
+    }
+
+    // Start a new stage at the plugin that takes the running cost past the current stage's share,
+    // making sure every stage keeps at least one plugin
+    _stageStarts.fill(numOps);
+    _stageStarts[0] = 0;
+
+    int stageIndex {0};
+    int numPluginsInStage {0};
+    int numPluginsRemaining {numPlugins};
+    double runningCost {0};
+
+    for (int opIndex {0}; opIndex < numOps; opIndex++) {
+        const RenderOp& op = plan.ops[opIndex];
+        const double cost {getCost(op)};
+
+        if (op.type == RENDER_OP_TYPE::PLUGIN) {
+            const int numStagesRemaining {_numStages - stageIndex - 1};
+            const double stageEndCost {totalCost * (stageIndex + 1) / _numStages};
+
+            const bool shouldStartStage {
+                numStagesRemaining > 0
+                && numPluginsInStage > 0
+                && (runningCost + cost / 2 > stageEndCost || numPluginsRemaining <= numStagesRemaining)
+            };
+
+            if (shouldStartStage) {
+                stageIndex++;
+                _stageStarts[stageIndex] = opIndex;
+                numPluginsInStage = 0;
+            }
+
+            numPluginsInStage++;
+            numPluginsRemaining--;
+        }
+
+        runningCost += cost;
+    }
+}
+
+int ChainPipeline::getStageEnd(int stageIndex, int numOps) const {
+    if (stageIndex + 1 < _numStages) {
+        return std::min(_stageStarts[stageIndex + 1], numOps);
+    }
+
+    return numOps;
+}
+
+bool ChainPipeline::canProcess(const juce::AudioBuffer<float>& buffer) const {
+    return _numStages > 1
+        && buffer.getNumSamples() == _blockSize
+        && buffer.getNumChannels() <= _numChannels;
+}
+
+void ChainPipeline::pushInput(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages) {
+    _inFlight->isEmpty = false;
+    copyChannels(buffer, getStageBuffer(0));
+
+    juce::MidiBuffer& stageMidi = getStageMidi(0);
+    stageMidi.clear();
+    stageMidi.addEvents(midiMessages, 0, -1, 0);
+}
+
+void ChainPipeline::popOutput(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+    const int lastStageIndex {_numStages - 1};
+    midiMessages.clear();
+
+    if (_inFlight->numBuffersInFlight < lastStageIndex) {
+        // Still filling back up, nothing has reached the last stage yet. The pending output is
+        // what was left in flight before, its MIDI has already been output.
+        _popPending(buffer, 0, buffer.getNumSamples());
+        _inFlight->numBuffersInFlight++;
+    } else {
+        copyChannels(getStageBuffer(lastStageIndex), buffer);
+        midiMessages.addEvents(getStageMidi(lastStageIndex), 0, -1, 0);
+    }
+
+    // Each stage's output becomes the next stage's input, and the last stage's buffer is reused
+    // for the next block's input
+    _inFlight->firstBufferIndex = _getBufferIndex(lastStageIndex);
+}
+
+void ChainPipeline::pushFlushedBlock(const juce::AudioBuffer<float>& buffer) {
+    _inFlight->isEmpty = false;
+    _pushPending(buffer, 0, buffer.getNumSamples());
+}
+
+void ChainPipeline::delayUnpipelinedBlock(juce::AudioBuffer<float>& buffer) {
+    _inFlight->isEmpty = false;
+
+    // The pending output only has space for the latency and one block, so split anything bigger
+    for (int startSample {0}; startSample < buffer.getNumSamples(); startSample += _blockSize) {
+        const int numSamples {std::min(_blockSize, buffer.getNumSamples() - startSample)};
+        _pushPending(buffer, startSample, numSamples);
+        _popPending(buffer, startSample, numSamples);
+    }
+}
+
+void ChainPipeline::reset() {
+    _inFlight->firstBufferIndex = 0;
+
+    for (int index {0}; index < MAX_NUM_STAGES; index++) {
+        _inFlight->buffers[index].clear();
+        _inFlight->midiBuffers[index].clear();
+    }
+
+    _inFlight->numBuffersInFlight = _numStages - 1;
+    _inFlight->pendingFifo.reset();
+    _inFlight->isEmpty = true;
+}
+
+void ChainPipeline::discard() {
+    if (!_inFlight->isEmpty) {
+        reset();
+    }
+}
+
+size_t ChainPipeline::getInFlightSizeBytes() const {
+    size_t numBytes {sizeof(InFlight)};
+
+    for (int index {0}; index < MAX_NUM_STAGES; index++) {
+        const juce::AudioBuffer<float>& buffer = _inFlight->buffers[index];
+        numBytes += static_cast<size_t>(buffer.getNumChannels()) * buffer.getNumSamples() * sizeof(float);
+        numBytes += MIDI_BUFFER_RESERVED_BYTES;
+    }
+
+    const juce::AudioBuffer<float>& pending = _inFlight->pendingBuffer;
+    numBytes += static_cast<size_t>(pending.getNumChannels()) * pending.getNumSamples() * sizeof(float);
+
+    return numBytes;
+}
+
+void ChainPipeline::_pushPending(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    juce::AudioBuffer<float>& pending = _inFlight->pendingBuffer;
+    const auto scope = _inFlight->pendingFifo.write(numSamples);
+    const int numChannels {std::min(buffer.getNumChannels(), pending.getNumChannels())};
+
+    for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+        pending.copyFrom(channelIndex, scope.startIndex1, buffer, channelIndex, startSample, scope.blockSize1);
+        pending.copyFrom(channelIndex, scope.startIndex2, buffer, channelIndex, startSample + scope.blockSize1, scope.blockSize2);
+    }
+}
+
+void ChainPipeline::_popPending(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    const juce::AudioBuffer<float>& pending = _inFlight->pendingBuffer;
+    const auto scope = _inFlight->pendingFifo.read(std::min(numSamples, _inFlight->pendingFifo.getNumReady()));
+    const int numChannels {std::min(buffer.getNumChannels(), pending.getNumChannels())};
+
+    for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+        buffer.copyFrom(channelIndex, startSample, pending, channelIndex, scope.startIndex1, scope.blockSize1);
+        buffer.copyFrom(channelIndex, startSample + scope.blockSize1, pending, channelIndex, scope.startIndex2, scope.blockSize2);
+
+        // Only short if the pending output wasn't filled by a flush first
+        const int numRead {scope.blockSize1 + scope.blockSize2};
+        buffer.clear(channelIndex, startSample + numRead, numSamples - numRead);
+    }
+}
+
+void ChainPipeline::setDefaultMaxNumStages(int maxNumStages) {
+    _defaultMaxNumStages.store(std::clamp(maxNumStages, 1, MAX_NUM_STAGES));
+}
+
+int ChainPipeline::getDefaultMaxNumStages() {
+    return _defaultMaxNumStages.load();
+}
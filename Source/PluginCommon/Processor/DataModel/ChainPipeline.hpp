@@ -0,0 +1,172 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "ChainRenderPlan.hpp"
+
+/**
+ * Splits a long series chain into stages which can be processed at the same time on different
+ * threads.
+ *
+ * In each block stage n processes the audio that stage n - 1 processed in the previous block, so
+ * each boundary between stages adds a block of latency. The stages are balanced using the measured
+ * cost of each plugin, and are only recompiled when the chain is edited or prepared so that plugins
+ * don't move between stages while audio is in flight.
+ *
+ * The audio and MIDI in flight between stages is held in a fixed set of buffers allocated in
+ * prepare(), which are rotated rather than copied at the end of each block. Clones share these
+ * buffers so editing the chain doesn't lose what's in flight, unless the number of stages changes.
+ *
+ * Pipelining needs every block to be the prepared size. Blocks that aren't are processed without
+ * it and delayed by the same amount, so the latency reported to the host doesn't change. Before the
+ * first of these the audio in flight is flushed through the remaining stages into a queue of
+ * pending output, which the unpipelined blocks are delayed through. When pipelining starts again
+ * the queue is output while the stages fill back up, so the output is continuous either way.
+ */
+class ChainPipeline {
+public:
+    static constexpr int MAX_NUM_STAGES {4};
+    static constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    ChainPipeline();
+
+    /**
+     * Allocates the buffers for up to maxNumStages stages. Must not be called while the audio
+     * thread is processing.
+     */
+    void prepare(int numChannels, int blockSize, int maxNumStages);
+
+    /**
+     * Splits the plan into stages of roughly equal cost. Plugins which haven't been measured yet
+     * are assumed to cost the average of those that have. Each stage gets at least one plugin, so
+     * short chains may have fewer stages than the maximum.
+     */
+    void compile(const ChainRenderPlan& plan);
+
+    int getNumStages() const { return _numStages; }
+    int getStageStart(int stageIndex) const { return _stageStarts[stageIndex]; }
+    int getStageEnd(int stageIndex, int numOps) const;
+
+    int getLatencySamples() const { return (_numStages - 1) * _blockSize; }
+
+    /**
+     * Returns true if the block can be pipelined, ie. the chain has more than one stage and the
+     * block is the prepared size.
+     */
+    bool canProcess(const juce::AudioBuffer<float>& buffer) const;
+
+    /**
+     * The number of stages with audio to process this block. This is less than the number of
+     * stages while the pipeline fills back up after blocks that couldn't be pipelined.
+     */
+    int getNumStagesToProcess() const { return _inFlight->numBuffersInFlight + 1; }
+
+    /**
+     * The number of blocks in flight that have been through some but not all of the stages. The
+     * block waiting for stage n has been through every stage before it.
+     */
+    int getNumBuffersInFlight() const { return _inFlight->numBuffersInFlight; }
+
+    /**
+     * The audio and MIDI the given stage should process in place this block.
+     */
+    juce::AudioBuffer<float>& getStageBuffer(int stageIndex) { return _inFlight->buffers[_getBufferIndex(stageIndex)]; }
+    juce::MidiBuffer& getStageMidi(int stageIndex) { return _inFlight->midiBuffers[_getBufferIndex(stageIndex)]; }
+
+    /**
+     * Gives this block's input to the first stage. Call before processing the stages.
+     */
+    void pushInput(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages);
+
+    /**
+     * Replaces the buffer with the output of the last stage, or with pending output while the
+     * stages are filling back up, and moves everything else on to the next stage. Call after
+     * processing the stages.
+     */
+    void popOutput(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+
+    /**
+     * Adds a block in flight which has now been through the rest of the stages to the pending
+     * output. Call for each of them, oldest first, then finishFlush().
+     */
+    void pushFlushedBlock(const juce::AudioBuffer<float>& buffer);
+    void finishFlush() { _inFlight->numBuffersInFlight = 0; }
+
+    /**
+     * Delays a block that was processed without pipelining by the pipeline's latency. The blocks in
+     * flight must have been flushed first.
+     */
+    void delayUnpipelinedBlock(juce::AudioBuffer<float>& buffer);
+
+    void reset();
+
+    /**
+     * Drops the audio and MIDI in flight and pending, so a chain that stops being processed while
+     * it's muted or bypassed doesn't output stale audio when it starts again. Only clears anything
+     * the first time it's called after the pipeline has been used, so can be called every block.
+     */
+    void discard();
+
+    ChainPipeline* clone() const {
+        return new ChainPipeline(*this);
+    }
+
+    /**
+     * Bytes allocated for the audio and MIDI in flight, which is shared with any clones.
+     */
+    size_t getInFlightSizeBytes() const;
+
+    /**
+     * Identifies what's in flight, which is the same for clones that share it.
+     */
+    const void* getInFlightId() const { return _inFlight.get(); }
+
+    /**
+     * The maximum number of stages series chains are split into. Read from the config when the
+     * plugin is created, 1 disables pipelining.
+     */
+    static void setDefaultMaxNumStages(int maxNumStages);
+    static int getDefaultMaxNumStages();
+
+private:
+    /**
+     * Everything that's only used by the audio thread, shared between clones. Nothing here is
+     * changed when a clone is compiled, a clone that needs different stages gets its own.
+     */
+    struct InFlight {
+        int firstBufferIndex;
+        std::array<juce::AudioBuffer<float>, MAX_NUM_STAGES> buffers;
+        std::array<juce::MidiBuffer, MAX_NUM_STAGES> midiBuffers;
+
+        // Blocks in flight after the first stage. The pending output holds whatever is left of the
+        // latency, so between them there's always exactly the latency of audio waiting to be output.
+        int numBuffersInFlight;
+        juce::AbstractFifo pendingFifo;
+        juce::AudioBuffer<float> pendingBuffer;
+
+        // False once a block has been pushed, until the pipeline is next reset
+        bool isEmpty;
+
+        InFlight(int numChannels, int blockSize, int maxNumStages, int numStages);
+    };
+
+    int _maxNumStages;
+    int _numStages;
+    int _numChannels;
+    int _blockSize;
+
+    // Index of the first op in each stage
+    std::array<int, MAX_NUM_STAGES> _stageStarts;
+
+    std::shared_ptr<InFlight> _inFlight;
+
+    static std::atomic<int> _defaultMaxNumStages;
+
+    ChainPipeline(const ChainPipeline& other) = default;
+
+    int _getBufferIndex(int stageIndex) const { return (_inFlight->firstBufferIndex + stageIndex) % _numStages; }
+
+    void _pushPending(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void _popPending(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+};
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+
+#include "ChainMutators.hpp"
+#include "PluginChain.hpp"
+
+namespace {
+    constexpr int NUM_SAMPLES {64};
+
+    std::shared_ptr<PluginChain> createChain(int numPlugins, HostConfiguration hostConfig) {
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int pluginIndex {0}; pluginIndex < numPlugins; pluginIndex++) {
+            ChainMutators::insertPlugin(chain, std::make_shared<TestUtils::TestPluginInstance>(), pluginIndex, hostConfig);
+        }
+
+        return chain;
+    }
+}
+
+SCENARIO("ChainPipeline: Stages are balanced by the cost of each plugin") {
+    auto messageManager = juce::MessageManager::getInstance();
+
+    GIVEN("A chain of four plugins") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = 44100;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto chain = createChain(4, hostConfig);
+        ChainPipeline& pipeline = *chain->pipeline;
+        pipeline.prepare(2, NUM_SAMPLES, 2);
+
+        WHEN("None of the plugins have been measured") {
+            pipeline.compile(chain->renderPlan);
+
+            THEN("The plugins are split evenly") {
+                REQUIRE(pipeline.getNumStages() == 2);
+                CHECK(pipeline.getStageStart(0) == 0);
+                CHECK(pipeline.getStageEnd(0, 4) == 2);
+                CHECK(pipeline.getStageStart(1) == 2);
+                CHECK(pipeline.getStageEnd(1, 4) == 4);
+                CHECK(pipeline.getLatencySamples() == NUM_SAMPLES);
+            }
+        }
+
+        WHEN("The first plugin costs as much as the rest put together") {
+            const std::vector<float> costs {3, 1, 1, 1};
+            for (int pluginIndex {0}; pluginIndex < costs.size(); pluginIndex++) {
+                std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[pluginIndex])->processingCost = costs[pluginIndex];
+            }
+
+            pipeline.compile(chain->renderPlan);
+
+            THEN("It gets a stage to itself") {
+                REQUIRE(pipeline.getNumStages() == 2);
+                CHECK(pipeline.getStageEnd(0, 4) == 1);
+                CHECK(pipeline.getStageStart(1) == 1);
+                CHECK(pipeline.getStageEnd(1, 4) == 4);
+            }
+        }
+
+        WHEN("There are more stages allowed than plugins") {
+            pipeline.prepare(2, NUM_SAMPLES, ChainPipeline::MAX_NUM_STAGES);
+            ChainMutators::removeSlot(chain, 3);
+            ChainMutators::removeSlot(chain, 2);
+
+            THEN("Each plugin gets its own stage") {
+                REQUIRE(pipeline.getNumStages() == 2);
+                CHECK(pipeline.getStageEnd(0, 2) == 1);
+                CHECK(pipeline.getStageEnd(1, 2) == 2);
+            }
+        }
+    }
+
+    GIVEN("A chain with a single plugin") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = 44100;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto chain = createChain(1, hostConfig);
+        chain->pipeline->prepare(2, NUM_SAMPLES, ChainPipeline::MAX_NUM_STAGES);
+        chain->pipeline->compile(chain->renderPlan);
+
+        THEN("It isn't pipelined") {
+            CHECK(chain->pipeline->getNumStages() == 1);
+            CHECK(chain->pipeline->getLatencySamples() == 0);
+
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+            CHECK_FALSE(chain->pipeline->canProcess(buffer));
+        }
+    }
+}
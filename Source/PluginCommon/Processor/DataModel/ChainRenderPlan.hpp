@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSlots.hpp"
+
+enum class RENDER_OP_TYPE {
+    GAIN_STAGE,
+    PLUGIN
+};
+
+/**
+ * A single step in a compiled chain.
+ *
+ * The slot is a raw pointer - it's owned by the chain the plan was compiled from, which keeps it
+ * alive for as long as the plan is valid.
+ */
+struct RenderOp {
+    RENDER_OP_TYPE type;
+    ChainSlotBase* slot;
+
+    RenderOp(RENDER_OP_TYPE newType, ChainSlotBase* newSlot) : type(newType), slot(newSlot) { }
+};
+
+/**
+ * A flat list of the operations needed to process a chain.
+ *
+ * This is compiled from the chain's slots whenever they change, so the audio thread can just walk
+ * an array of tagged ops rather than casting and copying the shared pointer for each slot every
+ * block.
+ */
+struct ChainRenderPlan {
+    std::vector<RenderOp> ops;
+
+    void compile(const std::vector<std::shared_ptr<ChainSlotBase>>& slots) {
+        ops.clear();
+        ops.reserve(slots.size());
+
+        for (const std::shared_ptr<ChainSlotBase>& slot : slots) {
+            if (dynamic_cast<ChainSlotGainStage*>(slot.get()) != nullptr) {
+                ops.emplace_back(RENDER_OP_TYPE::GAIN_STAGE, slot.get());
+            } else if (dynamic_cast<ChainSlotPlugin*>(slot.get()) != nullptr) {
+                ops.emplace_back(RENDER_OP_TYPE::PLUGIN, slot.get());
+            }
+        }
+    }
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "WEFilters/AREnvelopeFollowerSquareLaw.h"
+#include "LatencyCompensationLine.hpp"
+#include "LevelMeter.hpp"
 #include "ModulationSourceDefinition.hpp"
 #include "PluginConfigurator.hpp"
 
@@ -25,35 +26,32 @@ struct ChainSlotGainStage : ChainSlotBase {
     float pan;
 
     int numMainChannels;
-    std::array<WECore::AREnv::AREnvelopeFollowerSquareLaw, 2> meterEnvelopes;
+
+    // Shared between clones so the UI's meter carries on reading the same gain stage after edits
+    std::shared_ptr<LevelMeter> meter;
 
     ChainSlotGainStage(float newGain, float newPan, bool newIsBypassed, const juce::AudioProcessor::BusesLayout& busesLayout)
-        : ChainSlotBase(newIsBypassed), gain(newGain), pan(newPan), numMainChannels(busesLayout.getMainInputChannels()) {
-        _setUpEnvelopes();
+        : ChainSlotBase(newIsBypassed),
+          gain(newGain),
+          pan(newPan),
+          numMainChannels(busesLayout.getMainInputChannels()),
+          meter(std::make_shared<LevelMeter>()) {
     }
 
     ~ChainSlotGainStage() = default;
 
     ChainSlotGainStage* clone() const override {
-        return new ChainSlotGainStage(gain, pan, isBypassed, numMainChannels);
+        return new ChainSlotGainStage(gain, pan, isBypassed, numMainChannels, meter);
     }
 
 private:
-    void _setUpEnvelopes() {
-        for (auto& env : meterEnvelopes) {
-            env.setAttackTimeMs(1);
-            env.setReleaseTimeMs(50);
-            env.setFilterEnabled(false);
-        }
-    }
-
     ChainSlotGainStage(
         float newGain,
         float newPan,
         bool newIsBypassed,
-        int newNumMainChannels)
-            : ChainSlotBase(newIsBypassed), gain(newGain), pan(newPan), numMainChannels(newNumMainChannels) {
-        _setUpEnvelopes();
+        int newNumMainChannels,
+        std::shared_ptr<LevelMeter> newMeter)
+            : ChainSlotBase(newIsBypassed), gain(newGain), pan(newPan), numMainChannels(newNumMainChannels), meter(newMeter) {
     }
 };
 
@@ -127,6 +125,210 @@ struct PluginModulationConfig {
     }
 };
 
+/**
+ * The modulation config of a plugin compiled into a form that's quick to evaluate on the audio
+ * thread.
+ *
+ * Target parameters are looked up by name once when the config changes rather than every block,
+ * and the connections are stored as flat arrays (one element per source on each target) so
+ * evaluating them doesn't chase pointers through the config.
+ *
+ * The rest values and amounts can be changed by updateValues() while the audio thread is using the
+ * matrix, so they're atomic. Everything else is either only changed by compile(), or only used by
+ * the audio thread.
+ */
+struct ModulationMatrix {
+    // One element per plugin parameter being modulated
+    std::vector<juce::AudioProcessorParameter*> parameters;
+    std::vector<int> parameterConfigIndices;
+    std::vector<std::atomic<float>> restValues;
+    std::vector<float> parameterValues;
+    std::vector<float> lastParameterValues;
+
+    // One element per connection between a source and a parameter
+    std::vector<int> connectionParameterIndices;
+    std::vector<int> connectionSourceIndices;
+    std::vector<int> connectionConfigSourceIndices;
+    std::vector<std::atomic<float>> connectionAmounts;
+    std::vector<float> connectionValues;
+
+    // One element per unique source, so each is only read once per block
+    std::vector<ModulationSourceDefinition> sources;
+    std::vector<float> sourceValues;
+
+    // The structure the matrix was compiled from, used to check if values can be updated in place
+    std::vector<juce::String> compiledTargetNames;
+    std::vector<std::vector<ModulationSourceDefinition>> compiledTargetSources;
+
+    // Set when the values are updated so the audio thread sets every parameter on its next block
+    std::atomic<bool> shouldSetAllParameters;
+
+    ModulationMatrix() : shouldSetAllParameters(false) { }
+
+    /**
+     * Copies the compiled matrix, so a cloned slot with the same plugin and config doesn't need to
+     * look up its parameters again. Every parameter is set on the copy's first block.
+     */
+    ModulationMatrix(const ModulationMatrix& other) : parameters(other.parameters),
+                                                      parameterConfigIndices(other.parameterConfigIndices),
+                                                      restValues(_copyValues(other.restValues)),
+                                                      parameterValues(other.parameterValues.size()),
+                                                      lastParameterValues(other.lastParameterValues.size(), -1.0f),
+                                                      connectionParameterIndices(other.connectionParameterIndices),
+                                                      connectionSourceIndices(other.connectionSourceIndices),
+                                                      connectionConfigSourceIndices(other.connectionConfigSourceIndices),
+                                                      connectionAmounts(_copyValues(other.connectionAmounts)),
+                                                      connectionValues(other.connectionValues.size()),
+                                                      sources(other.sources),
+                                                      sourceValues(other.sourceValues.size()),
+                                                      compiledTargetNames(other.compiledTargetNames),
+                                                      compiledTargetSources(other.compiledTargetSources),
+                                                      shouldSetAllParameters(false) { }
+
+    ModulationMatrix& operator=(const ModulationMatrix&) = delete;
+
+    /**
+     * Resolves the targets in config to the plugin's parameters. Allocates, so must not be called
+     * on a matrix the audio thread might be using.
+     */
+    void compile(juce::AudioPluginInstance& plugin, const PluginModulationConfig& config) {
+        clear();
+
+        for (const std::shared_ptr<PluginParameterModulationConfig>& parameterConfig : config.parameterConfigs) {
+            compiledTargetNames.push_back(parameterConfig->targetParameterName);
+            compiledTargetSources.emplace_back();
+            for (const std::shared_ptr<PluginParameterModulationSource>& source : parameterConfig->sources) {
+                compiledTargetSources.back().push_back(source->definition);
+            }
+        }
+
+        const juce::Array<juce::AudioProcessorParameter*>& pluginParameters = plugin.getParameters();
+
+        // The atomic values can't be moved, so are collected first and copied in once the sizes
+        // are known
+        std::vector<float> newRestValues;
+        std::vector<float> newConnectionAmounts;
+
+        for (int configIndex {0}; configIndex < config.parameterConfigs.size(); configIndex++) {
+            const std::shared_ptr<PluginParameterModulationConfig>& parameterConfig = config.parameterConfigs[configIndex];
+
+            for (juce::AudioProcessorParameter* targetParameter : pluginParameters) {
+                if (targetParameter->getName(PluginParameterModulationConfig::PLUGIN_PARAMETER_NAME_LENGTH_LIMIT) != parameterConfig->targetParameterName) {
+                    continue;
+                }
+
+                const int parameterIndex {static_cast<int>(parameters.size())};
+                parameters.push_back(targetParameter);
+                parameterConfigIndices.push_back(configIndex);
+                newRestValues.push_back(parameterConfig->restValue);
+
+                for (int configSourceIndex {0}; configSourceIndex < parameterConfig->sources.size(); configSourceIndex++) {
+                    const PluginParameterModulationSource& source = *parameterConfig->sources[configSourceIndex];
+
+                    connectionParameterIndices.push_back(parameterIndex);
+                    connectionSourceIndices.push_back(_getSourceIndex(source.definition));
+                    connectionConfigSourceIndices.push_back(configSourceIndex);
+                    newConnectionAmounts.push_back(source.modulationAmount);
+                }
+            }
+        }
+
+        restValues = _copyValues(newRestValues);
+        connectionAmounts = _copyValues(newConnectionAmounts);
+
+        // Allocate the space used while evaluating
+        parameterValues.resize(parameters.size());
+        lastParameterValues.resize(parameters.size(), -1.0f);
+        connectionValues.resize(connectionAmounts.size());
+        sourceValues.resize(sources.size());
+    }
+
+    /**
+     * Copies the rest values and amounts from config without reallocating. Returns false if config
+     * has a different structure to the one the matrix was compiled from, in which case it needs to
+     * be compiled again.
+     *
+     * Only writes atomic values, so it's safe to call on a matrix the audio thread is using.
+     */
+    bool updateValues(const PluginModulationConfig& config) {
+        if (config.parameterConfigs.size() != compiledTargetNames.size()) {
+            return false;
+        }
+
+        for (int configIndex {0}; configIndex < config.parameterConfigs.size(); configIndex++) {
+            const PluginParameterModulationConfig& parameterConfig = *config.parameterConfigs[configIndex];
+
+            if (parameterConfig.targetParameterName != compiledTargetNames[configIndex]
+                || parameterConfig.sources.size() != compiledTargetSources[configIndex].size()) {
+                return false;
+            }
+
+            for (int sourceIndex {0}; sourceIndex < parameterConfig.sources.size(); sourceIndex++) {
+                if (!(parameterConfig.sources[sourceIndex]->definition == compiledTargetSources[configIndex][sourceIndex])) {
+                    return false;
+                }
+            }
+        }
+
+        for (int parameterIndex {0}; parameterIndex < parameters.size(); parameterIndex++) {
+            restValues[parameterIndex].store(config.parameterConfigs[parameterConfigIndices[parameterIndex]]->restValue, std::memory_order_relaxed);
+        }
+
+        for (int connectionIndex {0}; connectionIndex < connectionAmounts.size(); connectionIndex++) {
+            const int configIndex {parameterConfigIndices[connectionParameterIndices[connectionIndex]]};
+            connectionAmounts[connectionIndex].store(
+                config.parameterConfigs[configIndex]->sources[connectionConfigSourceIndices[connectionIndex]]->modulationAmount,
+                std::memory_order_relaxed);
+        }
+
+        // Make sure every parameter is set on the next block
+        shouldSetAllParameters.store(true, std::memory_order_release);
+
+        return true;
+    }
+
+    void clear() {
+        parameters.clear();
+        parameterConfigIndices.clear();
+        restValues.clear();
+        parameterValues.clear();
+        lastParameterValues.clear();
+        connectionParameterIndices.clear();
+        connectionSourceIndices.clear();
+        connectionConfigSourceIndices.clear();
+        connectionAmounts.clear();
+        connectionValues.clear();
+        sources.clear();
+        sourceValues.clear();
+        compiledTargetNames.clear();
+        compiledTargetSources.clear();
+    }
+
+private:
+    template <typename T>
+    static std::vector<std::atomic<float>> _copyValues(const std::vector<T>& values) {
+        // Sized up front as std::atomic can't be moved when a vector grows
+        std::vector<std::atomic<float>> retVal(values.size());
+
+        for (size_t index {0}; index < values.size(); index++) {
+            retVal[index].store(values[index], std::memory_order_relaxed);
+        }
+
+        return retVal;
+    }
+
+    int _getSourceIndex(ModulationSourceDefinition definition) {
+        for (int index {0}; index < sources.size(); index++) {
+            if (sources[index] == definition) {
+                return index;
+            }
+        }
+
+        sources.push_back(definition);
+        return static_cast<int>(sources.size()) - 1;
+    }
+};
+
 struct PluginEditorBoundsContainer {
     juce::Rectangle<int> editorBounds;
     juce::Rectangle<int> displayArea;
@@ -139,36 +341,84 @@ struct PluginEditorBoundsContainer {
 
 typedef std::optional<PluginEditorBoundsContainer> PluginEditorBounds;
 
+/**
+ * Delays the audio by the plugin's latency while the plugin is suspended and its input is passed
+ * through, so the chain stays lined up with the others.
+ */
+struct SuspendedPassthrough {
+    LatencyCompensationLine line;
+
+    // True while the audio thread is passing audio through the line, only used by the audio thread
+    bool isActive;
+
+    explicit SuspendedPassthrough(int maxDelayInSamples) : line(maxDelayInSamples), isActive(false) {}
+};
+
+/**
+ * The plugin that a slot's plugin replaced in place, such as a placeholder. It's processed
+ * alongside the new plugin for one more block so it can be crossfaded out rather than cut off.
+ */
+struct PluginSwapCrossfade {
+    std::shared_ptr<juce::AudioPluginInstance> replacedPlugin;
+
+    // The replaced plugin processes a copy of the input into this, allocated up front for a block
+    juce::AudioBuffer<float> replacedOutput;
+    juce::MidiBuffer replacedMidi;
+
+    // Cleared by the audio thread once it has started the crossfade
+    std::atomic<bool> isPending;
+
+    PluginSwapCrossfade(std::shared_ptr<juce::AudioPluginInstance> newReplacedPlugin, int numChannels, int blockSize)
+        : replacedPlugin(newReplacedPlugin), replacedOutput(numChannels, blockSize), isPending(true) {}
+};
+
 /**
  * Represents a plugin in a slot in a processing chain.
  */
 struct ChainSlotPlugin : ChainSlotBase {
     std::shared_ptr<juce::AudioPluginInstance> plugin;
     std::shared_ptr<PluginModulationConfig> modulationConfig;
+
+    // Compiled from modulationConfig, must be updated whenever it changes
+    ModulationMatrix modulationMatrix;
+
     std::function<float(int, MODULATION_TYPE)> getModulationValueCallback;
     std::shared_ptr<PluginEditorBounds> editorBounds;
 
-    // AUs always require a sidechain input, but if Syndicate is loaded as a VST3 it might not have
-    // one, as VST3s don't require a sidechain input. So we keep this empty buffer to provide as a
-    // sidechain for AUs if needed.
-    std::unique_ptr<juce::AudioBuffer<float>> spareSCBuffer;
+    // How long the plugin keeps outputting sound after its input goes silent, not including its
+    // latency. Set in prepareToPlay, negative if the plugin should never be put to sleep.
+    int tailLengthSamples;
+
+    // How long the input has been silent for, updated by the audio thread
+    std::atomic<int> numSilentSamples;
+
+    // Average time in seconds the plugin takes to process a sample, measured by the audio thread
+    // while the chain is pipelined and used to balance the stages. 0 until it has been measured.
+    std::atomic<float> processingCost;
+
+    // Allocated in prepareToPlay. Shared with clones as they share the plugin.
+    std::shared_ptr<SuspendedPassthrough> suspendedPassthrough;
+
+    // Set when the plugin has just replaced another one, nullptr otherwise. Shared with clones.
+    std::shared_ptr<PluginSwapCrossfade> swapCrossfade;
 
     ChainSlotPlugin(std::shared_ptr<juce::AudioPluginInstance> newPlugin,
                     bool newIsBypassed,
                     std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
-                    HostConfiguration config)
+                    HostConfiguration /*config*/)
         : ChainSlotBase(newIsBypassed),
           plugin(newPlugin),
           modulationConfig(std::make_shared<PluginModulationConfig>()),
           getModulationValueCallback(newGetModulationValueCallback),
           editorBounds(new PluginEditorBounds()),
-          spareSCBuffer(new juce::AudioBuffer<float>(config.layout.getMainInputChannels() * 2, config.blockSize)) {}
+          tailLengthSamples(-1),
+          numSilentSamples(0),
+          processingCost(0) {}
 
     ~ChainSlotPlugin() = default;
 
     ChainSlotPlugin* clone() const override {
-        auto newSpareSCBuffer = std::make_unique<juce::AudioBuffer<float>>(spareSCBuffer->getNumChannels(), spareSCBuffer->getNumSamples());
-        return new ChainSlotPlugin(plugin, isBypassed, modulationConfig, getModulationValueCallback, editorBounds, std::move(newSpareSCBuffer));
+        return new ChainSlotPlugin(plugin, isBypassed, modulationConfig, modulationMatrix, getModulationValueCallback, editorBounds, tailLengthSamples, numSilentSamples.load(std::memory_order_relaxed), processingCost.load(std::memory_order_relaxed), suspendedPassthrough, swapCrossfade);
     }
 
 private:
@@ -176,13 +426,24 @@ private:
         std::shared_ptr<juce::AudioPluginInstance> newPlugin,
         bool newIsBypassed,
         std::shared_ptr<PluginModulationConfig> newModulationConfig,
+        const ModulationMatrix& newModulationMatrix,
         std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
         std::shared_ptr<PluginEditorBounds> newEditorBounds,
-        std::unique_ptr<juce::AudioBuffer<float>> newSpareSCBuffer)
+        int newTailLengthSamples,
+        int newNumSilentSamples,
+        float newProcessingCost,
+        std::shared_ptr<SuspendedPassthrough> newSuspendedPassthrough,
+        std::shared_ptr<PluginSwapCrossfade> newSwapCrossfade)
             : ChainSlotBase(newIsBypassed),
               plugin(newPlugin),
               modulationConfig(std::shared_ptr<PluginModulationConfig>(newModulationConfig->clone())),
+              modulationMatrix(newModulationMatrix),
               getModulationValueCallback(newGetModulationValueCallback),
               editorBounds(newEditorBounds),
-              spareSCBuffer(std::move(newSpareSCBuffer)) {}
+              tailLengthSamples(newTailLengthSamples),
+              numSilentSamples(newNumSilentSamples),
+              processingCost(newProcessingCost),
+              suspendedPassthrough(newSuspendedPassthrough),
+              swapCrossfade(newSwapCrossfade) {
+    }
 };
@@ -16,16 +16,9 @@ SCENARIO("ChainSlotGainStage: Clone works correctly") {
                 CHECK(clonedGainStage->pan == gainStage.pan);
                 CHECK(clonedGainStage->numMainChannels == gainStage.numMainChannels);
 
-                // We don't need to copy the meter envelopes, but they should be configured exactly
-                // the same
-                CHECK(clonedGainStage->meterEnvelopes.size() == gainStage.meterEnvelopes.size());
-                for (int envIndex {0}; envIndex < clonedGainStage->meterEnvelopes.size(); envIndex++) {
-                    auto& clonedEnvelope = clonedGainStage->meterEnvelopes[envIndex];
-                    auto& originalEnvelope = gainStage.meterEnvelopes[envIndex];
-                    CHECK(clonedEnvelope.getAttackTimeMs() == originalEnvelope.getAttackTimeMs());
-                    CHECK(clonedEnvelope.getReleaseTimeMs() == originalEnvelope.getReleaseTimeMs());
-                    CHECK(clonedEnvelope.getFilterEnabled() == originalEnvelope.getFilterEnabled());
-                }
+                // The meter is shared so the UI keeps reading it after the gain stage is cloned
+                CHECK(clonedGainStage->meter != nullptr);
+                CHECK(clonedGainStage->meter == gainStage.meter);
             }
 
             delete clonedGainStage;
@@ -49,10 +42,6 @@ SCENARIO("ChainSlotPlugin: Clone works correctly") {
 
         auto pluginSlot = std::make_shared<ChainSlotPlugin>(plugin, false, modulationCallback, hostConfig);
 
-        REQUIRE(pluginSlot->spareSCBuffer != nullptr);
-        REQUIRE(pluginSlot->spareSCBuffer->getNumChannels() == 4);
-        REQUIRE(pluginSlot->spareSCBuffer->getNumSamples() == 10);
-
         auto modulationConfig = std::make_shared<PluginModulationConfig>();
         modulationConfig->isActive = true;
 
@@ -77,9 +66,6 @@ SCENARIO("ChainSlotPlugin: Clone works correctly") {
                 CHECK(clonedPluginSlot->modulationConfig != pluginSlot->modulationConfig); // Should be a different shared pointer
                 CHECK(clonedPluginSlot->getModulationValueCallback(0, MODULATION_TYPE::MACRO) == 1.2f);
                 CHECK(clonedPluginSlot->editorBounds == pluginSlot->editorBounds); // Should be the same shared pointer
-                CHECK(clonedPluginSlot->spareSCBuffer != pluginSlot->spareSCBuffer); // Should be a different shared pointer
-                CHECK(clonedPluginSlot->spareSCBuffer->getNumChannels() == pluginSlot->spareSCBuffer->getNumChannels());
-                CHECK(clonedPluginSlot->spareSCBuffer->getNumSamples() == pluginSlot->spareSCBuffer->getNumSamples());
 
                 // Check all the modulation
                 auto clonedModulationConfig = clonedPluginSlot->modulationConfig;
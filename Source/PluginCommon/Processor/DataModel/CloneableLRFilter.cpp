@@ -105,6 +105,164 @@ void CloneableLRFilter<SampleType>::processSample (int channel, SampleType input
     outputHigh = yL - R2 * yB + yH - yL2;
 }
 
+template <typename SampleType>
+void CloneableLRFilter<SampleType>::processSplit (const SampleType* const* input,
+                                                  SampleType* const* outputLow,
+                                                  SampleType* const* outputHigh,
+                                                  int numChannels,
+                                                  int numSamples) noexcept
+{
+    jassert (numChannels <= (int) s1.size());
+
+    if (numChannels >= 2)
+        processSplitChannels<2> (input, outputLow, outputHigh, numSamples);
+    else if (numChannels == 1)
+        processSplitChannels<1> (input, outputLow, outputHigh, numSamples);
+
+   #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+   #endif
+}
+
+template <typename SampleType>
+void CloneableLRFilter<SampleType>::processAllpass (SampleType* const* inputOutput, int numChannels, int numSamples) noexcept
+{
+    jassert (numChannels <= (int) s1.size());
+
+    if (numChannels >= 2)
+        processAllpassChannels<2, false> (inputOutput, nullptr, numSamples);
+    else if (numChannels == 1)
+        processAllpassChannels<1, false> (inputOutput, nullptr, numSamples);
+
+   #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+   #endif
+}
+
+template <typename SampleType>
+void CloneableLRFilter<SampleType>::processAllpassAndAdd (SampleType* const* inputOutput,
+                                                          const SampleType* const* addend,
+                                                          int numChannels,
+                                                          int numSamples) noexcept
+{
+    jassert (numChannels <= (int) s1.size());
+
+    if (numChannels >= 2)
+        processAllpassChannels<2, true> (inputOutput, addend, numSamples);
+    else if (numChannels == 1)
+        processAllpassChannels<1, true> (inputOutput, addend, numSamples);
+
+   #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+   #endif
+}
+
+template <typename SampleType>
+template <int NumChannels>
+void CloneableLRFilter<SampleType>::processSplitChannels (const SampleType* const* input,
+                                                          SampleType* const* outputLow,
+                                                          SampleType* const* outputHigh,
+                                                          int numSamples) noexcept
+{
+    // Keep the state in locals for the whole block rather than going through the vectors for
+    // every sample
+    SampleType z1[NumChannels], z2[NumChannels], z3[NumChannels], z4[NumChannels];
+
+    for (int channel = 0; channel < NumChannels; ++channel)
+    {
+        z1[channel] = s1[(size_t) channel];
+        z2[channel] = s2[(size_t) channel];
+        z3[channel] = s3[(size_t) channel];
+        z4[channel] = s4[(size_t) channel];
+    }
+
+    const auto gain = R2 + g;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        SampleType low[NumChannels], high[NumChannels];
+
+        for (int channel = 0; channel < NumChannels; ++channel)
+        {
+            const auto yH = (input[channel][i] - gain * z1[channel] - z2[channel]) * h;
+
+            const auto yB = g * yH + z1[channel];
+            z1[channel] = g * yH + yB;
+
+            const auto yL = g * yB + z2[channel];
+            z2[channel] = g * yB + yL;
+
+            const auto yH2 = (yL - gain * z3[channel] - z4[channel]) * h;
+
+            const auto yB2 = g * yH2 + z3[channel];
+            z3[channel] = g * yH2 + yB2;
+
+            const auto yL2 = g * yB2 + z4[channel];
+            z4[channel] = g * yB2 + yL2;
+
+            // The low and high outputs of a Linkwitz-Riley crossover sum to the all-pass
+            low[channel] = yL2;
+            high[channel] = yL - R2 * yB + yH - yL2;
+        }
+
+        for (int channel = 0; channel < NumChannels; ++channel)
+        {
+            outputLow[channel][i] = low[channel];
+            outputHigh[channel][i] = high[channel];
+        }
+    }
+
+    for (int channel = 0; channel < NumChannels; ++channel)
+    {
+        s1[(size_t) channel] = z1[channel];
+        s2[(size_t) channel] = z2[channel];
+        s3[(size_t) channel] = z3[channel];
+        s4[(size_t) channel] = z4[channel];
+    }
+}
+
+template <typename SampleType>
+template <int NumChannels, bool ShouldAdd>
+void CloneableLRFilter<SampleType>::processAllpassChannels (SampleType* const* inputOutput,
+                                                            const SampleType* const* addend,
+                                                            int numSamples) noexcept
+{
+    SampleType z1[NumChannels], z2[NumChannels];
+
+    for (int channel = 0; channel < NumChannels; ++channel)
+    {
+        z1[channel] = s1[(size_t) channel];
+        z2[channel] = s2[(size_t) channel];
+    }
+
+    const auto gain = R2 + g;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int channel = 0; channel < NumChannels; ++channel)
+        {
+            const auto yH = (inputOutput[channel][i] - gain * z1[channel] - z2[channel]) * h;
+
+            const auto yB = g * yH + z1[channel];
+            z1[channel] = g * yH + yB;
+
+            const auto yL = g * yB + z2[channel];
+            z2[channel] = g * yB + yL;
+
+            if constexpr (ShouldAdd)
+                inputOutput[channel][i] = yL - R2 * yB + yH + addend[channel][i];
+            else
+                inputOutput[channel][i] = yL - R2 * yB + yH;
+        }
+    }
+
+    for (int channel = 0; channel < NumChannels; ++channel)
+    {
+        s1[(size_t) channel] = z1[channel];
+        s2[(size_t) channel] = z2[channel];
+    }
+}
+
 template <typename SampleType>
 void CloneableLRFilter<SampleType>::update()
 {
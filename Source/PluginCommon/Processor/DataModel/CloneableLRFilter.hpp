@@ -89,6 +89,33 @@ public:
     */
     void processSample (int channel, SampleType inputValue, SampleType &outputLow, SampleType &outputHigh);
 
+    /** Splits up to two channels into low-pass and high-pass outputs in a single pass, using
+        this filter's state for both. The channels are processed together so their state sits
+        in neighbouring lanes and the compiler can vectorise across them.
+
+        The input may be the same as the low output to split in place. The filter type is
+        ignored.
+    */
+    void processSplit (const SampleType* const* input,
+                       SampleType* const* outputLow,
+                       SampleType* const* outputHigh,
+                       int numChannels,
+                       int numSamples) noexcept;
+
+    /** Applies the all-pass to up to two channels in place. This only uses the first of the two
+        stages, so a low-pass filter that isn't splitting can be used as an all-pass at its
+        cutoff. The filter type is ignored.
+    */
+    void processAllpass (SampleType* const* inputOutput, int numChannels, int numSamples) noexcept;
+
+    /** Applies the all-pass to up to two channels in place and adds the addend to the result in
+        the same pass. The filter type is ignored.
+    */
+    void processAllpassAndAdd (SampleType* const* inputOutput,
+                               const SampleType* const* addend,
+                               int numChannels,
+                               int numSamples) noexcept;
+
     /** Ensure that the state variables are rounded to zero if the state
         variables are denormals. This is only needed if you are doing
         sample by sample processing.
@@ -122,4 +149,10 @@ private:
 
     //==============================================================================
     void update();
+
+    template <int NumChannels>
+    void processSplitChannels (const SampleType* const* input, SampleType* const* outputLow, SampleType* const* outputHigh, int numSamples) noexcept;
+
+    template <int NumChannels, bool ShouldAdd>
+    void processAllpassChannels (SampleType* const* inputOutput, const SampleType* const* addend, int numSamples) noexcept;
 };
@@ -45,4 +45,98 @@ SCENARIO("CloneableLRFilter: Clone works correctly") {
             delete clonedFilter;
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("CloneableLRFilter: Splitting in one pass matches separate lowpass and highpass filters") {
+    GIVEN("A lowpass and highpass filter at the same frequency, and a stereo input") {
+        constexpr int numFilterChannels {2};
+        constexpr int numSamples {128};
+        const juce::dsp::ProcessSpec spec {48000, numSamples, numFilterChannels};
+
+        CloneableLRFilter<float> lowpassFilter;
+        lowpassFilter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+        lowpassFilter.prepare(spec);
+        lowpassFilter.setCutoffFrequency(1000);
+
+        CloneableLRFilter<float> highpassFilter;
+        highpassFilter.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+        highpassFilter.prepare(spec);
+        highpassFilter.setCutoffFrequency(1000);
+
+        juce::AudioBuffer<float> input(numFilterChannels, numSamples);
+        for (int channel {0}; channel < numFilterChannels; ++channel) {
+            for (int sample {0}; sample < numSamples; ++sample) {
+                input.setSample(channel, sample, ((sample * (channel + 3)) % 17) / 17.0f - 0.5f);
+            }
+        }
+
+        WHEN("The input is split in place") {
+            juce::AudioBuffer<float> expectedLow;
+            expectedLow.makeCopyOf(input);
+            juce::AudioBuffer<float> expectedHigh;
+            expectedHigh.makeCopyOf(input);
+
+            {
+                juce::dsp::AudioBlock<float> block(expectedLow);
+                juce::dsp::ProcessContextReplacing context(block);
+                lowpassFilter.process(context);
+            }
+
+            {
+                juce::dsp::AudioBlock<float> block(expectedHigh);
+                juce::dsp::ProcessContextReplacing context(block);
+                highpassFilter.process(context);
+            }
+
+            CloneableLRFilter<float> splitFilter;
+            splitFilter.prepare(spec);
+            splitFilter.setCutoffFrequency(1000);
+
+            juce::AudioBuffer<float> low;
+            low.makeCopyOf(input);
+            juce::AudioBuffer<float> high(numFilterChannels, numSamples);
+            splitFilter.processSplit(low.getArrayOfReadPointers(), low.getArrayOfWritePointers(), high.getArrayOfWritePointers(), numFilterChannels, numSamples);
+
+            THEN("Both outputs match the separate filters") {
+                for (int channel {0}; channel < numFilterChannels; ++channel) {
+                    for (int sample {0}; sample < numSamples; ++sample) {
+                        CHECK(low.getSample(channel, sample) == Approx(expectedLow.getSample(channel, sample)).margin(0.0001));
+                        CHECK(high.getSample(channel, sample) == Approx(expectedHigh.getSample(channel, sample)).margin(0.0001));
+                    }
+                }
+            }
+        }
+
+        WHEN("The input is allpassed and added to in one pass") {
+            CloneableLRFilter<float> allpassFilter;
+            allpassFilter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+            allpassFilter.prepare(spec);
+            allpassFilter.setCutoffFrequency(1000);
+
+            juce::AudioBuffer<float> expected;
+            expected.makeCopyOf(input);
+            {
+                juce::dsp::AudioBlock<float> block(expected);
+                juce::dsp::ProcessContextReplacing context(block);
+                allpassFilter.process(context);
+            }
+
+            for (int channel {0}; channel < numFilterChannels; ++channel) {
+                expected.addFrom(channel, 0, input, channel, 0, numSamples);
+            }
+
+            allpassFilter.reset();
+            juce::AudioBuffer<float> output;
+            output.makeCopyOf(input);
+            allpassFilter.processAllpassAndAdd(output.getArrayOfWritePointers(), input.getArrayOfReadPointers(), numFilterChannels, numSamples);
+
+            THEN("The output matches allpassing then adding") {
+                for (int channel {0}; channel < numFilterChannels; ++channel) {
+                    for (int sample {0}; sample < numSamples; ++sample) {
+                        CHECK(output.getSample(channel, sample) == Approx(expected.getSample(channel, sample)).margin(0.0001));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -4,7 +4,9 @@
 #include "WEFilters/AREnvelopeFollowerSquareLaw.h"
 
 namespace ModelInterface {
-    class CloneableLFO : public WECore::Richter::RichterLFO {
+    // Final so that the per sample calls in getNextOutputs() can be resolved at compile time
+    // rather than going through the virtual call for every sample
+    class CloneableLFO final : public WECore::Richter::RichterLFO {
     public:
         CloneableLFO() : WECore::Richter::RichterLFO() {}
 
@@ -12,6 +14,19 @@ namespace ModelInterface {
             return new CloneableLFO(*this);
         }
 
+        /**
+         * Renders the next numSamples outputs, the same as calling getNextOutput() for each sample.
+         * onSample(sampleIndex) is called before each sample is rendered, so sources modulating
+         * this one can be read at the right position in the block.
+         */
+        template <typename OnSampleFunction>
+        void getNextOutputs(double* outputs, int numSamples, OnSampleFunction onSample) {
+            for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+                onSample(sampleIndex);
+                outputs[sampleIndex] = getNextOutput(0);
+            }
+        }
+
          void setFreqModulationSources(std::vector<WECore::ModulationSourceWrapper<double>> sources) {
             _freqModulationSources = sources;
         }
@@ -55,7 +70,7 @@ namespace ModelInterface {
         }
     };
 
-    class CloneableEnvelopeFollower : public WECore::AREnv::AREnvelopeFollowerSquareLaw {
+    class CloneableEnvelopeFollower final : public WECore::AREnv::AREnvelopeFollowerSquareLaw {
     public:
         CloneableEnvelopeFollower() : WECore::AREnv::AREnvelopeFollowerSquareLaw() {}
 
@@ -63,6 +78,16 @@ namespace ModelInterface {
             return new CloneableEnvelopeFollower(*this);
         }
 
+        /**
+         * Renders the output for the next numSamples of input, the same as calling getNextOutput()
+         * for each sample.
+         */
+        void getNextOutputs(const float* inputs, double* outputs, int numSamples) {
+            for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+                outputs[sampleIndex] = getNextOutput(inputs[sampleIndex]);
+            }
+        }
+
     private:
         CloneableEnvelopeFollower(const CloneableEnvelopeFollower& other) {
             _envVal = other._envVal;
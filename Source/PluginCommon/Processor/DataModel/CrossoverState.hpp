@@ -14,14 +14,16 @@ struct BandState {
 
 class CrossoverState {
 public:
-    // Num low/highpass filters = num bands - 1 (= num crossovers)
+    // Num lowpass filters = num bands - 1 (= num crossovers)
+    // Each crossover is split into its low and high outputs in a single pass of its lowpass filter
     std::vector<std::shared_ptr<CloneableLRFilter<float>>> lowpassFilters;
-    std::vector<std::shared_ptr<CloneableLRFilter<float>>> highpassFilters;
 
     // Num allpass filters = num bands - 2
     std::vector<std::shared_ptr<CloneableLRFilter<float>>> allpassFilters;
 
     // Num buffers = num bands - 1 (= num crossovers)
+    // These don't own any memory, they refer to buffers borrowed from the scratch arena for the
+    // block currently being processed
     std::vector<juce::AudioBuffer<float>> buffers;
 
     std::vector<BandState> bands;
@@ -31,7 +33,12 @@ public:
     // We only need to implement solo at this level - chains handle bypass and mute themselves
     int numBandsSoloed;
 
-    CrossoverState() : numBandsSoloed(0) {}
+    // The number of bands at the top which pass their audio through unchanged, and are merged into
+    // the band below them so their crossovers don't need to be split. Kept up to date by the
+    // mutators, 0 if nothing can be merged.
+    int numMergedBands;
+
+    CrossoverState() : numBandsSoloed(0), numMergedBands(0) {}
 
     CrossoverState* clone() const {
         auto newState = new CrossoverState();
@@ -40,17 +47,12 @@ public:
             newState->lowpassFilters.emplace_back(filter->clone());
         }
 
-        for (auto& filter : highpassFilters) {
-            newState->highpassFilters.emplace_back(filter->clone());
-        }
-
         for (auto& filter : allpassFilters) {
             newState->allpassFilters.emplace_back(filter->clone());
         }
 
-        for (auto& buffer : buffers) {
-            newState->buffers.emplace_back(buffer);
-        }
+        // Copying a buffer that refers to other data would allocate its own, so just create empty ones
+        newState->buffers.resize(buffers.size());
 
         for (auto& band : bands) {
             newState->bands.emplace_back();
@@ -62,6 +64,8 @@ public:
 
         newState->numBandsSoloed = numBandsSoloed;
 
+        newState->numMergedBands = numMergedBands;
+
         return newState;
     }
 };
@@ -76,10 +80,6 @@ inline std::shared_ptr<CrossoverState> createDefaultCrossoverState(HostConfigura
     state->lowpassFilters[0]->setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
     state->lowpassFilters[0]->setCutoffFrequency(DEFAULT_FREQ);
 
-    state->highpassFilters.emplace_back(new CloneableLRFilter<float>());
-    state->highpassFilters[0]->setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    state->highpassFilters[0]->setCutoffFrequency(DEFAULT_FREQ);
-
     state->buffers.emplace_back();
 
     state->bands.emplace_back();
@@ -33,23 +33,9 @@ SCENARIO("CrossoverState: Clone works correctly") {
         // Set the host configuration (and filter states)
         CrossoverProcessors::prepareToPlay(*crossover.get(), hostConfig.sampleRate, hostConfig.blockSize, hostConfig.layout);
 
-        // Populate the buffers
-        for (size_t bufferIndex {0}; bufferIndex < crossover->buffers.size(); bufferIndex++) {
-            for (size_t channelIndex {0}; channelIndex < crossover->buffers[bufferIndex].getNumChannels(); channelIndex++) {
-                for (size_t sampleIndex {0}; sampleIndex < crossover->buffers[bufferIndex].getNumSamples(); sampleIndex++) {
-                    crossover->buffers[bufferIndex].getWritePointer(channelIndex)[sampleIndex] = 0.5f;
-                }
-            }
-        }
-
         REQUIRE(crossover->lowpassFilters.size() == 2);
-        REQUIRE(crossover->highpassFilters.size() == 2);
         REQUIRE(crossover->allpassFilters.size() == 1);
         REQUIRE(crossover->buffers.size() == 2);
-        REQUIRE(crossover->buffers[0].getNumChannels() == 2);
-        REQUIRE(crossover->buffers[0].getNumSamples() == 10);
-        REQUIRE(crossover->buffers[1].getNumChannels() == 2);
-        REQUIRE(crossover->buffers[1].getNumSamples() == 10);
         REQUIRE(crossover->bands.size() == 3);
 
         WHEN("It is cloned") {
@@ -57,7 +43,6 @@ SCENARIO("CrossoverState: Clone works correctly") {
 
             THEN("The cloned crossover is equal to the original") {
                 CHECK(clonedCrossover->lowpassFilters.size() == crossover->lowpassFilters.size());
-                CHECK(clonedCrossover->highpassFilters.size() == crossover->highpassFilters.size());
                 CHECK(clonedCrossover->allpassFilters.size() == crossover->allpassFilters.size());
                 CHECK(clonedCrossover->buffers.size() == crossover->buffers.size());
                 CHECK(clonedCrossover->bands.size() == crossover->bands.size());
@@ -70,8 +55,6 @@ SCENARIO("CrossoverState: Clone works correctly") {
                 for (size_t filterIndex {0}; filterIndex < crossover->lowpassFilters.size(); filterIndex++) {
                     CHECK(clonedCrossover->lowpassFilters[filterIndex]->getType() == crossover->lowpassFilters[filterIndex]->getType());
                     CHECK(clonedCrossover->lowpassFilters[filterIndex]->getCutoffFrequency() == crossover->lowpassFilters[filterIndex]->getCutoffFrequency());
-                    CHECK(clonedCrossover->highpassFilters[filterIndex]->getType() == crossover->highpassFilters[filterIndex]->getType());
-                    CHECK(clonedCrossover->highpassFilters[filterIndex]->getCutoffFrequency() == crossover->highpassFilters[filterIndex]->getCutoffFrequency());
                 }
 
                 for (size_t filterIndex {0}; filterIndex < crossover->allpassFilters.size(); filterIndex++) {
@@ -79,22 +62,6 @@ SCENARIO("CrossoverState: Clone works correctly") {
                     CHECK(clonedCrossover->allpassFilters[filterIndex]->getCutoffFrequency() == crossover->allpassFilters[filterIndex]->getCutoffFrequency());
                 }
 
-                // Check the buffers
-                for (size_t bufferIndex {0}; bufferIndex < crossover->buffers.size(); bufferIndex++) {
-                    CHECK(clonedCrossover->buffers[bufferIndex].getNumChannels() == crossover->buffers[bufferIndex].getNumChannels());
-                    CHECK(clonedCrossover->buffers[bufferIndex].getNumSamples() == crossover->buffers[bufferIndex].getNumSamples());
-
-                    for (size_t channelIndex {0}; channelIndex < crossover->buffers[bufferIndex].getNumChannels(); channelIndex++) {
-                        for (size_t sampleIndex {0}; sampleIndex < crossover->buffers[bufferIndex].getNumSamples(); sampleIndex++) {
-                            CHECK(clonedCrossover->buffers[bufferIndex].getReadPointer(channelIndex)[sampleIndex] == 0.5f);
-                        }
-                    }
-                }
-
-                // Check that modifying a cloned buffer doesn't modify the original
-                clonedCrossover->buffers[0].getWritePointer(0)[0] = 0.6f;
-                CHECK(crossover->buffers[0].getReadPointer(0)[0] == 0.5f);
-
                 // Check the bands
                 for (size_t bandIndex {0}; bandIndex < crossover->bands.size(); bandIndex++) {
                     CHECK(clonedCrossover->bands[bandIndex].isSoloed == crossover->bands[bandIndex].isSoloed);
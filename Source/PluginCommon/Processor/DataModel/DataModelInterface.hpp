@@ -2,10 +2,17 @@
 
 #include <memory>
 #include <deque>
+#include <atomic>
+#include <algorithm>
+#include <set>
 #include "PluginSplitter.hpp"
+#include "FFTProvider.hpp"
+#include "UITelemetry.hpp"
+#include "GraphCrossfader.hpp"
 #include "General/AudioSpinMutex.h"
 #include "SplitterProcessors.hpp"
 #include "CloneableSources.hpp"
+#include "ModulationGraph.hpp"
 #include "WEFilters/PerlinSource.hpp"
 #include "WEFilters/StepSequencer.h"
 
@@ -25,19 +32,115 @@ namespace ModelInterface {
                 new PluginSplitterSeries(config, getModulationValueCallback, latencyChangeCallback)
             );
 
-            SplitterProcessors::prepareToPlay(*splitter.get(), config.sampleRate, config.blockSize, config.layout);
+            SplitterProcessors::prepareToPlay(*splitter.get(), config.sampleRate, config.blockSize, config.layout, config.maxLatencyCompensationSamples);
         }
 
         SplitterState* clone() const {
             return new SplitterState(*this);
         }
 
+        /**
+         * Estimated bytes held by this state that aren't shared with previousState, or the whole
+         * state if previousState is nullptr.
+         *
+         * A clone shares its chains and slots with the state it was cloned from until they're
+         * changed, and copies of a chain share the plugin instances and the audio held by its
+         * latency compensation, pipeline and suspended passthrough. These are counted by the first
+         * state in the history that holds them. An undo state keeps a removed plugin alive, so it
+         * counts towards the history for as long as that state does.
+         */
+        size_t getFootprintBytes(const SplitterState* previousState) const {
+            size_t numBytes {sizeof(SplitterState)};
+
+            if (cachedcrossoverFrequencies.has_value()) {
+                numBytes += cachedcrossoverFrequencies->capacity() * sizeof(float);
+            }
+
+            if (splitter == nullptr) {
+                return numBytes;
+            }
+
+            numBytes += sizeof(PluginSplitterMultiband) + splitter->chains.capacity() * sizeof(PluginChainWrapper);
+
+            if (splitter->splitType == SPLIT_TYPE::MULTIBAND) {
+                const CrossoverState& crossover = *static_cast<const PluginSplitterMultiband&>(*splitter).crossover;
+                const size_t numFilters {crossover.lowpassFilters.size() + crossover.allpassFilters.size()};
+                numBytes += sizeof(CrossoverState) + numFilters * sizeof(CloneableLRFilter<float>);
+                numBytes += crossover.bands.capacity() * sizeof(BandState);
+            }
+
+            // Count each shared resource once, and not at all if previousState already holds it
+            std::set<const void*> countedResources;
+            if (previousState != nullptr) {
+                previousState->_forEachSharedResource([&countedResources](const void* resource, size_t) {
+                    countedResources.insert(resource);
+                });
+            }
+
+            _forEachSharedResource([&countedResources, &numBytes](const void* resource, size_t resourceBytes) {
+                if (countedResources.insert(resource).second) {
+                    numBytes += resourceBytes;
+                }
+            });
+
+            return numBytes;
+        }
+
     private:
+        // The size of a plugin instance can't be queried, so this is a rough guess at a typical one
+        static constexpr size_t ESTIMATED_PLUGIN_INSTANCE_BYTES {4 * 1024 * 1024};
+
         SplitterState(const SplitterState& other) : splitter(other.splitter->clone()) {
             if (other.cachedcrossoverFrequencies.has_value()) {
                 cachedcrossoverFrequencies = other.cachedcrossoverFrequencies;
             }
         }
+
+        /**
+         * Calls the callback with an identifier and the estimated size of each chain, slot and
+         * resource this state may share with other states.
+         */
+        template <typename CallbackType>
+        void _forEachSharedResource(CallbackType callback) const {
+            if (splitter == nullptr) {
+                return;
+            }
+
+            for (const PluginChainWrapper& chainWrapper : splitter->chains) {
+                const PluginChain& chain = *chainWrapper.chain;
+
+                callback(&chain, sizeof(PluginChain) + sizeof(LatencyCompensationLine) + sizeof(ChainPipeline)
+                                 + chain.chain.capacity() * sizeof(std::shared_ptr<ChainSlotBase>)
+                                 + chain.renderPlan.ops.capacity() * sizeof(RenderOp));
+                callback(chain.latencyCompLine->getRingId(), chain.latencyCompLine->getRingSizeBytes());
+                callback(chain.pipeline->getInFlightId(), chain.pipeline->getInFlightSizeBytes());
+
+                for (const std::shared_ptr<ChainSlotBase>& slot : chain.chain) {
+                    if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                        size_t slotBytes {sizeof(ChainSlotPlugin) + sizeof(PluginModulationConfig)};
+
+                        for (const auto& parameterConfig : pluginSlot->modulationConfig->parameterConfigs) {
+                            slotBytes += sizeof(PluginParameterModulationConfig);
+                            slotBytes += parameterConfig->targetParameterName.getNumBytesAsUTF8();
+                            slotBytes += parameterConfig->sources.size() * sizeof(PluginParameterModulationSource);
+                        }
+
+                        callback(slot.get(), slotBytes);
+
+                        if (pluginSlot->plugin != nullptr) {
+                            callback(pluginSlot->plugin.get(), ESTIMATED_PLUGIN_INSTANCE_BYTES);
+                        }
+
+                        if (pluginSlot->suspendedPassthrough != nullptr) {
+                            callback(pluginSlot->suspendedPassthrough.get(),
+                                     sizeof(SuspendedPassthrough) + pluginSlot->suspendedPassthrough->line.getRingSizeBytes());
+                        }
+                    } else {
+                        callback(slot.get(), sizeof(ChainSlotGainStage));
+                    }
+                }
+            }
+        }
     };
 
     struct EnvelopeWrapper {
@@ -56,6 +159,11 @@ namespace ModelInterface {
         }
     };
 
+    /**
+     * Modulation sources are shared with the state they were cloned from, and only copied the first
+     * time they're written to. An edit to one source then only copies that source, rather than every
+     * source in the state.
+     */
     struct ModulationSourcesState {
         std::vector<std::shared_ptr<CloneableLFO>> lfos;
         std::vector<std::shared_ptr<EnvelopeWrapper>> envelopes;
@@ -67,6 +175,10 @@ namespace ModelInterface {
 
         std::function<float(int, MODULATION_TYPE)> getModulationValueCallback;
 
+        // Built from the sources above by ModulationProcessors::prepareGraph(), isn't copied when
+        // cloning as it must be rebuilt for the new sources
+        ModulationGraph graph;
+
         ModulationSourcesState(std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback) :
             getModulationValueCallback(newGetModulationValueCallback) { }
 
@@ -74,23 +186,88 @@ namespace ModelInterface {
             return new ModulationSourcesState(*this);
         }
 
-    private:
-        ModulationSourcesState(const ModulationSourcesState& other) : hostConfig(other.hostConfig), getModulationValueCallback(other.getModulationValueCallback) {
-            for (std::shared_ptr<CloneableLFO> lfo : other.lfos) {
-                lfos.emplace_back(lfo->clone());
-            }
+        /**
+         * Return the source at the given index so it can be changed, copying it first if it's still
+         * shared with the state this was cloned from. The index must be valid.
+         *
+         * Copying replaces the source in this state, so this must only be called on a state that
+         * hasn't been published yet.
+         */
+        std::shared_ptr<CloneableLFO> getLfoForWrite(size_t index) { return _getForWrite(lfos, index); }
+        std::shared_ptr<EnvelopeWrapper> getEnvelopeForWrite(size_t index) { return _getForWrite(envelopes, index); }
+        std::shared_ptr<WECore::Perlin::PerlinSource> getRandomForWrite(size_t index) { return _getForWrite(randomSources, index); }
+        std::shared_ptr<WECore::StepSeq::StepSequencer> getStepSeqForWrite(size_t index) { return _getForWrite(stepSequencers, index); }
+
+        /**
+         * True if the source is still shared with the state this was cloned from.
+         */
+        bool isShared(const std::shared_ptr<void>& source) const {
+            return _sharedSources.find(source) != _sharedSources.end();
+        }
+
+        /**
+         * Estimated bytes held by this state. Sources shared with the state it was cloned from are
+         * only included if includeSharedSources is true.
+         */
+        size_t getFootprintBytes(bool includeSharedSources) const {
+            size_t numBytes {sizeof(ModulationSourcesState)};
+
+            numBytes += _getFootprintBytes(lfos, sizeof(CloneableLFO), includeSharedSources);
+            numBytes += _getFootprintBytes(envelopes, sizeof(EnvelopeWrapper) + sizeof(CloneableEnvelopeFollower), includeSharedSources);
+            numBytes += _getFootprintBytes(randomSources, sizeof(WECore::Perlin::PerlinSource), includeSharedSources);
+            numBytes += _getFootprintBytes(stepSequencers, sizeof(WECore::StepSeq::StepSequencer), includeSharedSources);
 
-            for (std::shared_ptr<EnvelopeWrapper> env : other.envelopes) {
-                envelopes.emplace_back(env->clone());
+            // The graph is never shared
+            for (const std::vector<double>& outputs : graph.outputs) {
+                numBytes += outputs.capacity() * sizeof(double);
             }
 
-            for (std::shared_ptr<WECore::Perlin::PerlinSource> source : other.randomSources) {
-                randomSources.emplace_back(source->clone());
+            numBytes += static_cast<size_t>(graph.mixdownBuffer.getNumChannels()) * graph.mixdownBuffer.getNumSamples() * sizeof(float);
+
+            return numBytes;
+        }
+
+    private:
+        // Sources inherited from the state this was cloned from that haven't been copied yet. Weak
+        // so a source that has since been deleted can't be mistaken for a new one at the same address.
+        std::set<std::weak_ptr<void>, std::owner_less<>> _sharedSources;
+
+        ModulationSourcesState(const ModulationSourcesState& other) : lfos(other.lfos),
+                                                                      envelopes(other.envelopes),
+                                                                      randomSources(other.randomSources),
+                                                                      stepSequencers(other.stepSequencers),
+                                                                      hostConfig(other.hostConfig),
+                                                                      getModulationValueCallback(other.getModulationValueCallback) {
+            _sharedSources.insert(lfos.begin(), lfos.end());
+            _sharedSources.insert(envelopes.begin(), envelopes.end());
+            _sharedSources.insert(randomSources.begin(), randomSources.end());
+            _sharedSources.insert(stepSequencers.begin(), stepSequencers.end());
+        }
+
+        template <typename T>
+        std::shared_ptr<T> _getForWrite(std::vector<std::shared_ptr<T>>& sources, size_t index) {
+            std::shared_ptr<T>& source = sources[index];
+
+            const auto sharedItr = _sharedSources.find(source);
+            if (sharedItr != _sharedSources.end()) {
+                _sharedSources.erase(sharedItr);
+                source.reset(source->clone());
             }
 
-            for (std::shared_ptr<WECore::StepSeq::StepSequencer> seq : other.stepSequencers) {
-                stepSequencers.emplace_back(seq->clone());
+            return source;
+        }
+
+        template <typename T>
+        size_t _getFootprintBytes(const std::vector<std::shared_ptr<T>>& sources, size_t sourceBytes, bool includeSharedSources) const {
+            size_t numBytes {sources.capacity() * sizeof(std::shared_ptr<T>)};
+
+            for (const std::shared_ptr<T>& source : sources) {
+                if (includeSharedSources || !isShared(source)) {
+                    numBytes += sourceBytes;
+                }
             }
+
+            return numBytes;
         }
     };
 
@@ -101,18 +278,44 @@ namespace ModelInterface {
         // String representation of the operation that was performed to get to this state
         juce::String operation;
 
+        // Estimated bytes held by this state that aren't shared with the state before it in the
+        // undo history, set when the state is added to the history
+        size_t footprintBytes;
+
         StateWrapper(HostConfiguration config,
                      std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                      std::function<void(int)> latencyChangeCallback) :
                 splitterState(new SplitterState(config, getModulationValueCallback, latencyChangeCallback)),
                 modulationSourcesState(new ModulationSourcesState(getModulationValueCallback)),
-                operation("") { }
+                operation(""),
+                footprintBytes(0) { }
 
         StateWrapper(std::shared_ptr<SplitterState> newSplitterState,
                      std::shared_ptr<ModulationSourcesState> newModulationSourcesState,
                      juce::String newOperation) : splitterState(newSplitterState),
                                                   modulationSourcesState(newModulationSourcesState),
-                                                  operation(newOperation) { }
+                                                  operation(newOperation),
+                                                  footprintBytes(0) { }
+
+        /**
+         * Estimates the bytes held by this state that aren't shared with previousState, which this
+         * state was created from. If previousState is nullptr the whole state is included.
+         */
+        size_t calculateFootprintBytes(const StateWrapper* previousState) const {
+            size_t numBytes {sizeof(StateWrapper) + operation.getNumBytesAsUTF8()};
+
+            if (previousState == nullptr) {
+                numBytes += splitterState->getFootprintBytes(nullptr);
+            } else if (splitterState != previousState->splitterState) {
+                numBytes += splitterState->getFootprintBytes(previousState->splitterState.get());
+            }
+
+            if (previousState == nullptr || modulationSourcesState != previousState->modulationSourcesState) {
+                numBytes += modulationSourcesState->getFootprintBytes(previousState == nullptr);
+            }
+
+            return numBytes;
+        }
     };
 
     struct StateManager {
@@ -128,19 +331,303 @@ namespace ModelInterface {
         std::recursive_mutex mutatorsMutex;
 
         // This mutex must be locked by mutators which change the structure of the data model, and
-        // also by the processors. Its purpose is to stop a mutator being called on one thread from
-        // changing the data model in a way that would crash a processor being called on another
-        // thread.
+        // also by prepareToPlay, reset and releaseResources which modify the current state in place.
+        // It is never taken by the audio thread, which reads publishedState instead.
         //
         // Mutators reading from the data model or writing only primitive values don't need to lock
         // this
         WECore::AudioSpinMutex sharedMutex;
 
+        // The state the audio thread should process. Mutators never change a published state,
+        // instead they change a clone and publish that, either as a new state in the history or in
+        // place of the current one when continuing the same change.
+        std::atomic<StateWrapper*> publishedState;
+
+        // The state the audio thread is currently processing, or nullptr between blocks. A retired
+        // state can't be deleted while the audio thread is using it.
+        std::atomic<StateWrapper*> stateInUse;
+
+        // States which have been removed from the history but may still be in use by the audio
+        // thread. Only accessed with mutatorsMutex held, and deleted on the mutator's thread.
+        std::vector<std::shared_ptr<StateWrapper>> retiredStates;
+
+        // Number of blocks the audio thread has passed through without processing
+        std::atomic<juce::uint64> numSkippedBlocks;
+
+        // Used to process independent chains concurrently, nullptr if multi-core processing is
+        // disabled. Not part of the undo history as it doesn't hold any model state.
+        std::unique_ptr<ChainWorkerPool> workerPool;
+        std::atomic<ChainWorkerPool*> publishedWorkerPool;
+
+        // As stateInUse and retiredStates, but for the worker pool
+        std::atomic<ChainWorkerPool*> workerPoolInUse;
+        std::vector<std::unique_ptr<ChainWorkerPool>> retiredWorkerPools;
+
+        // Number of samples between plugin parameter modulation updates, 0 to update once per block
+        std::atomic<int> modulationControlRate;
+
+        // Plugins are only put to sleep while their input is silent if this is enabled
+        std::atomic<bool> isSleepingEnabled;
+
+        // The longest delay the latency compensation of a chain can add, applied when the graph is
+        // next prepared
+        std::atomic<int> maxLatencyCompensationSamples;
+
+        // Buffers the processors borrow while processing a block. Sized for the worst case of
+        // whichever state is published, so it's never resized by the audio thread.
+        ScratchArena scratchArena;
+
+        // Used to split blocks bigger than the arena's block size into sub-blocks, so the MIDI for
+        // each can be offset without allocating
+        juce::MidiBuffer subBlockMidiBuffer;
+        juce::MidiBuffer subBlockOutputMidiBuffer;
+
+        // Analyses the input of multiband splits for the crossover visualiser. Not part of the undo
+        // history so the analysis carries on uninterrupted while the user edits.
+        FFTProvider fftProvider;
+
+        // Values the audio thread publishes once per block for the UI to read without locking
+        UITelemetry telemetry;
+
+        // A second, fully prepared state that can be switched to without loading anything. It isn't
+        // part of the undo history and is only processed while it's being faded in or out. Only
+        // changed with both mutatorsMutex and sharedMutex held.
+        std::shared_ptr<StateWrapper> standbyState;
+
+        // Both graphs are delayed to the higher of this and the current splitter's latency, so they
+        // stay aligned and switching doesn't change the latency reported to the host
+        std::atomic<int> standbyLatencySamples;
+
+        // The state being faded out after switching to the standby. The audio thread processes it
+        // alongside the published state until the crossfade finishes, then clears it. Retired states
+        // aren't deleted while this or fadingStateInUse point to them.
+        std::atomic<StateWrapper*> fadingState;
+        std::atomic<StateWrapper*> fadingStateInUse;
+        std::atomic<int> crossfadeLengthSamples;
+
+        // Set by the audio thread while it processes the fading state, so its plugins read
+        // modulation values from its own sources
+        std::atomic<bool> isProcessingFadingState;
+
+        // Only used by the audio thread, apart from being prepared
+        GraphCrossfader crossfader;
+        StateWrapper* crossfaderState;
+
+        // The oldest undo states are dropped once the history holds more than this, though the
+        // current state and the one before it are always kept
+        static constexpr size_t DEFAULT_UNDO_HISTORY_BUDGET_BYTES {64 * 1024 * 1024};
+        static constexpr size_t MIN_UNDO_HISTORY_SIZE {2};
+
+        // The footprints are only estimates, so the number of states is also limited in case
+        // they're badly wrong
+        static constexpr size_t MAX_UNDO_HISTORY_SIZE {200};
+        size_t undoHistoryBudgetBytes;
 
         StateManager(HostConfiguration config,
                      std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
-                     std::function<void(int)> latencyChangeCallback) {
+                     std::function<void(int)> latencyChangeCallback) : publishedState(nullptr),
+                                                                       stateInUse(nullptr),
+                                                                       numSkippedBlocks(0),
+                                                                       publishedWorkerPool(nullptr),
+                                                                       workerPoolInUse(nullptr),
+                                                                       modulationControlRate(0),
+                                                                       isSleepingEnabled(false),
+                                                                       maxLatencyCompensationSamples(config.maxLatencyCompensationSamples),
+                                                                       standbyLatencySamples(0),
+                                                                       fadingState(nullptr),
+                                                                       fadingStateInUse(nullptr),
+                                                                       crossfadeLengthSamples(0),
+                                                                       isProcessingFadingState(false),
+                                                                       crossfaderState(nullptr),
+                                                                       undoHistoryBudgetBytes(DEFAULT_UNDO_HISTORY_BUDGET_BYTES) {
             undoHistory.push_back(std::make_shared<StateWrapper>(config, getModulationValueCallback, latencyChangeCallback));
+            undoHistory.back()->footprintBytes = undoHistory.back()->calculateFootprintBytes(nullptr);
+
+            scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(config.layout),
+                                 config.blockSize,
+                                 std::max(SplitterProcessors::getNumScratchBuffersRequired(*undoHistory.back()->splitterState->splitter), ScratchArena::DEFAULT_NUM_BUFFERS));
+
+            fftProvider.setSampleRate(config.sampleRate);
+            fftProvider.setIsStereo(canDoStereoSplitTypes(config.layout));
+
+            crossfader.prepare(getTotalNumInputChannels(config.layout), config.blockSize, config.maxLatencyCompensationSamples);
+
+            subBlockMidiBuffer.ensureSize(ScratchArena::MIDI_BUFFER_RESERVED_BYTES);
+            subBlockOutputMidiBuffer.ensureSize(ScratchArena::MIDI_BUFFER_RESERVED_BYTES);
+
+            publishCurrentState();
+        }
+
+        /**
+         * Makes undoHistory.back() visible to the audio thread, and deletes any retired states it's
+         * no longer using. Must be called with mutatorsMutex held whenever undoHistory.back()
+         * changes.
+         */
+        void publishCurrentState() {
+            // The previous state hasn't been reclaimed yet, it's still in the history or retired
+            StateWrapper* previousState {publishedState.load(std::memory_order_seq_cst)};
+            if (previousState != nullptr && previousState->splitterState->splitter != nullptr) {
+                previousState->splitterState->splitter->onUnpublished();
+            }
+
+            if (undoHistory.back()->splitterState->splitter != nullptr) {
+                undoHistory.back()->splitterState->splitter->onPublished();
+            }
+
+            publishedState.store(undoHistory.back().get(), std::memory_order_seq_cst);
+            reclaimRetiredStates();
+        }
+
+        /**
+         * Keeps a state that has been removed from the history alive until the audio thread has
+         * finished with it.
+         */
+        void retireState(std::shared_ptr<StateWrapper> state) {
+            retiredStates.push_back(state);
+        }
+
+        /**
+         * Deletes the retired states that aren't currently being processed or faded out, and the
+         * retired worker pools the audio thread is no longer using.
+         */
+        void reclaimRetiredStates() {
+            const StateWrapper* inUse {stateInUse.load(std::memory_order_seq_cst)};
+            const StateWrapper* fading {fadingState.load(std::memory_order_seq_cst)};
+            const StateWrapper* fadingInUse {fadingStateInUse.load(std::memory_order_seq_cst)};
+
+            retiredStates.erase(
+                std::remove_if(retiredStates.begin(), retiredStates.end(),
+                               [inUse, fading, fadingInUse](const std::shared_ptr<StateWrapper>& state) {
+                                   return state.get() != inUse && state.get() != fading && state.get() != fadingInUse;
+                               }),
+                retiredStates.end());
+
+            const ChainWorkerPool* poolInUse {workerPoolInUse.load(std::memory_order_seq_cst)};
+
+            retiredWorkerPools.erase(
+                std::remove_if(retiredWorkerPools.begin(), retiredWorkerPools.end(),
+                               [poolInUse](const std::unique_ptr<ChainWorkerPool>& pool) {
+                                   return pool.get() != poolInUse;
+                               }),
+                retiredWorkerPools.end());
+        }
+
+        /**
+         * Estimated bytes held by the undo history, see StateWrapper::footprintBytes.
+         */
+        size_t getUndoHistoryFootprintBytes() const {
+            size_t numBytes {0};
+
+            for (const std::shared_ptr<StateWrapper>& state : undoHistory) {
+                numBytes += state->footprintBytes;
+            }
+
+            return numBytes;
+        }
+
+        /**
+         * Retires the oldest undo states until the history fits within undoHistoryBudgetBytes and
+         * MAX_UNDO_HISTORY_SIZE. Must be called with mutatorsMutex held.
+         */
+        void trimUndoHistory() {
+            size_t numBytes {getUndoHistoryFootprintBytes()};
+
+            while (undoHistory.size() > MIN_UNDO_HISTORY_SIZE
+                   && (numBytes > undoHistoryBudgetBytes || undoHistory.size() > MAX_UNDO_HISTORY_SIZE)) {
+                numBytes -= undoHistory.front()->footprintBytes;
+                retireState(undoHistory.front());
+                undoHistory.pop_front();
+
+                // The new oldest state now holds everything it was sharing with the one removed
+                StateWrapper& oldestState = *undoHistory.front();
+                numBytes -= oldestState.footprintBytes;
+                oldestState.footprintBytes = oldestState.calculateFootprintBytes(nullptr);
+                numBytes += oldestState.footprintBytes;
+            }
+        }
+
+        /**
+         * Called by the audio thread at the start of a block. The returned state is guaranteed to
+         * stay alive until releaseStateForProcessing() is called.
+         */
+        StateWrapper* acquireStateForProcessing() {
+            StateWrapper* state {publishedState.load(std::memory_order_seq_cst)};
+
+            while (true) {
+                stateInUse.store(state, std::memory_order_seq_cst);
+
+                // Check a new state wasn't published (and the old one reclaimed) before we marked it
+                // as in use
+                StateWrapper* latestState {publishedState.load(std::memory_order_seq_cst)};
+                if (latestState == state) {
+                    return state;
+                }
+
+                state = latestState;
+            }
+        }
+
+        void releaseStateForProcessing() {
+            stateInUse.store(nullptr, std::memory_order_seq_cst);
+        }
+
+        /**
+         * As acquireStateForProcessing() for the state being faded out, returns nullptr if there
+         * isn't one.
+         */
+        StateWrapper* acquireFadingStateForProcessing() {
+            StateWrapper* state {fadingState.load(std::memory_order_seq_cst)};
+
+            while (true) {
+                fadingStateInUse.store(state, std::memory_order_seq_cst);
+
+                StateWrapper* latestState {fadingState.load(std::memory_order_seq_cst)};
+                if (latestState == state) {
+                    return state;
+                }
+
+                state = latestState;
+            }
+        }
+
+        void releaseFadingStateForProcessing() {
+            fadingStateInUse.store(nullptr, std::memory_order_seq_cst);
+        }
+
+        /**
+         * As acquireStateForProcessing() for the worker pool, returns nullptr if multi-core
+         * processing is disabled.
+         */
+        ChainWorkerPool* acquireWorkerPoolForProcessing() {
+            ChainWorkerPool* pool {publishedWorkerPool.load(std::memory_order_seq_cst)};
+
+            while (true) {
+                workerPoolInUse.store(pool, std::memory_order_seq_cst);
+
+                ChainWorkerPool* latestPool {publishedWorkerPool.load(std::memory_order_seq_cst)};
+                if (latestPool == pool) {
+                    return pool;
+                }
+
+                pool = latestPool;
+            }
+        }
+
+        void releaseWorkerPoolForProcessing() {
+            workerPoolInUse.store(nullptr, std::memory_order_seq_cst);
+        }
+
+        /**
+         * Returns the state being processed if called from the audio thread during a block, or the
+         * published state otherwise.
+         */
+        StateWrapper* getProcessingStateUnsafe() {
+            if (isProcessingFadingState.load(std::memory_order_acquire)) {
+                return fadingStateInUse.load(std::memory_order_acquire);
+            }
+
+            StateWrapper* state {stateInUse.load(std::memory_order_acquire)};
+            return state != nullptr ? state : publishedState.load(std::memory_order_acquire);
         }
 
         // TODO remove this once all functions are migrated
@@ -0,0 +1,557 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+
+#include "DataModelInterface.hpp"
+#include "MutatorsInterface.hpp"
+#include "ProcessingInterface.hpp"
+#include "SplitterMutators.hpp"
+
+namespace {
+    class FadeTestPluginInstance : public TestUtils::TestPluginInstance {
+    public:
+        int numBlocksProcessed {0};
+        std::function<void()> onProcess;
+
+        void processBlock(juce::AudioBuffer<float>& /*buffer*/, juce::MidiBuffer& /*midiMessages*/) override {
+            numBlocksProcessed++;
+
+            if (onProcess) {
+                onProcess();
+            }
+        }
+    };
+
+    class BlockSizeTestPluginInstance : public TestUtils::TestPluginInstance {
+    public:
+        int numSamplesProcessed {0};
+        int maxBlockSize {0};
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/) override {
+            numSamplesProcessed += buffer.getNumSamples();
+            maxBlockSize = std::max(maxBlockSize, buffer.getNumSamples());
+        }
+    };
+}
+
+SCENARIO("DataModelInterface: Retired states stay alive while the audio thread is using them") {
+    GIVEN("A state manager with its initial state published") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        std::weak_ptr<ModelInterface::StateWrapper> initialState = manager.undoHistory.back();
+
+        REQUIRE(manager.publishedState.load() == manager.undoHistory.back().get());
+
+        WHEN("The audio thread acquires the state and a new one is published") {
+            ModelInterface::StateWrapper* acquiredState = manager.acquireStateForProcessing();
+
+            auto newState = std::make_shared<ModelInterface::StateWrapper>(
+                manager.undoHistory.back()->splitterState, manager.undoHistory.back()->modulationSourcesState, "test");
+            manager.retireState(manager.undoHistory.back());
+            manager.undoHistory.back() = newState;
+            manager.publishCurrentState();
+
+            THEN("The new state is published but the acquired one isn't deleted") {
+                CHECK(manager.publishedState.load() == newState.get());
+                CHECK(acquiredState == initialState.lock().get());
+                CHECK(manager.getProcessingStateUnsafe() == acquiredState);
+                CHECK(manager.retiredStates.size() == 1);
+            }
+
+            AND_WHEN("The audio thread releases the state") {
+                manager.releaseStateForProcessing();
+                manager.reclaimRetiredStates();
+
+                THEN("The retired state is deleted and the next block gets the new state") {
+                    CHECK(initialState.expired());
+                    CHECK(manager.retiredStates.size() == 0);
+                    CHECK(manager.acquireStateForProcessing() == newState.get());
+                    manager.releaseStateForProcessing();
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Retired worker pools stay alive while the audio thread is using them") {
+    GIVEN("A state manager with a worker pool") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        manager.workerPool = std::make_unique<ChainWorkerPool>(1);
+        manager.publishedWorkerPool.store(manager.workerPool.get());
+
+        WHEN("The audio thread acquires the pool and multi-core processing is disabled") {
+            ChainWorkerPool* acquiredPool = manager.acquireWorkerPoolForProcessing();
+            ModelInterface::setMultiCoreProcessingEnabled(manager, false);
+
+            THEN("The pool is unpublished but not deleted") {
+                CHECK(manager.workerPool == nullptr);
+                CHECK(manager.publishedWorkerPool.load() == nullptr);
+                REQUIRE(manager.retiredWorkerPools.size() == 1);
+                CHECK(manager.retiredWorkerPools[0].get() == acquiredPool);
+            }
+
+            AND_WHEN("The audio thread releases the pool") {
+                manager.releaseWorkerPoolForProcessing();
+                manager.reclaimRetiredStates();
+
+                THEN("The retired pool is deleted and the next block doesn't get a pool") {
+                    CHECK(manager.retiredWorkerPools.size() == 0);
+                    CHECK(manager.acquireWorkerPoolForProcessing() == nullptr);
+                    manager.releaseWorkerPoolForProcessing();
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Cloned modulation sources are only copied when written to") {
+    GIVEN("A sources state with two LFOs and an envelope") {
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        ModelInterface::ModulationSourcesState state(modulationCallback);
+        state.lfos.push_back(std::make_shared<ModelInterface::CloneableLFO>());
+        state.lfos.push_back(std::make_shared<ModelInterface::CloneableLFO>());
+        state.envelopes.push_back(std::make_shared<ModelInterface::EnvelopeWrapper>());
+        state.lfos[0]->setFreq(2);
+
+        WHEN("It is cloned") {
+            std::unique_ptr<ModelInterface::ModulationSourcesState> clonedState(state.clone());
+
+            THEN("The sources are shared with the original") {
+                CHECK(clonedState->lfos[0] == state.lfos[0]);
+                CHECK(clonedState->lfos[1] == state.lfos[1]);
+                CHECK(clonedState->envelopes[0] == state.envelopes[0]);
+                CHECK(clonedState->isShared(clonedState->lfos[0]));
+                CHECK_FALSE(state.isShared(state.lfos[0]));
+            }
+
+            AND_WHEN("One LFO is written to") {
+                clonedState->getLfoForWrite(0)->setFreq(5);
+
+                THEN("Only that LFO is copied and the original is unchanged") {
+                    CHECK(clonedState->lfos[0] != state.lfos[0]);
+                    CHECK_FALSE(clonedState->isShared(clonedState->lfos[0]));
+                    CHECK(clonedState->lfos[0]->getFreq() == 5);
+                    CHECK(state.lfos[0]->getFreq() == 2);
+
+                    CHECK(clonedState->lfos[1] == state.lfos[1]);
+                    CHECK(clonedState->envelopes[0] == state.envelopes[0]);
+                }
+
+                AND_WHEN("It is written to again") {
+                    std::shared_ptr<ModelInterface::CloneableLFO> copiedLfo = clonedState->lfos[0];
+                    clonedState->getLfoForWrite(0)->setFreq(6);
+
+                    THEN("It isn't copied again") {
+                        CHECK(clonedState->lfos[0] == copiedLfo);
+                        CHECK(copiedLfo->getFreq() == 6);
+                    }
+                }
+
+                AND_THEN("Only the copied LFO is included in the clone's footprint") {
+                    const size_t unsharedBytes {clonedState->getFootprintBytes(false)};
+                    const size_t totalBytes {clonedState->getFootprintBytes(true)};
+
+                    CHECK(unsharedBytes < state.getFootprintBytes(false));
+                    CHECK(totalBytes - unsharedBytes == sizeof(ModelInterface::CloneableLFO) + sizeof(ModelInterface::EnvelopeWrapper) + sizeof(ModelInterface::CloneableEnvelopeFollower));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: The undo history is limited by its footprint") {
+    GIVEN("A state manager with several states in its history") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        const size_t initialBytes {manager.undoHistory.back()->footprintBytes};
+        REQUIRE(initialBytes == manager.undoHistory.back()->calculateFootprintBytes(nullptr));
+
+        // Each new state shares everything with the initial one
+        constexpr int NUM_STATES {10};
+        for (int index {0}; index < NUM_STATES; index++) {
+            auto state = std::make_shared<ModelInterface::StateWrapper>(
+                manager.undoHistory.back()->splitterState, manager.undoHistory.back()->modulationSourcesState, "test");
+            state->footprintBytes = state->calculateFootprintBytes(manager.undoHistory.back().get());
+            manager.undoHistory.push_back(state);
+        }
+
+        const size_t sharedStateBytes {manager.undoHistory.back()->footprintBytes};
+
+        THEN("States sharing everything with the one before them are much smaller than a whole state") {
+            CHECK(sharedStateBytes < initialBytes);
+            CHECK(manager.getUndoHistoryFootprintBytes() == initialBytes + NUM_STATES * sharedStateBytes);
+        }
+
+        WHEN("The history is within the budget") {
+            manager.trimUndoHistory();
+
+            THEN("Nothing is removed") {
+                CHECK(manager.undoHistory.size() == NUM_STATES + 1);
+            }
+        }
+
+        WHEN("The budget is reduced below the footprint of the history") {
+            manager.undoHistoryBudgetBytes = initialBytes + 2 * sharedStateBytes;
+            manager.trimUndoHistory();
+
+            THEN("The oldest states are removed until it fits") {
+                CHECK(manager.getUndoHistoryFootprintBytes() <= manager.undoHistoryBudgetBytes);
+                CHECK(manager.undoHistory.size() < NUM_STATES + 1);
+                CHECK(manager.undoHistory.size() >= ModelInterface::StateManager::MIN_UNDO_HISTORY_SIZE);
+            }
+
+            AND_THEN("The oldest remaining state holds the whole state") {
+                CHECK(manager.undoHistory.front()->footprintBytes == manager.undoHistory.front()->calculateFootprintBytes(nullptr));
+            }
+        }
+
+        WHEN("The budget is smaller than a single state") {
+            manager.undoHistoryBudgetBytes = 1;
+            manager.trimUndoHistory();
+
+            THEN("The minimum number of states is kept") {
+                CHECK(manager.undoHistory.size() == ModelInterface::StateManager::MIN_UNDO_HISTORY_SIZE);
+            }
+        }
+
+        WHEN("The history has more states than the maximum but is within the budget") {
+            while (manager.undoHistory.size() < ModelInterface::StateManager::MAX_UNDO_HISTORY_SIZE + 5) {
+                auto state = std::make_shared<ModelInterface::StateWrapper>(
+                    manager.undoHistory.back()->splitterState, manager.undoHistory.back()->modulationSourcesState, "test");
+                state->footprintBytes = state->calculateFootprintBytes(manager.undoHistory.back().get());
+                manager.undoHistory.push_back(state);
+            }
+
+            REQUIRE(manager.getUndoHistoryFootprintBytes() <= manager.undoHistoryBudgetBytes);
+            manager.trimUndoHistory();
+
+            THEN("The oldest states are removed until it's at the maximum") {
+                CHECK(manager.undoHistory.size() == ModelInterface::StateManager::MAX_UNDO_HISTORY_SIZE);
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Audio shared between cloned splitter states is only counted once") {
+    GIVEN("A splitter state") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::SplitterState state(config, modulationCallback, latencyCallback);
+        const PluginChain& chain = *state.splitter->chains[0].chain;
+        REQUIRE(chain.latencyCompLine->getRingSizeBytes() > 0);
+
+        const size_t sharedBytes {chain.latencyCompLine->getRingSizeBytes() + chain.pipeline->getInFlightSizeBytes()};
+
+        WHEN("It is cloned") {
+            std::unique_ptr<ModelInterface::SplitterState> clonedState(state.clone());
+
+            THEN("The chain it shares isn't in the clone's footprint") {
+                CHECK(clonedState->getFootprintBytes(&state) + sharedBytes < clonedState->getFootprintBytes(nullptr));
+            }
+        }
+
+        WHEN("It is cloned and the chain is copied") {
+            std::unique_ptr<ModelInterface::SplitterState> clonedState(state.clone());
+            clonedState->splitter->getChainForWrite(0);
+
+            THEN("The latency compensation and pipeline audio it shares aren't in the clone's footprint") {
+                CHECK(clonedState->getFootprintBytes(&state) + sharedBytes == clonedState->getFootprintBytes(nullptr));
+            }
+
+            AND_WHEN("The clone is prepared again") {
+                SplitterProcessors::prepareToPlay(*clonedState->splitter, config.sampleRate, config.blockSize, config.layout);
+
+                THEN("It has its own audio, which is included in its footprint") {
+                    CHECK(clonedState->getFootprintBytes(&state) == clonedState->getFootprintBytes(nullptr));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Switching to the standby fades the previous state out") {
+    GIVEN("A state manager with a plugin in its current state and another in its standby") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        auto currentPlugin = std::make_shared<FadeTestPluginInstance>();
+        SplitterMutators::insertPlugin(manager.getSplitterStateUnsafe().splitter, currentPlugin, 0, 0);
+
+        auto standby = std::make_shared<ModelInterface::StateWrapper>(config, modulationCallback, latencyCallback);
+        auto standbyPlugin = std::make_shared<FadeTestPluginInstance>();
+        SplitterMutators::insertPlugin(standby->splitterState->splitter, standbyPlugin, 0, 0);
+
+        ModelInterface::setStandby(manager, standby);
+        ModelInterface::prepareToPlay(manager, config.sampleRate, config.blockSize, config.layout);
+
+        juce::AudioBuffer<float> buffer(2, config.blockSize);
+        juce::MidiBuffer midiBuffer;
+
+        auto processBlock = [&]() {
+            for (int channel {0}; channel < buffer.getNumChannels(); channel++) {
+                juce::FloatVectorOperations::fill(buffer.getWritePointer(channel), 1, buffer.getNumSamples());
+            }
+
+            ModelInterface::processBlock(manager, buffer, midiBuffer, nullptr, juce::AudioPlayHead::CurrentPositionInfo());
+        };
+
+        std::weak_ptr<ModelInterface::StateWrapper> outgoingState = manager.undoHistory.back();
+
+        WHEN("It switches to the standby with a crossfade two blocks long") {
+            REQUIRE(ModelInterface::switchToStandby(manager, 2 * config.blockSize));
+
+            THEN("The standby is published and the previous state is fading out and on standby") {
+                CHECK(manager.publishedState.load()->splitterState == standby->splitterState);
+                CHECK(manager.fadingState.load() == outgoingState.lock().get());
+                CHECK(manager.standbyState == outgoingState.lock());
+            }
+
+            AND_WHEN("A block is processed") {
+                processBlock();
+
+                THEN("Both states are processed and the previous state is still fading out") {
+                    CHECK(standbyPlugin->numBlocksProcessed == 1);
+                    CHECK(currentPlugin->numBlocksProcessed == 1);
+                    CHECK(manager.fadingState.load() == outgoingState.lock().get());
+                    CHECK(manager.fadingStateInUse.load() == nullptr);
+                }
+
+                AND_WHEN("The crossfade finishes") {
+                    processBlock();
+
+                    THEN("The previous state is no longer faded out and isn't processed") {
+                        CHECK(manager.fadingState.load() == nullptr);
+                        CHECK(currentPlugin->numBlocksProcessed == 2);
+
+                        processBlock();
+                        CHECK(standbyPlugin->numBlocksProcessed == 3);
+                        CHECK(currentPlugin->numBlocksProcessed == 2);
+                    }
+                }
+            }
+        }
+
+        WHEN("The current state is edited and it switches to the standby") {
+            REQUIRE(ModelInterface::setChainCustomName(manager, 0, "Edited"));
+            REQUIRE(ModelInterface::switchToStandby(manager, 2 * config.blockSize));
+
+            THEN("The undo history is kept") {
+                CHECK(manager.undoHistory.size() == 2);
+                CHECK(ModelInterface::isFadingToStandby(manager));
+            }
+
+            AND_WHEN("It undoes while the previous state is fading out") {
+                ModelInterface::undo(manager, config.sampleRate, config.blockSize, config.layout);
+
+                THEN("Nothing is undone") {
+                    CHECK(manager.undoHistory.size() == 2);
+                    CHECK(manager.redoHistory.empty());
+                    CHECK(manager.publishedState.load()->splitterState == standby->splitterState);
+                }
+            }
+
+            AND_WHEN("It undoes once the crossfade has finished, then switches to the standby again") {
+                processBlock();
+                processBlock();
+                REQUIRE_FALSE(ModelInterface::isFadingToStandby(manager));
+
+                ModelInterface::undo(manager, config.sampleRate, config.blockSize, config.layout);
+                REQUIRE(manager.redoHistory.size() == 1);
+
+                const int numCurrentBlocks {currentPlugin->numBlocksProcessed};
+                REQUIRE(ModelInterface::switchToStandby(manager, 2 * config.blockSize));
+                processBlock();
+
+                THEN("The states share the plugin so they're switched without a crossfade") {
+                    CHECK(manager.fadingState.load() == nullptr);
+                    CHECK(currentPlugin->numBlocksProcessed == numCurrentBlocks + 1);
+                }
+            }
+        }
+
+        WHEN("It switches to the standby, then switches back while the audio thread is processing the state being faded out") {
+            REQUIRE(ModelInterface::switchToStandby(manager, config.blockSize));
+            ModelInterface::StateWrapper* firstFadingState {manager.fadingState.load()};
+
+            bool hasSwitchedBack {false};
+            bool wasAliveWhileProcessed {false};
+            currentPlugin->onProcess = [&]() {
+                // The plugin is in the state switched back to as well
+                if (hasSwitchedBack) {
+                    return;
+                }
+
+                hasSwitchedBack = true;
+                REQUIRE(manager.fadingStateInUse.load() == firstFadingState);
+                REQUIRE(ModelInterface::switchToStandby(manager, config.blockSize));
+
+                // Only held by the retired states now, which mustn't delete it while it's in use
+                CHECK(manager.fadingState.load() != firstFadingState);
+                CHECK(manager.standbyState.get() != firstFadingState);
+                wasAliveWhileProcessed = !outgoingState.expired();
+            };
+
+            processBlock();
+
+            THEN("The state being processed isn't deleted until the audio thread has finished with it") {
+                CHECK(wasAliveWhileProcessed);
+                CHECK(manager.fadingStateInUse.load() == nullptr);
+
+                manager.reclaimRetiredStates();
+                CHECK(outgoingState.expired());
+            }
+
+            AND_THEN("The end of the first crossfade doesn't clear the state the second is fading out") {
+                REQUIRE(manager.fadingState.load() != nullptr);
+                CHECK(manager.fadingState.load()->splitterState == standby->splitterState);
+                CHECK(manager.publishedState.load()->splitterState != standby->splitterState);
+            }
+
+            AND_WHEN("Another block is processed") {
+                const int numStandbyBlocks {standbyPlugin->numBlocksProcessed};
+                processBlock();
+
+                THEN("The second crossfade fades the standby out and finishes") {
+                    CHECK(standbyPlugin->numBlocksProcessed == numStandbyBlocks + 1);
+                    CHECK(currentPlugin->numBlocksProcessed == 2);
+                    CHECK(manager.fadingState.load() == nullptr);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Blocks bigger than the prepared size are processed in sub-blocks") {
+    GIVEN("A state manager prepared for a block size of 10 with a plugin in its current state") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        auto plugin = std::make_shared<BlockSizeTestPluginInstance>();
+        SplitterMutators::insertPlugin(manager.getSplitterStateUnsafe().splitter, plugin, 0, 0);
+        ModelInterface::prepareToPlay(manager, config.sampleRate, config.blockSize, config.layout);
+
+        WHEN("The host processes a block of 25 samples") {
+            juce::AudioBuffer<float> buffer(2, 25);
+            buffer.clear();
+            juce::MidiBuffer midiBuffer;
+
+            ModelInterface::processBlock(manager, buffer, midiBuffer, nullptr, juce::AudioPlayHead::CurrentPositionInfo());
+
+            THEN("Every sample is processed in blocks no bigger than the prepared size") {
+                CHECK(plugin->numSamplesProcessed == 25);
+                CHECK(plugin->maxBlockSize == config.blockSize);
+                CHECK(ModelInterface::getNumSkippedBlocks(manager) == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("DataModelInterface: Continuing a parameter change replaces the published state") {
+    GIVEN("A state manager with a gain stage") {
+        HostConfiguration config;
+        config.sampleRate = 44100;
+        config.blockSize = 10;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        ModelInterface::StateManager manager(config, modulationCallback, latencyCallback);
+        SplitterMutators::insertGainStage(manager.getSplitterStateUnsafe().splitter, 0, 0);
+        ModelInterface::prepareToPlay(manager, config.sampleRate, config.blockSize, config.layout);
+
+        WHEN("The gain is changed twice in a row") {
+            REQUIRE(ModelInterface::setGainLinear(manager, 0, 0, 0.5f));
+            const size_t numStates {manager.undoHistory.size()};
+            std::shared_ptr<ModelInterface::StateWrapper> firstState = manager.undoHistory.back();
+
+            REQUIRE(ModelInterface::setGainLinear(manager, 0, 0, 0.25f));
+
+            THEN("The second change replaces the first state rather than changing it") {
+                CHECK(manager.undoHistory.size() == numStates);
+                CHECK(manager.undoHistory.back() != firstState);
+                CHECK(manager.publishedState.load() == manager.undoHistory.back().get());
+
+                CHECK(std::get<0>(ModelInterface::getGainLinearAndPan(manager, 0, 0)) == Approx(0.25));
+                CHECK(SplitterMutators::getGainLinear(firstState->splitterState->splitter, 0, 0) == Approx(0.5));
+            }
+        }
+    }
+}
@@ -1,14 +1,18 @@
 #include "FFTProvider.hpp"
 
-FFTProvider::FFTProvider() : _inputBuffer(new float[FFT_SIZE]),
-                             _fftBuffer(new float[FFT_SIZE]),
-                             _outputs(new float[NUM_OUTPUTS]),
-                             _fft(FFT_ORDER),
+FFTProvider::FFTProvider() : _fifo(RING_SIZE),
+                             _numVisualisers(0),
                              _isStereo(false),
-                             _binWidth(0) {
-    juce::FloatVectorOperations::fill(_inputBuffer, 0, FFT_SIZE);
-    juce::FloatVectorOperations::fill(_fftBuffer, 0, FFT_SIZE);
-    juce::FloatVectorOperations::fill(_outputs, 0, NUM_OUTPUTS);
+                             _sampleRate(0),
+                             _binWidth(0),
+                             _shouldReset(false),
+                             _fft(FFT_ORDER),
+                             _envSampleRate(0),
+                             _numSamplesSinceEnvelopeStep(0) {
+    _ring.fill(0);
+    _window.fill(0);
+    _fftBuffer.fill(0);
+    _outputs.fill(0);
 
     for (auto& env : _envs) {
         env.setAttackTimeMs(0.1);
@@ -17,67 +21,118 @@ FFTProvider::FFTProvider() : _inputBuffer(new float[FFT_SIZE]),
     }
 }
 
-FFTProvider::~FFTProvider() {
-    WECore::AudioSpinLock lock(_fftMutex);
-    delete[] _inputBuffer;
-    delete[] _fftBuffer;
-    delete[] _outputs;
+void FFTProvider::setSampleRate(double sampleRate) {
+    _sampleRate.store(sampleRate, std::memory_order_relaxed);
+    _binWidth.store((sampleRate / 2) / NUM_OUTPUTS, std::memory_order_relaxed);
 }
 
-void FFTProvider::setSampleRate(double sampleRate) {
-    _binWidth = (sampleRate / 2) / NUM_OUTPUTS;
+void FFTProvider::reset() {
+    _shouldReset.store(true, std::memory_order_release);
+}
 
-    for (auto& env : _envs) {
-        env.setSampleRate(sampleRate);
+void FFTProvider::pushSamples(const juce::AudioBuffer<float>& buffer) {
+    if (!isVisualiserAttached()) {
+        return;
     }
-}
 
-void FFTProvider::reset() {
-    for (auto& env : _envs) {
-        env.reset();
+    const bool isStereo {_isStereo.load(std::memory_order_relaxed) && buffer.getNumChannels() > 1};
+
+    // If the UI has fallen behind drop what doesn't fit, it only needs the most recent samples
+    int start1, size1, start2, size2;
+    _fifo.prepareToWrite(buffer.getNumSamples(), start1, size1, start2, size2);
+
+    auto writeSegment = [&](int ringStart, int bufferStart, int numSamples) {
+        float* const destination {_ring.data() + ringStart};
+
+        if (isStereo) {
+            // Add the left and right buffers
+            juce::FloatVectorOperations::add(destination, buffer.getReadPointer(0, bufferStart), buffer.getReadPointer(1, bufferStart), numSamples);
+            juce::FloatVectorOperations::multiply(destination, 0.5f, numSamples);
+        } else {
+            juce::FloatVectorOperations::copy(destination, buffer.getReadPointer(0, bufferStart), numSamples);
+        }
+    };
+
+    if (size1 > 0) {
+        writeSegment(start1, 0, size1);
+    }
+
+    if (size2 > 0) {
+        writeSegment(start2, size1, size2);
     }
+
+    _fifo.finishedWrite(size1 + size2);
 }
 
-void FFTProvider::processBlock(juce::AudioBuffer<float>& buffer) {
-    WECore::AudioSpinTryLock lock(_fftMutex);
-    if (lock.isLocked()) {
-        const size_t numBuffersRequired {static_cast<size_t>(
-            std::ceil(static_cast<double>(buffer.getNumSamples()) / FFT_SIZE)
-        )};
-
-        for (size_t bufferNumber {0}; bufferNumber < numBuffersRequired; bufferNumber++) {
-            // Calculate how many samples need to be processed in this chunk
-            const size_t numSamplesRemaining {buffer.getNumSamples() - (bufferNumber * FFT_SIZE)};
-            const size_t numSamplesToCopy {
-                std::min(numSamplesRemaining, static_cast<size_t>(FFT_SIZE))
-            };
-
-            // The input buffer size might be smaller than the FFT buffer size, so then we need to
-            // append the the existing FFT buffer by shifting it back and adding the new samples to
-            // the end
-            juce::FloatVectorOperations::copy(_inputBuffer, _inputBuffer + numSamplesToCopy, FFT_SIZE - numSamplesToCopy);
-
-            float* const fillStart {_inputBuffer + FFT_SIZE - numSamplesToCopy};
-            if (_isStereo) {
-                // Add the left and right buffers
-                const float* const leftBufferInputStart {buffer.getReadPointer(0) + bufferNumber * FFT_SIZE};
-                const float* const rightBufferInputStart {buffer.getReadPointer(1) + bufferNumber * FFT_SIZE};
-                juce::FloatVectorOperations::add(fillStart, leftBufferInputStart, rightBufferInputStart, numSamplesToCopy);
-                juce::FloatVectorOperations::multiply(fillStart, 0.5, numSamplesToCopy);
-            } else {
-                const float* const bufferInputStart {buffer.getReadPointer(0) + bufferNumber * FFT_SIZE};
-                juce::FloatVectorOperations::copy(fillStart, bufferInputStart, numSamplesToCopy);
-            }
+void FFTProvider::attachVisualiser() {
+    _numVisualisers++;
+}
 
-            // Perform the FFT
-            juce::FloatVectorOperations::copy(_fftBuffer, _inputBuffer, FFT_SIZE);
-            _fft.performFrequencyOnlyForwardTransform(_fftBuffer);
+void FFTProvider::detachVisualiser() {
+    _numVisualisers--;
+}
 
-            // Run each FFT output bin through an envelope follower so that it is smoothed when
-            // displayed on the UI
-            for (int index {0}; index < NUM_OUTPUTS; index++) {
+void FFTProvider::updateOutputs(std::array<float, NUM_OUTPUTS>& outputs) {
+    std::scoped_lock lock(_analysisMutex);
+
+    if (_shouldReset.exchange(false, std::memory_order_acquire)) {
+        for (auto& env : _envs) {
+            env.reset();
+        }
+
+        _window.fill(0);
+        _outputs.fill(0);
+        _numSamplesSinceEnvelopeStep = 0;
+    }
+
+    const double sampleRate {_sampleRate.load(std::memory_order_relaxed)};
+    if (sampleRate != _envSampleRate) {
+        for (auto& env : _envs) {
+            env.setSampleRate(sampleRate);
+        }
+
+        _envSampleRate = sampleRate;
+    }
+
+    const int numSamplesReady {_fifo.getNumReady()};
+
+    if (numSamplesReady > 0) {
+        // Only the most recent window of samples affects the FFT, skip the rest
+        const int numSamplesToSkip {std::max(numSamplesReady - FFT_SIZE, 0)};
+        _fifo.finishedRead(numSamplesToSkip);
+        _readFromRing(numSamplesReady - numSamplesToSkip);
+
+        // Perform the FFT
+        std::copy(_window.begin(), _window.end(), _fftBuffer.begin());
+        _fft.performFrequencyOnlyForwardTransform(_fftBuffer.data());
+
+        // Run each FFT output bin through an envelope follower so that it is smoothed when
+        // displayed on the UI. It's stepped for the amount of audio that has been analysed rather
+        // than once per update so the display rate doesn't change how quickly it responds.
+        _numSamplesSinceEnvelopeStep += numSamplesReady;
+        const int numEnvelopeSteps {std::max(_numSamplesSinceEnvelopeStep / ENVELOPE_STEP_SAMPLES, 1)};
+        _numSamplesSinceEnvelopeStep = std::max(_numSamplesSinceEnvelopeStep - numEnvelopeSteps * ENVELOPE_STEP_SAMPLES, 0);
+
+        for (int index {0}; index < NUM_OUTPUTS; index++) {
+            for (int step {0}; step < numEnvelopeSteps; step++) {
                 _outputs[index] = _envs[index].getNextOutput(_fftBuffer[index]);
             }
         }
     }
-}
\ No newline at end of file
+
+    outputs = _outputs;
+}
+
+void FFTProvider::_readFromRing(int numSamples) {
+    // Shift the window back and add the new samples to the end
+    std::copy(_window.begin() + numSamples, _window.end(), _window.begin());
+
+    int start1, size1, start2, size2;
+    _fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+    float* const fillStart {_window.data() + FFT_SIZE - numSamples};
+    std::copy(_ring.data() + start1, _ring.data() + start1 + size1, fillStart);
+    std::copy(_ring.data() + start2, _ring.data() + start2 + size2, fillStart + size1);
+
+    _fifo.finishedRead(size1 + size2);
+}
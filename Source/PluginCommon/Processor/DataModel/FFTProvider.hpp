@@ -1,13 +1,19 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <mutex>
 
 #include "WEFilters/EffectsProcessor.h"
 #include "WEFilters/AREnvelopeFollowerSquareLaw.h"
-#include "General/AudioSpinMutex.h"
 
 /**
  * Performs an FFT on the signal which can be provided to the UI to drive the visualiser.
+ *
+ * The audio thread only pushes a mono downmix of each block into a ring, and only while a
+ * visualiser is attached. The windowing, FFT and smoothing are done by whichever thread asks for
+ * the outputs, at the rate it asks for them, so analysis costs nothing while the editor is closed.
  */
 class FFTProvider {
 public:
@@ -15,28 +21,71 @@ public:
     static constexpr int FFT_SIZE {(1 << FFT_ORDER) * 2};
     static constexpr int NUM_OUTPUTS { FFT_SIZE / 4 };
 
+    // Enough for a few display frames at high sample rates, samples that don't fit are dropped
+    static constexpr int RING_SIZE {FFT_SIZE * 16};
+
+    // The envelopes are stepped once per this many samples analysed so the smoothing doesn't
+    // depend on how often the outputs are updated
+    static constexpr int ENVELOPE_STEP_SAMPLES {FFT_SIZE / 2};
+
     FFTProvider();
-    ~FFTProvider();
 
     void setSampleRate(double sampleRate);
 
+    void setIsStereo(bool val) { _isStereo.store(val, std::memory_order_relaxed); }
+
+    /**
+     * Clears the analysis. The envelopes and window are cleared the next time the outputs are
+     * updated, so this is safe to call while the UI is reading them.
+     */
     void reset();
 
-    void processBlock(juce::AudioBuffer<float>& buffer);
+    /**
+     * Called by the audio thread. Does nothing unless a visualiser is attached, and never blocks
+     * or allocates.
+     */
+    void pushSamples(const juce::AudioBuffer<float>& buffer);
+
+    /**
+     * Visualisers must be attached for the audio thread to push samples.
+     */
+    void attachVisualiser();
+    void detachVisualiser();
+    bool isVisualiserAttached() const { return _numVisualisers.load(std::memory_order_relaxed) > 0; }
 
-    const float* getOutputs() { return _outputs; }
+    /**
+     * Analyses the samples pushed since the last update and copies the smoothed outputs. Called
+     * from the UI, never from the audio thread.
+     */
+    void updateOutputs(std::array<float, NUM_OUTPUTS>& outputs);
 
-    void setIsStereo(bool val) { _isStereo = val; }
+    /**
+     * True if updating the outputs would change them.
+     */
+    bool hasNewSamples() const { return _fifo.getNumReady() > 0 || _shouldReset.load(std::memory_order_relaxed); }
 
-    float getBinWidth() const { return _binWidth; }
+    float getBinWidth() const { return _binWidth.load(std::memory_order_relaxed); }
 
 private:
-    float* _inputBuffer;
-    float* _fftBuffer;
-    float* _outputs;
+    // Written by the audio thread, read by the thread updating the outputs
+    juce::AbstractFifo _fifo;
+    std::array<float, RING_SIZE> _ring;
+
+    std::atomic<int> _numVisualisers;
+    std::atomic<bool> _isStereo;
+    std::atomic<double> _sampleRate;
+    std::atomic<float> _binWidth;
+    std::atomic<bool> _shouldReset;
+
+    // Only used while updating the outputs
+    std::mutex _analysisMutex;
+    std::array<float, FFT_SIZE> _window;
+    std::array<float, FFT_SIZE> _fftBuffer;
+    std::array<float, NUM_OUTPUTS> _outputs;
     juce::dsp::FFT _fft;
     std::array<WECore::AREnv::AREnvelopeFollowerSquareLaw, NUM_OUTPUTS> _envs;
-    WECore::AudioSpinMutex _fftMutex;
-    bool _isStereo;
-    float _binWidth;
+    double _envSampleRate;
+    int _numSamplesSinceEnvelopeStep;
+
+    void _readFromRing(int numSamples);
 };
@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include <numeric>
+#include "FFTProvider.hpp"
+
+namespace {
+    constexpr int NUM_SAMPLES {FFTProvider::FFT_SIZE};
+    constexpr double SAMPLE_RATE {44100};
+
+    juce::AudioBuffer<float> createSineBuffer(int numChannels) {
+        juce::AudioBuffer<float> buffer(numChannels, NUM_SAMPLES);
+
+        for (int channelIdx {0}; channelIdx < numChannels; channelIdx++) {
+            for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                buffer.setSample(channelIdx, sampleIdx, std::sin(2 * juce::MathConstants<float>::pi * 1000 * sampleIdx / SAMPLE_RATE));
+            }
+        }
+
+        return buffer;
+    }
+
+    float getTotalOutput(const std::array<float, FFTProvider::NUM_OUTPUTS>& outputs) {
+        return std::accumulate(outputs.begin(), outputs.end(), 0.0f);
+    }
+}
+
+SCENARIO("FFTProvider: Samples are only analysed while a visualiser is attached") {
+    GIVEN("An FFTProvider") {
+        FFTProvider provider;
+        provider.setSampleRate(SAMPLE_RATE);
+        provider.setIsStereo(true);
+
+        juce::AudioBuffer<float> buffer {createSineBuffer(2)};
+        std::array<float, FFTProvider::NUM_OUTPUTS> outputs;
+
+        WHEN("Samples are pushed without a visualiser attached") {
+            provider.pushSamples(buffer);
+            provider.updateOutputs(outputs);
+
+            THEN("Nothing is analysed") {
+                CHECK(getTotalOutput(outputs) == 0);
+            }
+        }
+
+        WHEN("Samples are pushed with a visualiser attached") {
+            provider.attachVisualiser();
+            provider.pushSamples(buffer);
+            provider.updateOutputs(outputs);
+
+            THEN("They are analysed") {
+                CHECK(getTotalOutput(outputs) > 0);
+            }
+
+            AND_WHEN("The visualiser is detached and the provider reset") {
+                provider.detachVisualiser();
+                provider.reset();
+                provider.pushSamples(buffer);
+                provider.updateOutputs(outputs);
+
+                THEN("The outputs are cleared and nothing new is analysed") {
+                    CHECK_FALSE(provider.isVisualiserAttached());
+                    CHECK(getTotalOutput(outputs) == 0);
+                }
+            }
+        }
+
+        WHEN("More samples are pushed than the ring can hold") {
+            provider.attachVisualiser();
+
+            for (int blockIdx {0}; blockIdx < FFTProvider::RING_SIZE / NUM_SAMPLES + 2; blockIdx++) {
+                provider.pushSamples(buffer);
+            }
+
+            provider.updateOutputs(outputs);
+
+            THEN("The extra samples are dropped and the rest are still analysed") {
+                CHECK(getTotalOutput(outputs) > 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include "LatencyCompensationLine.hpp"
+
+namespace {
+    void writeToRing(float* ring, int ringSize, int position, const float* source, int numSamples) {
+        const int numBeforeWrap {std::min(numSamples, ringSize - position)};
+        juce::FloatVectorOperations::copy(ring + position, source, numBeforeWrap);
+
+        if (numSamples > numBeforeWrap) {
+            juce::FloatVectorOperations::copy(ring, source + numBeforeWrap, numSamples - numBeforeWrap);
+        }
+    }
+
+    void readFromRing(const float* ring, int ringSize, int position, float* destination, int numSamples) {
+        const int numBeforeWrap {std::min(numSamples, ringSize - position)};
+        juce::FloatVectorOperations::copy(destination, ring + position, numBeforeWrap);
+
+        if (numSamples > numBeforeWrap) {
+            juce::FloatVectorOperations::copy(destination + numBeforeWrap, ring, numSamples - numBeforeWrap);
+        }
+    }
+}
+
+LatencyCompensationLine::LatencyCompensationLine() :
+        _maxDelay(DEFAULT_MAX_DELAY_SAMPLES),
+        _delay(0),
+        _ring(std::make_shared<Ring>()),
+        _maxBlockSize(0) {
+}
+
+LatencyCompensationLine::LatencyCompensationLine(const LatencyCompensationLine& other) :
+        _maxDelay(other._maxDelay),
+        _delay(other._delay.load()),
+        _ring(other._ring),
+        _maxBlockSize(other._maxBlockSize) {
+}
+
+void LatencyCompensationLine::prepare(int numChannels, int maxBlockSize, int maxDelayInSamples) {
+    _maxDelay = std::max(maxDelayInSamples, 0);
+    _maxBlockSize = std::max(maxBlockSize, 1);
+
+    if (_delay.load(std::memory_order_relaxed) > _maxDelay) {
+        _delay.store(_maxDelay, std::memory_order_relaxed);
+    }
+
+    // A new ring, as a clone may still be processing with the old one
+    _ring = std::make_shared<Ring>();
+    _ring->buffer.setSize(numChannels, _maxDelay + _maxBlockSize);
+    reset();
+}
+
+bool LatencyCompensationLine::setDelay(int numSamples) {
+    const int limitedDelay {std::clamp(numSamples, 0, _maxDelay)};
+    _delay.store(limitedDelay, std::memory_order_relaxed);
+
+    return limitedDelay == numSamples;
+}
+
+void LatencyCompensationLine::reset() {
+    _ring->buffer.clear();
+    _ring->writePosition = 0;
+}
+
+void LatencyCompensationLine::process(juce::AudioBuffer<float>& buffer) {
+    const int numChannels {std::min(buffer.getNumChannels(), _ring->buffer.getNumChannels())};
+    if (numChannels == 0) {
+        return;
+    }
+
+    // Use the same delay for the whole block even if it's changed part way through
+    const int delay {_delay.load(std::memory_order_relaxed)};
+
+    // The ring only has space for a block of _maxBlockSize, so split anything bigger
+    for (int startSample {0}; startSample < buffer.getNumSamples(); startSample += _maxBlockSize) {
+        const int numSamples {std::min(_maxBlockSize, buffer.getNumSamples() - startSample)};
+        _processChunk(buffer, startSample, numSamples, numChannels, delay);
+    }
+}
+
+size_t LatencyCompensationLine::getRingSizeBytes() const {
+    return static_cast<size_t>(_ring->buffer.getNumChannels()) * _ring->buffer.getNumSamples() * sizeof(float);
+}
+
+void LatencyCompensationLine::_processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannels, int delay) {
+    const int ringSize {_ring->buffer.getNumSamples()};
+    int& writePosition = _ring->writePosition;
+
+    // Write the input first so a delay shorter than the block can read from it. The ring is big
+    // enough that this never overwrites anything within the maximum delay.
+    const int readPosition {(writePosition - delay + ringSize) % ringSize};
+
+    for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+        float* ring {_ring->buffer.getWritePointer(channelIndex)};
+        float* samples {buffer.getWritePointer(channelIndex, startSample)};
+
+        writeToRing(ring, ringSize, writePosition, samples, numSamples);
+
+        if (delay > 0) {
+            readFromRing(ring, ringSize, readPosition, samples, numSamples);
+        }
+    }
+
+    writePosition = (writePosition + numSamples) % ringSize;
+}
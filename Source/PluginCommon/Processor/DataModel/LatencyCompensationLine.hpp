@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+/**
+ * A whole-sample delay used to line up the latency of the chains in a splitter.
+ *
+ * The ring buffer is allocated up front in prepare() with enough space for the maximum delay plus
+ * a block, so the delay can be changed with setDelay() from any thread without allocating or
+ * locking. Every block is written to the ring even when the delay is 0, so increasing the delay
+ * takes effect immediately using the history that's already there rather than dropping a block.
+ *
+ * Clones share the ring, as only one copy of a chain is ever processed at a time. Each clone has its
+ * own delay, and prepare() gives a clone a ring of its own.
+ */
+class LatencyCompensationLine {
+public:
+    static constexpr int DEFAULT_MAX_DELAY_SAMPLES {16384};
+
+    LatencyCompensationLine();
+
+    /**
+     * Allocates the ring buffer for the given maximum delay, limiting the current delay to it if
+     * needed. Until the line is first prepared the maximum is DEFAULT_MAX_DELAY_SAMPLES. Must not be
+     * called while the audio thread is processing.
+     */
+    void prepare(int numChannels, int maxBlockSize, int maxDelayInSamples);
+
+    /**
+     * Sets the delay, limited to the maximum. Safe to call while the audio thread is processing.
+     * Returns false if the delay had to be limited.
+     */
+    bool setDelay(int numSamples);
+
+    int getDelay() const { return _delay.load(std::memory_order_relaxed); }
+    int getMaximumDelayInSamples() const { return _maxDelay; }
+
+    void reset();
+
+    /**
+     * Delays the buffer in place. Channels beyond those given to prepare() are left unchanged.
+     */
+    void process(juce::AudioBuffer<float>& buffer);
+
+    LatencyCompensationLine* clone() const {
+        return new LatencyCompensationLine(*this);
+    }
+
+    /**
+     * Bytes allocated for the ring, which is shared with any clones.
+     */
+    size_t getRingSizeBytes() const;
+
+    /**
+     * Identifies the ring, which is the same for clones that share it.
+     */
+    const void* getRingId() const { return _ring.get(); }
+
+private:
+    int _maxDelay;
+    std::atomic<int> _delay;
+
+    struct Ring {
+        juce::AudioBuffer<float> buffer;
+        int writePosition;
+
+        Ring() : writePosition(0) { }
+    };
+
+    std::shared_ptr<Ring> _ring;
+    int _maxBlockSize;
+
+    LatencyCompensationLine(const LatencyCompensationLine& other);
+
+    void _processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int numChannels, int delay);
+};
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+
+#include "LatencyCompensationLine.hpp"
+
+SCENARIO("LatencyCompensationLine: Delays are applied across block boundaries") {
+    GIVEN("A prepared line and a buffer with an impulse") {
+        constexpr int NUM_CHANNELS {2};
+        constexpr int BLOCK_SIZE {16};
+        constexpr int MAX_DELAY {40};
+
+        LatencyCompensationLine line;
+        line.prepare(NUM_CHANNELS, BLOCK_SIZE, MAX_DELAY);
+
+        const int delay = GENERATE(0, 1, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 3, MAX_DELAY);
+        REQUIRE(line.setDelay(delay));
+
+        WHEN("Several blocks are processed") {
+            constexpr int NUM_BLOCKS {4};
+            constexpr int IMPULSE_POSITION {5};
+            std::vector<float> output;
+
+            for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+                buffer.clear();
+
+                if (blockIndex == 0) {
+                    for (int channelIndex {0}; channelIndex < NUM_CHANNELS; channelIndex++) {
+                        buffer.setSample(channelIndex, IMPULSE_POSITION, 1.0f);
+                    }
+                }
+
+                line.process(buffer);
+
+                for (int sampleIndex {0}; sampleIndex < BLOCK_SIZE; sampleIndex++) {
+                    CHECK(buffer.getSample(0, sampleIndex) == buffer.getSample(1, sampleIndex));
+                    output.push_back(buffer.getSample(0, sampleIndex));
+                }
+            }
+
+            THEN("The impulse is output after the delay") {
+                for (int sampleIndex {0}; sampleIndex < output.size(); sampleIndex++) {
+                    CHECK(output[sampleIndex] == (sampleIndex == IMPULSE_POSITION + delay ? 1.0f : 0.0f));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("LatencyCompensationLine: Delays are limited to the maximum") {
+    GIVEN("A prepared line") {
+        LatencyCompensationLine line;
+        line.prepare(1, 16, 10);
+
+        WHEN("A delay longer than the maximum is set") {
+            const bool result {line.setDelay(11)};
+
+            THEN("It is limited to the maximum") {
+                CHECK_FALSE(result);
+                CHECK(line.getDelay() == 10);
+            }
+        }
+    }
+}
+
+SCENARIO("LatencyCompensationLine: Preparing sets the maximum") {
+    GIVEN("A line prepared with a delay") {
+        LatencyCompensationLine line;
+        line.prepare(1, 16, 20);
+        REQUIRE(line.setDelay(15));
+
+        WHEN("It is prepared again with a lower maximum") {
+            line.prepare(1, 16, 10);
+
+            THEN("The delay is limited to the new maximum") {
+                CHECK(line.getMaximumDelayInSamples() == 10);
+                CHECK(line.getDelay() == 10);
+            }
+        }
+
+        WHEN("It is prepared again with a higher maximum") {
+            line.prepare(1, 16, 40);
+
+            THEN("The delay is unchanged and can be increased to the new maximum") {
+                CHECK(line.getMaximumDelayInSamples() == 40);
+                CHECK(line.getDelay() == 15);
+                CHECK(line.setDelay(40));
+            }
+        }
+    }
+}
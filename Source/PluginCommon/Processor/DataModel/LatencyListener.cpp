@@ -50,6 +50,9 @@ int PluginChainLatencyListener::_calculateTotalPluginLatency() const {
                 totalLatency += pluginSlot->plugin->getLatencySamples();
             }
         }
+
+        // Each boundary between pipeline stages adds a block
+        totalLatency += _chain->pipeline->getLatencySamples();
     }
 
     return totalLatency;
@@ -37,7 +37,15 @@ public:
 
     void setSplitter(PluginSplitter* splitter) { _splitter = splitter; }
 
-    void removeSplitter() { _splitter = nullptr; }
+    /**
+     * Chains can be shared between splitters, so this only removes the splitter if it's the one
+     * being notified.
+     */
+    void removeSplitter(const PluginSplitter* splitter) {
+        if (_splitter == splitter) {
+            _splitter = nullptr;
+        }
+    }
 
 private:
     PluginChain* _chain;
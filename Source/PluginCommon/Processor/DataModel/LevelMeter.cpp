@@ -0,0 +1,128 @@
+#include "LevelMeter.hpp"
+
+namespace {
+    float getSumOfSquares(const float* samples, int numSamples) {
+        using Register = juce::dsp::SIMDRegister<float>;
+        constexpr int NUM_ELEMENTS {static_cast<int>(Register::SIMDNumElements)};
+
+        float sum {0};
+        int index {0};
+
+        // Scalar until the samples are aligned for the SIMD loads
+        for (; index < numSamples && !Register::isSIMDAligned(samples + index); index++) {
+            sum += samples[index] * samples[index];
+        }
+
+        Register sumRegister = Register::expand(0.0f);
+        for (; index + NUM_ELEMENTS <= numSamples; index += NUM_ELEMENTS) {
+            const Register values = Register::fromRawArray(samples + index);
+            sumRegister += values * values;
+        }
+
+        sum += sumRegister.sum();
+
+        for (; index < numSamples; index++) {
+            sum += samples[index] * samples[index];
+        }
+
+        return sum;
+    }
+}
+
+LevelMeter::LevelMeter() : _numReaders(0), _shouldReset(false), _sampleRate(44100) {
+    _clear();
+}
+
+void LevelMeter::setSampleRate(double sampleRate) {
+    _sampleRate.store(sampleRate, std::memory_order_relaxed);
+}
+
+void LevelMeter::reset() {
+    _shouldReset.store(true, std::memory_order_release);
+}
+
+void LevelMeter::processBlock(const juce::AudioBuffer<float>& buffer, int numChannels) {
+    if (!isReaderAttached()) {
+        return;
+    }
+
+    if (_shouldReset.exchange(false, std::memory_order_acquire)) {
+        _clear();
+    }
+
+    const int numSamples {buffer.getNumSamples()};
+    if (numSamples == 0) {
+        return;
+    }
+
+    const double sampleRate {_sampleRate.load(std::memory_order_relaxed)};
+    const double attackDecay {_getBlockDecay(ATTACK_TIME_MS, sampleRate, numSamples)};
+    const double releaseDecay {_getBlockDecay(RELEASE_TIME_MS, sampleRate, numSamples)};
+
+    numChannels = std::min({numChannels, buffer.getNumChannels(), MAX_NUM_CHANNELS});
+    for (int channel {0}; channel < numChannels; channel++) {
+        const float* const samples {buffer.getReadPointer(channel)};
+
+        const double blockMeanSquare {static_cast<double>(getSumOfSquares(samples, numSamples)) / numSamples};
+        const juce::Range<float> range {juce::FloatVectorOperations::findMinAndMax(samples, numSamples)};
+        const float blockPeak {std::max(std::abs(range.getStart()), std::abs(range.getEnd()))};
+
+        // A one pole follower given the same input for n samples moves (1 - decay^n) of the way
+        // towards it
+        const double decay {blockMeanSquare > _meanSquares[channel] ? attackDecay : releaseDecay};
+        _meanSquares[channel] = decay * _meanSquares[channel] + (1 - decay) * blockMeanSquare;
+
+        // Peaks jump straight up and fall back with the release
+        _peaks[channel] = std::max(blockPeak, static_cast<float>(_peaks[channel] * releaseDecay));
+
+        _publishedRMS[channel].store(static_cast<float>(std::sqrt(_meanSquares[channel])), std::memory_order_relaxed);
+        _publishedPeaks[channel].store(_peaks[channel], std::memory_order_relaxed);
+    }
+}
+
+void LevelMeter::attachReader() {
+    if (_numReaders++ == 0) {
+        _shouldReset.store(true, std::memory_order_release);
+    }
+}
+
+void LevelMeter::detachReader() {
+    _numReaders--;
+}
+
+float LevelMeter::getRMS(int channel) const {
+    if (channel < 0 || channel >= MAX_NUM_CHANNELS) {
+        return 0;
+    }
+
+    return _publishedRMS[channel].load(std::memory_order_relaxed);
+}
+
+float LevelMeter::getPeak(int channel) const {
+    if (channel < 0 || channel >= MAX_NUM_CHANNELS) {
+        return 0;
+    }
+
+    return _publishedPeaks[channel].load(std::memory_order_relaxed);
+}
+
+void LevelMeter::_clear() {
+    _meanSquares.fill(0);
+    _peaks.fill(0);
+
+    for (int channel {0}; channel < MAX_NUM_CHANNELS; channel++) {
+        _publishedRMS[channel].store(0, std::memory_order_relaxed);
+        _publishedPeaks[channel].store(0, std::memory_order_relaxed);
+    }
+}
+
+double LevelMeter::_getBlockDecay(double timeMs, double sampleRate, int numSamples) {
+    if (sampleRate <= 0 || timeMs <= 0) {
+        return 0;
+    }
+
+    // Like the envelope followers, the time is how long it takes to get 99% of the way to the
+    // input. The per sample coefficient is exp(log(0.01) / (time * sampleRate)), raised to the
+    // number of samples.
+    return std::exp(numSamples * std::log(0.01) / (timeMs * 0.001 * sampleRate));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Measures the peak and RMS level of each channel once per block to drive the UI's meters.
+ *
+ * The ballistics are applied per block using the exact response of a one pole follower to a block
+ * of constant input. For constant input the RMS matches the per sample square law envelope
+ * followers the meters used to use, otherwise it follows the block's mean square instead of each
+ * sample. The readings are published through atomics so the UI never needs
+ * a lock to read them.
+ *
+ * Nothing is measured unless a reader is attached, so meters cost nothing while the editor is
+ * closed.
+ */
+class LevelMeter {
+public:
+    static constexpr int MAX_NUM_CHANNELS {2};
+    static constexpr double ATTACK_TIME_MS {1};
+    static constexpr double RELEASE_TIME_MS {50};
+
+    LevelMeter();
+
+    void setSampleRate(double sampleRate);
+
+    /**
+     * Safe to call from any thread, the audio thread clears the readings on its next block.
+     */
+    void reset();
+
+    /**
+     * Called by the audio thread with the processed block. Does nothing unless a reader is
+     * attached.
+     */
+    void processBlock(const juce::AudioBuffer<float>& buffer, int numChannels);
+
+    /**
+     * Readers must be attached for the audio thread to measure anything. The readings are cleared
+     * when the first reader attaches so they don't start from a stale level.
+     */
+    void attachReader();
+    void detachReader();
+    bool isReaderAttached() const { return _numReaders.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * Linear amplitudes, safe to call from any thread.
+     */
+    float getRMS(int channel) const;
+    float getPeak(int channel) const;
+
+private:
+    std::atomic<int> _numReaders;
+    std::atomic<bool> _shouldReset;
+    std::atomic<double> _sampleRate;
+
+    // Only used by the audio thread
+    std::array<double, MAX_NUM_CHANNELS> _meanSquares;
+    std::array<float, MAX_NUM_CHANNELS> _peaks;
+
+    // Published for the UI
+    std::array<std::atomic<float>, MAX_NUM_CHANNELS> _publishedRMS;
+    std::array<std::atomic<float>, MAX_NUM_CHANNELS> _publishedPeaks;
+
+    void _clear();
+
+    /**
+     * How much of the previous level remains after numSamples for the given time constant.
+     */
+    static double _getBlockDecay(double timeMs, double sampleRate, int numSamples);
+};
@@ -0,0 +1,173 @@
+#include "catch.hpp"
+#include "LevelMeter.hpp"
+#include "WEFilters/AREnvelopeFollowerSquareLaw.h"
+
+namespace {
+    constexpr int NUM_SAMPLES {64};
+    constexpr double SAMPLE_RATE {44100};
+
+    juce::AudioBuffer<float> createConstantBuffer(int numSamples, float value) {
+        juce::AudioBuffer<float> buffer(2, numSamples);
+
+        for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(channelIdx), value, numSamples);
+        }
+
+        return buffer;
+    }
+}
+
+SCENARIO("LevelMeter: Levels are only measured while a reader is attached") {
+    GIVEN("A meter") {
+        LevelMeter meter;
+        meter.setSampleRate(SAMPLE_RATE);
+
+        juce::AudioBuffer<float> buffer {createConstantBuffer(NUM_SAMPLES, 0.5f)};
+
+        WHEN("A block is processed without a reader attached") {
+            meter.processBlock(buffer, 2);
+
+            THEN("Nothing is measured") {
+                CHECK(meter.getRMS(0) == 0);
+                CHECK(meter.getPeak(0) == 0);
+            }
+        }
+
+        WHEN("Blocks are processed with a reader attached") {
+            meter.attachReader();
+
+            for (int blockIdx {0}; blockIdx < 100; blockIdx++) {
+                meter.processBlock(buffer, 2);
+            }
+
+            THEN("The RMS settles at the level of the input and the peak is the input") {
+                for (int channel {0}; channel < 2; channel++) {
+                    CHECK(meter.getRMS(channel) == Approx(0.5f));
+                    CHECK(meter.getPeak(channel) == Approx(0.5f));
+                }
+            }
+
+            AND_WHEN("The reader is detached and reattached") {
+                meter.detachReader();
+                meter.attachReader();
+
+                juce::AudioBuffer<float> silence {createConstantBuffer(NUM_SAMPLES, 0)};
+                meter.processBlock(silence, 2);
+
+                THEN("The meter starts again from silence") {
+                    CHECK(meter.getRMS(0) == 0);
+                    CHECK(meter.getPeak(0) == 0);
+                }
+            }
+        }
+
+        WHEN("The meter is given more channels than it can measure") {
+            meter.attachReader();
+            meter.processBlock(buffer, 4);
+
+            THEN("Only the channels it can measure are read") {
+                CHECK(meter.getRMS(LevelMeter::MAX_NUM_CHANNELS) == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("LevelMeter: Block ballistics match the per sample envelope follower for constant input") {
+    GIVEN("A meter and an envelope follower set up as the meters used to be") {
+        LevelMeter meter;
+        meter.setSampleRate(SAMPLE_RATE);
+        meter.attachReader();
+
+        WECore::AREnv::AREnvelopeFollowerSquareLaw envelope;
+        envelope.setAttackTimeMs(LevelMeter::ATTACK_TIME_MS);
+        envelope.setReleaseTimeMs(LevelMeter::RELEASE_TIME_MS);
+        envelope.setFilterEnabled(false);
+        envelope.setSampleRate(SAMPLE_RATE);
+
+        WHEN("They're given blocks which are each at a constant level") {
+            const int blockSize = GENERATE(1, NUM_SAMPLES, 512);
+
+            THEN("The meter's RMS follows the envelope after every block") {
+                for (float level : {0.25f, 1.0f, 0.5f, 0.0f, 0.0f, 0.75f, 0.0f}) {
+                    meter.processBlock(createConstantBuffer(blockSize, level), 2);
+
+                    for (int sampleIdx {0}; sampleIdx < blockSize; sampleIdx++) {
+                        envelope.getNextOutput(level);
+                    }
+
+                    CHECK(meter.getRMS(0) == Approx(envelope.getLastOutput()).margin(0.0001));
+                }
+            }
+        }
+
+        WHEN("They're given a block of constant input followed by silence") {
+            meter.processBlock(createConstantBuffer(NUM_SAMPLES, 1), 2);
+            meter.processBlock(createConstantBuffer(NUM_SAMPLES, 0), 2);
+
+            THEN("The peak releases at the same rate as the envelope") {
+                for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                    envelope.getNextOutput(1);
+                }
+
+                // Square the envelope's output to get the decay of the mean square, which is the
+                // same as the decay of a level following the release directly
+                const float levelBeforeRelease {static_cast<float>(envelope.getLastOutput())};
+                for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                    envelope.getNextOutput(0);
+                }
+                const float levelAfterRelease {static_cast<float>(envelope.getLastOutput())};
+
+                const double releaseDecay {std::pow(levelAfterRelease / levelBeforeRelease, 2)};
+                CHECK(meter.getPeak(0) == Approx(releaseDecay).margin(0.0001));
+            }
+        }
+    }
+}
+
+// Hidden by default, run with the [benchmark] tag
+SCENARIO("LevelMeter: Cost of metering a block", "[.][benchmark]") {
+    GIVEN("A stereo block of noise") {
+        constexpr int BLOCK_SIZE {512};
+
+        juce::Random random;
+        juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+        for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+            for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                buffer.setSample(channelIdx, sampleIdx, random.nextFloat() * 2 - 1);
+            }
+        }
+
+        std::array<WECore::AREnv::AREnvelopeFollowerSquareLaw, 2> envelopes;
+        for (auto& env : envelopes) {
+            env.setAttackTimeMs(LevelMeter::ATTACK_TIME_MS);
+            env.setReleaseTimeMs(LevelMeter::RELEASE_TIME_MS);
+            env.setFilterEnabled(false);
+            env.setSampleRate(SAMPLE_RATE);
+        }
+
+        LevelMeter meter;
+        meter.setSampleRate(SAMPLE_RATE);
+
+        BENCHMARK("Per sample envelope followers") {
+            for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    envelopes[channelIdx].getNextOutput(buffer.getReadPointer(channelIdx)[sampleIdx]);
+                }
+            }
+
+            return envelopes[0].getLastOutput();
+        };
+
+        BENCHMARK("Block meter with no reader") {
+            meter.processBlock(buffer, 2);
+            return meter.getRMS(0);
+        };
+
+        meter.attachReader();
+
+        BENCHMARK("Block meter with a reader") {
+            meter.processBlock(buffer, 2);
+            return meter.getRMS(0);
+        };
+    }
+}
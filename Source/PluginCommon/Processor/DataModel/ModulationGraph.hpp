@@ -0,0 +1,96 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ModulationSourceDefinition.hpp"
+
+/**
+ * The dependencies between the modulation sources (LFOs, envelopes, random sources and step
+ * sequencers), and the space used to render them a block at a time.
+ *
+ * Nodes are stored in the order the sources used to be stepped one sample at a time: LFOs,
+ * envelopes, random sources, then step sequencers. A source reading another source that comes
+ * later in that order sees the value from the previous sample, and this is preserved so the output
+ * is the same as stepping every source one sample at a time.
+ */
+struct ModulationGraph {
+    struct Node {
+        MODULATION_TYPE type;
+
+        // Index into the vector of sources of this type
+        int index;
+
+        Node(MODULATION_TYPE newType, int newIndex) : type(newType), index(newIndex) { }
+    };
+
+    std::vector<Node> nodes;
+
+    // Nodes grouped so that each group only depends on itself and the groups before it. A group
+    // with a single node that doesn't modulate itself can be rendered a block at a time, any other
+    // group contains a cycle and is stepped one sample at a time.
+    std::vector<int> renderOrder;
+    std::vector<int> groupStarts;
+    std::vector<bool> groupIsCycle;
+
+    // True for each node that's modulated by another node, so has to read that node's output at the
+    // right position in the block
+    std::vector<bool> isModulated;
+
+    // Output of each node for each sample of the current block
+    std::vector<std::vector<double>> outputs;
+
+    // Output of each node at the end of the previous block
+    std::vector<double> previousOutputs;
+
+    // Number of samples in outputs from the most recent block, 0 if the block wasn't rendered using
+    // the graph
+    int numRenderedSamples {0};
+
+    // Main input and sidechain mixed down to mono once per block, shared by every envelope
+    juce::AudioBuffer<float> mixdownBuffer;
+
+    int numLfos {0};
+    int numEnvelopes {0};
+    int numRandomSources {0};
+    int numStepSequencers {0};
+    int maxBlockSize {0};
+    bool isValid {false};
+
+    static constexpr int MAIN_MIXDOWN_CHANNEL {0};
+    static constexpr int SIDECHAIN_MIXDOWN_CHANNEL {1};
+
+    /**
+     * Returns the index of the node for the given source, or -1 if it isn't part of the graph (eg.
+     * a macro).
+     */
+    int getNodeIndex(ModulationSourceDefinition definition) const {
+        const int index {definition.id - 1};
+
+        switch (definition.type) {
+            case MODULATION_TYPE::LFO:
+                return index >= 0 && index < numLfos ? index : -1;
+            case MODULATION_TYPE::ENVELOPE:
+                return index >= 0 && index < numEnvelopes ? numLfos + index : -1;
+            case MODULATION_TYPE::RANDOM:
+                return index >= 0 && index < numRandomSources ? numLfos + numEnvelopes + index : -1;
+            case MODULATION_TYPE::STEP_SEQUENCER:
+                return index >= 0 && index < numStepSequencers ? numLfos + numEnvelopes + numRandomSources + index : -1;
+            case MODULATION_TYPE::MACRO:
+                return -1;
+        }
+
+        return -1;
+    }
+
+    /**
+     * Returns true if the graph was built for sources of these sizes and has space for a block of
+     * numSamples.
+     */
+    bool canRender(int newNumLfos, int newNumEnvelopes, int newNumRandomSources, int newNumStepSequencers, int numSamples) const {
+        return isValid
+            && numLfos == newNumLfos
+            && numEnvelopes == newNumEnvelopes
+            && numRandomSources == newNumRandomSources
+            && numStepSequencers == newNumStepSequencers
+            && numSamples <= maxBlockSize;
+    }
+};
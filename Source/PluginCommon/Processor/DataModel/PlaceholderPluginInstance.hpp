@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include "LatencyCompensationLine.hpp"
+
+/**
+ * Stands in for a plugin that hasn't been loaded yet, so a restore can finish without waiting for
+ * every plugin to be created.
+ *
+ * Audio is delayed by the latency the plugin reported when it was saved, so the rest of the graph
+ * stays aligned both while the placeholder is in place and when the real plugin is swapped in. The plugin's description
+ * and state are held so saving while the placeholder is in place doesn't lose anything.
+ */
+class PlaceholderPluginInstance : public juce::AudioPluginInstance {
+public:
+    explicit PlaceholderPluginInstance(const juce::PluginDescription& description)
+        : _description(description), _hasFailedToLoad(false) {}
+
+    ~PlaceholderPluginInstance() override = default;
+
+    void setExpectedLatency(int latencySamples) { setLatencySamples(latencySamples); }
+
+    const juce::MemoryBlock& getSavedState() const { return _savedState; }
+
+    /**
+     * Set by the loader if the real plugin couldn't be created, so it isn't tried again. The
+     * placeholder carries on passing audio through.
+     */
+    void setFailedToLoad() { _hasFailedToLoad.store(true); }
+    bool hasFailedToLoad() const { return _hasFailedToLoad.load(); }
+
+    void fillInPluginDescription(juce::PluginDescription& description) const override { description = _description; }
+    const juce::String getName() const override { return _description.name; }
+
+    void prepareToPlay(double /*sampleRate*/, int maximumExpectedSamplesPerBlock) override {
+        const int latencySamples {std::max(getLatencySamples(), 0)};
+        _delayLine = std::make_unique<LatencyCompensationLine>(latencySamples);
+        _delayLine->prepare(std::max(getTotalNumInputChannels(), getTotalNumOutputChannels()), maximumExpectedSamplesPerBlock);
+        _delayLine->setDelay(latencySamples);
+    }
+
+    void releaseResources() override { _delayLine.reset(); }
+
+    void reset() override {
+        if (_delayLine != nullptr) {
+            _delayLine->reset();
+        }
+    }
+
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/) override {
+        if (_delayLine != nullptr) {
+            _delayLine->process(buffer);
+        }
+    }
+
+    double getTailLengthSeconds() const override { return 0; }
+    bool acceptsMidi() const override { return _description.isInstrument; }
+    bool producesMidi() const override { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override { return false; }
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int /*index*/) override {}
+    const juce::String getProgramName(int /*index*/) override { return ""; }
+    void changeProgramName(int /*index*/, const juce::String& /*newName*/) override {}
+
+    void getStateInformation(juce::MemoryBlock& destData) override { destData.append(_savedState.getData(), _savedState.getSize()); }
+    void setStateInformation(const void* data, int sizeInBytes) override { _savedState.replaceAll(data, static_cast<size_t>(sizeInBytes)); }
+
+protected:
+    // Configured the same way as the real plugin would be
+    bool isBusesLayoutSupported(const BusesLayout& /*layout*/) const override { return true; }
+
+private:
+    const juce::PluginDescription _description;
+    juce::MemoryBlock _savedState;
+    std::atomic<bool> _hasFailedToLoad;
+
+    // Delays the audio by the expected latency, allocated in prepareToPlay()
+    std::unique_ptr<LatencyCompensationLine> _delayLine;
+};
@@ -1,36 +1,49 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <set>
 #include "ChainSlots.hpp"
 #include "LatencyListener.hpp"
-#include "General/AudioSpinMutex.h"
-#include "CloneableDelayLine.hpp"
-
-typedef CloneableDelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> CloneableDelayLineType;
+#include "LatencyCompensationLine.hpp"
+#include "ChainRenderPlan.hpp"
+#include "ChainPipeline.hpp"
 
 class PluginChain {
 public:
     std::vector<std::shared_ptr<ChainSlotBase>> chain;
 
+    // Compiled from chain, must be recompiled whenever a slot is added, removed or replaced
+    ChainRenderPlan renderPlan;
+
     bool isChainBypassed;
     bool isChainMuted;
 
+    // True while every plugin in the chain is asleep, read by the UI
+    std::atomic<bool> isSleeping;
+
     std::function<float(int, MODULATION_TYPE)> getModulationValueCallback;
 
-    std::unique_ptr<CloneableDelayLineType> latencyCompLine;
-    WECore::AudioSpinMutex latencyCompLineMutex;
+    std::unique_ptr<LatencyCompensationLine> latencyCompLine;
+
+    // Compiled from renderPlan, must be recompiled whenever the plan is
+    std::unique_ptr<ChainPipeline> pipeline;
 
     PluginChainLatencyListener latencyListener;
 
     juce::String customName;
 
+    // Used to split the MIDI between slices when modulating at a faster rate than once per block
+    juce::MidiBuffer sliceMidiBuffer;
+    juce::MidiBuffer outputMidiBuffer;
+
     PluginChain(std::function<float(int, MODULATION_TYPE)> getModulationValueCallback) :
             isChainBypassed(false),
             isChainMuted(false),
+            isSleeping(false),
             getModulationValueCallback(getModulationValueCallback),
             latencyListener(this) {
-        latencyCompLine.reset(new CloneableDelayLineType(0));
-        latencyCompLine->setDelay(0);
+        latencyCompLine.reset(new LatencyCompensationLine());
+        pipeline.reset(new ChainPipeline());
     }
 
     virtual ~PluginChain() {
@@ -43,39 +56,90 @@ public:
         }
     }
 
+    /**
+     * The copy shares the slots with this chain until they're written to with getSlotForWrite().
+     */
     PluginChain* clone() const {
         return new PluginChain(
             chain,
             isChainBypassed,
             isChainMuted,
             getModulationValueCallback,
-            std::unique_ptr<CloneableDelayLineType>(latencyCompLine->clone()),
+            std::unique_ptr<LatencyCompensationLine>(latencyCompLine->clone()),
+            std::unique_ptr<ChainPipeline>(pipeline->clone()),
             customName
         );
     }
 
+    /**
+     * Return the slot at the given index so it can be changed, copying it first if it's still
+     * shared with the chain this was cloned from. The index must be valid.
+     *
+     * Copying replaces the slot in this chain, so this must not be called on a chain the audio
+     * thread may be processing unless the slot has already been copied.
+     */
+    std::shared_ptr<ChainSlotBase> getSlotForWrite(size_t index) {
+        if (isShared(chain[index])) {
+            return replaceSlotWithCopy(index);
+        }
+
+        return chain[index];
+    }
+
+    /**
+     * Replaces the slot at the given index with a copy whether it's shared or not, and returns the
+     * copy.
+     */
+    std::shared_ptr<ChainSlotBase> replaceSlotWithCopy(size_t index) {
+        std::shared_ptr<ChainSlotBase>& slot = chain[index];
+        _sharedSlots.erase(slot);
+        slot.reset(slot->clone());
+
+        // The plan points to the slots, the pipeline's stages only refer to their positions so
+        // don't need to change
+        renderPlan.compile(chain);
+
+        return slot;
+    }
+
+    /**
+     * True if the slot is still shared with the chain this was cloned from.
+     */
+    bool isShared(const std::shared_ptr<ChainSlotBase>& slot) const {
+        return _sharedSlots.find(slot) != _sharedSlots.end();
+    }
+
 private:
+    // Slots inherited from the chain this was cloned from that haven't been copied yet. Weak so a
+    // slot that has since been deleted can't be mistaken for a new one at the same address.
+    std::set<std::weak_ptr<ChainSlotBase>, std::owner_less<>> _sharedSlots;
+
     PluginChain(
         std::vector<std::shared_ptr<ChainSlotBase>> newChain,
         bool newIsChainBypassed,
         bool newIsChainMuted,
         std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
-        std::unique_ptr<CloneableDelayLineType> newLatencyCompLine,
+        std::unique_ptr<LatencyCompensationLine> newLatencyCompLine,
+        std::unique_ptr<ChainPipeline> newPipeline,
         const juce::String& newCustomName) :
+            chain(newChain),
             isChainBypassed(newIsChainBypassed),
             isChainMuted(newIsChainMuted),
+            isSleeping(false),
             getModulationValueCallback(newGetModulationValueCallback),
             latencyCompLine(std::move(newLatencyCompLine)),
+            pipeline(std::move(newPipeline)),
             latencyListener(this),
             customName(newCustomName) {
-        for (auto& slot : newChain) {
-            chain.push_back(std::shared_ptr<ChainSlotBase>(slot->clone()));
+        _sharedSlots.insert(chain.begin(), chain.end());
 
+        for (auto& slot : chain) {
             if (auto plugin = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
                 plugin->plugin->addListener(&latencyListener);
             }
         }
 
+        renderPlan.compile(chain);
         latencyListener.onPluginChainUpdate();
     }
 };
@@ -33,10 +33,14 @@ SCENARIO("PluginChain: Clone works correctly") {
         // Change the values so we can test for them
         // chain->isBypassed = true; // Can't test for this one as it sets the latency to 0 so would stop us testing the latency listener
         chain->isChainMuted = true;
-        chain->latencyCompLine.reset(new CloneableDelayLineType(100));
+        chain->latencyCompLine.reset(new LatencyCompensationLine());
+        chain->latencyCompLine->prepare(1, 10, 100);
         chain->latencyCompLine->setDelay(50);
-        chain->latencyCompLine->prepare({44100, 10, 1});
-        chain->latencyCompLine->pushSample(0, 0.75f);
+
+        juce::AudioBuffer<float> latencyBuffer(1, 10);
+        latencyBuffer.clear();
+        latencyBuffer.setSample(0, 0, 0.75f);
+        chain->latencyCompLine->process(latencyBuffer);
 
         WHEN("It is cloned") {
             PluginChain* clonedChain = chain->clone();
@@ -50,8 +54,7 @@ SCENARIO("PluginChain: Clone works correctly") {
                 auto clonedPluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(clonedChain->chain[0]);
                 CHECK(clonedPluginSlot != nullptr);
                 CHECK(clonedPluginSlot->isBypassed == pluginSlot->isBypassed);
-                CHECK(clonedPluginSlot->plugin == pluginSlot->plugin); // Should be the same shared pointer
-                CHECK(clonedPluginSlot->modulationConfig != pluginSlot->modulationConfig); // Should be a different shared pointer
+                CHECK(clonedPluginSlot == pluginSlot); // The slots are shared until they're written to
 
                 // Check the gain stage
                 auto clonedGainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(clonedChain->chain[1]);
@@ -66,7 +69,13 @@ SCENARIO("PluginChain: Clone works correctly") {
                 CHECK(chain->latencyCompLine != nullptr);
                 CHECK(clonedChain->latencyCompLine->getMaximumDelayInSamples() == 100);
                 CHECK(clonedChain->latencyCompLine->getDelay() == 50);
-                CHECK(clonedChain->latencyCompLine->popSample(0, 0) == 0.75f);
+
+                // The cloned line should have the same history, so output the sample after the
+                // same delay
+                juce::AudioBuffer<float> clonedLatencyBuffer(1, 50);
+                clonedLatencyBuffer.clear();
+                clonedChain->latencyCompLine->process(clonedLatencyBuffer);
+                CHECK(clonedLatencyBuffer.getSample(0, 40) == 0.75f);
 
                 // Check the latency listener
                 CHECK(clonedChain->latencyListener.calculatedTotalPluginLatency == 15);
@@ -80,6 +89,33 @@ SCENARIO("PluginChain: Clone works correctly") {
 
             delete clonedChain;
         }
+
+        WHEN("It is cloned and a slot in the clone is written to") {
+            PluginChain* clonedChain = chain->clone();
+            auto writtenSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(clonedChain->getSlotForWrite(0));
+
+            THEN("Only that slot is copied") {
+                REQUIRE(writtenSlot != nullptr);
+                CHECK(writtenSlot != pluginSlot);
+                CHECK(clonedChain->chain[0] == writtenSlot);
+                CHECK(writtenSlot->plugin == pluginSlot->plugin); // Should be the same shared pointer
+                CHECK(writtenSlot->modulationConfig != pluginSlot->modulationConfig); // Should be a different shared pointer
+                CHECK(clonedChain->chain[1] == gainStage);
+
+                // The original is unchanged
+                CHECK(chain->chain[0] == pluginSlot);
+            }
+
+            AND_WHEN("The slot is written to again") {
+                std::shared_ptr<ChainSlotBase> writtenAgainSlot = clonedChain->getSlotForWrite(0);
+
+                THEN("It isn't copied again") {
+                    CHECK(writtenAgainSlot == writtenSlot);
+                }
+            }
+
+            delete clonedChain;
+        }
     }
 
     juce::MessageManager::deleteInstance();
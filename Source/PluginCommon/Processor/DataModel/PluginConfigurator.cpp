@@ -16,11 +16,115 @@ PluginConfigurator::PluginConfigurator() {
     stereoInStereoOutSC.outputBuses.add(juce::AudioChannelSet::stereo());
 }
 
+std::atomic<bool> PluginConfigurator::_isMonoChainsEnabled {false};
+std::mutex PluginConfigurator::_monoUnsupportedMutex;
+std::set<std::weak_ptr<juce::AudioPluginInstance>, std::owner_less<std::weak_ptr<juce::AudioPluginInstance>>> PluginConfigurator::_monoUnsupportedPlugins;
+
 bool PluginConfigurator::configure(std::shared_ptr<juce::AudioPluginInstance> plugin,
-                                   HostConfiguration configuration) const {
+                                   HostConfiguration configuration,
+                                   bool isMonoChain) const {
     // Note: for this layout stuff to work correctly it *must* be done before prepareToPlay() is
     // called on the plugin we just loaded. If we try it afterwards JUCE can't actually query the
     // layouts that the plugin supports so might do something weird.
+    const std::vector<const juce::AudioProcessor::BusesLayout*> rankedLayouts {
+        _getRankedLayouts(configuration, isMonoChain)
+    };
+
+    // Try each layout in order
+    bool setLayoutOk {false};
+    for (const juce::AudioProcessor::BusesLayout* layout : rankedLayouts) {
+        if (plugin->setBusesLayout(*layout)) {
+            setLayoutOk = true;
+            break;
+        }
+    }
+
+    if (setLayoutOk && rankedLayouts[0]->getMainInputChannels() == 1 && configuration.layout.getMainInputChannels() == 2) {
+        // Remember if mono was preferred but not supported so needsReconfiguring() doesn't keep
+        // asking for it
+        _setIsMonoUnsupported(plugin, plugin->getBusesLayout().getMainInputChannels() != 1);
+    }
+
+    if (setLayoutOk) {
+        plugin->enableAllBuses();
+        plugin->setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
+        plugin->prepareToPlay(configuration.sampleRate, configuration.blockSize);
+    }
+
+    return setLayoutOk;
+}
+
+bool PluginConfigurator::needsReconfiguring(std::shared_ptr<juce::AudioPluginInstance> plugin,
+                                            HostConfiguration configuration,
+                                            bool isMonoChain) const {
+    // Only the main channels affect routing, a plugin without a sidechain is fine either way
+    const juce::AudioProcessor::BusesLayout* preferredLayout {_getRankedLayouts(configuration, isMonoChain)[0]};
+    int expectedNumChannels {preferredLayout->getMainInputChannels()};
+
+    if (expectedNumChannels == 1 && configuration.layout.getMainInputChannels() == 2 && _isMonoUnsupported(plugin)) {
+        // Already fell back to stereo last time it was configured
+        expectedNumChannels = 2;
+    }
+
+    return plugin->getBusesLayout().getMainInputChannels() != expectedNumChannels;
+}
+
+bool PluginConfigurator::reconfigure(std::shared_ptr<juce::AudioPluginInstance> plugin,
+                                     HostConfiguration configuration,
+                                     bool isMonoChain) const {
+    const juce::AudioProcessor::BusesLayout previousLayout {plugin->getBusesLayout()};
+
+    // Takes the plugin's callback lock, so this waits for a block that's already being processed
+    plugin->suspendProcessing(true);
+    plugin->releaseResources();
+
+    const bool isConfigured {configure(plugin, configuration, isMonoChain)};
+
+    if (!isConfigured) {
+        // Go back to the layout we know works
+        juce::Logger::writeToLog("PluginConfigurator::reconfigure: Failed to reconfigure " + plugin->getName());
+        plugin->setBusesLayout(previousLayout);
+        plugin->enableAllBuses();
+        plugin->setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
+        plugin->prepareToPlay(configuration.sampleRate, configuration.blockSize);
+    }
+
+    plugin->suspendProcessing(false);
+
+    return isConfigured;
+}
+
+void PluginConfigurator::setMonoChainsEnabled(bool isEnabled) {
+    _isMonoChainsEnabled.store(isEnabled);
+}
+
+bool PluginConfigurator::isMonoChainsEnabled() {
+    return _isMonoChainsEnabled.load();
+}
+
+void PluginConfigurator::_setIsMonoUnsupported(std::shared_ptr<juce::AudioPluginInstance> plugin, bool isUnsupported) {
+    std::scoped_lock lock(_monoUnsupportedMutex);
+
+    // Drop plugins that have since been deleted
+    for (auto itr = _monoUnsupportedPlugins.begin(); itr != _monoUnsupportedPlugins.end();) {
+        itr = itr->expired() ? _monoUnsupportedPlugins.erase(itr) : std::next(itr);
+    }
+
+    if (isUnsupported) {
+        _monoUnsupportedPlugins.insert(plugin);
+    } else {
+        _monoUnsupportedPlugins.erase(plugin);
+    }
+}
+
+bool PluginConfigurator::_isMonoUnsupported(std::shared_ptr<juce::AudioPluginInstance> plugin) {
+    std::scoped_lock lock(_monoUnsupportedMutex);
+    return _monoUnsupportedPlugins.count(plugin) > 0;
+}
+
+std::vector<const juce::AudioProcessor::BusesLayout*> PluginConfigurator::_getRankedLayouts(
+        HostConfiguration configuration,
+        bool isMonoChain) const {
     std::vector<const juce::AudioProcessor::BusesLayout*> rankedLayouts;
 
     const bool isSyndicateStereo {
@@ -29,15 +133,7 @@ bool PluginConfigurator::configure(std::shared_ptr<juce::AudioPluginInstance> pl
 
     const bool isSyndicateSidechain {layoutHasSidechain(configuration.layout)};
 
-    if (isSyndicateStereo) {
-        if (isSyndicateSidechain) {
-            rankedLayouts.push_back(&stereoInStereoOutSC);
-            rankedLayouts.push_back(&stereoInStereoOut);
-        } else {
-            rankedLayouts.push_back(&stereoInStereoOut);
-            rankedLayouts.push_back(&stereoInStereoOutSC);
-        }
-    } else {
+    auto addMonoLayouts = [&]() {
         if (isSyndicateSidechain) {
             rankedLayouts.push_back(&monoInMonoOutSC);
             rankedLayouts.push_back(&monoInMonoOut);
@@ -45,22 +141,28 @@ bool PluginConfigurator::configure(std::shared_ptr<juce::AudioPluginInstance> pl
             rankedLayouts.push_back(&monoInMonoOut);
             rankedLayouts.push_back(&monoInMonoOutSC);
         }
-    }
+    };
 
-    // Try each layout in order
-    bool setLayoutOk {false};
-    for (const juce::AudioProcessor::BusesLayout* layout : rankedLayouts) {
-        if (plugin->setBusesLayout(*layout)) {
-            setLayoutOk = true;
-            break;
+    auto addStereoLayouts = [&]() {
+        if (isSyndicateSidechain) {
+            rankedLayouts.push_back(&stereoInStereoOutSC);
+            rankedLayouts.push_back(&stereoInStereoOut);
+        } else {
+            rankedLayouts.push_back(&stereoInStereoOut);
+            rankedLayouts.push_back(&stereoInStereoOutSC);
         }
-    }
+    };
 
-    if (setLayoutOk) {
-        plugin->enableAllBuses();
-        plugin->setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
-        plugin->prepareToPlay(configuration.sampleRate, configuration.blockSize);
+    if (isSyndicateStereo) {
+        if (isMonoChain && isMonoChainsEnabled()) {
+            // Fall back to stereo for plugins that don't support mono
+            addMonoLayouts();
+        }
+
+        addStereoLayouts();
+    } else {
+        addMonoLayouts();
     }
 
-    return setLayoutOk;
+    return rankedLayouts;
 }
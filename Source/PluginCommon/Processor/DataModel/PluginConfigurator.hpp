@@ -1,6 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include "SplitTypes.hpp"
+#include "LatencyCompensationLine.hpp"
 
 inline bool canDoStereoSplitTypes(const juce::AudioProcessor::BusesLayout& layout) {
     return layout.getMainInputChannels() == layout.getMainOutputChannels() &&
@@ -25,6 +30,9 @@ struct HostConfiguration {
     juce::AudioProcessor::BusesLayout layout;
     double sampleRate;
     int blockSize;
+
+    // The longest delay a chain's latency compensation can add
+    int maxLatencyCompensationSamples {LatencyCompensationLine::DEFAULT_MAX_DELAY_SAMPLES};
 };
 
 class PluginConfigurator {
@@ -38,19 +46,66 @@ public:
      * layout if it doesn't work. In processBlock we'll still pass the full buffer with sidechain to
      * the plugin, which should just be ignored if it doesn't need it.
      *
-     * We assume the buses layout will never change while the plugin is running, so only need to be
-     * configured when a plugin is added by the user or has been restored from XML.
+     * Chains in left/right and mid/side splits only ever process one channel. If mono chains are
+     * enabled, plugins in these chains are configured with mono layouts first and drop back to the
+     * stereo layouts if the plugin doesn't support mono. Processing works with either, so this is
+     * decided per plugin.
      *
-     * We could do things like try to load plugins in mono for split types that only ever need mono
-     * (ie. left/right and mid/side) but that gets really complicated and most users won't see any
-     * benefit from it.
+     * Plugins are configured when they're added by the user or restored from XML, and reconfigured
+     * by reconfigure() when the split type changes.
      */
     bool configure(std::shared_ptr<juce::AudioPluginInstance> plugin,
-                   HostConfiguration configuration) const;
+                   HostConfiguration configuration,
+                   bool isMonoChain = false) const;
+
+    /**
+     * Returns true if the plugin's layout doesn't match the one configure() would choose for a
+     * chain of the given type. Plugins that configure() found don't support mono are expected to
+     * be stereo, so they aren't reconfigured again every time.
+     */
+    bool needsReconfiguring(std::shared_ptr<juce::AudioPluginInstance> plugin,
+                            HostConfiguration configuration,
+                            bool isMonoChain) const;
+
+    /**
+     * Reconfigures a plugin that may be in use by the audio thread. Processing of the plugin is
+     * suspended while its layout changes, so it passes audio through unprocessed for the few
+     * blocks this takes rather than being called half configured.
+     */
+    bool reconfigure(std::shared_ptr<juce::AudioPluginInstance> plugin,
+                     HostConfiguration configuration,
+                     bool isMonoChain) const;
+
+    /**
+     * True for the split types that give each chain a single channel.
+     */
+    static bool isMonoChainSplitType(SPLIT_TYPE splitType) {
+        return splitType == SPLIT_TYPE::LEFTRIGHT || splitType == SPLIT_TYPE::MIDSIDE;
+    }
+
+    /**
+     * Opt in to configuring plugins in left/right and mid/side chains as mono. Read from the config
+     * when the plugin is created.
+     */
+    static void setMonoChainsEnabled(bool isEnabled);
+    static bool isMonoChainsEnabled();
 
 private:
     juce::AudioProcessor::BusesLayout monoInMonoOut;
     juce::AudioProcessor::BusesLayout monoInMonoOutSC;
     juce::AudioProcessor::BusesLayout stereoInStereoOut;
     juce::AudioProcessor::BusesLayout stereoInStereoOutSC;
+
+    static std::atomic<bool> _isMonoChainsEnabled;
+
+    // Plugins that were tried as mono by configure() and fell back to stereo. Shared by all
+    // configurators as they're created wherever they're needed.
+    static std::mutex _monoUnsupportedMutex;
+    static std::set<std::weak_ptr<juce::AudioPluginInstance>, std::owner_less<std::weak_ptr<juce::AudioPluginInstance>>> _monoUnsupportedPlugins;
+
+    static void _setIsMonoUnsupported(std::shared_ptr<juce::AudioPluginInstance> plugin, bool isUnsupported);
+    static bool _isMonoUnsupported(std::shared_ptr<juce::AudioPluginInstance> plugin);
+
+    std::vector<const juce::AudioProcessor::BusesLayout*> _getRankedLayouts(HostConfiguration configuration,
+                                                                            bool isMonoChain) const;
 };
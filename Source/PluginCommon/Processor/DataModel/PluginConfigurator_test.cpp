@@ -151,3 +151,69 @@ SCENARIO("PluginConfigurator: Can configure the plugin correctly") {
         }
     }
 }
+
+SCENARIO("PluginConfigurator: Plugins in mono chains are configured as mono when enabled") {
+    PluginConfigurator configurator;
+
+    GIVEN("A stereo host configuration and a plugin") {
+        typedef std::tuple<std::string, bool, bool> TestData;
+
+        auto [hostConfigString, isMonoChainsEnabled, supportsMono] = GENERATE(
+            TestData("stereo", true, true),
+            TestData("stereoSC", true, true),
+            TestData("stereo", true, false),
+            TestData("stereoSC", true, false),
+            TestData("stereo", false, true),
+            TestData("stereoSC", false, true)
+        );
+
+        PluginConfigurator::setMonoChainsEnabled(isMonoChainsEnabled);
+
+        const HostConfiguration hostConfig = getHostConfig(hostConfigString);
+
+        std::vector<juce::AudioProcessor::BusesLayout> testedLayouts;
+        auto plugin = std::make_shared<ConfigTestPluginInstance>([supportsMono = supportsMono, &testedLayouts](const juce::AudioProcessor::BusesLayout& layout) {
+            testedLayouts.push_back(layout);
+            return supportsMono || layout.getMainInputChannels() == 2;
+        });
+
+        WHEN("Asked to configure it for a mono chain") {
+            const bool success {configurator.configure(plugin, hostConfig, true)};
+
+            THEN("Mono is used if enabled and supported, otherwise it falls back to stereo") {
+                CHECK(success);
+                CHECK(plugin->isPrepared);
+
+                const bool expectMono {isMonoChainsEnabled && supportsMono};
+                CHECK(plugin->getBusesLayout().getMainInputChannels() == (expectMono ? 1 : 2));
+
+                if (isMonoChainsEnabled) {
+                    CHECK(testedLayouts[0].getMainInputChannels() == 1);
+                    CHECK(layoutHasSidechain(testedLayouts[0]) == (hostConfigString == "stereoSC"));
+                } else {
+                    CHECK(testedLayouts[0] == getExpectedLayouts(hostConfigString)[0]);
+                }
+
+                // A plugin that fell back to stereo isn't tried as mono again
+                CHECK_FALSE(configurator.needsReconfiguring(plugin, hostConfig, true));
+                CHECK_FALSE(PluginConfigurator().needsReconfiguring(plugin, hostConfig, true));
+            }
+        }
+
+        WHEN("It's configured for a mono chain then reconfigured for a stereo chain") {
+            REQUIRE(configurator.configure(plugin, hostConfig, true));
+            const bool needsReconfiguring {configurator.needsReconfiguring(plugin, hostConfig, false)};
+            const bool success {configurator.reconfigure(plugin, hostConfig, false)};
+
+            THEN("It's stereo and can be processed again") {
+                CHECK(needsReconfiguring == (isMonoChainsEnabled && supportsMono));
+                CHECK(success);
+                CHECK(plugin->getBusesLayout().getMainInputChannels() == 2);
+                CHECK_FALSE(plugin->isSuspended());
+                CHECK_FALSE(configurator.needsReconfiguring(plugin, hostConfig, false));
+            }
+        }
+
+        PluginConfigurator::setMonoChainsEnabled(false);
+    }
+}
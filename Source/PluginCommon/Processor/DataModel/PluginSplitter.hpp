@@ -1,13 +1,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <set>
 
 #include "ChainMutators.hpp"
 #include "PluginChain.hpp"
-#include "FFTProvider.hpp"
 #include "CrossoverState.hpp"
 #include "CrossoverMutators.hpp"
 #include "CrossoverProcessors.hpp"
+#include "SplitTypes.hpp"
 
 /**
  * Stores a plugin chain and any associated data.
@@ -31,6 +32,9 @@ struct PluginChainWrapper {
  */
 class PluginSplitter {
 public:
+    // Lets the processors dispatch on the type of splitter without RTTI
+    const SPLIT_TYPE splitType;
+
     std::vector<PluginChainWrapper> chains;
     size_t numChainsSoloed;
     HostConfiguration config;
@@ -38,11 +42,13 @@ public:
     std::function<void(int)> notifyProcessorOnLatencyChange;
     bool shouldNotifyProcessorOnLatencyChange;
 
-    PluginSplitter(int defaultNumChains,
+    PluginSplitter(SPLIT_TYPE newSplitType,
+                   int defaultNumChains,
                    HostConfiguration newConfig,
                    std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
                    std::function<void(int)> latencyChangeCallback)
-                   : numChainsSoloed(0),
+                   : splitType(newSplitType),
+                     numChainsSoloed(0),
                      config(newConfig),
                      getModulationValueCallback(newGetModulationValueCallback),
                      notifyProcessorOnLatencyChange(latencyChangeCallback),
@@ -56,17 +62,24 @@ public:
         onLatencyChange();
     }
 
-    PluginSplitter(std::shared_ptr<PluginSplitter> otherSplitter, int defaultNumChains)
-                   : chains(otherSplitter->chains),
+    PluginSplitter(SPLIT_TYPE newSplitType, std::shared_ptr<PluginSplitter> otherSplitter, int defaultNumChains)
+                   : splitType(newSplitType),
+                     chains(otherSplitter->chains),
                      numChainsSoloed(otherSplitter->numChainsSoloed),
                      config(otherSplitter->config),
                      getModulationValueCallback(otherSplitter->getModulationValueCallback),
                      notifyProcessorOnLatencyChange(otherSplitter->notifyProcessorOnLatencyChange),
                      shouldNotifyProcessorOnLatencyChange(true) {
 
-        // Move the latency listeners for the existing chains to point to this splitter
+        // Chains the other splitter shares with the one it was cloned from are still shared, the
+        // rest now belong to this splitter so move their latency listeners to point to it
+        _sharedChains = otherSplitter->_sharedChains;
+        _isPublished = otherSplitter->_isPublished;
+
         for (auto& chain : chains) {
-            chain.chain->latencyListener.setSplitter(this);
+            if (!isShared(chain.chain)) {
+                chain.chain->latencyListener.setSplitter(this);
+            }
         }
 
         // Add chains if we still need to reach the default
@@ -77,11 +90,17 @@ public:
         onLatencyChange();
     }
 
-    virtual ~PluginSplitter() = default;
+    virtual ~PluginSplitter() {
+        // Chains can outlive this splitter if they're shared with another one
+        for (PluginChainWrapper& chain : chains) {
+            chain.chain->latencyListener.removeSplitter(this);
+        }
+    }
 
-    void onLatencyChange() {
-        // The latency of the splitter is the latency of the slowest chain, so iterate through each
-        // chain and report the highest latency
+    /**
+     * The latency of the splitter is the latency of the slowest chain.
+     */
+    int getLatencySamples() const {
         int highestLatency {0};
 
         for (const PluginChainWrapper& chain : chains) {
@@ -91,10 +110,16 @@ public:
             }
         }
 
-        // Tell each chain the latency of the slowest chain, so they can all add compensation to match
-        // it
-        for (PluginChainWrapper& chain : chains) {
-            ChainMutators::setRequiredLatency(chain.chain, highestLatency, config);
+        return highestLatency;
+    }
+
+    void onLatencyChange() {
+        const int highestLatency {getLatencySamples()};
+
+        // The compensation of a chain can be shared with other splitters, so only the published
+        // splitter sets it. The others set it when they're published.
+        if (_isPublished) {
+            _setRequiredLatency(highestLatency);
         }
 
         if (shouldNotifyProcessorOnLatencyChange) {
@@ -102,28 +127,126 @@ public:
         }
     }
 
+    /**
+     * The copy shares the chains with this splitter until they're written to with
+     * getChainForWrite(), so an edit only copies the chain it changes.
+     */
     virtual PluginSplitter* clone() const = 0;
 
+    /**
+     * Return the chain at the given index so it can be changed, copying it first if it's still
+     * shared with the splitter this was cloned from. The index must be valid.
+     *
+     * Copying replaces the chain in this splitter, so this must only be called on a splitter that
+     * hasn't been published yet.
+     */
+    std::shared_ptr<PluginChain> getChainForWrite(size_t index) {
+        if (isShared(chains[index].chain)) {
+            return replaceChainWithCopy(index);
+        }
+
+        return chains[index].chain;
+    }
+
+    /**
+     * Replaces the chain at the given index with a copy whether it's shared or not, and returns the
+     * copy. Its slots are still shared.
+     */
+    std::shared_ptr<PluginChain> replaceChainWithCopy(size_t index) {
+        std::shared_ptr<PluginChain>& chain = chains[index].chain;
+        _sharedChains.erase(chain);
+
+        chain.reset(chain->clone());
+        chain->latencyListener.setSplitter(this);
+        _onChainReplaced(index);
+
+        return chain;
+    }
+
+    /**
+     * True if the chain is still shared with the splitter this was cloned from.
+     */
+    bool isShared(const std::shared_ptr<PluginChain>& chain) const {
+        return _sharedChains.find(chain) != _sharedChains.end();
+    }
+
+    /**
+     * Called with mutatorsMutex held just before this splitter is published. The audio thread is
+     * about to process its chains, so from here on only their compensation is changed, in place, and
+     * their latency changes are sent to this splitter.
+     */
+    void onPublished() {
+        // Set the compensation while the chains can still be copied, the splitter that's being
+        // replaced may be processing the ones it shares with this one
+        _setRequiredLatency(getLatencySamples());
+        _sharedChains.clear();
+        _isPublished = true;
+
+        for (PluginChainWrapper& chain : chains) {
+            chain.chain->latencyListener.setSplitter(this);
+        }
+    }
+
+    /**
+     * Called with mutatorsMutex held when another splitter is published in place of this one. Its
+     * chains may now be shared with the published splitter, so it stops setting their compensation.
+     */
+    void onUnpublished() {
+        _isPublished = false;
+    }
+
 protected:
-    PluginSplitter(std::vector<PluginChainWrapper> newChains,
+    PluginSplitter(SPLIT_TYPE newSplitType,
+                   std::vector<PluginChainWrapper> newChains,
                    HostConfiguration newConfig,
                    std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
                    std::function<void(int)> newNotifyProcessorOnLatencyChange) :
+                       splitType(newSplitType),
                        numChainsSoloed(0),
                        config(newConfig),
                        getModulationValueCallback(newGetModulationValueCallback),
                        notifyProcessorOnLatencyChange(newNotifyProcessorOnLatencyChange),
                        shouldNotifyProcessorOnLatencyChange(true) {
+        // The chains' latency listeners keep pointing to the splitter being processed until this
+        // one is published
+        _isPublished = false;
+
         for (auto& chain : newChains) {
-            std::shared_ptr<PluginChain> newChain(chain.chain->clone());
-            newChain->latencyListener.setSplitter(this);
+            chains.emplace_back(chain.chain, chain.isSoloed);
+            _sharedChains.insert(chain.chain);
 
-            chains.emplace_back(newChain, chain.isSoloed);
             if (chain.isSoloed) {
                 numChainsSoloed++;
             }
         }
     }
+
+    /**
+     * Called when the chain at the given index has been replaced with a copy.
+     */
+    virtual void _onChainReplaced(size_t /*index*/) { }
+
+private:
+    // Splitters that aren't clones don't share their chains, so they're treated as published until
+    // another splitter is
+    bool _isPublished {true};
+
+    // Chains inherited from the splitter this was cloned from that haven't been copied yet. Weak so
+    // a chain that has since been deleted can't be mistaken for a new one at the same address.
+    std::set<std::weak_ptr<PluginChain>, std::owner_less<>> _sharedChains;
+
+    /**
+     * Tells each chain the latency of the slowest chain, so they can all add compensation to match
+     * it. The compensation belongs to this splitter, so a chain still shared with the splitter this
+     * was cloned from is copied before it's changed.
+     */
+    void _setRequiredLatency(int highestLatency) {
+        for (size_t index {0}; index < chains.size(); index++) {
+            if (ChainMutators::isRequiredLatencyChanged(chains[index].chain, highestLatency)) {
+                ChainMutators::setRequiredLatency(getChainForWrite(index), highestLatency);
+            }
+        }
+    }
 };
 
 /**
@@ -136,16 +259,18 @@ public:
     PluginSplitterSeries(HostConfiguration newConfig,
                          std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                          std::function<void(int)> latencyChangeCallback)
-                         : PluginSplitter(DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
+                         : PluginSplitter(SPLIT_TYPE::SERIES, DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
         juce::Logger::writeToLog("Constructed PluginSplitterSeries");
     }
 
     PluginSplitterSeries(std::shared_ptr<PluginSplitter> otherSplitter)
-                         : PluginSplitter(otherSplitter, DEFAULT_NUM_CHAINS) {
+                         : PluginSplitter(SPLIT_TYPE::SERIES, otherSplitter, DEFAULT_NUM_CHAINS) {
         juce::Logger::writeToLog("Converted to PluginSplitterSeries");
 
         // We only have one active chain in the series splitter, so it can't be muted or soloed
-        ChainMutators::setChainMute(chains[0].chain, false);
+        if (chains[0].chain->isChainMuted) {
+            ChainMutators::setChainMute(getChainForWrite(0), false);
+        }
     }
 
     PluginSplitterSeries* clone() const override {
@@ -157,7 +282,7 @@ private:
                          HostConfiguration newConfig,
                          std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
                          std::function<void(int)> newNotifyProcessorOnLatencyChange) :
-                                PluginSplitter(newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
+                                PluginSplitter(SPLIT_TYPE::SERIES, newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
     }
 };
 
@@ -168,42 +293,28 @@ class PluginSplitterParallel : public PluginSplitter {
 public:
     static constexpr int DEFAULT_NUM_CHAINS {1};
 
-    std::unique_ptr<juce::AudioBuffer<float>> inputBuffer;
-    std::unique_ptr<juce::AudioBuffer<float>> outputBuffer;
-
     PluginSplitterParallel(HostConfiguration newConfig,
                            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                            std::function<void(int)> latencyChangeCallback)
-                           : PluginSplitter(DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
+                           : PluginSplitter(SPLIT_TYPE::PARALLEL, DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
         juce::Logger::writeToLog("Constructed PluginSplitterParallel");
     }
 
     PluginSplitterParallel(std::shared_ptr<PluginSplitter> otherSplitter)
-                           : PluginSplitter(otherSplitter, DEFAULT_NUM_CHAINS) {
+                           : PluginSplitter(SPLIT_TYPE::PARALLEL, otherSplitter, DEFAULT_NUM_CHAINS) {
         juce::Logger::writeToLog("Converted to PluginSplitterParallel");
     }
 
     PluginSplitterParallel* clone() const override {
-        return new PluginSplitterParallel(
-            chains,
-            config,
-            getModulationValueCallback,
-            notifyProcessorOnLatencyChange,
-            *inputBuffer,
-            *outputBuffer);
+        return new PluginSplitterParallel(chains, config, getModulationValueCallback, notifyProcessorOnLatencyChange);
     }
 
 private:
     PluginSplitterParallel(std::vector<PluginChainWrapper> newChains,
                            HostConfiguration newConfig,
                            std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
-                           std::function<void(int)> newNotifyProcessorOnLatencyChange,
-                           const juce::AudioBuffer<float>& newInputBuffer,
-                           const juce::AudioBuffer<float>& newOutputBuffer) :
-                                PluginSplitter(newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
-        // We need to copy the buffers as well
-        inputBuffer.reset(new juce::AudioBuffer<float>(newInputBuffer));
-        outputBuffer.reset(new juce::AudioBuffer<float>(newOutputBuffer));
+                           std::function<void(int)> newNotifyProcessorOnLatencyChange) :
+                                PluginSplitter(SPLIT_TYPE::PARALLEL, newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
     }
 };
 
@@ -215,12 +326,11 @@ public:
     static constexpr int DEFAULT_NUM_CHAINS {2};
 
     std::shared_ptr<CrossoverState> crossover;
-    FFTProvider fftProvider;
 
     PluginSplitterMultiband(HostConfiguration newConfig,
                             std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                             std::function<void(int)> latencyChangeCallback)
-                            : PluginSplitter(DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback),
+                            : PluginSplitter(SPLIT_TYPE::MULTIBAND, DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback),
                               crossover(createDefaultCrossoverState(config)) {
         juce::Logger::writeToLog("Constructed PluginSplitterMultiband");
 
@@ -228,7 +338,7 @@ public:
     }
 
     PluginSplitterMultiband(std::shared_ptr<PluginSplitter> otherSplitter, std::optional<std::vector<float>> crossoverFrequencies)
-                            : PluginSplitter(otherSplitter, DEFAULT_NUM_CHAINS),
+                            : PluginSplitter(SPLIT_TYPE::MULTIBAND, otherSplitter, DEFAULT_NUM_CHAINS),
                               crossover(createDefaultCrossoverState(config)) {
         juce::Logger::writeToLog("Converted to PluginSplitterMultiband");
 
@@ -263,25 +373,30 @@ public:
             notifyProcessorOnLatencyChange,
             std::shared_ptr<CrossoverState>(crossover->clone()));
 
-        // The crossover we cloned needs to be updated to use the new chains that were just cloned
+        // Make sure the crossover we cloned uses the same chains as the splitter
         for (int chainIndex {0}; chainIndex < clonedSplitter->chains.size(); chainIndex++) {
             CrossoverMutators::setPluginChain(clonedSplitter->crossover, chainIndex, clonedSplitter->chains[chainIndex].chain);
         }
 
-        // Set up the fft provider
-        clonedSplitter->fftProvider.setSampleRate(config.sampleRate);
-        clonedSplitter->fftProvider.setIsStereo(canDoStereoSplitTypes(config.layout));
-
         return clonedSplitter;
     }
 
+protected:
+    void _onChainReplaced(size_t index) override {
+        // The crossover may not have a band for every chain while it's being converted from another
+        // splitter, it's set up once it has
+        if (index < CrossoverMutators::getNumBands(crossover)) {
+            CrossoverMutators::setPluginChain(crossover, index, chains[index].chain);
+        }
+    }
+
 private:
     PluginSplitterMultiband(std::vector<PluginChainWrapper> newChains,
                             HostConfiguration newConfig,
                             std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
                             std::function<void(int)> newNotifyProcessorOnLatencyChange,
                             std::shared_ptr<CrossoverState> newCrossover) :
-                                PluginSplitter(newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange),
+                                PluginSplitter(SPLIT_TYPE::MULTIBAND, newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange),
                                 crossover(newCrossover) {
     }
 };
@@ -293,42 +408,28 @@ class PluginSplitterLeftRight : public PluginSplitter {
 public:
     static constexpr int DEFAULT_NUM_CHAINS {2};
 
-    std::unique_ptr<juce::AudioBuffer<float>> leftBuffer;
-    std::unique_ptr<juce::AudioBuffer<float>> rightBuffer;
-
     PluginSplitterLeftRight(HostConfiguration newConfig,
                             std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                             std::function<void(int)> latencyChangeCallback)
-                            : PluginSplitter(DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
+                            : PluginSplitter(SPLIT_TYPE::LEFTRIGHT, DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
         juce::Logger::writeToLog("Constructed PluginSplitterLeftRight");
     }
 
     PluginSplitterLeftRight(std::shared_ptr<PluginSplitter> otherSplitter)
-                            : PluginSplitter(otherSplitter, DEFAULT_NUM_CHAINS) {
+                            : PluginSplitter(SPLIT_TYPE::LEFTRIGHT, otherSplitter, DEFAULT_NUM_CHAINS) {
         juce::Logger::writeToLog("Converted to PluginSplitterLeftRight");
     }
 
     PluginSplitterLeftRight* clone() const override {
-        return new PluginSplitterLeftRight(
-            chains,
-            config,
-            getModulationValueCallback,
-            notifyProcessorOnLatencyChange,
-            *leftBuffer,
-            *rightBuffer);
+        return new PluginSplitterLeftRight(chains, config, getModulationValueCallback, notifyProcessorOnLatencyChange);
     }
 
 private:
     PluginSplitterLeftRight(std::vector<PluginChainWrapper> newChains,
                             HostConfiguration newConfig,
                             std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
-                            std::function<void(int)> newNotifyProcessorOnLatencyChange,
-                            const juce::AudioBuffer<float>& newLeftBuffer,
-                            const juce::AudioBuffer<float>& newRightBuffer) :
-                                PluginSplitter(newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
-        // We need to copy the buffers as well
-        leftBuffer.reset(new juce::AudioBuffer<float>(newLeftBuffer));
-        rightBuffer.reset(new juce::AudioBuffer<float>(newRightBuffer));
+                            std::function<void(int)> newNotifyProcessorOnLatencyChange) :
+                                PluginSplitter(SPLIT_TYPE::LEFTRIGHT, newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
     }
 };
 
@@ -339,41 +440,27 @@ class PluginSplitterMidSide : public PluginSplitter {
 public:
     static constexpr int DEFAULT_NUM_CHAINS {2};
 
-    std::unique_ptr<juce::AudioBuffer<float>> midBuffer;
-    std::unique_ptr<juce::AudioBuffer<float>> sideBuffer;
-
     PluginSplitterMidSide(HostConfiguration newConfig,
                           std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
                           std::function<void(int)> latencyChangeCallback)
-                          : PluginSplitter(DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
+                          : PluginSplitter(SPLIT_TYPE::MIDSIDE, DEFAULT_NUM_CHAINS, newConfig, getModulationValueCallback, latencyChangeCallback) {
         juce::Logger::writeToLog("Constructed PluginSplitterMidSide");
     }
 
     PluginSplitterMidSide(std::shared_ptr<PluginSplitter> otherSplitter)
-                          : PluginSplitter(otherSplitter, DEFAULT_NUM_CHAINS) {
+                          : PluginSplitter(SPLIT_TYPE::MIDSIDE, otherSplitter, DEFAULT_NUM_CHAINS) {
         juce::Logger::writeToLog("Converted to PluginSplitterMidSide");
     }
 
     PluginSplitterMidSide* clone() const override {
-        return new PluginSplitterMidSide(
-            chains,
-            config,
-            getModulationValueCallback,
-            notifyProcessorOnLatencyChange,
-            *midBuffer,
-            *sideBuffer);
+        return new PluginSplitterMidSide(chains, config, getModulationValueCallback, notifyProcessorOnLatencyChange);
     }
 
 private:
     PluginSplitterMidSide(std::vector<PluginChainWrapper> newChains,
                           HostConfiguration newConfig,
                           std::function<float(int, MODULATION_TYPE)> newGetModulationValueCallback,
-                          std::function<void(int)> newNotifyProcessorOnLatencyChange,
-                          const juce::AudioBuffer<float>& newMidBuffer,
-                          const juce::AudioBuffer<float>& newSideBuffer) :
-                              PluginSplitter(newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
-        // We need to copy the buffers as well
-        midBuffer.reset(new juce::AudioBuffer<float>(newMidBuffer));
-        sideBuffer.reset(new juce::AudioBuffer<float>(newSideBuffer));
+                          std::function<void(int)> newNotifyProcessorOnLatencyChange) :
+                              PluginSplitter(SPLIT_TYPE::MIDSIDE, newChains, newConfig, newGetModulationValueCallback, newNotifyProcessorOnLatencyChange) {
     }
 };
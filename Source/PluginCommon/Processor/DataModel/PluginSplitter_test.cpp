@@ -13,30 +13,9 @@ namespace {
             PluginChainWrapper originalChain = original->chains[chainIndex];
             PluginChainWrapper clonedChain = clone->chains[chainIndex];
 
-            REQUIRE(originalChain.chain->chain.size() == clonedChain.chain->chain.size());
+            // The chains are shared until one of the splitters writes to them
+            CHECK(clonedChain.chain == originalChain.chain);
             CHECK(originalChain.isSoloed == clonedChain.isSoloed);
-
-            for (int slotIndex {0}; slotIndex < originalChain.chain->chain.size(); slotIndex++) {
-                std::shared_ptr<ChainSlotBase> originalSlot = originalChain.chain->chain[slotIndex];
-                std::shared_ptr<ChainSlotBase> clonedSlot = clonedChain.chain->chain[slotIndex];
-
-                if (std::shared_ptr<ChainSlotPlugin> originalPluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(originalSlot)) {
-                    // It's a plugin slot, check the plugin
-                    auto clonedPluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(clonedSlot);
-                    REQUIRE(clonedPluginSlot != nullptr);
-                    CHECK(clonedPluginSlot->plugin == originalPluginSlot->plugin);
-                    CHECK(clonedPluginSlot->modulationConfig != originalPluginSlot->modulationConfig);
-                } else {
-                    // It's a gain stage, check the values
-                    auto originalGainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(originalSlot);
-                    auto clonedGainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(clonedSlot);
-                    REQUIRE(originalGainStage != nullptr);
-                    REQUIRE(clonedGainStage != nullptr);
-
-                    CHECK(clonedGainStage->gain == originalGainStage->gain);
-                    CHECK(clonedGainStage->pan == originalGainStage->pan);
-                }
-            }
         }
 
         CHECK(original->numChainsSoloed == clone->numChainsSoloed);
@@ -47,23 +26,6 @@ namespace {
         CHECK(clone->getModulationValueCallback(0, MODULATION_TYPE::MACRO) == 1.2f);
         CHECK(clone->shouldNotifyProcessorOnLatencyChange == true);
     }
-
-    void checkBuffers(juce::AudioBuffer<float>& buffer1, juce::AudioBuffer<float>& buffer2) {
-        // Check the buffers are the same size
-        REQUIRE(buffer1.getNumChannels() == buffer2.getNumChannels());
-        REQUIRE(buffer1.getNumSamples() == buffer2.getNumSamples());
-
-        // Check the buffers have the same values
-        for (int channelIndex {0}; channelIndex < buffer1.getNumChannels(); channelIndex++) {
-            for (int sampleIndex {0}; sampleIndex < buffer1.getNumSamples(); sampleIndex++) {
-                CHECK(buffer1.getReadPointer(channelIndex)[sampleIndex] == buffer2.getReadPointer(channelIndex)[sampleIndex]);
-            }
-        }
-
-        // Mofify one of the buffers, check they're different
-        buffer1.getWritePointer(0)[0] = 0.5f;
-        CHECK(buffer1.getReadPointer(0)[0] != buffer2.getReadPointer(0)[0]);
-    }
 }
 
 SCENARIO("PluginSplitterSeries: Clone works correctly") {
@@ -105,6 +67,10 @@ SCENARIO("PluginSplitterSeries: Clone works correctly") {
             PluginSplitterSeries* clonedSplitter = splitter->clone();
             splitter->shouldNotifyProcessorOnLatencyChange = false;
 
+            // Published in place of the original, as the state manager would
+            splitter->onUnpublished();
+            clonedSplitter->onPublished();
+
             THEN("The cloned splitter is equal to the original") {
                 checkSplitterCommon(splitter.get(), clonedSplitter);
 
@@ -166,6 +132,10 @@ SCENARIO("PluginSplitterParallel: Clone works correctly") {
             PluginSplitterParallel* clonedSplitter = splitter->clone();
             splitter->shouldNotifyProcessorOnLatencyChange = false;
 
+            // Published in place of the original, as the state manager would
+            splitter->onUnpublished();
+            clonedSplitter->onPublished();
+
             THEN("The cloned splitter is equal to the original") {
                 checkSplitterCommon(splitter.get(), clonedSplitter);
 
@@ -175,10 +145,6 @@ SCENARIO("PluginSplitterParallel: Clone works correctly") {
                 messageManager->runDispatchLoopUntil(10);
                 CHECK(latencyCalled == 1);
                 CHECK(receivedLatency == 15);
-
-                // Check that the buffers are equal
-                checkBuffers(*splitter->inputBuffer, *clonedSplitter->inputBuffer);
-                checkBuffers(*splitter->outputBuffer, *clonedSplitter->outputBuffer);
             }
 
             delete clonedSplitter;
@@ -244,6 +210,10 @@ SCENARIO("PluginSplitterMultiband: Clone works correctly") {
             PluginSplitterMultiband* clonedSplitter = splitter->clone();
             splitter->shouldNotifyProcessorOnLatencyChange = false;
 
+            // Published in place of the original, as the state manager would
+            splitter->onUnpublished();
+            clonedSplitter->onPublished();
+
             THEN("The cloned splitter is equal to the original") {
                 checkSplitterCommon(splitter.get(), clonedSplitter);
 
@@ -257,9 +227,8 @@ SCENARIO("PluginSplitterMultiband: Clone works correctly") {
                 // Check the crossover is equal but not the same
                 CHECK(splitter->crossover != clonedSplitter->crossover);
                 CHECK(splitter->crossover->bands[0].chain == originalChain);
-                CHECK(clonedSplitter->crossover->bands[0].chain != originalChain);
+                CHECK(clonedSplitter->crossover->bands[0].chain == originalChain);
                 CHECK(splitter->crossover->lowpassFilters.size() == clonedSplitter->crossover->lowpassFilters.size());
-                CHECK(splitter->crossover->highpassFilters.size() == clonedSplitter->crossover->highpassFilters.size());
                 CHECK(splitter->crossover->allpassFilters.size() == clonedSplitter->crossover->allpassFilters.size());
                 CHECK(splitter->crossover->buffers.size() == clonedSplitter->crossover->buffers.size());
                 CHECK(splitter->crossover->bands.size() == clonedSplitter->crossover->bands.size());
@@ -271,8 +240,6 @@ SCENARIO("PluginSplitterMultiband: Clone works correctly") {
                 for (int filterIndex {0}; filterIndex < splitter->crossover->lowpassFilters.size(); filterIndex++) {
                     CHECK(splitter->crossover->lowpassFilters[filterIndex]->getType() == clonedSplitter->crossover->lowpassFilters[filterIndex]->getType());
                     CHECK(splitter->crossover->lowpassFilters[filterIndex]->getCutoffFrequency() == clonedSplitter->crossover->lowpassFilters[filterIndex]->getCutoffFrequency());
-                    CHECK(splitter->crossover->highpassFilters[filterIndex]->getType() == clonedSplitter->crossover->highpassFilters[filterIndex]->getType());
-                    CHECK(splitter->crossover->highpassFilters[filterIndex]->getCutoffFrequency() == clonedSplitter->crossover->highpassFilters[filterIndex]->getCutoffFrequency());
                 }
 
                 for (int filterIndex {0}; filterIndex < splitter->crossover->allpassFilters.size(); filterIndex++) {
@@ -283,6 +250,24 @@ SCENARIO("PluginSplitterMultiband: Clone works correctly") {
 
             delete clonedSplitter;
         }
+
+        WHEN("It is cloned and a chain in the clone is written to") {
+            PluginSplitterMultiband* clonedSplitter = splitter->clone();
+            std::shared_ptr<PluginChain> writtenChain = clonedSplitter->getChainForWrite(0);
+
+            THEN("Only that chain is copied and the cloned crossover uses the copy") {
+                CHECK(writtenChain != originalChain);
+                CHECK(clonedSplitter->chains[0].chain == writtenChain);
+                CHECK(clonedSplitter->crossover->bands[0].chain == writtenChain);
+                CHECK(clonedSplitter->chains[1].chain == splitter->chains[1].chain);
+
+                // The original is unchanged
+                CHECK(splitter->chains[0].chain == originalChain);
+                CHECK(splitter->crossover->bands[0].chain == originalChain);
+            }
+
+            delete clonedSplitter;
+        }
     }
 
     juce::MessageManager::deleteInstance();
@@ -330,6 +315,10 @@ SCENARIO("PluginSplitterLeftRight: Clone works correctly") {
             PluginSplitterLeftRight* clonedSplitter = splitter->clone();
             splitter->shouldNotifyProcessorOnLatencyChange = false;
 
+            // Published in place of the original, as the state manager would
+            splitter->onUnpublished();
+            clonedSplitter->onPublished();
+
             THEN("The cloned splitter is equal to the original") {
                 checkSplitterCommon(splitter.get(), clonedSplitter);
 
@@ -339,10 +328,6 @@ SCENARIO("PluginSplitterLeftRight: Clone works correctly") {
                 messageManager->runDispatchLoopUntil(10);
                 CHECK(latencyCalled == 1);
                 CHECK(receivedLatency == 15);
-
-                // Check that the buffers are equal
-                checkBuffers(*splitter->leftBuffer, *clonedSplitter->leftBuffer);
-                checkBuffers(*splitter->rightBuffer, *clonedSplitter->rightBuffer);
             }
 
             delete clonedSplitter;
@@ -397,16 +382,16 @@ SCENARIO("PluginSplitterMidSide: Clone works correctly") {
                 checkSplitterCommon(splitter.get(), clonedSplitter);
                 splitter->shouldNotifyProcessorOnLatencyChange = false;
 
+                // Published in place of the original, as the state manager would
+                splitter->onUnpublished();
+                clonedSplitter->onPublished();
+
                 // Check that when a plugin updates its latency, the latency callback is called from
                 // the new splitter only
                 plugin->setLatencySamples(15);
                 messageManager->runDispatchLoopUntil(10);
                 CHECK(latencyCalled == 1);
                 CHECK(receivedLatency == 15);
-
-                // Check that the buffers are equal
-                checkBuffers(*splitter->midBuffer, *clonedSplitter->midBuffer);
-                checkBuffers(*splitter->sideBuffer, *clonedSplitter->sideBuffer);
             }
 
             delete clonedSplitter;
@@ -414,4 +399,60 @@ SCENARIO("PluginSplitterMidSide: Clone works correctly") {
     }
 
     juce::MessageManager::deleteInstance();
-}
\ No newline at end of file
+}
+
+SCENARIO("PluginSplitter: Changing a clone only copies the chain and slot that are changed") {
+    auto messageManager = juce::MessageManager::getInstance();
+
+    GIVEN("A parallel splitter with two chains") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = 44100;
+        hostConfig.blockSize = 10;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) { return 0.0f; };
+        auto latencyCallback = [](int) { };
+
+        auto splitter = std::make_shared<PluginSplitterParallel>(hostConfig, modulationCallback, latencyCallback);
+
+        auto plugin = std::make_shared<TestUtils::TestPluginInstance>();
+        SplitterMutators::insertPlugin(splitter, plugin, 0, 0);
+        SplitterMutators::addChain(splitter);
+        SplitterMutators::insertGainStage(splitter, 1, 0);
+        SplitterMutators::insertGainStage(splitter, 1, 1);
+
+        SplitterProcessors::prepareToPlay(*splitter.get(), hostConfig.sampleRate, hostConfig.blockSize, hostConfig.layout);
+
+        REQUIRE(splitter->chains.size() == 2);
+        REQUIRE(splitter->chains[1].chain->chain.size() == 2);
+
+        WHEN("It is cloned and a gain stage in the clone is changed") {
+            std::shared_ptr<PluginSplitter> clonedSplitter(splitter->clone());
+            SplitterMutators::setGainLinear(clonedSplitter, 1, 0, 0.5);
+
+            THEN("Only the chain and slot that were changed are copied") {
+                CHECK(clonedSplitter->chains[0].chain == splitter->chains[0].chain);
+                CHECK(clonedSplitter->chains[1].chain != splitter->chains[1].chain);
+                CHECK(clonedSplitter->chains[1].chain->chain[0] != splitter->chains[1].chain->chain[0]);
+                CHECK(clonedSplitter->chains[1].chain->chain[1] == splitter->chains[1].chain->chain[1]);
+
+                CHECK(SplitterMutators::getGainLinear(clonedSplitter, 1, 0) == Approx(0.5));
+                CHECK(SplitterMutators::getGainLinear(splitter, 1, 0) == Approx(1.0));
+            }
+
+            AND_WHEN("The same gain stage is changed again") {
+                std::shared_ptr<ChainSlotBase> copiedSlot = clonedSplitter->chains[1].chain->chain[0];
+                SplitterMutators::setGainLinear(clonedSplitter, 1, 0, 0.25);
+
+                THEN("It isn't copied again") {
+                    CHECK(clonedSplitter->chains[1].chain->chain[0] == copiedSlot);
+                    CHECK(SplitterMutators::getGainLinear(clonedSplitter, 1, 0) == Approx(0.25));
+                    CHECK(SplitterMutators::getGainLinear(splitter, 1, 0) == Approx(1.0));
+                }
+            }
+        }
+    }
+
+    juce::MessageManager::deleteInstance();
+}
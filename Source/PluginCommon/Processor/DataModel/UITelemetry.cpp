@@ -0,0 +1,36 @@
+#include "UITelemetry.hpp"
+
+UITelemetry::UITelemetry() : _middleIndex(1), _writeIndex(0), _nextVersion(1), _readIndex(2) {
+    for (Snapshot& snapshot : _snapshots) {
+        snapshot.version = 0;
+        snapshot.publishedTimeMs = 0;
+
+        for (SourceTypeValues* values : {&snapshot.lfos, &snapshot.envelopes, &snapshot.randomSources, &snapshot.stepSequencers}) {
+            values->numSources = 0;
+            values->sources.fill(SourceValues{0, 0, 0, 0});
+        }
+    }
+}
+
+void UITelemetry::publish() {
+    Snapshot& snapshot = _snapshots[_writeIndex];
+    snapshot.version = _nextVersion++;
+    snapshot.publishedTimeMs = juce::Time::getMillisecondCounter();
+
+    // Swap the finished snapshot into the middle and carry on with whichever one was there
+    _writeIndex = _middleIndex.exchange(_writeIndex | HAS_NEW_SNAPSHOT, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+const UITelemetry::Snapshot* UITelemetry::read() {
+    if (_middleIndex.load(std::memory_order_relaxed) & HAS_NEW_SNAPSHOT) {
+        _readIndex = _middleIndex.exchange(_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    const Snapshot& snapshot = _snapshots[_readIndex];
+
+    if (snapshot.version == 0 || juce::Time::getMillisecondCounter() - snapshot.publishedTimeMs > MAX_SNAPSHOT_AGE_MS) {
+        return nullptr;
+    }
+
+    return &snapshot;
+}
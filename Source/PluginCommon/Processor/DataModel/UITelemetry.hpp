@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Values the audio thread produces for the UI to display, written once per block.
+ *
+ * The snapshots are triple buffered: the audio thread always has a buffer of its own to write to
+ * and the reader always has a complete snapshot to read, so neither side ever waits for the other.
+ * The reader only sees the most recent snapshot, any published in between are skipped.
+ *
+ * There must only be one reading thread, in the plugin this is the message thread.
+ */
+class UITelemetry {
+public:
+    // Sources beyond this are read from the data model instead
+    static constexpr int MAX_NUM_SOURCES_PER_TYPE {16};
+
+    // A snapshot older than this is stale, most likely because the host has stopped processing
+    static constexpr juce::uint32 MAX_SNAPSHOT_AGE_MS {250};
+
+    struct SourceValues {
+        // The source's output as the UI displays it (envelopes include their amount)
+        float output;
+
+        // Parameter values with modulation applied, zero for parameters the source doesn't have
+        float modulatedFreq;
+        float modulatedDepth;
+        float modulatedPhase;
+    };
+
+    struct SourceTypeValues {
+        int numSources;
+        std::array<SourceValues, MAX_NUM_SOURCES_PER_TYPE> sources;
+
+        const SourceValues* get(int index) const {
+            return index >= 0 && index < numSources ? &sources[index] : nullptr;
+        }
+    };
+
+    struct Snapshot {
+        // Incremented for every snapshot published, 0 until the first one
+        juce::uint64 version;
+
+        // juce::Time::getMillisecondCounter() when the snapshot was published
+        juce::uint32 publishedTimeMs;
+
+        SourceTypeValues lfos;
+        SourceTypeValues envelopes;
+        SourceTypeValues randomSources;
+        SourceTypeValues stepSequencers;
+    };
+
+    UITelemetry();
+
+    /**
+     * Audio thread. Returns the snapshot to fill in for this block, which only becomes visible to
+     * the reader once it's published.
+     */
+    Snapshot& getSnapshotToWrite() { return _snapshots[_writeIndex]; }
+    void publish();
+
+    /**
+     * Reading thread. Returns the most recently published snapshot, or nullptr if nothing has been
+     * published recently.
+     */
+    const Snapshot* read();
+
+private:
+    static constexpr int INDEX_MASK {0x3};
+    static constexpr int HAS_NEW_SNAPSHOT {0x4};
+
+    std::array<Snapshot, 3> _snapshots;
+
+    // Index of the snapshot neither side is using, flagged when it holds one the reader hasn't seen
+    std::atomic<int> _middleIndex;
+
+    // Only used by the audio thread
+    int _writeIndex;
+    juce::uint64 _nextVersion;
+
+    // Only used by the reading thread
+    int _readIndex;
+};
@@ -0,0 +1,70 @@
+#include "catch.hpp"
+#include "UITelemetry.hpp"
+
+namespace {
+    void publishLfoOutput(UITelemetry& telemetry, float output) {
+        UITelemetry::Snapshot& snapshot = telemetry.getSnapshotToWrite();
+        snapshot.lfos.numSources = 1;
+        snapshot.lfos.sources[0].output = output;
+        telemetry.publish();
+    }
+}
+
+SCENARIO("UITelemetry: The reader sees the most recently published snapshot") {
+    GIVEN("A telemetry surface") {
+        UITelemetry telemetry;
+
+        WHEN("Nothing has been published") {
+            THEN("There's nothing to read") {
+                CHECK(telemetry.read() == nullptr);
+            }
+        }
+
+        WHEN("A snapshot is published") {
+            publishLfoOutput(telemetry, 0.5f);
+
+            THEN("The reader sees it") {
+                const UITelemetry::Snapshot* snapshot {telemetry.read()};
+                REQUIRE(snapshot != nullptr);
+                CHECK(snapshot->version == 1);
+                REQUIRE(snapshot->lfos.get(0) != nullptr);
+                CHECK(snapshot->lfos.get(0)->output == 0.5f);
+            }
+
+            AND_THEN("Sources that weren't written aren't available") {
+                const UITelemetry::Snapshot* snapshot {telemetry.read()};
+                REQUIRE(snapshot != nullptr);
+                CHECK(snapshot->lfos.get(1) == nullptr);
+                CHECK(snapshot->envelopes.get(0) == nullptr);
+            }
+
+            AND_THEN("The writer never writes to the snapshot being read") {
+                const UITelemetry::Snapshot* snapshot {telemetry.read()};
+                CHECK(&telemetry.getSnapshotToWrite() != snapshot);
+            }
+        }
+
+        WHEN("Several snapshots are published between reads") {
+            publishLfoOutput(telemetry, 0.1f);
+            publishLfoOutput(telemetry, 0.2f);
+            publishLfoOutput(telemetry, 0.3f);
+
+            THEN("The reader skips to the latest") {
+                const UITelemetry::Snapshot* snapshot {telemetry.read()};
+                REQUIRE(snapshot != nullptr);
+                CHECK(snapshot->version == 3);
+                CHECK(snapshot->lfos.get(0)->output == 0.3f);
+            }
+
+            AND_WHEN("Nothing more is published") {
+                telemetry.read();
+
+                THEN("The reader keeps the same snapshot") {
+                    const UITelemetry::Snapshot* snapshot {telemetry.read()};
+                    REQUIRE(snapshot != nullptr);
+                    CHECK(snapshot->version == 3);
+                }
+            }
+        }
+    }
+}
@@ -1,6 +1,15 @@
 #include "ChainMutators.hpp"
 #include "ChainSlotProcessors.hpp"
 
+namespace {
+    int getLatencyCompensation(const PluginChain& chain, int numSamples) {
+        // The compensation is the amount of latency we need to add artificially to the latency of the
+        // plugins in this chain in order to meet the required amount
+        // If this is the slowest chain owned by the splitter this should be 0
+        return std::max(numSamples - chain.latencyListener.calculatedTotalPluginLatency, 0);
+    }
+}
+
 namespace ChainMutators {
     void insertPlugin(std::shared_ptr<PluginChain> chain, std::shared_ptr<juce::AudioPluginInstance> plugin, int position, HostConfiguration config) {
         if (chain->chain.size() > position) {
@@ -10,6 +19,8 @@ namespace ChainMutators {
             chain->chain.push_back(std::make_shared<ChainSlotPlugin>(plugin, false, chain->getModulationValueCallback, config));
         }
 
+        chain->renderPlan.compile(chain->chain);
+        chain->pipeline->compile(chain->renderPlan);
         plugin->addListener(&chain->latencyListener);
         chain->latencyListener.onPluginChainUpdate();
     }
@@ -28,10 +39,61 @@ namespace ChainMutators {
             chain->chain.push_back(std::make_unique<ChainSlotPlugin>(plugin, false, chain->getModulationValueCallback, config));
         }
 
+        chain->renderPlan.compile(chain->chain);
+        chain->pipeline->compile(chain->renderPlan);
         plugin->addListener(&chain->latencyListener);
         chain->latencyListener.onPluginChainUpdate();
     }
 
+    bool swapPlugin(std::shared_ptr<PluginChain> chain,
+                    const juce::AudioPluginInstance* oldPlugin,
+                    std::shared_ptr<juce::AudioPluginInstance> newPlugin,
+                    HostConfiguration config,
+                    bool shouldCrossfade) {
+        bool isFound {false};
+
+        for (size_t index {0}; index < chain->chain.size(); index++) {
+            if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[index])) {
+                if (pluginSlot->plugin.get() == oldPlugin) {
+                    pluginSlot = std::static_pointer_cast<ChainSlotPlugin>(chain->getSlotForWrite(index));
+                    std::shared_ptr<juce::AudioPluginInstance> replacedPlugin = pluginSlot->plugin;
+
+                    replacedPlugin->removeListener(&chain->latencyListener);
+                    pluginSlot->plugin = newPlugin;
+                    newPlugin->addListener(&chain->latencyListener);
+
+                    // Also compiles the modulation matrix against the new plugin's parameters
+                    ChainProcessors::prepareToPlay(*pluginSlot, config);
+
+                    pluginSlot->swapCrossfade = shouldCrossfade ?
+                        std::make_shared<PluginSwapCrossfade>(replacedPlugin, getTotalNumInputChannels(config.layout), config.blockSize) : nullptr;
+
+                    isFound = true;
+                }
+            }
+        }
+
+        if (isFound) {
+            chain->renderPlan.compile(chain->chain);
+            chain->pipeline->compile(chain->renderPlan);
+            chain->latencyListener.onPluginChainUpdate();
+        }
+
+        return isFound;
+    }
+
+    bool containsPlugin(std::shared_ptr<PluginChain> chain, const juce::AudioPluginInstance* plugin) {
+        for (const std::shared_ptr<ChainSlotBase>& slot : chain->chain) {
+            if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                if (pluginSlot->plugin.get() == plugin) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
     bool removeSlot(std::shared_ptr<PluginChain> chain, int position) {
         if (chain->chain.size() > position) {
             // If it's a plugin remove the listener so we don't continue getting updates if it's kept
@@ -41,6 +103,8 @@ namespace ChainMutators {
             }
 
             chain->chain.erase(chain->chain.begin() + position);
+            chain->renderPlan.compile(chain->chain);
+            chain->pipeline->compile(chain->renderPlan);
             chain->latencyListener.onPluginChainUpdate();
             return true;
         }
@@ -59,6 +123,9 @@ namespace ChainMutators {
             // If the position is bigger than the chain just add it to the end
             chain->chain.push_back(std::move(gainStage));
         }
+
+        chain->renderPlan.compile(chain->chain);
+        chain->pipeline->compile(chain->renderPlan);
     }
 
     std::shared_ptr<juce::AudioPluginInstance> getPlugin(std::shared_ptr<PluginChain> chain, int position) {
@@ -75,7 +142,15 @@ namespace ChainMutators {
                                    PluginModulationConfig config,
                                    int position) {
         if (chain->chain.size() > position) {
-            if (const auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[position])) {
+            if (std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[position]) != nullptr) {
+                const auto pluginSlot = std::static_pointer_cast<ChainSlotPlugin>(chain->getSlotForWrite(position));
+
+                // Parameter changes can be applied to the compiled matrix in place, anything else needs
+                // it to be compiled again
+                if (!pluginSlot->modulationMatrix.updateValues(config)) {
+                    pluginSlot->modulationMatrix.compile(*pluginSlot->plugin, config);
+                }
+
                 pluginSlot->modulationConfig = std::make_shared<PluginModulationConfig>(config);
                 return true;
             }
@@ -89,7 +164,9 @@ namespace ChainMutators {
 
         if (chain->chain.size() > position) {
             if (const auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[position])) {
-                retVal = *pluginSlot->modulationConfig.get();
+                // Copy the parameter configs too, so changing them doesn't change the slot's
+                std::unique_ptr<PluginModulationConfig> configCopy(pluginSlot->modulationConfig->clone());
+                retVal = *configCopy;
             }
         }
 
@@ -99,7 +176,7 @@ namespace ChainMutators {
     bool setSlotBypass(std::shared_ptr<PluginChain> chain, int position, bool isBypassed) {
         if (chain->chain.size() > position) {
             if (chain->chain[position]->isBypassed != isBypassed) {
-                chain->chain[position]->isBypassed = isBypassed;
+                chain->getSlotForWrite(position)->isBypassed = isBypassed;
 
                 // Trigger an update to the latency compensation
                 chain->latencyListener.onPluginChainUpdate();
@@ -132,9 +209,9 @@ namespace ChainMutators {
 
     bool setGainLinear(std::shared_ptr<PluginChain> chain, int position, float gain) {
         if (chain->chain.size() > position) {
-            if (const auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[position])) {
+            if (std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[position]) != nullptr) {
                 // TODO bounds check
-                gainStage->gain = gain;
+                std::static_pointer_cast<ChainSlotGainStage>(chain->getSlotForWrite(position))->gain = gain;
                 return true;
             }
         }
@@ -152,23 +229,21 @@ namespace ChainMutators {
         return 0.0f;
     }
 
-    float getGainStageOutputAmplitude(std::shared_ptr<PluginChain> chain, int position, int channelNumber) {
+    std::shared_ptr<LevelMeter> getGainStageMeter(std::shared_ptr<PluginChain> chain, int position) {
         if (chain->chain.size() > position) {
             if (const auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[position])) {
-                if (channelNumber < gainStage->meterEnvelopes.size()) {
-                    return gainStage->meterEnvelopes[channelNumber].getLastOutput();
-                }
+                return gainStage->meter;
             }
         }
 
-        return 0.0f;
+        return nullptr;
     }
 
     bool setPan(std::shared_ptr<PluginChain> chain, int position, float pan) {
         if (chain->chain.size() > position) {
-            if (const auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[position])) {
+            if (std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[position]) != nullptr) {
                 // TODO bounds check
-                gainStage->pan = pan;
+                std::static_pointer_cast<ChainSlotGainStage>(chain->getSlotForWrite(position))->pan = pan;
                 return true;
             }
         }
@@ -186,20 +261,18 @@ namespace ChainMutators {
         return 0.0f;
     }
 
-    void setRequiredLatency(std::shared_ptr<PluginChain> chain, int numSamples, HostConfiguration config) {
-        // The compensation is the amount of latency we need to add artificially to the latency of the
-        // plugins in this chain in order to meet the required amount
-        // If this is the slowest chain owned by the splitter this should be 0
-        const int compensation {std::max(numSamples - chain->latencyListener.calculatedTotalPluginLatency, 0)};
-
-        WECore::AudioSpinLock lock(chain->latencyCompLineMutex);
-        chain->latencyCompLine.reset(new CloneableDelayLineType(compensation));
-        chain->latencyCompLine->prepare({
-            config.sampleRate,
-            static_cast<juce::uint32>(config.blockSize),
-            static_cast<juce::uint32>(getTotalNumInputChannels(config.layout))
-        });
-        chain->latencyCompLine->setDelay(compensation);
+    void setRequiredLatency(std::shared_ptr<PluginChain> chain, int numSamples) {
+        const int compensation {getLatencyCompensation(*chain, numSamples)};
+
+        // The line is preallocated, so this can be changed while the chain is being processed
+        if (!chain->latencyCompLine->setDelay(compensation)) {
+            juce::Logger::writeToLog("ChainMutators::setRequiredLatency: Compensation of " + juce::String(compensation) +
+                " exceeds the maximum of " + juce::String(chain->latencyCompLine->getMaximumDelayInSamples()));
+        }
+    }
+
+    bool isRequiredLatencyChanged(std::shared_ptr<PluginChain> chain, int numSamples) {
+        return getLatencyCompensation(*chain, numSamples) != chain->latencyCompLine->getDelay();
     }
 
     std::shared_ptr<PluginEditorBounds> getPluginEditorBounds(std::shared_ptr<PluginChain> chain, int position) {
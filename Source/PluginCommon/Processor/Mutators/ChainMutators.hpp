@@ -3,6 +3,11 @@
 #include <JuceHeader.h>
 #include "PluginChain.hpp"
 
+/**
+ * The chain passed to a mutator that changes it must not be shared with another splitter, see
+ * PluginSplitter::getChainForWrite(). Slots still shared with the chain it was cloned from are
+ * copied before they're changed.
+ */
 namespace ChainMutators {
     /**
      * Inserts a plugin at the given position, or at the end if that position doesn't exist.
@@ -20,6 +25,24 @@ namespace ChainMutators {
                        int position,
                        HostConfiguration config);
 
+    /**
+     * Swaps oldPlugin for newPlugin wherever it appears in the chain, keeping the slot's bypass,
+     * modulation and editor bounds. Returns false if the chain doesn't contain oldPlugin.
+     *
+     * If shouldCrossfade is true the slot fades from oldPlugin to newPlugin over the first block
+     * it processes, which should only be used for a chain that's about to be published.
+     */
+    bool swapPlugin(std::shared_ptr<PluginChain> chain,
+                    const juce::AudioPluginInstance* oldPlugin,
+                    std::shared_ptr<juce::AudioPluginInstance> newPlugin,
+                    HostConfiguration config,
+                    bool shouldCrossfade);
+
+    /**
+     * Returns true if any slot in the chain hosts the plugin.
+     */
+    bool containsPlugin(std::shared_ptr<PluginChain> chain, const juce::AudioPluginInstance* plugin);
+
     /**
      * Removes the plugin or gain stage at the given position in the chain.
      */
@@ -44,7 +67,8 @@ namespace ChainMutators {
                                    int position);
 
     /**
-     * Returns the modulation config for the given plugin.
+     * Returns a copy of the modulation config for the given plugin, which can be changed and passed
+     * back to setPluginModulationConfig() without affecting the chain until it is.
      */
     PluginModulationConfig getPluginModulationConfig(std::shared_ptr<PluginChain> chain,
                                                      int position);
@@ -84,7 +108,11 @@ namespace ChainMutators {
      */
     float getGainLinear(std::shared_ptr<PluginChain> chain, int position);
 
-    float getGainStageOutputAmplitude(std::shared_ptr<PluginChain> chain, int position, int channelNumber);
+    /**
+     * Returns the meter for the gain stage at the given position, or nullptr if there isn't a gain
+     * stage there. The meter is shared by clones of the gain stage.
+     */
+    std::shared_ptr<LevelMeter> getGainStageMeter(std::shared_ptr<PluginChain> chain, int position);
 
     /**
      * Sets the pan/balance for the gain stage at the given position.
@@ -103,7 +131,13 @@ namespace ChainMutators {
      * The chain can't reduce its latency below the total of the plugins it hosts, but it can
      * increase its latency to match slower chains.
      */
-    void setRequiredLatency(std::shared_ptr<PluginChain> chain, int numSamples, HostConfiguration config);
+    void setRequiredLatency(std::shared_ptr<PluginChain> chain, int numSamples);
+
+    /**
+     * Returns true if calling setRequiredLatency() with numSamples would change the chain's
+     * latency compensation.
+     */
+    bool isRequiredLatencyChanged(std::shared_ptr<PluginChain> chain, int numSamples);
 
     /**
      * Returns a pointer to the bounds for this plugin's editor. Will pointer to an empty optional
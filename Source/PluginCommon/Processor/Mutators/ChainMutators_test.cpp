@@ -3,6 +3,7 @@
 
 #include "ChainMutators.hpp"
 #include "ChainProcessors.hpp"
+#include "PlaceholderPluginInstance.hpp"
 
 namespace {
     constexpr int SAMPLE_RATE {44100};
@@ -255,6 +256,76 @@ SCENARIO("ChainMutators: Slots can be added, replaced, and removed") {
     juce::MessageManager::deleteInstance();
 }
 
+SCENARIO("ChainMutators: A placeholder can be swapped for the loaded plugin") {
+    GIVEN("A chain with a placeholder that is bypassed and has a modulation target") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = 44100;
+        hostConfig.blockSize = 10;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+
+        juce::PluginDescription description;
+        description.name = "TestPlugin";
+        auto placeholder = std::make_shared<PlaceholderPluginInstance>(description);
+        placeholder->setExpectedLatency(10);
+
+        ChainMutators::insertPlugin(chain, placeholder, 0, hostConfig);
+        ChainMutators::insertGainStage(chain, 1, hostConfig);
+        ChainMutators::setSlotBypass(chain, 0, true);
+
+        auto parameterConfig = std::make_shared<PluginParameterModulationConfig>();
+        parameterConfig->targetParameterName = "param2";
+        parameterConfig->sources.push_back(std::make_shared<PluginParameterModulationSource>(ModulationSourceDefinition(1, MODULATION_TYPE::LFO), 0.5f));
+        PluginModulationConfig modulationConfig;
+        modulationConfig.parameterConfigs.push_back(parameterConfig);
+        ChainMutators::setPluginModulationConfig(chain, modulationConfig, 0);
+
+        REQUIRE(chain->latencyListener.calculatedTotalPluginLatency == 10);
+
+        WHEN("The loaded plugin is swapped in") {
+            auto plugin = std::make_shared<MutatorTestPluginInstance>();
+            plugin->setLatencySamples(15);
+            const bool isSwapped {ChainMutators::swapPlugin(chain, placeholder.get(), plugin, hostConfig, true)};
+
+            THEN("It takes the placeholder's place and keeps the slot's settings") {
+                CHECK(isSwapped);
+                CHECK(ChainMutators::getNumSlots(chain) == 2);
+                CHECK(ChainMutators::getPlugin(chain, 0) == plugin);
+                CHECK(ChainMutators::getSlotBypass(chain, 0));
+                CHECK(plugin->addedListener == &chain->latencyListener);
+                CHECK(chain->latencyListener.calculatedTotalPluginLatency == 15);
+
+                auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[0]);
+                REQUIRE(pluginSlot != nullptr);
+                CHECK(pluginSlot->modulationConfig->parameterConfigs[0]->targetParameterName == "param2");
+                REQUIRE(pluginSlot->modulationMatrix.parameters.size() == 1);
+                CHECK(pluginSlot->modulationMatrix.parameters[0] == plugin->getParameters()[1]);
+
+                REQUIRE(pluginSlot->swapCrossfade != nullptr);
+                CHECK(pluginSlot->swapCrossfade->replacedPlugin == placeholder);
+                CHECK(pluginSlot->swapCrossfade->isPending);
+            }
+        }
+
+        WHEN("A plugin that isn't in the chain is swapped") {
+            auto otherPlugin = std::make_shared<MutatorTestPluginInstance>();
+            auto plugin = std::make_shared<MutatorTestPluginInstance>();
+            const bool isSwapped {ChainMutators::swapPlugin(chain, otherPlugin.get(), plugin, hostConfig, true)};
+
+            THEN("Nothing changes") {
+                CHECK_FALSE(isSwapped);
+                CHECK(ChainMutators::getPlugin(chain, 0) == placeholder);
+            }
+        }
+    }
+}
+
 SCENARIO("ChainMutators: Modulation config can be set and retrieved") {
     GIVEN("A chain with three plugins and a gain stage") {
         HostConfiguration hostConfig;
@@ -3,6 +3,12 @@
 
 namespace {
     constexpr int MAX_FREQ {20000};
+
+    bool isPassThrough(const BandState& band) {
+        return band.chain != nullptr
+            && !band.chain->isChainMuted
+            && (band.chain->isChainBypassed || band.chain->renderPlan.ops.empty());
+    }
 }
 
 namespace CrossoverMutators {
@@ -16,6 +22,8 @@ namespace CrossoverMutators {
                 } else {
                     state->numBandsSoloed--;
                 }
+
+                updateMergedBands(state);
             }
         }
     }
@@ -30,7 +38,6 @@ namespace CrossoverMutators {
         }
 
         state->lowpassFilters[crossoverNumber]->setCutoffFrequency(val);
-        state->highpassFilters[crossoverNumber]->setCutoffFrequency(val);
 
         // We might also have an allpass filter to set
         if (state->allpassFilters.size() > crossoverNumber - 1) {
@@ -64,6 +71,7 @@ namespace CrossoverMutators {
     void setPluginChain(std::shared_ptr<CrossoverState> state, size_t bandNumber, std::shared_ptr<PluginChain> chain) {
         if (state->bands.size() > bandNumber) {
             state->bands[bandNumber].chain = chain;
+            updateMergedBands(state);
         }
     }
 
@@ -94,9 +102,6 @@ namespace CrossoverMutators {
         state->lowpassFilters.emplace_back(new CloneableLRFilter<float>());
         state->lowpassFilters[state->lowpassFilters.size() - 1]->setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
 
-        state->highpassFilters.emplace_back(new CloneableLRFilter<float>());
-        state->highpassFilters[state->highpassFilters.size() - 1]->setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-
         state->allpassFilters.emplace_back(new CloneableLRFilter<float>());
         state->allpassFilters[state->allpassFilters.size() - 1]->setType(juce::dsp::LinkwitzRileyFilterType::allpass);
 
@@ -124,6 +129,8 @@ namespace CrossoverMutators {
 
         CrossoverProcessors::prepareToPlay(*state.get(), state->config.sampleRate, state->config.blockSize, state->config.layout);
         CrossoverProcessors::reset(*state.get());
+
+        updateMergedBands(state);
     }
 
     bool removeBand(std::shared_ptr<CrossoverState> state, size_t bandNumber) {
@@ -161,7 +168,6 @@ namespace CrossoverMutators {
         // Now remove an arbitrary filter
         state->buffers.erase(state->buffers.end() - 1);
         state->lowpassFilters.erase(state->lowpassFilters.end() - 1);
-        state->highpassFilters.erase(state->highpassFilters.end() - 1);
 
         // We might also have an allpass filter to delete
         if (state->allpassFilters.size() > 0) {
@@ -175,6 +181,40 @@ namespace CrossoverMutators {
 
         CrossoverProcessors::reset(*state.get());
 
+        updateMergedBands(state);
+
         return true;
     }
+
+    void updateMergedBands(std::shared_ptr<CrossoverState> state) {
+        // Only a run reaching the top band is merged. A band above a run lower down still needs the
+        // highpass of every crossover in the run, and the bands below it their allpass rotations,
+        // so merging it wouldn't skip any filtering.
+        //
+        // Soloing needs every band to be split
+        int numPassThroughBands {0};
+        if (state->numBandsSoloed == 0) {
+            for (auto band = state->bands.rbegin(); band != state->bands.rend() && isPassThrough(*band); band++) {
+                numPassThroughBands++;
+            }
+        }
+
+        // A run of pass through bands is merged into the lowest of them
+        const int numMergedBands {std::max(numPassThroughBands - 1, 0)};
+
+        if (numMergedBands != state->numMergedBands) {
+            // The lowpass filters of the crossovers that start or stop being split have either
+            // been idle or (for the first crossover) used as an allpass, so their state doesn't
+            // match what they're about to be used for
+            const int numCrossovers {static_cast<int>(state->lowpassFilters.size())};
+            const int firstChangedCrossover {numCrossovers - std::max(numMergedBands, state->numMergedBands)};
+            const int lastChangedCrossover {numCrossovers - std::min(numMergedBands, state->numMergedBands)};
+
+            for (int crossoverNumber {std::max(firstChangedCrossover, 0)}; crossoverNumber < lastChangedCrossover; crossoverNumber++) {
+                state->lowpassFilters[crossoverNumber]->reset();
+            }
+
+            state->numMergedBands = numMergedBands;
+        }
+    }
 }
@@ -13,4 +13,14 @@ namespace CrossoverMutators {
 
     void addBand(std::shared_ptr<CrossoverState> state);
     bool removeBand(std::shared_ptr<CrossoverState> state, size_t bandNumber);
+
+    /**
+     * Works out which of the top bands can be merged because their chains are empty or bypassed.
+     * Must be called after changing the bands' chains and before the state is published, the
+     * other crossover mutators call it themselves.
+     *
+     * Only a run of bands reaching the top band can be merged without changing the phase of the
+     * output, as the high output of each crossover feeds every band above it.
+     */
+    void updateMergedBands(std::shared_ptr<CrossoverState> state);
 }
@@ -1,10 +1,15 @@
 #include "ModulationMutators.hpp"
 
 namespace {
-    std::vector<WECore::ModulationSourceWrapper<double>> deleteSourceFromTargetSources(
-            std::vector<WECore::ModulationSourceWrapper<double>> sources,
+    /**
+     * Removes the source from the list and renumbers those above it. Returns true if the list was
+     * changed.
+     */
+    bool deleteSourceFromTargetSources(
+            std::vector<WECore::ModulationSourceWrapper<double>>& sources,
             ModulationSourceDefinition definition,
             std::function<float(int, MODULATION_TYPE)> getModulationValueCallback) {
+        bool hasChanged {false};
         bool needsToDelete {false};
         int indexToDelete {0};
 
@@ -33,14 +38,16 @@ namespace {
                 newSource.amount = sources[sourceIndex].amount;
 
                 sources[sourceIndex] = newSource;
+                hasChanged = true;
             }
         }
 
         if (needsToDelete) {
             sources.erase(sources.begin() + indexToDelete);
+            hasChanged = true;
         }
 
-        return sources;
+        return hasChanged;
     }
 }
 
@@ -57,7 +64,7 @@ namespace ModulationMutators {
 
     bool setLfoTempoSyncSwitch(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, bool val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setTempoSyncSwitch(val);
+            sources->getLfoForWrite(lfoIndex)->setTempoSyncSwitch(val);
             return true;
         }
 
@@ -66,7 +73,7 @@ namespace ModulationMutators {
 
     bool setLfoInvertSwitch(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, bool val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setInvertSwitch(val);
+            sources->getLfoForWrite(lfoIndex)->setInvertSwitch(val);
             return true;
         }
 
@@ -75,7 +82,7 @@ namespace ModulationMutators {
 
     bool setLfoOutputMode(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setOutputMode(val);
+            sources->getLfoForWrite(lfoIndex)->setOutputMode(val);
             return true;
         }
 
@@ -84,7 +91,7 @@ namespace ModulationMutators {
 
     bool setLfoWave(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setWave(val);
+            sources->getLfoForWrite(lfoIndex)->setWave(val);
             return true;
         }
 
@@ -93,7 +100,7 @@ namespace ModulationMutators {
 
     bool setLfoTempoNumer(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setTempoNumer(val);
+            sources->getLfoForWrite(lfoIndex)->setTempoNumer(val);
             return true;
         }
 
@@ -102,7 +109,7 @@ namespace ModulationMutators {
 
     bool setLfoTempoDenom(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setTempoDenom(val);
+            sources->getLfoForWrite(lfoIndex)->setTempoDenom(val);
             return true;
         }
 
@@ -111,7 +118,7 @@ namespace ModulationMutators {
 
     bool setLfoFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setFreq(val);
+            sources->getLfoForWrite(lfoIndex)->setFreq(val);
             return true;
         }
 
@@ -120,7 +127,7 @@ namespace ModulationMutators {
 
     bool setLfoDepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setDepth(val);
+            sources->getLfoForWrite(lfoIndex)->setDepth(val);
             return true;
         }
 
@@ -129,7 +136,7 @@ namespace ModulationMutators {
 
     bool setLfoManualPhase(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            sources->lfos[lfoIndex]->setManualPhase(val);
+            sources->getLfoForWrite(lfoIndex)->setManualPhase(val);
             return true;
         }
 
@@ -142,7 +149,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->lfos[lfoIndex]->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getLfoForWrite(lfoIndex)->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromLFOFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, ModulationSourceDefinition source) {
@@ -154,7 +161,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->lfos[lfoIndex]->removeFreqModulationSource(existingSource.source);
+                return sources->getLfoForWrite(lfoIndex)->removeFreqModulationSource(existingSource.source);
             }
         }
 
@@ -163,7 +170,7 @@ namespace ModulationMutators {
 
     bool setLFOFreqModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int sourceIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            return sources->lfos[lfoIndex]->setFreqModulationAmount(sourceIndex, val);
+            return sources->getLfoForWrite(lfoIndex)->setFreqModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -189,7 +196,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->lfos[lfoIndex]->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getLfoForWrite(lfoIndex)->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromLFODepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, ModulationSourceDefinition source) {
@@ -201,7 +208,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->lfos[lfoIndex]->removeDepthModulationSource(existingSource.source);
+                return sources->getLfoForWrite(lfoIndex)->removeDepthModulationSource(existingSource.source);
             }
         }
 
@@ -210,7 +217,7 @@ namespace ModulationMutators {
 
     bool setLFODepthModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int sourceIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            return sources->lfos[lfoIndex]->setDepthModulationAmount(sourceIndex, val);
+            return sources->getLfoForWrite(lfoIndex)->setDepthModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -236,7 +243,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->lfos[lfoIndex]->addPhaseModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getLfoForWrite(lfoIndex)->addPhaseModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromLFOPhase(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, ModulationSourceDefinition source) {
@@ -248,7 +255,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->lfos[lfoIndex]->removePhaseModulationSource(existingSource.source);
+                return sources->getLfoForWrite(lfoIndex)->removePhaseModulationSource(existingSource.source);
             }
         }
 
@@ -257,7 +264,7 @@ namespace ModulationMutators {
 
     bool setLFOPhaseModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int lfoIndex, int sourceIndex, double val) {
         if (sources->lfos.size() > lfoIndex) {
-            return sources->lfos[lfoIndex]->setPhaseModulationAmount(sourceIndex, val);
+            return sources->getLfoForWrite(lfoIndex)->setPhaseModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -384,7 +391,7 @@ namespace ModulationMutators {
 
     bool setEnvAttackTimeMs(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, double val) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->envelope->setAttackTimeMs(val);
+            sources->getEnvelopeForWrite(envIndex)->envelope->setAttackTimeMs(val);
             return true;
         }
 
@@ -393,7 +400,7 @@ namespace ModulationMutators {
 
     bool setEnvReleaseTimeMs(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, double val) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->envelope->setReleaseTimeMs(val);
+            sources->getEnvelopeForWrite(envIndex)->envelope->setReleaseTimeMs(val);
             return true;
         }
 
@@ -402,7 +409,7 @@ namespace ModulationMutators {
 
     bool setEnvFilterEnabled(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, bool val) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->envelope->setFilterEnabled(val);
+            sources->getEnvelopeForWrite(envIndex)->envelope->setFilterEnabled(val);
             return true;
         }
 
@@ -411,8 +418,8 @@ namespace ModulationMutators {
 
     bool setEnvFilterHz(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, double lowCut, double highCut) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->envelope->setLowCutHz(lowCut);
-            sources->envelopes[envIndex]->envelope->setHighCutHz(highCut);
+            sources->getEnvelopeForWrite(envIndex)->envelope->setLowCutHz(lowCut);
+            sources->getEnvelopeForWrite(envIndex)->envelope->setHighCutHz(highCut);
             return true;
         }
 
@@ -421,7 +428,7 @@ namespace ModulationMutators {
 
     bool setEnvAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, float val) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->amount = val;
+            sources->getEnvelopeForWrite(envIndex)->amount = val;
             return true;
         }
 
@@ -430,7 +437,7 @@ namespace ModulationMutators {
 
     bool setEnvUseSidechainInput(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int envIndex, bool val) {
         if (sources->envelopes.size() > envIndex) {
-            sources->envelopes[envIndex]->useSidechainInput = val;
+            sources->getEnvelopeForWrite(envIndex)->useSidechainInput = val;
             return true;
         }
 
@@ -512,7 +519,7 @@ namespace ModulationMutators {
 
     bool setRandomOutputMode(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, int val) {
         if (sources->randomSources.size() > randomIndex) {
-            sources->randomSources[randomIndex]->setOutputMode(val);
+            sources->getRandomForWrite(randomIndex)->setOutputMode(val);
             return true;
         }
 
@@ -521,7 +528,7 @@ namespace ModulationMutators {
 
     bool setRandomFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, double val) {
         if (sources->randomSources.size() > randomIndex) {
-            sources->randomSources[randomIndex]->setFreq(val);
+            sources->getRandomForWrite(randomIndex)->setFreq(val);
             return true;
         }
 
@@ -530,7 +537,7 @@ namespace ModulationMutators {
 
     bool setRandomDepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, double val) {
         if (sources->randomSources.size() > randomIndex) {
-            sources->randomSources[randomIndex]->setDepth(val);
+            sources->getRandomForWrite(randomIndex)->setDepth(val);
             return true;
         }
 
@@ -543,7 +550,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->randomSources[randomIndex]->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getRandomForWrite(randomIndex)->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromRandomFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, ModulationSourceDefinition source) {
@@ -555,7 +562,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->randomSources[randomIndex]->removeFreqModulationSource(existingSource.source);
+                return sources->getRandomForWrite(randomIndex)->removeFreqModulationSource(existingSource.source);
             }
         }
 
@@ -564,7 +571,7 @@ namespace ModulationMutators {
 
     bool setRandomFreqModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, int sourceIndex, double val) {
         if (sources->randomSources.size() > randomIndex) {
-            return sources->randomSources[randomIndex]->setFreqModulationAmount(sourceIndex, val);
+            return sources->getRandomForWrite(randomIndex)->setFreqModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -590,7 +597,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->randomSources[randomIndex]->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getRandomForWrite(randomIndex)->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromRandomDepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, ModulationSourceDefinition source) {
@@ -602,7 +609,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->randomSources[randomIndex]->removeDepthModulationSource(existingSource.source);
+                return sources->getRandomForWrite(randomIndex)->removeDepthModulationSource(existingSource.source);
             }
         }
 
@@ -611,7 +618,7 @@ namespace ModulationMutators {
 
     bool setRandomDepthModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int randomIndex, int sourceIndex, double val) {
         if (sources->randomSources.size() > randomIndex) {
-            return sources->randomSources[randomIndex]->setDepthModulationAmount(sourceIndex, val);
+            return sources->getRandomForWrite(randomIndex)->setDepthModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -694,7 +701,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->stepSequencers[seqIndex]->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getStepSeqForWrite(seqIndex)->addFreqModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromStepSeqFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, ModulationSourceDefinition source) {
@@ -706,7 +713,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->stepSequencers[seqIndex]->removeFreqModulationSource(existingSource.source);
+                return sources->getStepSeqForWrite(seqIndex)->removeFreqModulationSource(existingSource.source);
             }
         }
 
@@ -715,7 +722,7 @@ namespace ModulationMutators {
 
     bool setStepSeqFreqModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int sourceIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            return sources->stepSequencers[seqIndex]->setFreqModulationAmount(sourceIndex, val);
+            return sources->getStepSeqForWrite(seqIndex)->setFreqModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -741,7 +748,7 @@ namespace ModulationMutators {
         }
 
         auto sourceProvider = std::make_shared<ModulationSourceProvider>(source, sources->getModulationValueCallback);
-        return sources->stepSequencers[seqIndex]->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
+        return sources->getStepSeqForWrite(seqIndex)->addDepthModulationSource(std::dynamic_pointer_cast<WECore::ModulationSource<double>>(sourceProvider));
     }
 
     bool removeSourceFromStepSeqDepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, ModulationSourceDefinition source) {
@@ -753,7 +760,7 @@ namespace ModulationMutators {
         for (const auto& existingSource : existingSources) {
             auto thisSource = std::dynamic_pointer_cast<ModulationSourceProvider>(existingSource.source);
             if (thisSource != nullptr && thisSource->definition == source) {
-                return sources->stepSequencers[seqIndex]->removeDepthModulationSource(existingSource.source);
+                return sources->getStepSeqForWrite(seqIndex)->removeDepthModulationSource(existingSource.source);
             }
         }
 
@@ -762,7 +769,7 @@ namespace ModulationMutators {
 
     bool setStepSeqDepthModulationAmount(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int sourceIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            return sources->stepSequencers[seqIndex]->setDepthModulationAmount(sourceIndex, val);
+            return sources->getStepSeqForWrite(seqIndex)->setDepthModulationAmount(sourceIndex, val);
         }
 
         return false;
@@ -784,7 +791,7 @@ namespace ModulationMutators {
 
     bool setStepSeqTempoSyncSwitch(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, bool val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setTempoSyncSwitch(val);
+            sources->getStepSeqForWrite(seqIndex)->setTempoSyncSwitch(val);
             return true;
         }
         return false;
@@ -792,7 +799,7 @@ namespace ModulationMutators {
 
     bool setStepSeqTempoNumer(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setTempoNumer(val);
+            sources->getStepSeqForWrite(seqIndex)->setTempoNumer(val);
             return true;
         }
         return false;
@@ -800,7 +807,7 @@ namespace ModulationMutators {
 
     bool setStepSeqTempoDenom(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setTempoDenom(val);
+            sources->getStepSeqForWrite(seqIndex)->setTempoDenom(val);
             return true;
         }
         return false;
@@ -808,7 +815,7 @@ namespace ModulationMutators {
 
     bool setStepSeqFreq(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setFreq(val);
+            sources->getStepSeqForWrite(seqIndex)->setFreq(val);
             return true;
         }
         return false;
@@ -816,7 +823,7 @@ namespace ModulationMutators {
 
     bool setStepSeqDepth(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setDepth(val);
+            sources->getStepSeqForWrite(seqIndex)->setDepth(val);
             return true;
         }
         return false;
@@ -824,7 +831,7 @@ namespace ModulationMutators {
 
     bool addStepSeqStep(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->addStep(patternIndex);
+            sources->getStepSeqForWrite(seqIndex)->addStep(patternIndex);
             return true;
         }
         return false;
@@ -832,7 +839,7 @@ namespace ModulationMutators {
 
     bool removeStepSeqStep(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->removeStep(patternIndex);
+            sources->getStepSeqForWrite(seqIndex)->removeStep(patternIndex);
             return true;
         }
         return false;
@@ -847,7 +854,7 @@ namespace ModulationMutators {
 
     bool setStepSeqStepValue(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex, int stepIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setStepValue(patternIndex, stepIndex, val);
+            sources->getStepSeqForWrite(seqIndex)->setStepValue(patternIndex, stepIndex, val);
             return true;
         }
         return false;
@@ -855,7 +862,7 @@ namespace ModulationMutators {
 
     bool setStepSeqStepShape(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex, int stepIndex, int shape) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setStepShape(patternIndex, stepIndex, static_cast<WECore::StepSeq::StepShape>(shape));
+            sources->getStepSeqForWrite(seqIndex)->setStepShape(patternIndex, stepIndex, static_cast<WECore::StepSeq::StepShape>(shape));
             return true;
         }
         return false;
@@ -863,7 +870,7 @@ namespace ModulationMutators {
 
     bool setStepSeqStepReverse(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex, int stepIndex, bool val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setStepReverse(patternIndex, stepIndex, val);
+            sources->getStepSeqForWrite(seqIndex)->setStepReverse(patternIndex, stepIndex, val);
             return true;
         }
         return false;
@@ -871,7 +878,7 @@ namespace ModulationMutators {
 
     bool setStepSeqStepRepeat(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex, int stepIndex, int val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setStepRepeat(patternIndex, stepIndex, val);
+            sources->getStepSeqForWrite(seqIndex)->setStepRepeat(patternIndex, stepIndex, val);
             return true;
         }
         return false;
@@ -879,7 +886,7 @@ namespace ModulationMutators {
 
     bool setStepSeqStepLengthMultiplier(std::shared_ptr<ModelInterface::ModulationSourcesState> sources, int seqIndex, int patternIndex, int stepIndex, double val) {
         if (sources->stepSequencers.size() > seqIndex) {
-            sources->stepSequencers[seqIndex]->setStepLengthMultiplier(patternIndex, stepIndex, val);
+            sources->getStepSeqForWrite(seqIndex)->setStepLengthMultiplier(patternIndex, stepIndex, val);
             return true;
         }
         return false;
@@ -986,46 +993,54 @@ namespace ModulationMutators {
     }
 
     bool removeModulationSource(ModelInterface::ModulationSourcesState& state, ModulationSourceDefinition definition) {
-        // First remove/renumber any modulation sources that reference this one
-        for (std::shared_ptr<ModelInterface::CloneableLFO> lfo : state.lfos) {
+        // First remove/renumber any modulation sources that reference this one, only copying the
+        // sources that actually change
+        for (size_t lfoIndex {0}; lfoIndex < state.lfos.size(); lfoIndex++) {
             // Freq
-            std::vector<WECore::ModulationSourceWrapper<double>> lfoFreqSources = lfo->getFreqModulationSources();
-            lfoFreqSources = deleteSourceFromTargetSources(lfoFreqSources, definition, state.getModulationValueCallback);
-            lfo->setFreqModulationSources(lfoFreqSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> lfoFreqSources = state.lfos[lfoIndex]->getFreqModulationSources();
+            if (deleteSourceFromTargetSources(lfoFreqSources, definition, state.getModulationValueCallback)) {
+                state.getLfoForWrite(lfoIndex)->setFreqModulationSources(lfoFreqSources);
+            }
 
             // Depth
-            std::vector<WECore::ModulationSourceWrapper<double>> lfoDepthSources = lfo->getDepthModulationSources();
-            lfoDepthSources = deleteSourceFromTargetSources(lfoDepthSources, definition, state.getModulationValueCallback);
-            lfo->setDepthModulationSources(lfoDepthSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> lfoDepthSources = state.lfos[lfoIndex]->getDepthModulationSources();
+            if (deleteSourceFromTargetSources(lfoDepthSources, definition, state.getModulationValueCallback)) {
+                state.getLfoForWrite(lfoIndex)->setDepthModulationSources(lfoDepthSources);
+            }
 
             // Phase
-            std::vector<WECore::ModulationSourceWrapper<double>> lfoPhaseSources = lfo->getPhaseModulationSources();
-            lfoPhaseSources = deleteSourceFromTargetSources(lfoPhaseSources, definition, state.getModulationValueCallback);
-            lfo->setPhaseModulationSources(lfoPhaseSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> lfoPhaseSources = state.lfos[lfoIndex]->getPhaseModulationSources();
+            if (deleteSourceFromTargetSources(lfoPhaseSources, definition, state.getModulationValueCallback)) {
+                state.getLfoForWrite(lfoIndex)->setPhaseModulationSources(lfoPhaseSources);
+            }
         }
 
-        for (std::shared_ptr<WECore::Perlin::PerlinSource> random : state.randomSources) {
+        for (size_t randomIndex {0}; randomIndex < state.randomSources.size(); randomIndex++) {
             // Freq
-            std::vector<WECore::ModulationSourceWrapper<double>> randomFreqSources = random->getFreqModulationSources();
-            randomFreqSources = deleteSourceFromTargetSources(randomFreqSources, definition, state.getModulationValueCallback);
-            random->setFreqModulationSources(randomFreqSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> randomFreqSources = state.randomSources[randomIndex]->getFreqModulationSources();
+            if (deleteSourceFromTargetSources(randomFreqSources, definition, state.getModulationValueCallback)) {
+                state.getRandomForWrite(randomIndex)->setFreqModulationSources(randomFreqSources);
+            }
 
             // Depth
-            std::vector<WECore::ModulationSourceWrapper<double>> randomDepthSources = random->getDepthModulationSources();
-            randomDepthSources = deleteSourceFromTargetSources(randomDepthSources, definition, state.getModulationValueCallback);
-            random->setDepthModulationSources(randomDepthSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> randomDepthSources = state.randomSources[randomIndex]->getDepthModulationSources();
+            if (deleteSourceFromTargetSources(randomDepthSources, definition, state.getModulationValueCallback)) {
+                state.getRandomForWrite(randomIndex)->setDepthModulationSources(randomDepthSources);
+            }
         }
 
-        for (std::shared_ptr<WECore::StepSeq::StepSequencer> seq : state.stepSequencers) {
+        for (size_t seqIndex {0}; seqIndex < state.stepSequencers.size(); seqIndex++) {
             // Freq
-            std::vector<WECore::ModulationSourceWrapper<double>> seqFreqSources = seq->getFreqModulationSources();
-            seqFreqSources = deleteSourceFromTargetSources(seqFreqSources, definition, state.getModulationValueCallback);
-            seq->setFreqModulationSources(seqFreqSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> seqFreqSources = state.stepSequencers[seqIndex]->getFreqModulationSources();
+            if (deleteSourceFromTargetSources(seqFreqSources, definition, state.getModulationValueCallback)) {
+                state.getStepSeqForWrite(seqIndex)->setFreqModulationSources(seqFreqSources);
+            }
 
             // Depth
-            std::vector<WECore::ModulationSourceWrapper<double>> seqDepthSources = seq->getDepthModulationSources();
-            seqDepthSources = deleteSourceFromTargetSources(seqDepthSources, definition, state.getModulationValueCallback);
-            seq->setDepthModulationSources(seqDepthSources);
+            std::vector<WECore::ModulationSourceWrapper<double>> seqDepthSources = state.stepSequencers[seqIndex]->getDepthModulationSources();
+            if (deleteSourceFromTargetSources(seqDepthSources, definition, state.getModulationValueCallback)) {
+                state.getStepSeqForWrite(seqIndex)->setDepthModulationSources(seqDepthSources);
+            }
         }
 
         const int index {definition.id - 1};
@@ -1,9 +1,13 @@
 #include "MutatorsInterface.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <map>
+#include <set>
 
 #include "SplitterMutators.hpp"
 #include "ModulationMutators.hpp"
+#include "ModulationProcessors.hpp"
 #include "XmlConsts.hpp"
 #include "XmlReader.hpp"
 #include "XmlWriter.hpp"
@@ -35,7 +39,235 @@ namespace {
         return sources;
     }
 
-    constexpr int MAX_HISTORY_SIZE = 20;
+    /**
+     * True if the config uses the source, or one of the same type that's numbered higher and would
+     * be renumbered if it was removed.
+     */
+    bool isSourceOrHigherAssigned(const PluginModulationConfig& config, ModulationSourceDefinition definition) {
+        for (const std::shared_ptr<PluginParameterModulationConfig>& parameterConfig : config.parameterConfigs) {
+            for (const std::shared_ptr<PluginParameterModulationSource>& source : parameterConfig->sources) {
+                if (source->definition.type == definition.type && source->definition.id >= definition.id) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * A band's chain may have been edited without going through the crossover, so check which
+     * bands can be merged before the audio thread sees the new state.
+     */
+    void updateMergedBands(PluginSplitter& splitter) {
+        if (splitter.splitType == SPLIT_TYPE::MULTIBAND) {
+            CrossoverMutators::updateMergedBands(static_cast<PluginSplitterMultiband&>(splitter).crossover);
+        }
+    }
+
+    /**
+     * Plugins in left/right and mid/side chains may be configured as mono. These split types can
+     * process plugins with either layout, so plugins are moved back to stereo before any other
+     * split type is published, and only moved to mono once one of these has been published. That
+     * way the audio thread never has a plugin with a layout its chain can't process.
+     */
+    void migratePluginLayouts(PluginSplitter& splitter, HostConfiguration config, bool isPublished) {
+        const bool isMonoChain {PluginConfigurator::isMonoChainSplitType(splitter.splitType)};
+
+        if (isMonoChain != isPublished) {
+            return;
+        }
+
+        PluginConfigurator pluginConfigurator;
+
+        for (PluginChainWrapper& chainWrapper : splitter.chains) {
+            for (std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                    if (pluginConfigurator.needsReconfiguring(pluginSlot->plugin, config, isMonoChain)) {
+                        pluginConfigurator.reconfigure(pluginSlot->plugin, config, isMonoChain);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<juce::AudioPluginInstance>> getPlugins(const PluginSplitter& splitter) {
+        std::vector<std::shared_ptr<juce::AudioPluginInstance>> retVal;
+
+        for (const PluginChainWrapper& chainWrapper : splitter.chains) {
+            for (const std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                    retVal.push_back(pluginSlot->plugin);
+                }
+            }
+        }
+
+        return retVal;
+    }
+
+    /**
+     * Builds a new splitter state from the element and prepares it, so it's ready to be published.
+     * The audio thread may still be processing the current splitter, so this never restores into
+     * an existing one.
+     */
+    std::shared_ptr<ModelInterface::SplitterState> restoreSplitterState(
+            juce::XmlElement* element,
+            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+            std::function<void(int)> latencyChangeCallback,
+            HostConfiguration config,
+            const PluginConfigurator& pluginConfigurator,
+            PluginInstantiator& instantiator,
+            std::function<void(juce::String)> onErrorCallback,
+            const SessionFormat::Reader* sessionReader) {
+        auto newSplitterState = std::make_shared<ModelInterface::SplitterState>(config, getModulationValueCallback, latencyChangeCallback);
+        ModelInterface::SplitterState& splitter = *newSplitterState;
+
+        // Restore the cached crossover frequencies first, we need to allow for them to be overwritten
+        // by the later call to setSplitType() in the case that we're restoring a multiband split
+        juce::XmlElement* frequenciesElement = element->getChildByName(XML_CACHED_CROSSOVER_FREQUENCIES_STR);
+        if (frequenciesElement != nullptr) {
+            splitter.cachedcrossoverFrequencies = std::vector<float>();
+            const int numFrequencies {frequenciesElement->getNumAttributes()};
+            for (int index {0}; index < numFrequencies; index++) {
+                if (frequenciesElement->hasAttribute(getCachedCrossoverFreqXMLName(index))) {
+                    splitter.cachedcrossoverFrequencies.value().push_back(
+                        frequenciesElement->getDoubleAttribute(getCachedCrossoverFreqXMLName(index)));
+                }
+            }
+        }
+
+        splitter.splitter = XmlReader::restoreSplitterFromXml(
+            element,
+            getModulationValueCallback,
+            latencyChangeCallback,
+            config,
+            pluginConfigurator,
+            instantiator,
+            onErrorCallback,
+            sessionReader);
+
+        // Make sure prepareToPlay has been called on the splitter as we don't actually know if the host
+        // will call it via the PluginProcessor
+        if (splitter.splitter != nullptr) {
+            SplitterProcessors::prepareToPlay(*splitter.splitter.get(), config.sampleRate, config.blockSize, config.layout, config.maxLatencyCompensationSamples);
+        }
+
+        return newSplitterState;
+    }
+
+    bool splitterContainsPlugin(const PluginSplitter& splitter, const juce::AudioPluginInstance* plugin) {
+        for (const PluginChainWrapper& chainWrapper : splitter.chains) {
+            for (const std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                    if (pluginSlot->plugin.get() == plugin) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool splittersSharePlugins(const PluginSplitter& splitter, const PluginSplitter& otherSplitter) {
+        for (const PluginChainWrapper& chainWrapper : splitter.chains) {
+            for (const std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
+                    if (splitterContainsPlugin(otherSplitter, pluginSlot->plugin.get())) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * True if the audio thread may be processing the plugin as part of the published state or the
+     * state being faded out.
+     */
+    bool isPluginInUse(ModelInterface::StateManager& manager, const juce::AudioPluginInstance* plugin) {
+        for (const ModelInterface::StateWrapper* state : {manager.publishedState.load(std::memory_order_seq_cst),
+                                                          manager.fadingState.load(std::memory_order_seq_cst)}) {
+            if (state != nullptr
+                    && state->splitterState->splitter != nullptr
+                    && splitterContainsPlugin(*state->splitterState->splitter, plugin)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * The chains and slots of the published state and the state being faded out, which the audio
+     * thread may be processing.
+     */
+    std::set<const void*> getNodesInUse(ModelInterface::StateManager& manager) {
+        std::set<const void*> retVal;
+
+        for (const ModelInterface::StateWrapper* state : {manager.publishedState.load(std::memory_order_seq_cst),
+                                                          manager.fadingState.load(std::memory_order_seq_cst)}) {
+            if (state != nullptr && state->splitterState->splitter != nullptr) {
+                for (const PluginChainWrapper& chainWrapper : state->splitterState->splitter->chains) {
+                    retVal.insert(chainWrapper.chain.get());
+
+                    for (const std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                        retVal.insert(slot.get());
+                    }
+                }
+            }
+        }
+
+        return retVal;
+    }
+
+    /**
+     * Prepares a splitter that isn't published yet. States share plugin instances, so any that the
+     * audio thread may be processing are suspended while they're prepared - it passes audio
+     * through them until they're ready.
+     *
+     * States also share chains and slots, so any that the audio thread may be processing are
+     * copied rather than prepared in place.
+     */
+    void prepareUnpublishedSplitter(ModelInterface::StateManager& manager, PluginSplitter& splitter, HostConfiguration config) {
+        const std::set<const void*> nodesInUse {getNodesInUse(manager)};
+
+        for (size_t chainIndex {0}; chainIndex < splitter.chains.size(); chainIndex++) {
+            std::shared_ptr<PluginChain> chain {splitter.chains[chainIndex].chain};
+
+            if (nodesInUse.count(chain.get()) > 0) {
+                chain = splitter.replaceChainWithCopy(chainIndex);
+            }
+
+            for (size_t slotIndex {0}; slotIndex < chain->chain.size(); slotIndex++) {
+                if (nodesInUse.count(chain->chain[slotIndex].get()) > 0) {
+                    chain->replaceSlotWithCopy(slotIndex);
+                }
+            }
+        }
+
+        std::vector<std::shared_ptr<juce::AudioPluginInstance>> pluginsInUse;
+
+        for (const std::shared_ptr<juce::AudioPluginInstance>& plugin : getPlugins(splitter)) {
+            // Leave any that are already suspended for something else as they are
+            if (!plugin->isSuspended() && isPluginInUse(manager, plugin.get())) {
+                pluginsInUse.push_back(plugin);
+            }
+        }
+
+        // Takes each plugin's callback lock, so this waits for a block that's already being processed
+        for (std::shared_ptr<juce::AudioPluginInstance>& plugin : pluginsInUse) {
+            plugin->suspendProcessing(true);
+        }
+
+        SplitterProcessors::prepareToPlay(splitter, config.sampleRate, config.blockSize, config.layout, manager.maxLatencyCompensationSamples.load(std::memory_order_relaxed));
+
+        for (std::shared_ptr<juce::AudioPluginInstance>& plugin : pluginsInUse) {
+            plugin->suspendProcessing(false);
+        }
+    }
 
     void pushState(ModelInterface::StateManager& manager,
                    std::shared_ptr<ModelInterface::StateWrapper> state) {
@@ -45,42 +277,102 @@ namespace {
         manager.undoHistory.back()->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = false;
         state->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = true;
 
-        manager.undoHistory.push_back(state);
+        // New sources haven't been published yet, so their graph can be rebuilt here
+        if (state->modulationSourcesState != manager.undoHistory.back()->modulationSourcesState) {
+            ModulationProcessors::prepareGraph(*state->modulationSourcesState);
+        }
 
-        while (manager.undoHistory.size() > MAX_HISTORY_SIZE) {
-            manager.undoHistory.pop_front();
+        // The same goes for a new splitter
+        if (state->splitterState != manager.undoHistory.back()->splitterState) {
+            updateMergedBands(*state->splitterState->splitter);
         }
 
+        state->footprintBytes = state->calculateFootprintBytes(manager.undoHistory.back().get());
+        manager.undoHistory.push_back(state);
+        manager.trimUndoHistory();
+
         // If the state is updated, the redo history is no longer valid
+        for (std::shared_ptr<ModelInterface::StateWrapper>& redoState : manager.redoHistory) {
+            manager.retireState(redoState);
+        }
         manager.redoHistory.clear();
+
+        // Make sure there's enough scratch space for the processors and the worker pool to process
+        // every chain before the audio thread sees the new state
+        manager.scratchArena.ensureCapacity(SplitterProcessors::getNumScratchBuffersRequired(*state->splitterState->splitter));
+
+        if (manager.workerPool != nullptr) {
+            manager.workerPool->ensureCapacity(static_cast<int>(state->splitterState->splitter->chains.size()));
+        }
+
+        manager.publishCurrentState();
     }
 
-    /* Splitter */
+    /**
+     * Replaces the current state without adding to the undo history. Used when restoring and when
+     * continuing a parameter change, where the audio thread may still be processing the state being
+     * replaced.
+     */
+    void replaceCurrentState(ModelInterface::StateManager& manager,
+                             std::shared_ptr<ModelInterface::SplitterState> splitterState,
+                             std::shared_ptr<ModelInterface::ModulationSourcesState> sourcesState) {
+        std::shared_ptr<ModelInterface::StateWrapper> oldState = manager.undoHistory.back();
 
-    std::shared_ptr<ModelInterface::SplitterState> cloneSplitterState(const ModelInterface::StateManager& manager) {
-        if (manager.undoHistory.size() == 0) {
-            return nullptr;
+        if (splitterState->splitter != nullptr) {
+            splitterState->splitter->shouldNotifyProcessorOnLatencyChange = true;
         }
 
-        return std::shared_ptr<ModelInterface::SplitterState>(manager.undoHistory.back()->splitterState->clone());
+        if (oldState->splitterState != splitterState && oldState->splitterState->splitter != nullptr) {
+            oldState->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = false;
+        }
+
+        if (oldState->modulationSourcesState != sourcesState) {
+            ModulationProcessors::prepareGraph(*sourcesState);
+        }
+
+        if (oldState->splitterState != splitterState && splitterState->splitter != nullptr) {
+            updateMergedBands(*splitterState->splitter);
+        }
+
+        manager.undoHistory.back() = std::make_shared<ModelInterface::StateWrapper>(
+            splitterState, sourcesState, oldState->operation);
+
+        const size_t numStates {manager.undoHistory.size()};
+        manager.undoHistory.back()->footprintBytes = manager.undoHistory.back()->calculateFootprintBytes(
+            numStates > 1 ? manager.undoHistory[numStates - 2].get() : nullptr);
+
+        if (splitterState->splitter != nullptr) {
+            manager.scratchArena.ensureCapacity(SplitterProcessors::getNumScratchBuffersRequired(*splitterState->splitter));
+
+            if (manager.workerPool != nullptr) {
+                manager.workerPool->ensureCapacity(static_cast<int>(splitterState->splitter->chains.size()));
+            }
+        }
+
+        manager.retireState(oldState);
+        manager.publishCurrentState();
     }
 
-    // Use this instead of manager.cloneSplitterState() for parameter changes
-    // It will only clone the splitter state if we're not already in the middle of a change
-    std::shared_ptr<ModelInterface::SplitterState> cloneSplitterStateIfNeeded(const ModelInterface::StateManager& manager, const juce::String& operation) {
+    /**
+     * True if a change with the given operation continues the one the current state was pushed for,
+     * so it can replace the current state rather than adding another to the history.
+     */
+    bool isContinuingOperation(const ModelInterface::StateManager& manager, const juce::String& operation) {
         const std::optional<juce::String> previousOperation = ModelInterface::getUndoOperation(manager);
 
+        // After an undo the current state is shared with the states that can be redone, so the
+        // change starts a new state that clears them
+        return previousOperation.has_value() && previousOperation.value() == operation && manager.redoHistory.empty();
+    }
+
+    /* Splitter */
+
+    std::shared_ptr<ModelInterface::SplitterState> cloneSplitterState(const ModelInterface::StateManager& manager) {
         if (manager.undoHistory.size() == 0) {
             return nullptr;
         }
 
-        if (previousOperation.has_value() && previousOperation.value() == operation) {
-            // We're already in the middle of this change, return the current state
-            return manager.undoHistory.back()->splitterState;
-        }
-
-        // We're not in the middle of this change, clone the current state
-        return cloneSplitterState(manager);
+        return std::shared_ptr<ModelInterface::SplitterState>(manager.undoHistory.back()->splitterState->clone());
     }
 
     void pushSplitter(ModelInterface::StateManager& manager,
@@ -100,32 +392,31 @@ namespace {
         pushState(manager, newState);
     }
 
-    /* Sources */
-
-    std::shared_ptr<ModelInterface::ModulationSourcesState> cloneSourcesState(const ModelInterface::StateManager& manager) {
+    // Use this instead of pushSplitter() for parameter changes
+    // The splitter state must be a clone. If it continues the change the current state was pushed
+    // for, the current state is replaced with it rather than adding another to the history.
+    void pushOrReplaceSplitter(ModelInterface::StateManager& manager,
+                               std::shared_ptr<ModelInterface::SplitterState> splitterState,
+                               juce::String operation) {
         if (manager.undoHistory.size() == 0) {
-            return nullptr;
+            return;
         }
 
-        return std::shared_ptr<ModelInterface::ModulationSourcesState>(manager.undoHistory.back()->modulationSourcesState->clone());
+        if (isContinuingOperation(manager, operation)) {
+            replaceCurrentState(manager, splitterState, manager.undoHistory.back()->modulationSourcesState);
+        } else {
+            pushSplitter(manager, splitterState, operation);
+        }
     }
 
-    // Use this instead of manager.cloneSourcesState() for parameter changes
-    // It will only clone the sources state if we're not already in the middle of a change
-    std::shared_ptr<ModelInterface::ModulationSourcesState> cloneSourcesStateIfNeeded(const ModelInterface::StateManager& manager, const juce::String& operation) {
-        const std::optional<juce::String> previousOperation = ModelInterface::getUndoOperation(manager);
+    /* Sources */
 
+    std::shared_ptr<ModelInterface::ModulationSourcesState> cloneSourcesState(const ModelInterface::StateManager& manager) {
         if (manager.undoHistory.size() == 0) {
             return nullptr;
         }
 
-        if (previousOperation.has_value() && previousOperation.value() == operation) {
-            // We're already in the middle of this change, return the current state
-            return manager.undoHistory.back()->modulationSourcesState;
-        }
-
-        // We're not in the middle of this change, clone the current state
-        return cloneSourcesState(manager);
+        return std::shared_ptr<ModelInterface::ModulationSourcesState>(manager.undoHistory.back()->modulationSourcesState->clone());
     }
 
     void pushSources(ModelInterface::StateManager& manager,
@@ -144,6 +435,39 @@ namespace {
             manager.undoHistory.back()->splitterState, sourcesState, operation);
         pushState(manager, newState);
     }
+
+    // Use this instead of pushSources() for parameter changes
+    // The sources state must be a clone. If it continues the change the current state was pushed
+    // for, the current state is replaced with it rather than adding another to the history.
+    void pushOrReplaceSources(ModelInterface::StateManager& manager,
+                              std::shared_ptr<ModelInterface::ModulationSourcesState> sourcesState,
+                              juce::String operation) {
+        if (manager.undoHistory.size() == 0) {
+            return;
+        }
+
+        if (isContinuingOperation(manager, operation)) {
+            replaceCurrentState(manager, manager.undoHistory.back()->splitterState, sourcesState);
+        } else {
+            pushSources(manager, sourcesState, operation);
+        }
+    }
+
+    /**
+     * Returns the values the audio thread last published for a source, or nullptr if they aren't
+     * available and should be read from the data model instead. Only the message thread reads the
+     * telemetry, so other threads always get nullptr.
+     */
+    const UITelemetry::SourceValues* getSourceTelemetry(ModelInterface::StateManager& manager,
+                                                        UITelemetry::SourceTypeValues UITelemetry::Snapshot::*sourceType,
+                                                        int index) {
+        if (!juce::MessageManager::existsAndIsCurrentThread()) {
+            return nullptr;
+        }
+
+        const UITelemetry::Snapshot* snapshot {manager.telemetry.read()};
+        return snapshot != nullptr ? (snapshot->*sourceType).get(index) : nullptr;
+    }
 }
 
 namespace ModelInterface {
@@ -197,10 +521,16 @@ namespace ModelInterface {
             // Make sure prepareToPlay has been called on the splitter as we don't actually know if the host
             // will call it via the PluginProcessor
             if (splitter->splitter != nullptr) {
-                SplitterProcessors::prepareToPlay(*splitter->splitter.get(), config.sampleRate, config.blockSize, config.layout);
+                migratePluginLayouts(*splitter->splitter.get(), config, false);
+                prepareUnpublishedSplitter(manager, *splitter->splitter.get(), config);
             }
 
             pushSplitter(manager, splitter, "change split type");
+
+            if (splitter->splitter != nullptr) {
+                migratePluginLayouts(*splitter->splitter.get(), config, true);
+            }
+
             return true;
         }
 
@@ -282,14 +612,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set gain in chain " + juce::String(chainNumber + 1) + " slot " + juce::String(positionInChain + 1);
-        std::shared_ptr<SplitterState> splitter = cloneSplitterStateIfNeeded(manager, operation);
+        std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
 
         if (splitter == nullptr || splitter->splitter == nullptr) {
             return false;
         }
 
         if (SplitterMutators::setGainLinear(splitter->splitter, chainNumber, positionInChain, gain)) {
-            pushSplitter(manager, splitter, operation);
+            pushOrReplaceSplitter(manager, splitter, operation);
             return true;
         }
 
@@ -300,14 +630,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set pan in chain " + juce::String(chainNumber + 1) + " slot " + juce::String(positionInChain + 1);
-        std::shared_ptr<SplitterState> splitter = cloneSplitterStateIfNeeded(manager, operation);
+        std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
 
         if (splitter == nullptr || splitter->splitter == nullptr) {
             return false;
         }
 
         if (SplitterMutators::setPan(splitter->splitter, chainNumber, positionInChain, pan)) {
-            pushSplitter(manager, splitter, operation);
+            pushOrReplaceSplitter(manager, splitter, operation);
             return true;
         }
 
@@ -328,15 +658,15 @@ namespace ModelInterface {
         return std::make_tuple<float, float>(0, 0);
     }
 
-    float getGainStageOutputAmplitude(StateManager& manager, int chainNumber, int positionInChain, int channelNumber) {
+    std::shared_ptr<LevelMeter> getGainStageMeter(StateManager& manager, int chainNumber, int positionInChain) {
         std::scoped_lock lock(manager.mutatorsMutex);
         SplitterState& splitter = manager.getSplitterStateUnsafe();
 
         if (splitter.splitter != nullptr) {
-            return SplitterMutators::getGainStageOutputAmplitude(splitter.splitter, chainNumber, positionInChain, channelNumber);
+            return SplitterMutators::getGainStageMeter(splitter.splitter, chainNumber, positionInChain);
         }
 
-        return 0.0f;
+        return nullptr;
     }
 
     PluginModulationConfig getPluginModulationConfig(StateManager& manager, int chainNumber, int positionInChain) {
@@ -463,7 +793,7 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set value for target " + juce::String(targetNumber + 1) + " in slot " + juce::String(positionInChain + 1) + " in chain " + juce::String(chainNumber + 1);
-        std::shared_ptr<SplitterState> splitter = cloneSplitterStateIfNeeded(manager, operation);
+        std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
 
         if (splitter == nullptr || splitter->splitter == nullptr) {
             return;
@@ -478,7 +808,7 @@ namespace ModelInterface {
         config.parameterConfigs[targetNumber]->restValue = val;
 
         if (SplitterMutators::setPluginModulationConfig(splitter->splitter, config, chainNumber, positionInChain)) {
-            pushSplitter(manager, splitter, operation);
+            pushOrReplaceSplitter(manager, splitter, operation);
         }
     }
 
@@ -486,7 +816,7 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set amount for source " + juce::String(sourceNumber + 1) + " on target " + juce::String(targetNumber + 1) + " in slot " + juce::String(positionInChain + 1) + " in chain " + juce::String(chainNumber + 1);
-        std::shared_ptr<SplitterState> splitter = cloneSplitterStateIfNeeded(manager, operation);
+        std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
 
         if (splitter == nullptr || splitter->splitter == nullptr) {
             return;
@@ -505,7 +835,7 @@ namespace ModelInterface {
         config.parameterConfigs[targetNumber]->sources[sourceNumber]->modulationAmount = val;
 
         if (SplitterMutators::setPluginModulationConfig(splitter->splitter, config, chainNumber, positionInChain)) {
-            pushSplitter(manager, splitter, operation);
+            pushOrReplaceSplitter(manager, splitter, operation);
         }
     }
 
@@ -545,7 +875,7 @@ namespace ModelInterface {
             return;
         }
 
-        ChainMutators::setChainBypass(splitter->splitter->chains[chainNumber].chain, val);
+        ChainMutators::setChainBypass(splitter->splitter->getChainForWrite(chainNumber), val);
         pushSplitter(manager, splitter, "set chain " + juce::String(chainNumber + 1) + " bypass");
     }
 
@@ -561,7 +891,7 @@ namespace ModelInterface {
             return;
         }
 
-        ChainMutators::setChainMute(splitter->splitter->chains[chainNumber].chain, val);
+        ChainMutators::setChainMute(splitter->splitter->getChainForWrite(chainNumber), val);
         pushSplitter(manager, splitter, "set chain " + juce::String(chainNumber + 1) + " mute");
     }
 
@@ -611,6 +941,17 @@ namespace ModelInterface {
         return false;
     }
 
+    bool getChainIsSleeping(StateManager& manager, int chainNumber) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+        SplitterState& splitter = manager.getSplitterStateUnsafe();
+
+        if (splitter.splitter != nullptr && chainNumber < splitter.splitter->chains.size()) {
+            return splitter.splitter->chains[chainNumber].chain->isSleeping.load(std::memory_order_relaxed);
+        }
+
+        return false;
+    }
+
     void moveSlot(StateManager& manager, int fromChainNumber, int fromSlotNumber, int toChainNumber, int toSlotNumber) {
         std::scoped_lock lock(manager.mutatorsMutex);
         std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
@@ -790,7 +1131,7 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set crossover frequency";
-        std::shared_ptr<SplitterState> splitter = cloneSplitterStateIfNeeded(manager, operation);
+        std::shared_ptr<SplitterState> splitter = cloneSplitterState(manager);
 
         if (splitter == nullptr || splitter->splitter == nullptr) {
             return false;
@@ -801,7 +1142,7 @@ namespace ModelInterface {
         if (multibandSplitter != nullptr) {
             if (index < SplitterMutators::getNumBands(multibandSplitter) - 1) {
                 if (SplitterMutators::setCrossoverFrequency(multibandSplitter, index, val)) {
-                    pushSplitter(manager, splitter, operation);
+                    pushOrReplaceSplitter(manager, splitter, operation);
                     return true;
                 }
             }
@@ -853,26 +1194,39 @@ namespace ModelInterface {
     }
 
     std::pair<std::array<float, FFTProvider::NUM_OUTPUTS>, float> getFFTOutputs(StateManager& manager) {
-        std::scoped_lock lock(manager.mutatorsMutex);
-        SplitterState& splitter = manager.getSplitterStateUnsafe();
+        bool isMultiband {false};
 
-        auto multibandSplitter = std::dynamic_pointer_cast<PluginSplitterMultiband>(splitter.splitter);
-
-        if (multibandSplitter != nullptr) {
-            std::array<float, FFTProvider::NUM_OUTPUTS> bins;
-            const float* outputs = multibandSplitter->fftProvider.getOutputs();
+        {
+            std::scoped_lock lock(manager.mutatorsMutex);
+            SplitterState& splitter = manager.getSplitterStateUnsafe();
+            isMultiband = splitter.splitter != nullptr && splitter.splitter->splitType == SPLIT_TYPE::MULTIBAND;
+        }
 
-            std::copy(outputs, outputs + FFTProvider::NUM_OUTPUTS, bins.begin());
+        std::array<float, FFTProvider::NUM_OUTPUTS> bins;
 
-            return std::make_pair(bins, multibandSplitter->fftProvider.getBinWidth());
+        if (isMultiband) {
+            // The FFT provider has its own lock, so don't hold up the mutators while analysing
+            manager.fftProvider.updateOutputs(bins);
+            return std::make_pair(bins, manager.fftProvider.getBinWidth());
         }
 
-        std::array<float, FFTProvider::NUM_OUTPUTS> bins;
         std::fill(bins.begin(), bins.end(), 0.0f);
 
         return std::make_pair(bins, 0);
     }
 
+    void attachFFTVisualiser(StateManager& manager) {
+        manager.fftProvider.attachVisualiser();
+    }
+
+    void detachFFTVisualiser(StateManager& manager) {
+        manager.fftProvider.detachVisualiser();
+    }
+
+    bool hasNewFFTSamples(StateManager& manager) {
+        return manager.fftProvider.hasNewSamples();
+    }
+
     std::shared_ptr<PluginEditorBounds> getPluginEditorBounds(StateManager& manager, int chainNumber, int positionInChain) {
         std::scoped_lock lock(manager.mutatorsMutex);
         SplitterState& splitter = manager.getSplitterStateUnsafe();
@@ -908,11 +1262,11 @@ namespace ModelInterface {
         }
     }
 
-    void writeSplitterToXml(StateManager& manager, juce::XmlElement* element) {
+    void writeSplitterToXml(StateManager& manager, juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
         std::scoped_lock lock(manager.mutatorsMutex);
         SplitterState& splitter = manager.getSplitterStateUnsafe();
 
-        XmlWriter::write(splitter.splitter, element);
+        XmlWriter::write(splitter.splitter, element, sessionWriter);
 
         // Store the cached crossover frequencies
         if (splitter.cachedcrossoverFrequencies.has_value()) {
@@ -930,39 +1284,404 @@ namespace ModelInterface {
                                 HostConfiguration config,
                                 const PluginConfigurator& pluginConfigurator,
                                 juce::Array<juce::PluginDescription> availableTypes,
-                                std::function<void(juce::String)> onErrorCallback) {
+                                std::function<void(juce::String)> onErrorCallback,
+                                bool usePlaceholders,
+                                bool reuseRunningPlugins,
+                                const SessionFormat::Reader* sessionReader) {
+        PluginInstantiator instantiator(availableTypes);
+        instantiator.setCreatePlaceholders(usePlaceholders);
+
+        // The processor doesn't know the limit, so the restored chains are prepared with the manager's
+        config.maxLatencyCompensationSamples = manager.maxLatencyCompensationSamples.load(std::memory_order_relaxed);
+
+        if (reuseRunningPlugins) {
+            // Slots that match a plugin in the current state take it over rather than creating a new
+            // one, so switching between similar documents only has to restore the plugins' state
+            std::scoped_lock lock(manager.mutatorsMutex);
+
+            if (!manager.undoHistory.empty() && manager.getSplitterStateUnsafe().splitter != nullptr) {
+                std::vector<std::shared_ptr<juce::AudioPluginInstance>> plugins = getPlugins(*manager.getSplitterStateUnsafe().splitter);
+
+                // The standby may be faded in at any time, so its plugins must keep their state
+                if (manager.standbyState != nullptr && manager.standbyState->splitterState->splitter != nullptr) {
+                    const PluginSplitter& standbySplitter = *manager.standbyState->splitterState->splitter;
+                    plugins.erase(
+                        std::remove_if(plugins.begin(), plugins.end(),
+                                       [&standbySplitter](const std::shared_ptr<juce::AudioPluginInstance>& plugin) {
+                                           return splitterContainsPlugin(standbySplitter, plugin.get());
+                                       }),
+                        plugins.end());
+                }
+
+                instantiator.addReusablePlugins(plugins);
+            }
+        }
+
+        // The whole splitter is built before taking the locks, loading plugins can take a long time
+        // and nothing else should be blocked while it happens
+        std::shared_ptr<SplitterState> newSplitterState = restoreSplitterState(
+            element, getModulationValueCallback, latencyChangeCallback, config, pluginConfigurator, instantiator, onErrorCallback, sessionReader);
+        SplitterState& splitter = *newSplitterState;
+        const bool hasCachedFrequencies {element->getChildByName(XML_CACHED_CROSSOVER_FREQUENCIES_STR) != nullptr};
+
+        // Publish the finished splitter in one go
+        const double publishStartTime {juce::Time::getMillisecondCounterHiRes()};
+        {
+            std::scoped_lock lock(manager.mutatorsMutex);
+
+            // Reused plugins pass audio through from here until the splitter is published, so this is
+            // left as late as possible
+            instantiator.suspendReusedPlugins();
+
+            // States in the history still use the reused plugins, which no longer have the state
+            // those states expect. They get a placeholder with the state each plugin had instead,
+            // which is loaded in the background like any other. As in replacePlaceholder() states
+            // can share a splitter, so each one is only cloned once.
+            std::map<const SplitterState*, std::shared_ptr<SplitterState>> snapshotSplitters;
+
+            auto getSnapshotSplitter = [&](const std::shared_ptr<SplitterState>& splitterState) {
+                auto snapshotIt = snapshotSplitters.find(splitterState.get());
+                if (snapshotIt != snapshotSplitters.end()) {
+                    return snapshotIt->second;
+                }
+
+                std::shared_ptr<SplitterState> snapshotSplitter;
+                if (splitterState->splitter != nullptr) {
+                    for (const PluginInstantiator::ReusedPlugin& reused : instantiator.getReusedPlugins()) {
+                        if (!splitterContainsPlugin(*splitterState->splitter, reused.plugin.get())) {
+                            continue;
+                        }
+
+                        if (snapshotSplitter == nullptr) {
+                            snapshotSplitter.reset(splitterState->clone());
+                            snapshotSplitter->splitter->shouldNotifyProcessorOnLatencyChange = false;
+                        }
+
+                        pluginConfigurator.configure(reused.previousState,
+                                                     snapshotSplitter->splitter->config,
+                                                     PluginConfigurator::isMonoChainSplitType(snapshotSplitter->splitter->splitType));
+                        SplitterMutators::swapPlugin(snapshotSplitter->splitter, reused.plugin.get(), reused.previousState, false);
+                    }
+                }
+
+                snapshotSplitters[splitterState.get()] = snapshotSplitter;
+                return snapshotSplitter;
+            };
+
+            for (std::deque<std::shared_ptr<StateWrapper>>* history : {&manager.undoHistory, &manager.redoHistory}) {
+                for (std::shared_ptr<StateWrapper>& state : *history) {
+                    if (state == manager.undoHistory.back()) {
+                        continue;
+                    }
+
+                    if (std::shared_ptr<SplitterState> snapshotSplitter = getSnapshotSplitter(state->splitterState)) {
+                        state->splitterState = snapshotSplitter;
+                    }
+                }
+            }
+
+            // Now the reused plugins have their restored state they can take their slots
+            if (splitter.splitter != nullptr) {
+                for (const PluginInstantiator::ReusedPlugin& reused : instantiator.getReusedPlugins()) {
+                    SplitterMutators::swapPlugin(splitter.splitter, reused.standIn.get(), reused.plugin, false);
+                }
+            }
+
+            WECore::AudioSpinLock sharedLock(manager.sharedMutex);
+
+            if (!hasCachedFrequencies) {
+                splitter.cachedcrossoverFrequencies = manager.getSplitterStateUnsafe().cachedcrossoverFrequencies;
+            }
+
+            replaceCurrentState(manager, newSplitterState, manager.undoHistory.back()->modulationSourcesState);
+        }
+
+        // The reused plugins are now only in the published splitter's chains
+        instantiator.resumeReusedPlugins();
+
+        juce::Logger::writeToLog("Published restored splitter in " + juce::String(juce::Time::getMillisecondCounterHiRes() - publishStartTime, 1) + "ms");
+    }
+
+    std::shared_ptr<StateWrapper> createStandbyFromXml(juce::XmlElement* splitterElement,
+                                                       juce::XmlElement* sourcesElement,
+                                                       std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+                                                       std::function<void(int)> latencyChangeCallback,
+                                                       HostConfiguration config,
+                                                       const PluginConfigurator& pluginConfigurator,
+                                                       PluginInstantiator& instantiator,
+                                                       std::function<void(juce::String)> onErrorCallback) {
+        // The processor's latency follows the current state, so don't report the standby's latency
+        // while it's being restored
+        std::shared_ptr<SplitterState> splitterState = restoreSplitterState(
+            splitterElement, getModulationValueCallback, [](int) {}, config, pluginConfigurator, instantiator, onErrorCallback, nullptr);
+
+        if (splitterState->splitter != nullptr) {
+            splitterState->splitter->notifyProcessorOnLatencyChange = latencyChangeCallback;
+            splitterState->splitter->shouldNotifyProcessorOnLatencyChange = false;
+        }
+
+        auto sourcesState = std::make_shared<ModulationSourcesState>(getModulationValueCallback);
+        if (sourcesElement != nullptr) {
+            XmlReader::restoreModulationSourcesFromXml(*sourcesState, sourcesElement, config);
+        }
+
+        ModulationProcessors::prepareToPlay(*sourcesState, config.sampleRate, config.blockSize, config.layout);
+        ModulationProcessors::prepareGraph(*sourcesState);
+
+        return std::make_shared<StateWrapper>(splitterState, sourcesState, "Load standby");
+    }
+
+    void setStandby(StateManager& manager, std::shared_ptr<StateWrapper> state) {
         std::scoped_lock lock(manager.mutatorsMutex);
         WECore::AudioSpinLock sharedLock(manager.sharedMutex);
-        SplitterState& splitter = manager.getSplitterStateUnsafe();
 
-        // Restore the cached crossover frequencies first, we need to allow for them to be overwritten
-        // by the later call to setSplitType() in the case that we're restoring a multiband split
-        juce::XmlElement* frequenciesElement = element->getChildByName(XML_CACHED_CROSSOVER_FREQUENCIES_STR);
-        if (frequenciesElement != nullptr) {
-            splitter.cachedcrossoverFrequencies = std::vector<float>();
-            const int numFrequencies {frequenciesElement->getNumAttributes()};
-            for (int index {0}; index < numFrequencies; index++) {
-                if (frequenciesElement->hasAttribute(getCachedCrossoverFreqXMLName(index))) {
-                    splitter.cachedcrossoverFrequencies.value().push_back(
-                        frequenciesElement->getDoubleAttribute(getCachedCrossoverFreqXMLName(index)));
+        if (manager.standbyState != nullptr) {
+            // It may still be fading out
+            manager.retireState(manager.standbyState);
+        }
+
+        manager.standbyState = state;
+
+        int latencySamples {0};
+        if (state != nullptr && state->splitterState->splitter != nullptr) {
+            const PluginSplitter& splitter = *state->splitterState->splitter;
+            latencySamples = splitter.getLatencySamples();
+
+            // Both states are processed in the same block while fading, one after the other
+            manager.scratchArena.ensureCapacity(SplitterProcessors::getNumScratchBuffersRequired(splitter));
+
+            if (manager.workerPool != nullptr) {
+                manager.workerPool->ensureCapacity(static_cast<int>(splitter.chains.size()));
+            }
+        }
+
+        manager.standbyLatencySamples.store(latencySamples);
+        manager.reclaimRetiredStates();
+    }
+
+    bool hasStandby(StateManager& manager) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+        return manager.standbyState != nullptr;
+    }
+
+    int getStandbyLatencySamples(StateManager& manager) {
+        return manager.standbyLatencySamples.load();
+    }
+
+    bool switchToStandby(StateManager& manager, int crossfadeLengthSamples) {
+        std::shared_ptr<PluginSplitter> newSplitter;
+
+        {
+            std::scoped_lock lock(manager.mutatorsMutex);
+            WECore::AudioSpinLock sharedLock(manager.sharedMutex);
+
+            if (manager.standbyState == nullptr) {
+                return false;
+            }
+
+            std::shared_ptr<StateWrapper> outgoingState = manager.undoHistory.back();
+            std::shared_ptr<StateWrapper> incomingState = manager.standbyState;
+
+            // The history is kept, undo() and redo() wait for the crossfade to finish instead. After
+            // that a state restored from it may share plugins with the standby, which can't both be
+            // processed in the same block, so switch between them without a crossfade
+            const bool canCrossfade {
+                outgoingState->splitterState->splitter == nullptr
+                || incomingState->splitterState->splitter == nullptr
+                || !splittersSharePlugins(*outgoingState->splitterState->splitter, *incomingState->splitterState->splitter)
+            };
+
+            // Set before publishing, the audio thread ignores it until the incoming state is current
+            manager.crossfadeLengthSamples.store(canCrossfade ? std::max(crossfadeLengthSamples, 0) : 0);
+            manager.fadingState.store(outgoingState.get(), std::memory_order_seq_cst);
+
+            replaceCurrentState(manager, incomingState->splitterState, incomingState->modulationSourcesState);
+
+            // The audio thread may still be fading the incoming state out from a previous switch
+            manager.retireState(incomingState);
+
+            // Already prepared, so it can be switched back to straight away
+            manager.standbyState = outgoingState;
+            manager.standbyLatencySamples.store(
+                outgoingState->splitterState->splitter != nullptr ? outgoingState->splitterState->splitter->getLatencySamples() : 0);
+
+            newSplitter = incomingState->splitterState->splitter;
+        }
+
+        // Tell the processor the latency of the new current state
+        if (newSplitter != nullptr) {
+            newSplitter->onLatencyChange();
+        }
+
+        return true;
+    }
+
+    std::optional<PlaceholderToLoad> getNextPlaceholder(StateManager& manager, bool loadInactiveLast) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+
+        if (manager.undoHistory.empty()) {
+            return std::optional<PlaceholderToLoad>();
+        }
+
+        std::optional<PlaceholderToLoad> inactivePlaceholder;
+        std::optional<PlaceholderToLoad> standbyPlaceholder;
+        std::optional<PlaceholderToLoad> historyPlaceholder;
+
+        // Placeholders in states other than the current one are kept in otherStatePlaceholder
+        auto findPlaceholders = [&](const SplitterState& splitterState,
+                                    std::optional<PlaceholderToLoad>* otherStatePlaceholder) -> std::optional<PlaceholderToLoad> {
+            std::shared_ptr<PluginSplitter> splitter = splitterState.splitter;
+
+            if (splitter == nullptr) {
+                return std::optional<PlaceholderToLoad>();
+            }
+
+            bool hasSoloedChain {false};
+            for (const PluginChainWrapper& chainWrapper : splitter->chains) {
+                hasSoloedChain = hasSoloedChain || chainWrapper.isSoloed;
+            }
+
+            for (const PluginChainWrapper& chainWrapper : splitter->chains) {
+                const bool isChainAudible {
+                    !chainWrapper.chain->isChainMuted
+                    && !chainWrapper.chain->isChainBypassed
+                    && (!hasSoloedChain || chainWrapper.isSoloed)
+                };
+
+                for (const std::shared_ptr<ChainSlotBase>& slot : chainWrapper.chain->chain) {
+                    auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot);
+                    if (pluginSlot == nullptr) {
+                        continue;
+                    }
+
+                    auto placeholder = std::dynamic_pointer_cast<PlaceholderPluginInstance>(pluginSlot->plugin);
+                    if (placeholder == nullptr || placeholder->hasFailedToLoad()) {
+                        continue;
+                    }
+
+                    PlaceholderToLoad thisPlaceholder {
+                        placeholder, splitter->config, PluginConfigurator::isMonoChainSplitType(splitter->splitType)
+                    };
+
+                    if (otherStatePlaceholder != nullptr) {
+                        if (!otherStatePlaceholder->has_value()) {
+                            *otherStatePlaceholder = thisPlaceholder;
+                        }
+                    } else if (!loadInactiveLast || (isChainAudible && !pluginSlot->isBypassed)) {
+                        return thisPlaceholder;
+                    } else if (!inactivePlaceholder.has_value()) {
+                        inactivePlaceholder = thisPlaceholder;
+                    }
                 }
             }
+
+            return std::optional<PlaceholderToLoad>();
+        };
+
+        std::optional<PlaceholderToLoad> retVal = findPlaceholders(*manager.undoHistory.back()->splitterState, nullptr);
+
+        if (!retVal.has_value() && !inactivePlaceholder.has_value()) {
+            if (manager.standbyState != nullptr) {
+                findPlaceholders(*manager.standbyState->splitterState, &standbyPlaceholder);
+            }
+
+            for (const std::shared_ptr<StateWrapper>& state : manager.undoHistory) {
+                findPlaceholders(*state->splitterState, &historyPlaceholder);
+            }
+
+            for (const std::shared_ptr<StateWrapper>& state : manager.redoHistory) {
+                findPlaceholders(*state->splitterState, &historyPlaceholder);
+            }
         }
 
-        splitter.splitter = XmlReader::restoreSplitterFromXml(
-            element,
-            getModulationValueCallback,
-            latencyChangeCallback,
-            config,
-            pluginConfigurator,
-            availableTypes,
-            onErrorCallback);
+        if (retVal.has_value()) {
+            return retVal;
+        }
 
-        // Make sure prepareToPlay has been called on the splitter as we don't actually know if the host
-        // will call it via the PluginProcessor
-        if (splitter.splitter != nullptr) {
-            SplitterProcessors::prepareToPlay(*splitter.splitter.get(), config.sampleRate, config.blockSize, config.layout);
+        if (inactivePlaceholder.has_value()) {
+            return inactivePlaceholder;
         }
+
+        return standbyPlaceholder.has_value() ? standbyPlaceholder : historyPlaceholder;
+    }
+
+    bool replacePlaceholder(StateManager& manager,
+                            std::shared_ptr<PlaceholderPluginInstance> placeholder,
+                            std::shared_ptr<juce::AudioPluginInstance> plugin) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+
+        if (manager.undoHistory.empty()) {
+            return false;
+        }
+
+        // States in the history can share a splitter, so each splitter containing the placeholder
+        // is only cloned once and the clone is shared in the same way
+        std::map<const SplitterState*, std::shared_ptr<SplitterState>> swappedSplitters;
+        bool isFound {false};
+
+        auto getSwappedSplitter = [&](const std::shared_ptr<SplitterState>& splitterState, bool shouldCrossfade) {
+            auto swappedIt = swappedSplitters.find(splitterState.get());
+            if (swappedIt != swappedSplitters.end()) {
+                return swappedIt->second;
+            }
+
+            std::shared_ptr<SplitterState> swappedSplitter;
+            if (splitterState->splitter != nullptr && splitterContainsPlugin(*splitterState->splitter, placeholder.get())) {
+                swappedSplitter.reset(splitterState->clone());
+
+                // Only the current state's splitter should notify the processor, which is set when
+                // it's published
+                swappedSplitter->splitter->shouldNotifyProcessorOnLatencyChange = false;
+                SplitterMutators::swapPlugin(swappedSplitter->splitter, placeholder.get(), plugin, shouldCrossfade);
+                isFound = true;
+            }
+
+            swappedSplitters[splitterState.get()] = swappedSplitter;
+            return swappedSplitter;
+        };
+
+        // The current state is swapped first so it's the one that crossfades from the placeholder
+        // to the plugin, but it's published last so the audio thread can't be using the plugin while
+        // the other states prepare it
+        std::shared_ptr<SplitterState> swappedCurrentSplitter = getSwappedSplitter(manager.undoHistory.back()->splitterState, true);
+
+        // The states that aren't published can be changed in place
+        for (std::deque<std::shared_ptr<StateWrapper>>* history : {&manager.undoHistory, &manager.redoHistory}) {
+            for (std::shared_ptr<StateWrapper>& state : *history) {
+                if (state == manager.undoHistory.back()) {
+                    continue;
+                }
+
+                if (std::shared_ptr<SplitterState> swappedSplitter = getSwappedSplitter(state->splitterState, false)) {
+                    state->splitterState = swappedSplitter;
+                }
+            }
+        }
+
+        // The standby may be fading out, so the audio thread may be using its wrapper. It's
+        // replaced rather than changed in place, and the old one is retired until the fade finishes.
+        std::shared_ptr<StateWrapper> swappedStandby;
+        if (manager.standbyState != nullptr) {
+            if (std::shared_ptr<SplitterState> swappedSplitter = getSwappedSplitter(manager.standbyState->splitterState, false)) {
+                swappedStandby = std::make_shared<StateWrapper>(
+                    swappedSplitter, manager.standbyState->modulationSourcesState, manager.standbyState->operation);
+            }
+        }
+
+        if (swappedCurrentSplitter != nullptr || swappedStandby != nullptr) {
+            WECore::AudioSpinLock sharedLock(manager.sharedMutex);
+
+            if (swappedStandby != nullptr) {
+                manager.retireState(manager.standbyState);
+                manager.standbyState = swappedStandby;
+            }
+
+            if (swappedCurrentSplitter != nullptr) {
+                replaceCurrentState(manager, swappedCurrentSplitter, manager.undoHistory.back()->modulationSourcesState);
+            }
+        }
+
+        return isFound;
     }
 
     void createDefaultSources(StateManager& manager) {
@@ -970,10 +1689,13 @@ namespace ModelInterface {
         WECore::AudioSpinLock sharedLock(manager.sharedMutex);
 
         // No undo/redo needed here
-        ModulationMutators::addLfo(manager.getSourcesStateUnsafe());
-        ModulationMutators::addEnvelope(manager.getSourcesStateUnsafe());
-        ModulationMutators::addRandom(manager.getSourcesStateUnsafe());
-        ModulationMutators::addStepSequencer(manager.getSourcesStateUnsafe());
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
+        ModulationMutators::addLfo(sources);
+        ModulationMutators::addEnvelope(sources);
+        ModulationMutators::addRandom(sources);
+        ModulationMutators::addStepSequencer(sources);
+
+        replaceCurrentState(manager, manager.undoHistory.back()->splitterState, sources);
     }
 
     void addLfo(StateManager& manager) {
@@ -1042,16 +1764,22 @@ namespace ModelInterface {
 
         // Iterate through each plugin, remove the source if it has been assigned and renumber ones that
         // are numbered higher
-        for (PluginChainWrapper& chain : newState->splitterState->splitter->chains) {
-            for (int slotIndex {0}; slotIndex < ChainMutators::getNumSlots(chain.chain); slotIndex++) {
-                PluginModulationConfig thisPluginConfig = ChainMutators::getPluginModulationConfig(chain.chain, slotIndex);
+        PluginSplitter& splitter = *newState->splitterState->splitter;
+        for (size_t chainIndex {0}; chainIndex < splitter.chains.size(); chainIndex++) {
+            for (int slotIndex {0}; slotIndex < ChainMutators::getNumSlots(splitter.chains[chainIndex].chain); slotIndex++) {
+                PluginModulationConfig thisPluginConfig = ChainMutators::getPluginModulationConfig(splitter.chains[chainIndex].chain, slotIndex);
+
+                // Only copy the slots that are affected
+                if (!isSourceOrHigherAssigned(thisPluginConfig, definition)) {
+                    continue;
+                }
 
                 // Iterate through each configured parameter
                 for (std::shared_ptr<PluginParameterModulationConfig> parameterConfig : thisPluginConfig.parameterConfigs) {
                     parameterConfig->sources = deleteSourceFromTargetSources(parameterConfig->sources, definition);
                 }
 
-                ChainMutators::setPluginModulationConfig(chain.chain, thisPluginConfig, slotIndex);
+                ChainMutators::setPluginModulationConfig(splitter.getChainForWrite(chainIndex), thisPluginConfig, slotIndex);
             }
         }
 
@@ -1150,14 +1878,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " tempo numerator";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLfoTempoNumer(sources, lfoIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1165,14 +1893,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " tempo denominator";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLfoTempoDenom(sources, lfoIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1180,14 +1908,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " frequency";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLfoFreq(sources, lfoIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1195,14 +1923,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " depth";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLfoDepth(sources, lfoIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1210,14 +1938,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " phase";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLfoManualPhase(sources, lfoIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1251,14 +1979,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " rate modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLFOFreqModulationAmount(sources, lfoIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1297,14 +2025,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " depth modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLFODepthModulationAmount(sources, lfoIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1343,14 +2071,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set LFO " + juce::String(lfoIndex + 1) + " phase modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setLFOPhaseModulationAmount(sources, lfoIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1395,6 +2123,10 @@ namespace ModelInterface {
     }
 
     double getLFOModulatedFreqValue(StateManager& manager, int lfoIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::lfos, lfoIndex)) {
+            return values->modulatedFreq;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getLFOModulatedFreqValue(manager.getSourcesStateUnsafe(), lfoIndex);
     }
@@ -1405,6 +2137,10 @@ namespace ModelInterface {
     }
 
     double getLFOModulatedDepthValue(StateManager& manager, int lfoIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::lfos, lfoIndex)) {
+            return values->modulatedDepth;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getLFOModulatedDepthValue(manager.getSourcesStateUnsafe(), lfoIndex);
     }
@@ -1415,6 +2151,10 @@ namespace ModelInterface {
     }
 
     double getLFOModulatedPhaseValue(StateManager& manager, int lfoIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::lfos, lfoIndex)) {
+            return values->modulatedPhase;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getLFOModulatedPhaseValue(manager.getSourcesStateUnsafe(), lfoIndex);
     }
@@ -1423,14 +2163,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set ENV " + juce::String(envIndex + 1) + " attack time";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setEnvAttackTimeMs(sources, envIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1438,14 +2178,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set ENV " + juce::String(envIndex + 1) + " release time";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setEnvReleaseTimeMs(sources, envIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1466,14 +2206,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set ENV " + juce::String(envIndex + 1) + " filter cutoff";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setEnvFilterHz(sources, envIndex, lowCut, highCut)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1481,14 +2221,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set ENV " + juce::String(envIndex + 1) + " amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setEnvAmount(sources, envIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1545,6 +2285,16 @@ namespace ModelInterface {
         return ModulationMutators::getEnvLastOutput(manager.getSourcesStateUnsafe(), envIndex);
     }
 
+    double getEnvOutputWithAmount(StateManager& manager, int envIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::envelopes, envIndex)) {
+            return values->output;
+        }
+
+        std::scoped_lock lock(manager.mutatorsMutex);
+        return ModulationMutators::getEnvLastOutput(manager.getSourcesStateUnsafe(), envIndex)
+            * ModulationMutators::getEnvAmount(manager.getSourcesStateUnsafe(), envIndex);
+    }
+
     void setRandomOutputMode(StateManager& manager, int randomIndex, int val) {
         std::scoped_lock lock(manager.mutatorsMutex);
         std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
@@ -1562,14 +2312,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set RND " + juce::String(randomIndex + 1) + " frequency";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setRandomFreq(sources, randomIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1577,14 +2327,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set RND " + juce::String(randomIndex + 1) + " depth";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setRandomDepth(sources, randomIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1618,14 +2368,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set RND " + juce::String(randomIndex + 1) + " frequency modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setRandomFreqModulationAmount(sources, randomIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1664,14 +2414,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set RND " + juce::String(randomIndex + 1) + " depth modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setRandomDepthModulationAmount(sources, randomIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1691,6 +2441,10 @@ namespace ModelInterface {
     }
 
     double getRandomModulatedFreqValue(StateManager& manager, int randomIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::randomSources, randomIndex)) {
+            return values->modulatedFreq;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getRandomModulatedFreqValue(manager.getSourcesStateUnsafe(), randomIndex);
     }
@@ -1701,11 +2455,19 @@ namespace ModelInterface {
     }
 
     double getRandomModulatedDepthValue(StateManager& manager, int randomIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::randomSources, randomIndex)) {
+            return values->modulatedDepth;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getRandomModulatedDepthValue(manager.getSourcesStateUnsafe(), randomIndex);
     }
 
     double getRandomLastOutput(StateManager& manager, int randomIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::randomSources, randomIndex)) {
+            return values->output;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getRandomLastOutput(manager.getSourcesStateUnsafe(), randomIndex);
     }
@@ -1740,14 +2502,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " frequency modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqFreqModulationAmount(sources, seqIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1786,14 +2548,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " depth modulation amount";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqDepthModulationAmount(sources, seqIndex, sourceIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1819,14 +2581,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " tempo numerator";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqTempoNumer(sources, seqIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1834,14 +2596,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " tempo denominator";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqTempoDenom(sources, seqIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1849,14 +2611,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " frequency";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqFreq(sources, seqIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1864,14 +2626,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " depth";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqDepth(sources, seqIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1910,14 +2672,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " step " + juce::String(stepIndex) + " value";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqStepValue(sources, seqIndex, patternIndex, stepIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1951,14 +2713,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " step " + juce::String(stepIndex) + " repeat";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqStepRepeat(sources, seqIndex, patternIndex, stepIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1966,14 +2728,14 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
 
         const juce::String operation = "set SEQ " + juce::String(seqIndex + 1) + " step " + juce::String(stepIndex) + " length multiplier";
-        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesStateIfNeeded(manager, operation);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
 
         if (sources == nullptr) {
             return;
         }
 
         if (ModulationMutators::setStepSeqStepLengthMultiplier(sources, seqIndex, patternIndex, stepIndex, val)) {
-            pushSources(manager, sources, operation);
+            pushOrReplaceSources(manager, sources, operation);
         }
     }
 
@@ -1998,6 +2760,10 @@ namespace ModelInterface {
     }
 
     double getStepSeqModulatedFreqValue(StateManager& manager, int seqIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::stepSequencers, seqIndex)) {
+            return values->modulatedFreq;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getStepSeqModulatedFreqValue(manager.getSourcesStateUnsafe(), seqIndex);
     }
@@ -2008,6 +2774,10 @@ namespace ModelInterface {
     }
 
     double getStepSeqModulatedDepthValue(StateManager& manager, int seqIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::stepSequencers, seqIndex)) {
+            return values->modulatedDepth;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getStepSeqModulatedDepthValue(manager.getSourcesStateUnsafe(), seqIndex);
     }
@@ -2038,6 +2808,10 @@ namespace ModelInterface {
     }
 
     double getStepSeqLastOutput(StateManager& manager, int seqIndex) {
+        if (const UITelemetry::SourceValues* values = getSourceTelemetry(manager, &UITelemetry::Snapshot::stepSequencers, seqIndex)) {
+            return values->output;
+        }
+
         std::scoped_lock lock(manager.mutatorsMutex);
         return ModulationMutators::getStepSeqLastOutput(manager.getSourcesStateUnsafe(), seqIndex);
     }
@@ -2068,13 +2842,20 @@ namespace ModelInterface {
         std::scoped_lock lock(manager.mutatorsMutex);
         WECore::AudioSpinLock sharedLock(manager.sharedMutex);
 
-        XmlReader::restoreModulationSourcesFromXml(*manager.getSourcesStateUnsafe(), element, config);
+        std::shared_ptr<ModulationSourcesState> sources = cloneSourcesState(manager);
+        XmlReader::restoreModulationSourcesFromXml(*sources, element, config);
+
+        replaceCurrentState(manager, manager.undoHistory.back()->splitterState, sources);
     }
 
     void undo(StateManager& manager, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
         std::scoped_lock lock(manager.mutatorsMutex);
         WECore::AudioSpinLock sharedLock(manager.sharedMutex);
 
+        if (isFadingToStandby(manager)) {
+            return;
+        }
+
         if (manager.undoHistory.size() <= 1) {
             return;
         }
@@ -2086,13 +2867,22 @@ namespace ModelInterface {
         manager.undoHistory.back()->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = true;
         manager.redoHistory.back()->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = false;
 
-        SplitterProcessors::prepareToPlay(*(manager.undoHistory.back()->splitterState->splitter), sampleRate, samplesPerBlock, layout);
+        PluginSplitter& splitter = *(manager.undoHistory.back()->splitterState->splitter);
+        const HostConfiguration config {layout, sampleRate, samplesPerBlock};
+        migratePluginLayouts(splitter, config, false);
+        prepareUnpublishedSplitter(manager, splitter, config);
+        manager.publishCurrentState();
+        migratePluginLayouts(splitter, config, true);
     }
 
     void redo(StateManager& manager, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
         std::scoped_lock lock(manager.mutatorsMutex);
         WECore::AudioSpinLock sharedLock(manager.sharedMutex);
 
+        if (isFadingToStandby(manager)) {
+            return;
+        }
+
         if (manager.redoHistory.size() == 0) {
             return;
         }
@@ -2106,7 +2896,18 @@ namespace ModelInterface {
             manager.redoHistory.back()->splitterState->splitter->shouldNotifyProcessorOnLatencyChange = false;
         }
 
-        SplitterProcessors::prepareToPlay(*(manager.undoHistory.back()->splitterState->splitter), sampleRate, samplesPerBlock, layout);
+        PluginSplitter& splitter = *(manager.undoHistory.back()->splitterState->splitter);
+        const HostConfiguration config {layout, sampleRate, samplesPerBlock};
+        migratePluginLayouts(splitter, config, false);
+        prepareUnpublishedSplitter(manager, splitter, config);
+        manager.publishCurrentState();
+        migratePluginLayouts(splitter, config, true);
+    }
+
+    bool isFadingToStandby(const StateManager& manager) {
+        // The history shares plugins with the state being faded out, they would be processed twice
+        // in a block if a state from it was published now
+        return manager.fadingState.load(std::memory_order_seq_cst) != nullptr;
     }
 
     std::optional<juce::String> getUndoOperation(const StateManager& manager) {
@@ -2124,4 +2925,17 @@ namespace ModelInterface {
 
         return manager.redoHistory.back()->operation;
     }
+
+    void setUndoHistoryBudget(StateManager& manager, size_t numBytes) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+
+        manager.undoHistoryBudgetBytes = numBytes;
+        manager.trimUndoHistory();
+        manager.reclaimRetiredStates();
+    }
+
+    size_t getUndoHistoryFootprint(StateManager& manager) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+        return manager.getUndoHistoryFootprintBytes();
+    }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "DataModelInterface.hpp"
+#include "PlaceholderPluginInstance.hpp"
+#include "PluginInstantiator.hpp"
+#include "SessionFormat.hpp"
 
 namespace ModelInterface {
     bool setSplitType(StateManager& manager, SPLIT_TYPE splitType, HostConfiguration config);
@@ -15,7 +18,12 @@ namespace ModelInterface {
     bool setGainLinear(StateManager& manager, int chainNumber, int positionInChain, float gain);
     bool setPan(StateManager& manager, int chainNumber, int positionInChain, float pan);
     std::tuple<float, float> getGainLinearAndPan(StateManager& manager, int chainNumber, int positionInChain);
-    float getGainStageOutputAmplitude(StateManager& manager, int chainNumber, int positionInChain, int channelNumber);
+
+    /**
+     * The UI holds on to the meter and reads it without locking. Attach a reader to it while it's
+     * displayed.
+     */
+    std::shared_ptr<LevelMeter> getGainStageMeter(StateManager& manager, int chainNumber, int positionInChain);
 
     PluginModulationConfig getPluginModulationConfig(StateManager& manager, int chainNumber, int positionInChain);
     void setPluginModulationIsActive(StateManager& manager, int chainNumber, int positionInChain, bool val);
@@ -36,6 +44,11 @@ namespace ModelInterface {
     bool getChainMute(StateManager& manager, int chainNumber);
     bool getChainSolo(StateManager& manager, int chainNumber);
 
+    /**
+     * True while every plugin in the chain is asleep because its input is silent.
+     */
+    bool getChainIsSleeping(StateManager& manager, int chainNumber);
+
     void moveSlot(StateManager& manager, int fromChainNumber, int fromSlotNumber, int toChainNumber, int toSlotNumber);
     void copySlot(StateManager& manager,
                   std::function<void()> onSuccess,
@@ -67,12 +80,39 @@ namespace ModelInterface {
 
     std::pair<std::array<float, FFTProvider::NUM_OUTPUTS>, float> getFFTOutputs(StateManager& manager);
 
+    /**
+     * The audio thread only provides samples for the FFT while at least one visualiser is
+     * attached.
+     */
+    void attachFFTVisualiser(StateManager& manager);
+    void detachFFTVisualiser(StateManager& manager);
+
+    /**
+     * True if there are samples the FFT outputs haven't been updated with yet.
+     */
+    bool hasNewFFTSamples(StateManager& manager);
+
     std::shared_ptr<PluginEditorBounds> getPluginEditorBounds(StateManager& manager, int chainNumber, int positionInChain);
 
     void forEachChain(StateManager& manager, std::function<void(int, std::shared_ptr<PluginChain>)> callback);
     void forEachCrossover(StateManager& manager, std::function<void(float)> callback);
 
-    void writeSplitterToXml(StateManager& manager, juce::XmlElement* element);
+    /**
+     * If sessionWriter is given, plugin states are written to it instead of the element.
+     */
+    void writeSplitterToXml(StateManager& manager,
+                            juce::XmlElement* element,
+                            SessionFormat::Writer* sessionWriter = nullptr);
+
+    /**
+     * Replaces the current splitter with the one in the element. If reuseRunningPlugins is set,
+     * plugins in the current state are reused by slots with the same plugin instead of being
+     * created again, only their state is restored. Plugins in the standby aren't reused, and states
+     * in the history that use a reused plugin are given a placeholder holding its previous state.
+     *
+     * sessionReader provides the plugin states if the element was read from the binary session
+     * format.
+     */
     void restoreSplitterFromXml(
         StateManager& manager, juce::XmlElement* element,
         std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
@@ -80,8 +120,72 @@ namespace ModelInterface {
         HostConfiguration config,
         const PluginConfigurator& pluginConfigurator,
         juce::Array<juce::PluginDescription> availableTypes,
+        std::function<void(juce::String)> onErrorCallback,
+        bool usePlaceholders = false,
+        bool reuseRunningPlugins = false,
+        const SessionFormat::Reader* sessionReader = nullptr);
+
+    struct PlaceholderToLoad {
+        std::shared_ptr<PlaceholderPluginInstance> placeholder;
+        HostConfiguration config;
+        bool isMonoChain;
+    };
+
+    /**
+     * Returns the placeholder that should be loaded next, if there is one. Placeholders in the
+     * current state come first, and of those the ones in slots that can be heard first if
+     * loadInactiveLast is set. Then those in the standby, which can be switched to at any time, and
+     * placeholders that are only in the undo or redo history come last.
+     */
+    std::optional<PlaceholderToLoad> getNextPlaceholder(StateManager& manager, bool loadInactiveLast);
+
+    /**
+     * Swaps a loaded plugin in for its placeholder throughout the undo and redo history and the
+     * standby, without adding an undo step. The plugin must already be configured and have its state restored.
+     * Returns false if the placeholder is no longer in any state.
+     */
+    bool replacePlaceholder(StateManager& manager,
+                            std::shared_ptr<PlaceholderPluginInstance> placeholder,
+                            std::shared_ptr<juce::AudioPluginInstance> plugin);
+
+    /**
+     * Builds a state from elements written by writeSplitterToXml() and writeSourcesToXml() that can
+     * be set as the standby. Nothing in the manager is touched, so this can be called from a
+     * background thread while the current state is processed. The new splitter doesn't notify the
+     * processor of latency changes until it's switched to.
+     */
+    std::shared_ptr<StateWrapper> createStandbyFromXml(
+        juce::XmlElement* splitterElement,
+        juce::XmlElement* sourcesElement,
+        std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+        std::function<void(int)> latencyChangeCallback,
+        HostConfiguration config,
+        const PluginConfigurator& pluginConfigurator,
+        PluginInstantiator& instantiator,
         std::function<void(juce::String)> onErrorCallback);
 
+    /**
+     * Replaces the standby state, or clears it if state is nullptr. The state must not share any
+     * plugins with the current state or its history.
+     *
+     * Both states are delayed to the latency of the slower one from the next block, so call this on
+     * the thread that reports the processor's latency and report it straight after.
+     */
+    void setStandby(StateManager& manager, std::shared_ptr<StateWrapper> state);
+    bool hasStandby(StateManager& manager);
+    int getStandbyLatencySamples(StateManager& manager);
+
+    /**
+     * Makes the standby the current state and puts the current state on standby, with an
+     * equal-power crossfade between them over crossfadeLengthSamples. Both are processed until the
+     * crossfade finishes.
+     *
+     * The undo and redo history is kept, but can't be used until the crossfade finishes. If the
+     * two states share plugins, which happens after undoing back past a switch, they're switched
+     * without a crossfade. Returns false if there isn't a standby.
+     */
+    bool switchToStandby(StateManager& manager, int crossfadeLengthSamples);
+
     void createDefaultSources(StateManager& manager);
     void addLfo(StateManager& manager);
     void addEnvelope(StateManager& manager);
@@ -146,6 +250,7 @@ namespace ModelInterface {
     float getEnvAmount(StateManager& manager, int envIndex);
     bool getEnvUseSidechainInput(StateManager& manager, int envIndex);
     double getEnvLastOutput(StateManager& manager, int envIndex);
+    double getEnvOutputWithAmount(StateManager& manager, int envIndex);
 
     // Random
     void setRandomOutputMode(StateManager& manager, int randomIndex, int val);
@@ -219,6 +324,13 @@ namespace ModelInterface {
     void undo(StateManager& manager, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout);
     void redo(StateManager& manager, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout);
 
+    // Undo and redo do nothing while the state switched away from is faded out
+    bool isFadingToStandby(const StateManager& manager);
+
     std::optional<juce::String> getUndoOperation(const StateManager& manager);
     std::optional<juce::String> getRedoOperation(const StateManager& manager);
+
+    // The oldest undo states are dropped once the history's estimated memory use exceeds the budget
+    void setUndoHistoryBudget(StateManager& manager, size_t numBytes);
+    size_t getUndoHistoryFootprint(StateManager& manager);
 }
\ No newline at end of file
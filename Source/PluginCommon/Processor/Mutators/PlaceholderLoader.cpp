@@ -0,0 +1,128 @@
+#include "PlaceholderLoader.hpp"
+
+PlaceholderLoader::PlaceholderLoader(ModelInterface::StateManager& manager,
+                                     const PluginConfigurator& pluginConfigurator,
+                                     std::function<void()> onPluginLoadedCallback,
+                                     std::function<void(juce::String)> onErrorCallback)
+        : juce::Thread("Placeholder loader"),
+          _manager(manager),
+          _pluginConfigurator(pluginConfigurator),
+          _onPluginLoadedCallback(onPluginLoadedCallback),
+          _onErrorCallback(onErrorCallback),
+          _loadInactiveLast(true),
+          _hasPendingPluginLoaded(false) {
+    addDefaultFormatsToManager(_formatManager);
+}
+
+PlaceholderLoader::~PlaceholderLoader() {
+    stop();
+    cancelPendingUpdate();
+}
+
+void PlaceholderLoader::start(juce::Array<juce::PluginDescription> availableTypes, bool loadInactiveLast) {
+    stop();
+
+    _availableTypes = availableTypes;
+    _loadInactiveLast = loadInactiveLast;
+    startThread();
+}
+
+void PlaceholderLoader::stop() {
+    stopThread(STOP_TIMEOUT_MS);
+}
+
+void PlaceholderLoader::run() {
+    PluginInstantiator instantiator(_availableTypes,
+        [&](const juce::PluginDescription& description, const HostConfiguration& config, juce::String& errorMessage) {
+            return PluginInstantiator::createPluginFromThread(_formatManager, description, config, errorMessage);
+        });
+
+    const double startTime {juce::Time::getMillisecondCounterHiRes()};
+    int numLoaded {0};
+
+    while (!threadShouldExit()) {
+        std::optional<ModelInterface::PlaceholderToLoad> next = ModelInterface::getNextPlaceholder(_manager, _loadInactiveLast);
+
+        if (!next.has_value()) {
+            break;
+        }
+
+        std::shared_ptr<PlaceholderPluginInstance> placeholder = next->placeholder;
+        const juce::PluginDescription description = placeholder->getPluginDescription();
+
+        auto [thisPlugin, errorMessage] = instantiator.loadPlugin(description, next->config);
+
+        if (threadShouldExit()) {
+            break;
+        }
+
+        if (thisPlugin == nullptr) {
+            juce::Logger::writeToLog("Failed to load plugin: " + errorMessage);
+            placeholder->setFailedToLoad();
+            _reportError("Failed to restore plugin: " + errorMessage);
+            continue;
+        }
+
+        std::shared_ptr<juce::AudioPluginInstance> sharedPlugin = std::move(thisPlugin);
+
+        if (!_pluginConfigurator.configure(sharedPlugin, next->config, next->isMonoChain)) {
+            juce::Logger::writeToLog("Failed to configure plugin: " + description.name);
+            placeholder->setFailedToLoad();
+            _reportError("Failed to restore " + description.name + " as it may be a mono only plugin being restored into a stereo instance of Syndicate or vice versa");
+            continue;
+        }
+
+        const juce::MemoryBlock& savedState = placeholder->getSavedState();
+        if (savedState.getSize() > 0) {
+            sharedPlugin->setStateInformation(savedState.getData(), static_cast<int>(savedState.getSize()));
+        }
+
+        if (ModelInterface::replacePlaceholder(_manager, placeholder, sharedPlugin)) {
+            numLoaded++;
+            _reportPluginLoaded();
+        } else {
+            // The slot was removed while the plugin was loading
+            juce::Logger::writeToLog("Placeholder for " + description.name + " no longer in use");
+        }
+    }
+
+    juce::Logger::writeToLog("Loaded " + juce::String(numLoaded) + " placeholder plugins in " +
+                             juce::String(juce::Time::getMillisecondCounterHiRes() - startTime, 1) + "ms");
+}
+
+void PlaceholderLoader::handleAsyncUpdate() {
+    std::vector<juce::String> errors;
+    bool hasPluginLoaded {false};
+
+    {
+        const juce::ScopedLock lock(_pendingCallbacksLock);
+        std::swap(errors, _pendingErrors);
+        std::swap(hasPluginLoaded, _hasPendingPluginLoaded);
+    }
+
+    for (const juce::String& errorText : errors) {
+        _onErrorCallback(errorText);
+    }
+
+    if (hasPluginLoaded) {
+        _onPluginLoadedCallback();
+    }
+}
+
+void PlaceholderLoader::_reportError(const juce::String& errorText) {
+    {
+        const juce::ScopedLock lock(_pendingCallbacksLock);
+        _pendingErrors.push_back(errorText);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void PlaceholderLoader::_reportPluginLoaded() {
+    {
+        const juce::ScopedLock lock(_pendingCallbacksLock);
+        _hasPendingPluginLoaded = true;
+    }
+
+    triggerAsyncUpdate();
+}
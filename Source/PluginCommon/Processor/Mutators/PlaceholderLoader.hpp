@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MutatorsInterface.hpp"
+#include "PluginInstantiator.hpp"
+
+/**
+ * Loads the real plugins for the placeholders left by a restore in the background, and swaps each
+ * one in as soon as it's ready.
+ *
+ * Plugins are created with PluginInstantiator::createPluginFromThread(), so stopping the loader
+ * from the message thread can't deadlock with a plugin that's being created on it.
+ *
+ * The callbacks are called on the message thread.
+ */
+class PlaceholderLoader : public juce::Thread,
+                          private juce::AsyncUpdater {
+public:
+    PlaceholderLoader(ModelInterface::StateManager& manager,
+                      const PluginConfigurator& pluginConfigurator,
+                      std::function<void()> onPluginLoadedCallback,
+                      std::function<void(juce::String)> onErrorCallback);
+    ~PlaceholderLoader() override;
+
+    /**
+     * Starts loading the placeholders in the current state. If loadInactiveLast is set, plugins in
+     * bypassed slots and in chains that can't be heard are loaded after the others.
+     */
+    void start(juce::Array<juce::PluginDescription> availableTypes, bool loadInactiveLast);
+
+    /**
+     * Stops loading, any placeholders left carry on passing audio through until start() is called
+     * again.
+     */
+    void stop();
+
+    void run() override;
+
+private:
+    static constexpr int STOP_TIMEOUT_MS {5000};
+
+    ModelInterface::StateManager& _manager;
+    const PluginConfigurator& _pluginConfigurator;
+    std::function<void()> _onPluginLoadedCallback;
+    std::function<void(juce::String)> _onErrorCallback;
+
+    juce::AudioPluginFormatManager _formatManager;
+    juce::Array<juce::PluginDescription> _availableTypes;
+    bool _loadInactiveLast;
+
+    // Passed from the loading thread to the message thread
+    juce::CriticalSection _pendingCallbacksLock;
+    std::vector<juce::String> _pendingErrors;
+    bool _hasPendingPluginLoaded;
+
+    void handleAsyncUpdate() override;
+    void _reportError(const juce::String& errorText);
+    void _reportPluginLoaded();
+};
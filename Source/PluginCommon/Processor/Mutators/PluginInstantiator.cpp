@@ -0,0 +1,422 @@
+#include "PluginInstantiator.hpp"
+
+namespace {
+    // More than this and the message thread is the bottleneck anyway
+    constexpr int MAX_NUM_LOADING_THREADS {8};
+
+    // How often a thread waiting for a plugin to be created checks whether it should exit
+    constexpr int EXIT_CHECK_INTERVAL_MS {50};
+
+    // How long preload() waits for the plugins it's creating. Anything that isn't ready by then is
+    // created by loadPlugin() when its slot asks for it
+    constexpr int PRELOAD_TIMEOUT_MS {30000};
+
+    // Shared with the creation callback, which may still run after the thread has stopped waiting
+    struct PendingPlugin {
+        juce::WaitableEvent createdEvent;
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        juce::String errorMessage;
+    };
+
+    int comparePluginDescriptionAgainstTarget(const juce::PluginDescription& description, const juce::PluginDescription& target) {
+        // Format is most important for compatibility when loading settings
+        if (description.pluginFormatName == target.pluginFormatName) {
+            return 2;
+        }
+
+        if (description.version == target.version) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    class AvailableTypesSorter {
+    public:
+        AvailableTypesSorter(const juce::PluginDescription& target) : _target(target) {}
+
+        int compareElements(const juce::PluginDescription& a, const juce::PluginDescription& b) {
+            return comparePluginDescriptionAgainstTarget(b, _target) - comparePluginDescriptionAgainstTarget(a, _target);
+        }
+
+    private:
+        const juce::PluginDescription& _target;
+    };
+
+    juce::String pluginTypesToString(const juce::Array<juce::PluginDescription>& types) {
+        juce::String retVal;
+        for (const juce::PluginDescription& type : types) {
+            retVal += type.pluginFormatName + " " + type.version + ", ";
+        }
+
+        return retVal;
+    }
+
+    std::string getIndexKey(const juce::PluginDescription& description) {
+        return (description.manufacturerName + "/" + description.name).toStdString();
+    }
+
+    bool shouldStopWaiting() {
+        if (juce::Thread::currentThreadShouldExit()) {
+            return true;
+        }
+
+        // Pool jobs are asked to stop without the thread itself being asked to exit
+        juce::ThreadPoolJob* job {juce::ThreadPoolJob::getCurrentThreadPoolJob()};
+        return job != nullptr && job->shouldExit();
+    }
+}
+
+PluginInstantiator::PluginInstantiator(const juce::Array<juce::PluginDescription>& availableTypes)
+        : PluginInstantiator(availableTypes, nullptr) {
+    addDefaultFormatsToManager(_formatManager);
+
+    _createPlugin = [&formatManager = _formatManager](const juce::PluginDescription& description,
+                                                      const HostConfiguration& config,
+                                                      juce::String& errorMessage) {
+        if (juce::MessageManager::existsAndIsCurrentThread()) {
+            return formatManager.createPluginInstance(description, config.sampleRate, config.blockSize, errorMessage);
+        }
+
+        // Off the message thread the wait can be given up on, so preload() doesn't wait forever
+        return createPluginFromThread(formatManager, description, config, errorMessage);
+    };
+
+    _canCreateAsync = true;
+}
+
+PluginInstantiator::PluginInstantiator(const juce::Array<juce::PluginDescription>& availableTypes,
+                                       CreatePluginFunction createPlugin) : _createPlugin(createPlugin),
+                                                                            _canCreateAsync(false),
+                                                                            _createPlaceholders(false),
+                                                                            _areReusedPluginsSuspended(false) {
+    for (const juce::PluginDescription& availableType : availableTypes) {
+        _availableTypesIndex[getIndexKey(availableType)].add(availableType);
+    }
+}
+
+PluginInstantiator::~PluginInstantiator() {
+    resumeReusedPlugins();
+}
+
+void PluginInstantiator::addReusablePlugins(const std::vector<std::shared_ptr<juce::AudioPluginInstance>>& plugins) {
+    for (std::shared_ptr<juce::AudioPluginInstance> plugin : plugins) {
+        if (plugin != nullptr && std::dynamic_pointer_cast<PlaceholderPluginInstance>(plugin) == nullptr) {
+            _reusablePlugins[plugin->getPluginDescription().createIdentifierString().toStdString()].push_back(plugin);
+        }
+    }
+}
+
+std::shared_ptr<PlaceholderPluginInstance> PluginInstantiator::takeReusablePlugin(
+        const juce::PluginDescription& description,
+        std::function<bool(std::shared_ptr<juce::AudioPluginInstance>)> canReuse) {
+
+    auto reusableIt = _reusablePlugins.find(description.createIdentifierString().toStdString());
+
+    if (reusableIt == _reusablePlugins.end()) {
+        return nullptr;
+    }
+
+    std::deque<std::shared_ptr<juce::AudioPluginInstance>>& candidates = reusableIt->second;
+    for (auto candidateIt = candidates.begin(); candidateIt != candidates.end(); candidateIt++) {
+        std::shared_ptr<juce::AudioPluginInstance> plugin = *candidateIt;
+
+        if (canReuse(plugin)) {
+            candidates.erase(candidateIt);
+
+            auto standIn = std::make_shared<PlaceholderPluginInstance>(plugin->getPluginDescription());
+            standIn->setExpectedLatency(plugin->getLatencySamples());
+            _reusedPlugins.push_back({plugin, standIn, nullptr});
+            return standIn;
+        }
+    }
+
+    return nullptr;
+}
+
+void PluginInstantiator::suspendReusedPlugins() {
+    for (ReusedPlugin& reused : _reusedPlugins) {
+        reused.previousState = std::make_shared<PlaceholderPluginInstance>(reused.plugin->getPluginDescription());
+
+        juce::MemoryBlock previousState;
+        reused.plugin->getStateInformation(previousState);
+        reused.previousState->setStateInformation(previousState.getData(), static_cast<int>(previousState.getSize()));
+        reused.previousState->setExpectedLatency(reused.plugin->getLatencySamples());
+
+        // Takes the plugin's callback lock, so this waits for a block that's already being processed
+        reused.plugin->suspendProcessing(true);
+
+        const juce::MemoryBlock& restoredState = reused.standIn->getSavedState();
+        if (restoredState.getSize() > 0) {
+            reused.plugin->setStateInformation(restoredState.getData(), static_cast<int>(restoredState.getSize()));
+        }
+    }
+
+    _areReusedPluginsSuspended = true;
+}
+
+void PluginInstantiator::resumeReusedPlugins() {
+    if (_areReusedPluginsSuspended) {
+        for (ReusedPlugin& reused : _reusedPlugins) {
+            reused.plugin->suspendProcessing(false);
+        }
+    }
+
+    _areReusedPluginsSuspended = false;
+    _reusedPlugins.clear();
+}
+
+void PluginInstantiator::preload(const std::vector<juce::PluginDescription>& allDescriptions, const HostConfiguration& config) {
+    if (_createPlaceholders) {
+        return;
+    }
+
+    // Don't create plugins that are expected to be reused. If one can't be reused after all it's
+    // created when the slot asks for it
+    std::unordered_map<std::string, size_t> numReusable;
+    for (const auto& [identifier, plugins] : _reusablePlugins) {
+        numReusable[identifier] = plugins.size();
+    }
+
+    std::vector<juce::PluginDescription> descriptions;
+    for (const juce::PluginDescription& description : allDescriptions) {
+        auto numReusableIt = numReusable.find(description.createIdentifierString().toStdString());
+
+        if (numReusableIt != numReusable.end() && numReusableIt->second > 0) {
+            numReusableIt->second--;
+        } else {
+            descriptions.push_back(description);
+        }
+    }
+
+    if (descriptions.empty()) {
+        return;
+    }
+
+    // Only the plugins that finished loading are kept, loadPlugin() creates the rest when their
+    // slots ask for them
+    std::vector<LoadResult> results(descriptions.size());
+    std::vector<char> isLoaded(descriptions.size(), false);
+
+    if (!juce::MessageManager::existsAndIsCurrentThread()) {
+        _preloadFromThread(descriptions, config, results, isLoaded);
+#if JUCE_MODAL_LOOPS_PERMITTED
+    } else if (_canCreateAsync) {
+        _preloadAsync(descriptions, config, results, isLoaded);
+#endif
+    } else {
+        // Formats that finish creating plugins on the message thread can't do so while we're
+        // blocking it. These aren't preloaded, everything else is created here one at a time.
+        for (size_t index {0}; index < descriptions.size(); index++) {
+            if (!_requiresUnblockedMessageThread(descriptions[index])) {
+                results[index] = _createPluginOrAlternative(descriptions[index], config);
+                isLoaded[index] = true;
+            }
+        }
+    }
+
+    for (size_t index {0}; index < descriptions.size(); index++) {
+        if (isLoaded[index]) {
+            _preloadedPlugins[descriptions[index].createIdentifierString().toStdString()].push_back(std::move(results[index]));
+        }
+    }
+}
+
+PluginInstantiator::LoadResult PluginInstantiator::loadPlugin(const juce::PluginDescription& description, const HostConfiguration& config) {
+    if (_createPlaceholders) {
+        return std::make_tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String>(
+            std::make_unique<PlaceholderPluginInstance>(description), juce::String());
+    }
+
+    auto preloadedIt = _preloadedPlugins.find(description.createIdentifierString().toStdString());
+
+    if (preloadedIt != _preloadedPlugins.end() && !preloadedIt->second.empty()) {
+        LoadResult retVal = std::move(preloadedIt->second.front());
+        preloadedIt->second.pop_front();
+        return retVal;
+    }
+
+    return _createPluginOrAlternative(description, config);
+}
+
+juce::Array<juce::PluginDescription> PluginInstantiator::findAlternatives(const juce::PluginDescription& description) const {
+    juce::Array<juce::PluginDescription> retVal;
+
+    auto indexIt = _availableTypesIndex.find(getIndexKey(description));
+    if (indexIt != _availableTypesIndex.end()) {
+        retVal = indexIt->second;
+
+        // Sort by best match first
+        AvailableTypesSorter sorter(description);
+        retVal.sort(sorter);
+    }
+
+    return retVal;
+}
+
+int PluginInstantiator::getNumPreloadedPlugins() const {
+    int retVal {0};
+
+    for (const auto& [identifier, results] : _preloadedPlugins) {
+        retVal += static_cast<int>(results.size());
+    }
+
+    return retVal;
+}
+
+std::unique_ptr<juce::AudioPluginInstance> PluginInstantiator::createPluginFromThread(juce::AudioPluginFormatManager& formatManager,
+                                                                                    const juce::PluginDescription& description,
+                                                                                    const HostConfiguration& config,
+                                                                                    juce::String& errorMessage) {
+    auto pending = std::make_shared<PendingPlugin>();
+
+    formatManager.createPluginInstanceAsync(description, config.sampleRate, config.blockSize,
+        [pending](std::unique_ptr<juce::AudioPluginInstance> plugin, const juce::String& newErrorMessage) {
+            pending->plugin = std::move(plugin);
+            pending->errorMessage = newErrorMessage;
+            pending->createdEvent.signal();
+        });
+
+    while (!pending->createdEvent.wait(EXIT_CHECK_INTERVAL_MS)) {
+        if (shouldStopWaiting()) {
+            errorMessage = "Stopped loading";
+            return nullptr;
+        }
+    }
+
+    errorMessage = pending->errorMessage;
+    return std::move(pending->plugin);
+}
+
+void PluginInstantiator::_preloadFromThread(const std::vector<juce::PluginDescription>& descriptions,
+                                            const HostConfiguration& config,
+                                            std::vector<LoadResult>& results,
+                                            std::vector<char>& isLoaded) {
+    // Declared before the pool so they outlive any job still running when it's destroyed
+    std::atomic<int> numRemaining {static_cast<int>(descriptions.size())};
+    juce::WaitableEvent allLoadedEvent;
+
+    {
+        const int numThreads {std::min(static_cast<int>(descriptions.size()), MAX_NUM_LOADING_THREADS)};
+        juce::ThreadPool pool(numThreads);
+
+        for (size_t index {0}; index < descriptions.size(); index++) {
+            pool.addJob([&, index]() {
+                LoadResult result = _createPluginOrAlternative(descriptions[index], config);
+
+                // A plugin that gave up because preload() stopped waiting isn't kept, so
+                // loadPlugin() tries it again
+                if (!shouldStopWaiting()) {
+                    results[index] = std::move(result);
+                    isLoaded[index] = true;
+                }
+
+                if (--numRemaining == 0) {
+                    allLoadedEvent.signal();
+                }
+            });
+        }
+
+        const juce::uint32 startTime {juce::Time::getMillisecondCounter()};
+        while (!allLoadedEvent.wait(EXIT_CHECK_INTERVAL_MS)) {
+            if (juce::Thread::currentThreadShouldExit()) {
+                break;
+            }
+
+            if (juce::Time::getMillisecondCounter() - startTime > static_cast<juce::uint32>(PRELOAD_TIMEOUT_MS)) {
+                juce::Logger::writeToLog("Timed out preloading " + juce::String(numRemaining.load()) + " plugins");
+                break;
+            }
+        }
+
+        // Asks the jobs still waiting for a plugin to give up, and waits for them to do so. The
+        // results are only read once the pool has finished with them
+        pool.removeAllJobs(true, PRELOAD_TIMEOUT_MS);
+    }
+}
+
+#if JUCE_MODAL_LOOPS_PERMITTED
+void PluginInstantiator::_preloadAsync(const std::vector<juce::PluginDescription>& descriptions,
+                                       const HostConfiguration& config,
+                                       std::vector<LoadResult>& results,
+                                       std::vector<char>& isLoaded) {
+    // The callbacks run on the message thread while it's pumped below, or later if we stop waiting
+    auto numRemaining = std::make_shared<int>(static_cast<int>(descriptions.size()));
+    std::vector<std::shared_ptr<PendingPlugin>> pendingPlugins;
+
+    for (const juce::PluginDescription& description : descriptions) {
+        auto pending = std::make_shared<PendingPlugin>();
+        pendingPlugins.push_back(pending);
+
+        _formatManager.createPluginInstanceAsync(description, config.sampleRate, config.blockSize,
+            [pending, numRemaining](std::unique_ptr<juce::AudioPluginInstance> plugin, const juce::String& errorMessage) {
+                pending->plugin = std::move(plugin);
+                pending->errorMessage = errorMessage;
+                pending->createdEvent.signal();
+                (*numRemaining)--;
+            });
+    }
+
+    const juce::uint32 startTime {juce::Time::getMillisecondCounter()};
+    while (*numRemaining > 0) {
+        if (juce::Time::getMillisecondCounter() - startTime > static_cast<juce::uint32>(PRELOAD_TIMEOUT_MS)) {
+            juce::Logger::writeToLog("Timed out preloading " + juce::String(*numRemaining) + " plugins");
+            break;
+        }
+
+        if (!juce::MessageManager::getInstance()->runDispatchLoopUntil(EXIT_CHECK_INTERVAL_MS)) {
+            // The app is quitting
+            break;
+        }
+    }
+
+    // Plugins that failed aren't kept, loadPlugin() tries them again along with their alternatives
+    for (size_t index {0}; index < descriptions.size(); index++) {
+        const std::shared_ptr<PendingPlugin>& pending = pendingPlugins[index];
+
+        if (pending->createdEvent.wait(0) && pending->plugin != nullptr) {
+            results[index] = std::make_tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String>(
+                std::move(pending->plugin), juce::String(pending->errorMessage));
+            isLoaded[index] = true;
+        }
+    }
+}
+#endif
+
+PluginInstantiator::LoadResult PluginInstantiator::_createPluginOrAlternative(const juce::PluginDescription& description, const HostConfiguration& config) {
+    // First try the exact match
+    juce::String errorMessage;
+    std::unique_ptr<juce::AudioPluginInstance> thisPlugin = _createPlugin(description, config, errorMessage);
+
+    // Failing that, try the alternatives from the available types
+    if (thisPlugin == nullptr) {
+        juce::Logger::writeToLog("Failed to load plugin " + description.name + ": " + errorMessage);
+        juce::Logger::writeToLog("Looking for alternatives");
+
+        const juce::Array<juce::PluginDescription> possibleTypes = findAlternatives(description);
+
+        const juce::String possibleTypesString = pluginTypesToString(possibleTypes);
+        juce::Logger::writeToLog("Found alternatives: " + possibleTypesString);
+
+        for (const juce::PluginDescription& possibleType : possibleTypes) {
+            juce::String newErrorMessage;
+            thisPlugin = _createPlugin(possibleType, config, newErrorMessage);
+
+            if (thisPlugin != nullptr) {
+                juce::Logger::writeToLog("Loaded " + possibleType.pluginFormatName + " " + possibleType.version);
+                break;
+            }
+
+            errorMessage += " - " + newErrorMessage;
+        }
+    }
+
+    return std::make_tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String>(
+        std::move(thisPlugin), juce::String(errorMessage));
+}
+
+bool PluginInstantiator::_requiresUnblockedMessageThread(const juce::PluginDescription& description) const {
+    juce::String errorMessage;
+    juce::AudioPluginFormat* format {_formatManager.findFormatForDescription(description, errorMessage)};
+    return format != nullptr && format->requiresUnblockedMessageThreadDuringCreation(description);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <unordered_map>
+#include "PluginConfigurator.hpp"
+#include "PlaceholderPluginInstance.hpp"
+
+/**
+ * Creates the plugins for a restore.
+ *
+ * Every plugin in the document is created up front by preload(), then handed out by loadPlugin() as
+ * the slots are restored. One format manager is shared by every plugin, and alternatives for a
+ * plugin that can't be created are found through an index of the available types rather than
+ * searching them all.
+ *
+ * Most formats finish creating a plugin on the message thread. When restoring from another thread
+ * plugins are created concurrently on a pool of threads. On the message thread they're all started
+ * with the async API and the message thread is pumped until they've finished, where modal loops are
+ * permitted. Otherwise they're created one at a time, and plugins whose format needs an unblocked
+ * message thread aren't preloaded but created by loadPlugin() instead.
+ *
+ * Plugins that are already running can be offered for reuse, so restoring a document that uses the
+ * same plugins as the current state only has to restore their state rather than create them again.
+ */
+class PluginInstantiator {
+public:
+    typedef std::function<
+        std::unique_ptr<juce::AudioPluginInstance>(
+            const juce::PluginDescription&, const HostConfiguration&, juce::String&)> CreatePluginFunction;
+
+    typedef std::tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String> LoadResult;
+
+    /**
+     * Creates plugins using the default formats.
+     */
+    explicit PluginInstantiator(const juce::Array<juce::PluginDescription>& availableTypes);
+
+    /**
+     * Creates plugins using the given function instead of the default formats.
+     */
+    PluginInstantiator(const juce::Array<juce::PluginDescription>& availableTypes,
+                       CreatePluginFunction createPlugin);
+
+    /**
+     * Resumes any reused plugins that have been suspended.
+     */
+    ~PluginInstantiator();
+
+    /**
+     * Offers running plugins to the restore, in the order they appear in the current state.
+     * Placeholders aren't offered as they're cheap to create anyway.
+     */
+    void addReusablePlugins(const std::vector<std::shared_ptr<juce::AudioPluginInstance>>& plugins);
+
+    /**
+     * A running plugin taken by a slot in the restored state.
+     */
+    struct ReusedPlugin {
+        std::shared_ptr<juce::AudioPluginInstance> plugin;
+
+        // Holds the slot and the state restored for it until the plugin is swapped in
+        std::shared_ptr<PlaceholderPluginInstance> standIn;
+
+        // The plugin's state and latency from before the restore, set by suspendReusedPlugins()
+        std::shared_ptr<PlaceholderPluginInstance> previousState;
+    };
+
+    /**
+     * Finds the first reusable plugin with the same description that canReuse accepts and returns
+     * a placeholder to stand in for it, or nullptr if there isn't one.
+     *
+     * The plugin may still be processing audio in the current state so it's left alone while the
+     * restore is assembled, the stand-in takes the plugin's state and preparation instead.
+     */
+    std::shared_ptr<PlaceholderPluginInstance> takeReusablePlugin(
+        const juce::PluginDescription& description,
+        std::function<bool(std::shared_ptr<juce::AudioPluginInstance>)> canReuse);
+
+    /**
+     * Suspends the plugins taken by takeReusablePlugin(), keeps the state they had in previousState,
+     * and gives them the state restored into their stand-ins. Call right before the restored state
+     * is published, as they don't process until resumeReusedPlugins() is called.
+     */
+    void suspendReusedPlugins();
+
+    /**
+     * Lets the suspended plugins process audio again. Call once the restored state has been
+     * published.
+     */
+    void resumeReusedPlugins();
+
+    const std::vector<ReusedPlugin>& getReusedPlugins() const { return _reusedPlugins; }
+
+    int getNumReusedPlugins() const { return static_cast<int>(_reusedPlugins.size()); }
+
+    /**
+     * Creates a plugin for each description, concurrently if possible, and waits for them up to a
+     * timeout. Plugins that aren't ready by then are created by loadPlugin() instead. Descriptions
+     * that a reusable plugin is expected to cover are skipped.
+     */
+    void preload(const std::vector<juce::PluginDescription>& descriptions, const HostConfiguration& config);
+
+    /**
+     * Returns the plugin preloaded for the description, or creates it now if there isn't one. Falls
+     * back to the best available alternative if the plugin itself can't be created.
+     */
+    LoadResult loadPlugin(const juce::PluginDescription& description, const HostConfiguration& config);
+
+    /**
+     * The available types with the same name and manufacturer as the description, best match
+     * first.
+     */
+    juce::Array<juce::PluginDescription> findAlternatives(const juce::PluginDescription& description) const;
+
+    int getNumPreloadedPlugins() const;
+
+    /**
+     * Creates a plugin with the async API from a background thread. Gives up if the thread is asked
+     * to exit while it waits, so the thread can be stopped from the message thread without
+     * deadlocking with a format that finishes creating plugins there.
+     */
+    static std::unique_ptr<juce::AudioPluginInstance> createPluginFromThread(juce::AudioPluginFormatManager& formatManager,
+                                                                             const juce::PluginDescription& description,
+                                                                             const HostConfiguration& config,
+                                                                             juce::String& errorMessage);
+
+    /**
+     * When set, loadPlugin() returns a PlaceholderPluginInstance instead of creating the plugin, and
+     * preload() does nothing. The real plugins are loaded later by a PlaceholderLoader.
+     */
+    void setCreatePlaceholders(bool createPlaceholders) { _createPlaceholders = createPlaceholders; }
+
+private:
+    juce::AudioPluginFormatManager _formatManager;
+    CreatePluginFunction _createPlugin;
+
+    // True when plugins are created by the format manager, so preload() can use the async API
+    bool _canCreateAsync;
+
+    bool _createPlaceholders;
+
+    // Available types keyed by manufacturer and name
+    std::unordered_map<std::string, juce::Array<juce::PluginDescription>> _availableTypesIndex;
+
+    // Plugins created by preload() keyed by the description's identifier, in the order they were
+    // asked for
+    std::unordered_map<std::string, std::deque<LoadResult>> _preloadedPlugins;
+
+    // Running plugins offered for reuse keyed by the description's identifier, and the ones that
+    // have been taken
+    std::unordered_map<std::string, std::deque<std::shared_ptr<juce::AudioPluginInstance>>> _reusablePlugins;
+    std::vector<ReusedPlugin> _reusedPlugins;
+    bool _areReusedPluginsSuspended;
+
+    LoadResult _createPluginOrAlternative(const juce::PluginDescription& description, const HostConfiguration& config);
+    bool _requiresUnblockedMessageThread(const juce::PluginDescription& description) const;
+
+    void _preloadFromThread(const std::vector<juce::PluginDescription>& descriptions,
+                            const HostConfiguration& config,
+                            std::vector<LoadResult>& results,
+                            std::vector<char>& isLoaded);
+
+#if JUCE_MODAL_LOOPS_PERMITTED
+    void _preloadAsync(const std::vector<juce::PluginDescription>& descriptions,
+                       const HostConfiguration& config,
+                       std::vector<LoadResult>& results,
+                       std::vector<char>& isLoaded);
+#endif
+};
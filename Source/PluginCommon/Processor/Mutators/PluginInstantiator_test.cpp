@@ -0,0 +1,219 @@
+#include "catch.hpp"
+
+#include "PluginInstantiator.hpp"
+#include "TestUtils.hpp"
+
+namespace {
+    class InstantiatorTestPluginInstance : public TestUtils::TestPluginInstance {
+    public:
+        juce::PluginDescription description;
+
+        juce::MemoryBlock state;
+
+        InstantiatorTestPluginInstance(const juce::PluginDescription& newDescription) : description(newDescription) { }
+
+        void fillInPluginDescription(juce::PluginDescription& desc) const override { desc = description; }
+        void getStateInformation(juce::MemoryBlock& destData) override { destData = state; }
+        void setStateInformation(const void* data, int sizeInBytes) override { state.replaceAll(data, static_cast<size_t>(sizeInBytes)); }
+    };
+
+    juce::PluginDescription createDescription(juce::String name, juce::String format, juce::String version) {
+        juce::PluginDescription description;
+        description.name = name;
+        description.manufacturerName = "TestManufacturer";
+        description.pluginFormatName = format;
+        description.version = version;
+        description.fileOrIdentifier = name + format + version;
+        return description;
+    }
+
+    const HostConfiguration CONFIG {
+        TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo()), 44100, 64
+    };
+}
+
+SCENARIO("PluginInstantiator: Preloaded plugins are handed out in order") {
+    GIVEN("An instantiator that counts the plugins it creates") {
+        std::atomic<int> numCreated {0};
+
+        PluginInstantiator instantiator({},
+            [&numCreated](const juce::PluginDescription& description, const HostConfiguration&, juce::String& errorMessage) {
+                numCreated++;
+                return std::make_unique<InstantiatorTestPluginInstance>(description);
+            });
+
+        WHEN("Several plugins are preloaded, including two of the same type") {
+            const juce::PluginDescription descriptionA {createDescription("PluginA", "VST3", "1.0")};
+            const juce::PluginDescription descriptionB {createDescription("PluginB", "VST3", "1.0")};
+
+            instantiator.preload({descriptionA, descriptionB, descriptionA}, CONFIG);
+
+            THEN("They're all created up front") {
+                CHECK(numCreated == 3);
+                CHECK(instantiator.getNumPreloadedPlugins() == 3);
+            }
+
+            AND_WHEN("They're loaded") {
+                auto [pluginA1, errorA1] = instantiator.loadPlugin(descriptionA, CONFIG);
+                auto [pluginB, errorB] = instantiator.loadPlugin(descriptionB, CONFIG);
+                auto [pluginA2, errorA2] = instantiator.loadPlugin(descriptionA, CONFIG);
+
+                THEN("Each gets its own preloaded plugin without creating any more") {
+                    REQUIRE(pluginA1 != nullptr);
+                    REQUIRE(pluginB != nullptr);
+                    REQUIRE(pluginA2 != nullptr);
+                    CHECK(pluginA1 != pluginA2);
+                    CHECK(pluginA1->getPluginDescription().name == "PluginA");
+                    CHECK(pluginB->getPluginDescription().name == "PluginB");
+                    CHECK(numCreated == 3);
+                    CHECK(instantiator.getNumPreloadedPlugins() == 0);
+                }
+
+                AND_WHEN("Another is loaded after the preloaded ones have run out") {
+                    auto [pluginA3, errorA3] = instantiator.loadPlugin(descriptionA, CONFIG);
+
+                    THEN("It's created when asked for") {
+                        CHECK(pluginA3 != nullptr);
+                        CHECK(numCreated == 4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("PluginInstantiator: Falls back to the best available alternative") {
+    GIVEN("Available types for two plugins and an instantiator that can only create AU plugins") {
+        const juce::Array<juce::PluginDescription> availableTypes {
+            createDescription("PluginA", "VST", "1.0"),
+            createDescription("PluginA", "AudioUnit", "2.0"),
+            createDescription("PluginA", "AudioUnit", "1.0"),
+            createDescription("PluginB", "AudioUnit", "1.0")
+        };
+
+        PluginInstantiator instantiator(availableTypes,
+            [](const juce::PluginDescription& description, const HostConfiguration&, juce::String& errorMessage) -> std::unique_ptr<juce::AudioPluginInstance> {
+                if (description.pluginFormatName != "AudioUnit") {
+                    errorMessage = "Can't create " + description.pluginFormatName;
+                    return nullptr;
+                }
+
+                return std::make_unique<InstantiatorTestPluginInstance>(description);
+            });
+
+        WHEN("The alternatives for a plugin are found") {
+            const juce::Array<juce::PluginDescription> alternatives {
+                instantiator.findAlternatives(createDescription("PluginA", "AudioUnit", "1.0"))
+            };
+
+            THEN("Only types with the same name and manufacturer are returned, best match first") {
+                REQUIRE(alternatives.size() == 3);
+                CHECK(alternatives[0].pluginFormatName == "AudioUnit");
+                CHECK(alternatives[1].pluginFormatName == "AudioUnit");
+                CHECK(alternatives[2].pluginFormatName == "VST");
+            }
+        }
+
+        WHEN("A plugin is loaded in a format that can't be created") {
+            auto [plugin, errorMessage] = instantiator.loadPlugin(createDescription("PluginA", "VST3", "2.0"), CONFIG);
+
+            THEN("The best alternative that can be created is loaded") {
+                REQUIRE(plugin != nullptr);
+                CHECK(plugin->getPluginDescription().pluginFormatName == "AudioUnit");
+                CHECK(plugin->getPluginDescription().version == "2.0");
+            }
+        }
+
+        WHEN("A plugin with no alternatives is loaded in a format that can't be created") {
+            auto [plugin, errorMessage] = instantiator.loadPlugin(createDescription("PluginC", "VST3", "1.0"), CONFIG);
+
+            THEN("It fails with the error") {
+                CHECK(plugin == nullptr);
+                CHECK(errorMessage == "Can't create VST3");
+            }
+        }
+    }
+}
+
+SCENARIO("PluginInstantiator: Running plugins are reused instead of created") {
+    GIVEN("An instantiator offered two running plugins of the same type") {
+        std::atomic<int> numCreated {0};
+
+        PluginInstantiator instantiator({},
+            [&numCreated](const juce::PluginDescription& description, const HostConfiguration&, juce::String& errorMessage) {
+                numCreated++;
+                return std::make_unique<InstantiatorTestPluginInstance>(description);
+            });
+
+        const juce::PluginDescription descriptionA {createDescription("PluginA", "VST3", "1.0")};
+        const juce::PluginDescription descriptionB {createDescription("PluginB", "VST3", "1.0")};
+
+        auto runningA1 = std::make_shared<InstantiatorTestPluginInstance>(descriptionA);
+        auto runningA2 = std::make_shared<InstantiatorTestPluginInstance>(descriptionA);
+        instantiator.addReusablePlugins({runningA1, runningA2});
+
+        WHEN("A document using one of them and another plugin is preloaded") {
+            instantiator.preload({descriptionA, descriptionB}, CONFIG);
+
+            THEN("Only the plugin that isn't running is created") {
+                CHECK(numCreated == 1);
+                CHECK(instantiator.getNumPreloadedPlugins() == 1);
+            }
+        }
+
+        WHEN("A plugin is taken for reuse") {
+            runningA1->state.replaceAll("old", 3);
+            auto standIn = instantiator.takeReusablePlugin(descriptionA, [](std::shared_ptr<juce::AudioPluginInstance>) { return true; });
+
+            THEN("The first running plugin is taken but keeps processing while a stand-in takes its place") {
+                REQUIRE(standIn != nullptr);
+                CHECK(standIn->getPluginDescription().name == "PluginA");
+                REQUIRE(instantiator.getNumReusedPlugins() == 1);
+                CHECK(instantiator.getReusedPlugins()[0].plugin == runningA1);
+                CHECK_FALSE(runningA1->isSuspended());
+            }
+
+            AND_WHEN("The stand-in's state is restored and the reused plugins are suspended") {
+                standIn->setStateInformation("new", 3);
+                instantiator.suspendReusedPlugins();
+
+                THEN("The plugin is suspended with the restored state and its previous state is kept") {
+                    const PluginInstantiator::ReusedPlugin& reused = instantiator.getReusedPlugins()[0];
+                    CHECK(runningA1->isSuspended());
+                    CHECK_FALSE(runningA2->isSuspended());
+                    CHECK(runningA1->state == juce::MemoryBlock("new", 3));
+                    REQUIRE(reused.previousState != nullptr);
+                    CHECK(reused.previousState->getSavedState() == juce::MemoryBlock("old", 3));
+                }
+
+                AND_WHEN("The reused plugins are resumed") {
+                    instantiator.resumeReusedPlugins();
+
+                    THEN("It processes again") {
+                        CHECK_FALSE(runningA1->isSuspended());
+                        CHECK(instantiator.getNumReusedPlugins() == 0);
+                    }
+                }
+            }
+        }
+
+        WHEN("A plugin is taken but the first running plugin can't be reused") {
+            auto standIn = instantiator.takeReusablePlugin(descriptionA,
+                [&runningA1](std::shared_ptr<juce::AudioPluginInstance> plugin) { return plugin != runningA1; });
+
+            THEN("The next one is taken") {
+                CHECK(standIn != nullptr);
+                REQUIRE(instantiator.getNumReusedPlugins() == 1);
+                CHECK(instantiator.getReusedPlugins()[0].plugin == runningA2);
+            }
+        }
+
+        WHEN("A plugin that isn't running is taken") {
+            auto standIn = instantiator.takeReusablePlugin(descriptionB, [](std::shared_ptr<juce::AudioPluginInstance>) { return true; });
+
+            THEN("Nothing is returned") {
+                CHECK(standIn == nullptr);
+            }
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#include "SessionFormat.hpp"
+
+namespace {
+    constexpr char MAGIC[] {'S', 'Y', 'N', 'S'};
+    constexpr size_t MAGIC_SIZE {sizeof(MAGIC)};
+
+    constexpr int FLAG_COMPRESSED {1 << 0};
+
+    // Saving happens on autosave too, so favour speed over size
+    constexpr int COMPRESSION_LEVEL {1};
+}
+
+namespace SessionFormat {
+    bool isSessionData(const void* data, size_t sizeInBytes) {
+        return data != nullptr && sizeInBytes >= MAGIC_SIZE && std::memcmp(data, MAGIC, MAGIC_SIZE) == 0;
+    }
+
+    Writer::Writer(juce::OutputStream& stream, bool shouldCompress) : _stream(stream),
+                                                                      _shouldCompress(shouldCompress),
+                                                                      _numPluginStates(0),
+                                                                      _hasWrittenDocument(false) {
+        _stream.write(MAGIC, MAGIC_SIZE);
+        _stream.writeInt(CURRENT_VERSION);
+    }
+
+    int Writer::writePluginState(const juce::MemoryBlock& state) {
+        if (_hasWrittenDocument) {
+            juce::Logger::writeToLog("Can't write plugin state after the session document");
+            return -1;
+        }
+
+        if (!_writeChunk(CHUNK_TYPE::PLUGIN_STATE, state.getData(), state.getSize())) {
+            juce::Logger::writeToLog("Failed to write plugin state to session");
+            return -1;
+        }
+
+        return _numPluginStates++;
+    }
+
+    bool Writer::writeDocument(const juce::XmlElement& document) {
+        if (_hasWrittenDocument) {
+            juce::Logger::writeToLog("Session document has already been written");
+            return false;
+        }
+
+        _hasWrittenDocument = true;
+
+        juce::MemoryOutputStream documentStream;
+        document.writeTo(documentStream, juce::XmlElement::TextFormat().singleLine().withoutHeader());
+
+        const bool isWritten {
+            _writeChunk(CHUNK_TYPE::DOCUMENT, documentStream.getData(), documentStream.getDataSize()) &&
+            _writeChunk(CHUNK_TYPE::END, nullptr, 0)
+        };
+
+        _stream.flush();
+
+        if (!isWritten) {
+            juce::Logger::writeToLog("Failed to write session document");
+        }
+
+        return isWritten;
+    }
+
+    bool Writer::_writeChunk(CHUNK_TYPE type, const void* data, size_t sizeInBytes) {
+        int flags {0};
+        const void* storedData {data};
+        size_t storedSize {sizeInBytes};
+
+        juce::MemoryOutputStream compressedStream;
+        if (_shouldCompress && sizeInBytes >= MIN_COMPRESSION_BYTES) {
+            {
+                juce::GZIPCompressorOutputStream compressor(compressedStream, COMPRESSION_LEVEL);
+                compressor.write(data, sizeInBytes);
+            }
+
+            // Already compressed data can come out bigger
+            if (compressedStream.getDataSize() < sizeInBytes) {
+                flags |= FLAG_COMPRESSED;
+                storedData = compressedStream.getData();
+                storedSize = compressedStream.getDataSize();
+            }
+        }
+
+        return _stream.writeInt(static_cast<int>(type)) &&
+               _stream.writeInt(flags) &&
+               _stream.writeInt64(static_cast<juce::int64>(storedSize)) &&
+               _stream.writeInt64(static_cast<juce::int64>(sizeInBytes)) &&
+               (storedSize == 0 || _stream.write(storedData, storedSize));
+    }
+
+    bool Reader::read(juce::InputStream& stream) {
+        _pluginStates.clear();
+        _document.reset();
+
+        char magic[MAGIC_SIZE];
+        if (stream.read(magic, MAGIC_SIZE) != MAGIC_SIZE || std::memcmp(magic, MAGIC, MAGIC_SIZE) != 0) {
+            juce::Logger::writeToLog("Not a session");
+            return false;
+        }
+
+        const int version {stream.readInt()};
+        if (version < 1 || version > CURRENT_VERSION) {
+            juce::Logger::writeToLog("Unsupported session version " + juce::String(version));
+            return false;
+        }
+
+        while (true) {
+            if (stream.isExhausted()) {
+                juce::Logger::writeToLog("Session is truncated");
+                return false;
+            }
+
+            const int type {stream.readInt()};
+            const int flags {stream.readInt()};
+            const juce::int64 storedSize {stream.readInt64()};
+            const juce::int64 originalSize {stream.readInt64()};
+
+            const juce::int64 totalLength {stream.getTotalLength()};
+            const bool isTooLong {totalLength >= 0 && storedSize > totalLength - stream.getPosition()};
+
+            if (storedSize < 0 || originalSize < 0 || isTooLong) {
+                juce::Logger::writeToLog("Session has an invalid chunk size");
+                return false;
+            }
+
+            if (type == static_cast<int>(CHUNK_TYPE::END)) {
+                break;
+            } else if (type == static_cast<int>(CHUNK_TYPE::PLUGIN_STATE)) {
+                _pluginStates.emplace_back();
+
+                if (!_readChunkData(stream, flags, storedSize, originalSize, _pluginStates.back())) {
+                    juce::Logger::writeToLog("Failed to read plugin state " + juce::String(getNumPluginStates() - 1));
+                    return false;
+                }
+            } else if (type == static_cast<int>(CHUNK_TYPE::DOCUMENT)) {
+                juce::MemoryBlock documentData;
+
+                if (!_readChunkData(stream, flags, storedSize, originalSize, documentData)) {
+                    juce::Logger::writeToLog("Failed to read session document");
+                    return false;
+                }
+
+                _document = juce::parseXML(documentData.toString());
+            } else {
+                // Written by a newer version, but not needed to restore
+                stream.skipNextBytes(storedSize);
+            }
+        }
+
+        if (_document == nullptr) {
+            juce::Logger::writeToLog("Session has no document");
+            return false;
+        }
+
+        return true;
+    }
+
+    const juce::MemoryBlock* Reader::getPluginState(int index) const {
+        if (index < 0 || index >= getNumPluginStates()) {
+            return nullptr;
+        }
+
+        return &_pluginStates[static_cast<size_t>(index)];
+    }
+
+    bool Reader::_readChunkData(juce::InputStream& stream,
+                                int flags,
+                                juce::int64 storedSize,
+                                juce::int64 originalSize,
+                                juce::MemoryBlock& destData) {
+        destData.reset();
+
+        if (storedSize == 0) {
+            return originalSize == 0;
+        }
+
+        if ((flags & FLAG_COMPRESSED) == 0) {
+            return stream.readIntoMemoryBlock(destData, static_cast<juce::pointer_sized_int>(storedSize)) == static_cast<size_t>(storedSize);
+        }
+
+        if (originalSize > MAX_DECOMPRESSED_BYTES || originalSize > storedSize * MAX_COMPRESSION_RATIO) {
+            juce::Logger::writeToLog("Session has a compressed chunk that's too big: " + juce::String(originalSize) + " bytes");
+            return false;
+        }
+
+        juce::MemoryBlock compressedData;
+        if (stream.readIntoMemoryBlock(compressedData, static_cast<juce::pointer_sized_int>(storedSize)) != static_cast<size_t>(storedSize)) {
+            return false;
+        }
+
+        juce::MemoryInputStream compressedStream(compressedData, false);
+        juce::GZIPDecompressorInputStream decompressor(compressedStream);
+
+        return decompressor.readIntoMemoryBlock(destData, static_cast<juce::pointer_sized_int>(originalSize)) == static_cast<size_t>(originalSize);
+    }
+}
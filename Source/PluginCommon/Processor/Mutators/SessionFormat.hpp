@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * A binary container for saving sessions, so plugin states don't have to be base64 encoded into
+ * the XML document.
+ *
+ * The container is a header followed by a sequence of chunks, each with a type and a length so
+ * readers can skip types they don't know:
+ *
+ *   "SYNS" | int32 version | chunk... | end chunk
+ *   chunk: int32 type | int32 flags | int64 stored size | int64 original size | bytes
+ *
+ * Plugin states are written as raw chunks as soon as they're collected, and the slots in the
+ * document refer to them by index. The document is written last as it's only complete once every
+ * plugin state has been collected. All integers are little endian.
+ */
+namespace SessionFormat {
+    constexpr int CURRENT_VERSION {1};
+
+    enum class CHUNK_TYPE : int {
+        END = 0,
+        PLUGIN_STATE = 1,
+        DOCUMENT = 2
+    };
+
+    /**
+     * Returns true if the data starts with the container's header, otherwise it should be read as
+     * a legacy XML state.
+     */
+    bool isSessionData(const void* data, size_t sizeInBytes);
+
+    /**
+     * Writes a session to the stream as it's collected.
+     *
+     * If shouldCompress is set, chunks that are big enough are compressed where that makes them
+     * smaller.
+     */
+    class Writer {
+    public:
+        Writer(juce::OutputStream& stream, bool shouldCompress);
+
+        /**
+         * Writes a plugin state and returns the index the document should refer to it by.
+         */
+        int writePluginState(const juce::MemoryBlock& state);
+
+        /**
+         * Writes the document and the end of the container. Nothing can be written after this.
+         */
+        bool writeDocument(const juce::XmlElement& document);
+
+        int getNumPluginStates() const { return _numPluginStates; }
+
+    private:
+        // Smaller than this it isn't worth compressing
+        static constexpr size_t MIN_COMPRESSION_BYTES {1024};
+
+        juce::OutputStream& _stream;
+        const bool _shouldCompress;
+        int _numPluginStates;
+        bool _hasWrittenDocument;
+
+        bool _writeChunk(CHUNK_TYPE type, const void* data, size_t sizeInBytes);
+    };
+
+    /**
+     * Reads a session from the stream in one pass, keeping the plugin states so they can be looked
+     * up by index while the document is restored.
+     */
+    class Reader {
+    public:
+        Reader() = default;
+
+        /**
+         * Returns false if the stream doesn't hold a complete session this version can read.
+         */
+        bool read(juce::InputStream& stream);
+
+        std::unique_ptr<juce::XmlElement> takeDocument() { return std::move(_document); }
+
+        /**
+         * Returns nullptr if there isn't a plugin state with this index.
+         */
+        const juce::MemoryBlock* getPluginState(int index) const;
+
+        int getNumPluginStates() const { return static_cast<int>(_pluginStates.size()); }
+
+    private:
+        // The size a compressed chunk claims to decompress to is checked before any memory is
+        // allocated for it. Deflate can't do better than about 1032:1, and no plugin state is
+        // anywhere near a gigabyte
+        static constexpr juce::int64 MAX_COMPRESSION_RATIO {1032};
+        static constexpr juce::int64 MAX_DECOMPRESSED_BYTES {1024LL * 1024 * 1024};
+
+        std::vector<juce::MemoryBlock> _pluginStates;
+        std::unique_ptr<juce::XmlElement> _document;
+
+        bool _readChunkData(juce::InputStream& stream, int flags, juce::int64 storedSize, juce::int64 originalSize, juce::MemoryBlock& destData);
+    };
+}
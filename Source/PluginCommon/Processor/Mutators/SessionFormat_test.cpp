@@ -0,0 +1,231 @@
+#include "catch.hpp"
+
+#include "SessionFormat.hpp"
+
+namespace {
+    juce::MemoryBlock createTextState(const std::string& text) {
+        return juce::MemoryBlock(text.c_str(), text.size());
+    }
+
+    juce::MemoryBlock createRepeatingState(size_t sizeInBytes) {
+        juce::MemoryBlock retVal(sizeInBytes);
+        for (size_t index {0}; index < sizeInBytes; index++) {
+            retVal[index] = static_cast<char>(index % 16);
+        }
+
+        return retVal;
+    }
+
+    juce::MemoryBlock createNoiseState(size_t sizeInBytes) {
+        // Fixed seed so the corpus is the same every run
+        juce::Random random(1234);
+
+        juce::MemoryBlock retVal(sizeInBytes);
+        random.fillBitsRandomly(retVal.getData(), retVal.getSize());
+        return retVal;
+    }
+
+    // Plugin states like the ones hosts hand us, from empty to a multi-megabyte sampler
+    std::vector<juce::MemoryBlock> createStateCorpus() {
+        return {
+            juce::MemoryBlock(),
+            createTextState("testPluginData"),
+            createRepeatingState(64 * 1024),
+            createNoiseState(64 * 1024),
+            createNoiseState(4 * 1024 * 1024)
+        };
+    }
+
+    juce::MemoryBlock writeSession(const std::vector<juce::MemoryBlock>& states, bool shouldCompress) {
+        juce::MemoryBlock retVal;
+
+        {
+            juce::MemoryOutputStream stream(retVal, false);
+            SessionFormat::Writer writer(stream, shouldCompress);
+
+            juce::XmlElement document("test");
+            for (const juce::MemoryBlock& state : states) {
+                juce::XmlElement* slotElement = document.createNewChildElement("Slot");
+                slotElement->setAttribute("Chunk", writer.writePluginState(state));
+            }
+
+            writer.writeDocument(document);
+        }
+
+        return retVal;
+    }
+
+    bool readSession(const juce::MemoryBlock& data, SessionFormat::Reader& reader) {
+        juce::MemoryInputStream stream(data, false);
+        return reader.read(stream);
+    }
+}
+
+SCENARIO("SessionFormat: Documents and plugin states round trip") {
+    GIVEN("A corpus of plugin states") {
+        const std::vector<juce::MemoryBlock> states = createStateCorpus();
+        const bool shouldCompress = GENERATE(false, true);
+
+        WHEN("They're written to a session and read back") {
+            const juce::MemoryBlock data = writeSession(states, shouldCompress);
+
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(data, reader)};
+
+            THEN("Every state is read back unchanged and the document refers to it by index") {
+                REQUIRE(isRead);
+                CHECK(SessionFormat::isSessionData(data.getData(), data.getSize()));
+                REQUIRE(reader.getNumPluginStates() == static_cast<int>(states.size()));
+
+                std::unique_ptr<juce::XmlElement> document = reader.takeDocument();
+                REQUIRE(document != nullptr);
+                CHECK(document->getTagName() == "test");
+                REQUIRE(document->getNumChildElements() == static_cast<int>(states.size()));
+
+                for (int index {0}; index < document->getNumChildElements(); index++) {
+                    const int chunkIndex {document->getChildElement(index)->getIntAttribute("Chunk", -1)};
+                    CHECK(chunkIndex == index);
+
+                    const juce::MemoryBlock* state = reader.getPluginState(chunkIndex);
+                    REQUIRE(state != nullptr);
+                    CHECK(*state == states[static_cast<size_t>(index)]);
+                }
+
+                CHECK(reader.getPluginState(-1) == nullptr);
+                CHECK(reader.getPluginState(static_cast<int>(states.size())) == nullptr);
+            }
+        }
+    }
+
+    GIVEN("A state that compresses well and one that doesn't") {
+        const juce::MemoryBlock repeatingState = createRepeatingState(64 * 1024);
+        const juce::MemoryBlock noiseState = createNoiseState(64 * 1024);
+
+        WHEN("They're written with and without compression") {
+            const juce::MemoryBlock uncompressedRepeating = writeSession({repeatingState}, false);
+            const juce::MemoryBlock compressedRepeating = writeSession({repeatingState}, true);
+            const juce::MemoryBlock uncompressedNoise = writeSession({noiseState}, false);
+            const juce::MemoryBlock compressedNoise = writeSession({noiseState}, true);
+
+            THEN("Only the state that compresses well is stored compressed") {
+                CHECK(compressedRepeating.getSize() < uncompressedRepeating.getSize() / 10);
+                CHECK(compressedNoise.getSize() == uncompressedNoise.getSize());
+            }
+
+            THEN("Uncompressed states are stored raw rather than encoded") {
+                CHECK(uncompressedNoise.getSize() < noiseState.getSize() + 1024);
+            }
+        }
+    }
+}
+
+SCENARIO("SessionFormat: Legacy XML states aren't read as sessions") {
+    GIVEN("A state saved as XML by an older version") {
+        juce::XmlElement element("SyndicateState");
+        element.setAttribute("PluginData", createTextState("testPluginData").toBase64Encoding());
+
+        juce::MemoryBlock binaryXml;
+        juce::AudioProcessor::copyXmlToBinary(element, binaryXml);
+
+        const juce::String xmlText = element.toString();
+
+        WHEN("They're checked") {
+            THEN("Neither the binary XML or plain text is recognised as a session") {
+                CHECK_FALSE(SessionFormat::isSessionData(binaryXml.getData(), binaryXml.getSize()));
+                CHECK_FALSE(SessionFormat::isSessionData(xmlText.toRawUTF8(), xmlText.getNumBytesAsUTF8()));
+                CHECK_FALSE(SessionFormat::isSessionData(nullptr, 0));
+            }
+        }
+
+        WHEN("One is read as a session") {
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(binaryXml, reader)};
+
+            THEN("It fails") {
+                CHECK_FALSE(isRead);
+                CHECK(reader.takeDocument() == nullptr);
+            }
+        }
+    }
+}
+
+SCENARIO("SessionFormat: Damaged sessions are rejected") {
+    GIVEN("A session with plugin states") {
+        const juce::MemoryBlock data = writeSession({createTextState("testPluginData"), createNoiseState(4096)}, false);
+
+        WHEN("It's truncated") {
+            const size_t truncatedSize = GENERATE(4, 8, 20, 100, 4000);
+            juce::MemoryBlock truncatedData(data.getData(), std::min(truncatedSize, data.getSize() - 1));
+
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(truncatedData, reader)};
+
+            THEN("It isn't read") {
+                CHECK_FALSE(isRead);
+            }
+        }
+
+        WHEN("A compressed chunk claims to decompress to more than it could") {
+            juce::MemoryBlock oversizedData(writeSession({createRepeatingState(64 * 1024)}, true));
+
+            // The first chunk's original size, after the magic, version, type, flags and stored size
+            const juce::int64 originalSize {1LL << 40};
+            oversizedData.copyFrom(&originalSize, 24, sizeof(originalSize));
+
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(oversizedData, reader)};
+
+            THEN("It isn't read") {
+                CHECK_FALSE(isRead);
+            }
+        }
+
+        WHEN("Its version is newer than this one can read") {
+            juce::MemoryBlock newerData(data);
+            const int newerVersion {SessionFormat::CURRENT_VERSION + 1};
+            newerData.copyFrom(&newerVersion, 4, sizeof(newerVersion));
+
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(newerData, reader)};
+
+            THEN("It isn't read") {
+                CHECK_FALSE(isRead);
+            }
+        }
+    }
+}
+
+SCENARIO("SessionFormat: Unknown chunks are skipped") {
+    GIVEN("A session with a chunk type this version doesn't know") {
+        juce::MemoryBlock data;
+
+        {
+            juce::MemoryOutputStream stream(data, false);
+            SessionFormat::Writer writer(stream, false);
+            writer.writePluginState(createTextState("testPluginData"));
+
+            // As a newer version would write it
+            const std::string unknownData("unknown");
+            stream.writeInt(99);
+            stream.writeInt(0);
+            stream.writeInt64(static_cast<juce::int64>(unknownData.size()));
+            stream.writeInt64(static_cast<juce::int64>(unknownData.size()));
+            stream.write(unknownData.c_str(), unknownData.size());
+
+            juce::XmlElement document("test");
+            writer.writeDocument(document);
+        }
+
+        WHEN("It's read") {
+            SessionFormat::Reader reader;
+            const bool isRead {readSession(data, reader)};
+
+            THEN("The rest of the session is read") {
+                REQUIRE(isRead);
+                REQUIRE(reader.getNumPluginStates() == 1);
+                CHECK(*reader.getPluginState(0) == createTextState("testPluginData"));
+                CHECK(reader.takeDocument() != nullptr);
+            }
+        }
+    }
+}
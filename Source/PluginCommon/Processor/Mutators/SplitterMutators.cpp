@@ -42,7 +42,7 @@ namespace {
 namespace SplitterMutators {
     bool insertPlugin(std::shared_ptr<PluginSplitter> splitter, std::shared_ptr<juce::AudioPluginInstance> plugin, int chainNumber, int positionInChain) {
         if (splitter->chains.size() > chainNumber) {
-            ChainMutators::insertPlugin(splitter->chains[chainNumber].chain, plugin, positionInChain, splitter->config);
+            ChainMutators::insertPlugin(splitter->getChainForWrite(chainNumber), plugin, positionInChain, splitter->config);
             return true;
         }
 
@@ -51,7 +51,7 @@ namespace SplitterMutators {
 
     bool replacePlugin(std::shared_ptr<PluginSplitter> splitter, std::shared_ptr<juce::AudioPluginInstance> plugin, int chainNumber, int positionInChain) {
         if (splitter->chains.size() > chainNumber) {
-            ChainMutators::replacePlugin(splitter->chains[chainNumber].chain, plugin, positionInChain, splitter->config);
+            ChainMutators::replacePlugin(splitter->getChainForWrite(chainNumber), plugin, positionInChain, splitter->config);
             return true;
         }
 
@@ -60,15 +60,29 @@ namespace SplitterMutators {
 
     bool removeSlot(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain) {
         if (splitter->chains.size() > chainNumber) {
-            return ChainMutators::removeSlot(splitter->chains[chainNumber].chain, positionInChain);
+            return ChainMutators::removeSlot(splitter->getChainForWrite(chainNumber), positionInChain);
         }
 
         return false;
     }
 
+    bool swapPlugin(std::shared_ptr<PluginSplitter> splitter, const juce::AudioPluginInstance* oldPlugin, std::shared_ptr<juce::AudioPluginInstance> newPlugin, bool shouldCrossfade) {
+        bool isFound {false};
+
+        // Only the chains hosting the plugin are copied
+        for (size_t chainIndex {0}; chainIndex < splitter->chains.size(); chainIndex++) {
+            if (ChainMutators::containsPlugin(splitter->chains[chainIndex].chain, oldPlugin)) {
+                ChainMutators::swapPlugin(splitter->getChainForWrite(chainIndex), oldPlugin, newPlugin, splitter->config, shouldCrossfade);
+                isFound = true;
+            }
+        }
+
+        return isFound;
+    }
+
     bool insertGainStage(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain) {
         if (splitter->chains.size() > chainNumber) {
-            ChainMutators::insertGainStage(splitter->chains[chainNumber].chain, positionInChain, splitter->config);
+            ChainMutators::insertGainStage(splitter->getChainForWrite(chainNumber), positionInChain, splitter->config);
             return true;
         }
 
@@ -85,7 +99,7 @@ namespace SplitterMutators {
 
     bool setPluginModulationConfig(std::shared_ptr<PluginSplitter> splitter, PluginModulationConfig config, int chainNumber, int positionInChain) {
         if (chainNumber < splitter->chains.size()) {
-            return ChainMutators::setPluginModulationConfig(splitter->chains[chainNumber].chain, config, positionInChain);
+            return ChainMutators::setPluginModulationConfig(splitter->getChainForWrite(chainNumber), config, positionInChain);
         }
 
         return false;
@@ -101,7 +115,7 @@ namespace SplitterMutators {
 
     bool setSlotBypass(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, bool isBypassed) {
         if (splitter->chains.size() > chainNumber) {
-            return ChainMutators::setSlotBypass(splitter->chains[chainNumber].chain, positionInChain, isBypassed);
+            return ChainMutators::setSlotBypass(splitter->getChainForWrite(chainNumber), positionInChain, isBypassed);
         }
 
         return false;
@@ -225,7 +239,7 @@ namespace SplitterMutators {
 
                     PluginConfigurator pluginConfigurator;
 
-                    if (pluginConfigurator.configure(sharedPlugin, splitter->config)) {
+                    if (pluginConfigurator.configure(sharedPlugin, splitter->config, PluginConfigurator::isMonoChainSplitType(splitter->splitType))) {
                         insertPlugin(sharedPlugin, sourceState, isBypassed, sourceConfig);
                     } else {
                         juce::Logger::writeToLog("SyndicateAudioProcessor::copySlot: Failed to configure plugin");
@@ -322,7 +336,7 @@ namespace SplitterMutators {
 
     bool setGainLinear(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, float gain) {
         if (chainNumber < splitter->chains.size()) {
-            return ChainMutators::setGainLinear(splitter->chains[chainNumber].chain, positionInChain, gain);
+            return ChainMutators::setGainLinear(splitter->getChainForWrite(chainNumber), positionInChain, gain);
         }
 
         return false;
@@ -336,17 +350,17 @@ namespace SplitterMutators {
         return 0.0f;
     }
 
-    float getGainStageOutputAmplitude(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, int channelNumber) {
+    std::shared_ptr<LevelMeter> getGainStageMeter(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain) {
         if (chainNumber < splitter->chains.size()) {
-            return ChainMutators::getGainStageOutputAmplitude(splitter->chains[chainNumber].chain, positionInChain, channelNumber);
+            return ChainMutators::getGainStageMeter(splitter->chains[chainNumber].chain, positionInChain);
         }
 
-        return 0.0f;
+        return nullptr;
     }
 
     bool setPan(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, float pan) {
         if (chainNumber < splitter->chains.size()) {
-            return ChainMutators::setPan(splitter->chains[chainNumber].chain, positionInChain, pan);
+            return ChainMutators::setPan(splitter->getChainForWrite(chainNumber), positionInChain, pan);
         }
 
         return false;
@@ -369,27 +383,7 @@ namespace SplitterMutators {
     }
 
     SPLIT_TYPE getSplitType(const std::shared_ptr<PluginSplitter> splitter) {
-        if (std::dynamic_pointer_cast<PluginSplitterSeries>(splitter)) {
-            return SPLIT_TYPE::SERIES;
-        }
-
-        if (std::dynamic_pointer_cast<PluginSplitterParallel>(splitter)) {
-            return SPLIT_TYPE::PARALLEL;
-        }
-
-        if (std::dynamic_pointer_cast<PluginSplitterMultiband>(splitter)) {
-            return SPLIT_TYPE::MULTIBAND;
-        }
-
-        if (std::dynamic_pointer_cast<PluginSplitterLeftRight>(splitter)) {
-            return SPLIT_TYPE::LEFTRIGHT;
-        }
-
-        if (std::dynamic_pointer_cast<PluginSplitterMidSide>(splitter)) {
-            return SPLIT_TYPE::MIDSIDE;
-        }
-
-        return SPLIT_TYPE::SERIES;
+        return splitter->splitType;
     }
 
     void addChain(std::shared_ptr<PluginSplitter> splitter) {
@@ -403,7 +397,7 @@ namespace SplitterMutators {
 
     bool removeChain(std::shared_ptr<PluginSplitterParallel> splitter, int chainNumber) {
         if (splitter->chains.size() > 1 && chainNumber < splitter->chains.size()) {
-            splitter->chains[chainNumber].chain->latencyListener.removeSplitter();
+            splitter->chains[chainNumber].chain->latencyListener.removeSplitter(splitter.get());
             splitter->chains.erase(splitter->chains.begin() + chainNumber);
 
             splitter->onLatencyChange();
@@ -435,7 +429,7 @@ namespace SplitterMutators {
             CrossoverMutators::getNumBands(splitter->crossover) > bandNumber) {
             // Remove the band first, then the chain
             if (CrossoverMutators::removeBand(splitter->crossover, bandNumber)) {
-                splitter->chains[bandNumber].chain->latencyListener.removeSplitter();
+                splitter->chains[bandNumber].chain->latencyListener.removeSplitter(splitter.get());
                 splitter->chains.erase(splitter->chains.begin() + bandNumber);
                 splitter->onLatencyChange();
                 return true;
@@ -460,7 +454,7 @@ namespace SplitterMutators {
             return false;
         }
 
-        splitter->chains[chainNumber].chain->customName = name;
+        splitter->getChainForWrite(chainNumber)->customName = name;
         return true;
     }
 
@@ -9,6 +9,7 @@ namespace SplitterMutators {
     bool insertPlugin(std::shared_ptr<PluginSplitter> splitter, std::shared_ptr<juce::AudioPluginInstance> plugin, int chainNumber, int positionInChain);
     bool replacePlugin(std::shared_ptr<PluginSplitter> splitter, std::shared_ptr<juce::AudioPluginInstance> plugin, int chainNumber, int positionInChain);
     bool removeSlot(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
+    bool swapPlugin(std::shared_ptr<PluginSplitter> splitter, const juce::AudioPluginInstance* oldPlugin, std::shared_ptr<juce::AudioPluginInstance> newPlugin, bool shouldCrossfade);
     bool insertGainStage(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
 
     std::shared_ptr<juce::AudioPluginInstance> getPlugin(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
@@ -39,7 +40,7 @@ namespace SplitterMutators {
 
     bool setGainLinear(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, float gain);
     float getGainLinear(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
-    float getGainStageOutputAmplitude(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, int channelNumber);
+    std::shared_ptr<LevelMeter> getGainStageMeter(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
 
     bool setPan(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain, float pan);
     float getPan(std::shared_ptr<PluginSplitter> splitter, int chainNumber, int positionInChain);
@@ -0,0 +1,106 @@
+#include "StandbyLoader.hpp"
+
+StandbyLoader::StandbyLoader(ModelInterface::StateManager& manager,
+                             const PluginConfigurator& pluginConfigurator,
+                             std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+                             std::function<void(int)> latencyChangeCallback,
+                             std::function<void()> onStandbyLoadedCallback,
+                             std::function<void(juce::String)> onErrorCallback)
+        : juce::Thread("Standby loader"),
+          _manager(manager),
+          _pluginConfigurator(pluginConfigurator),
+          _getModulationValueCallback(getModulationValueCallback),
+          _latencyChangeCallback(latencyChangeCallback),
+          _onStandbyLoadedCallback(onStandbyLoadedCallback),
+          _onErrorCallback(onErrorCallback) {
+    addDefaultFormatsToManager(_formatManager);
+}
+
+StandbyLoader::~StandbyLoader() {
+    stop();
+    cancelPendingUpdate();
+}
+
+void StandbyLoader::load(std::unique_ptr<juce::XmlElement> splitterElement,
+                         std::unique_ptr<juce::XmlElement> sourcesElement,
+                         juce::Array<juce::PluginDescription> availableTypes,
+                         HostConfiguration config) {
+    stop();
+
+    _splitterElement = std::move(splitterElement);
+    _sourcesElement = std::move(sourcesElement);
+    _availableTypes = availableTypes;
+    _config = config;
+    _config.maxLatencyCompensationSamples = _manager.maxLatencyCompensationSamples.load(std::memory_order_relaxed);
+    startThread();
+}
+
+void StandbyLoader::stop() {
+    stopThread(STOP_TIMEOUT_MS);
+
+    const juce::ScopedLock lock(_pendingCallbacksLock);
+    _pendingStandby.reset();
+}
+
+void StandbyLoader::run() {
+    if (_splitterElement == nullptr) {
+        juce::Logger::writeToLog("Standby not loaded - missing splitter");
+        return;
+    }
+
+    const double startTime {juce::Time::getMillisecondCounterHiRes()};
+
+    PluginInstantiator instantiator(_availableTypes,
+        [&](const juce::PluginDescription& description, const HostConfiguration& config, juce::String& errorMessage) {
+            return PluginInstantiator::createPluginFromThread(_formatManager, description, config, errorMessage);
+        });
+
+    std::vector<juce::String> errors;
+    std::shared_ptr<ModelInterface::StateWrapper> standby = ModelInterface::createStandbyFromXml(
+        _splitterElement.get(),
+        _sourcesElement.get(),
+        _getModulationValueCallback,
+        _latencyChangeCallback,
+        _config,
+        _pluginConfigurator,
+        instantiator,
+        [&errors](juce::String errorText) { errors.push_back(errorText); });
+
+    if (threadShouldExit()) {
+        // Stopped part way through, so some plugins may be missing
+        juce::Logger::writeToLog("Standby load abandoned");
+        return;
+    }
+
+    juce::Logger::writeToLog("Loaded standby in " +
+                             juce::String(juce::Time::getMillisecondCounterHiRes() - startTime, 1) + "ms");
+
+    {
+        const juce::ScopedLock lock(_pendingCallbacksLock);
+        _pendingErrors.insert(_pendingErrors.end(), errors.begin(), errors.end());
+        _pendingStandby = standby;
+    }
+
+    triggerAsyncUpdate();
+}
+
+void StandbyLoader::handleAsyncUpdate() {
+    std::vector<juce::String> errors;
+    std::shared_ptr<ModelInterface::StateWrapper> standby;
+
+    {
+        const juce::ScopedLock lock(_pendingCallbacksLock);
+        std::swap(errors, _pendingErrors);
+        std::swap(standby, _pendingStandby);
+    }
+
+    for (const juce::String& errorText : errors) {
+        _onErrorCallback(errorText);
+    }
+
+    if (standby != nullptr) {
+        // Changes the latency the graph is aligned to, the callback reports it to the host
+        ModelInterface::setStandby(_manager, standby);
+        _onStandbyLoadedCallback();
+    }
+}
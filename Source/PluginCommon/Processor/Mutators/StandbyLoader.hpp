@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MutatorsInterface.hpp"
+#include "PluginInstantiator.hpp"
+
+/**
+ * Builds a standby state from a saved document in the background, while the current state carries
+ * on processing, so switching to it later is just a crossfade.
+ *
+ * The finished standby is set on the message thread, just before the loaded callback, so the
+ * latency the graph is aligned to only changes when the processor is about to report it to the
+ * host. The callbacks are called on the message thread.
+ */
+class StandbyLoader : public juce::Thread,
+                      private juce::AsyncUpdater {
+public:
+    StandbyLoader(ModelInterface::StateManager& manager,
+                  const PluginConfigurator& pluginConfigurator,
+                  std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+                  std::function<void(int)> latencyChangeCallback,
+                  std::function<void()> onStandbyLoadedCallback,
+                  std::function<void(juce::String)> onErrorCallback);
+    ~StandbyLoader() override;
+
+    /**
+     * Starts building a standby from elements written by writeSplitterToXml() and
+     * writeSourcesToXml(). Any standby that's already loading is abandoned.
+     */
+    void load(std::unique_ptr<juce::XmlElement> splitterElement,
+              std::unique_ptr<juce::XmlElement> sourcesElement,
+              juce::Array<juce::PluginDescription> availableTypes,
+              HostConfiguration config);
+
+    /**
+     * Stops loading, and drops a loaded standby that hasn't been set yet. The existing standby is
+     * kept.
+     */
+    void stop();
+
+    void run() override;
+
+private:
+    static constexpr int STOP_TIMEOUT_MS {5000};
+
+    ModelInterface::StateManager& _manager;
+    const PluginConfigurator& _pluginConfigurator;
+    std::function<float(int, MODULATION_TYPE)> _getModulationValueCallback;
+    std::function<void(int)> _latencyChangeCallback;
+    std::function<void()> _onStandbyLoadedCallback;
+    std::function<void(juce::String)> _onErrorCallback;
+
+    juce::AudioPluginFormatManager _formatManager;
+    std::unique_ptr<juce::XmlElement> _splitterElement;
+    std::unique_ptr<juce::XmlElement> _sourcesElement;
+    juce::Array<juce::PluginDescription> _availableTypes;
+    HostConfiguration _config;
+
+    // Passed from the loading thread to the message thread
+    juce::CriticalSection _pendingCallbacksLock;
+    std::vector<juce::String> _pendingErrors;
+    std::shared_ptr<ModelInterface::StateWrapper> _pendingStandby;
+
+    void handleAsyncUpdate() override;
+};
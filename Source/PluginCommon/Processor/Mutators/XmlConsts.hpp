@@ -11,6 +11,8 @@ inline const char* XML_GAIN_STAGE_GAIN_STR {"Gain"};
 inline const char* XML_GAIN_STAGE_PAN_STR {"Pan"};
 
 inline const char* XML_PLUGIN_DATA_STR {"PluginData"};
+inline const char* XML_PLUGIN_DATA_CHUNK_STR {"PluginDataChunk"};
+inline const char* XML_PLUGIN_LATENCY_STR {"PluginLatency"};
 inline const char* XML_MODULATION_CONFIG_STR {"ModulationConfig"};
 inline const char* XML_MODULATION_IS_ACTIVE_STR {"ModulationIsActive"};
 inline const char* XML_MODULATION_TARGET_PARAMETER_NAME_STR {"TargetParameterName"};
@@ -7,38 +7,110 @@
 #include "RichterLFO/RichterLFO.h"
 
 namespace {
-    int comparePluginDescriptionAgainstTarget(const juce::PluginDescription& description, const juce::PluginDescription& target) {
-        // Format is most important for compatibility when loading settings
-        if (description.pluginFormatName == target.pluginFormatName) {
-            return 2;
+    /**
+     * Returns the descriptions of all the plugins in the chains, in the order they'll be restored.
+     */
+    std::vector<juce::PluginDescription> getPluginDescriptions(juce::XmlElement* chainsElement) {
+        std::vector<juce::PluginDescription> retVal;
+
+        if (chainsElement == nullptr) {
+            return retVal;
+        }
+
+        for (int chainNumber {0}; chainNumber < chainsElement->getNumChildElements(); chainNumber++) {
+            juce::XmlElement* chainElement = chainsElement->getChildByName(getChainXMLName(chainNumber));
+            juce::XmlElement* pluginsElement = chainElement == nullptr ? nullptr : chainElement->getChildByName(XML_PLUGINS_STR);
+
+            if (pluginsElement == nullptr) {
+                continue;
+            }
+
+            for (int pluginNumber {0}; pluginNumber < pluginsElement->getNumChildElements(); pluginNumber++) {
+                juce::XmlElement* pluginElement = pluginsElement->getChildByName(getSlotXMLName(pluginNumber));
+
+                if (pluginElement != nullptr &&
+                    XmlReader::XmlElementIsPlugin(pluginElement) &&
+                    pluginElement->getNumChildElements() > 0) {
+
+                    juce::PluginDescription description;
+                    if (description.loadFromXml(*pluginElement->getChildElement(0))) {
+                        retVal.push_back(description);
+                    }
+                }
+            }
         }
 
-        if (description.version == target.version) {
-            return 1;
+        return retVal;
+    }
+
+    bool restoreSlotIsBypassed(juce::XmlElement* element) {
+        bool retVal {false};
+        if (element->hasAttribute(XML_SLOT_IS_BYPASSED_STR)) {
+            retVal = element->getBoolAttribute(XML_SLOT_IS_BYPASSED_STR);
+        } else {
+            juce::Logger::writeToLog("Missing attribute " + juce::String(XML_SLOT_IS_BYPASSED_STR));
         }
 
-        return 0;
+        return retVal;
     }
 
-    class AvailableTypesSorter {
-    public:
-        AvailableTypesSorter(const juce::PluginDescription& target) : _target(target) {}
+    /**
+     * Restores the editor bounds, the plugin's internal state, and its modulation config into a
+     * slot that already holds the plugin. The state is looked up in the session if it was saved
+     * outside the document.
+     */
+    void restorePluginSlotSettings(juce::XmlElement* element,
+                                   ChainSlotPlugin& slot,
+                                   const SessionFormat::Reader* sessionReader) {
+        // Restore the editor bounds
+        if (element->hasAttribute(XML_PLUGIN_EDITOR_BOUNDS_STR)) {
+            const juce::String boundsString = element->getStringAttribute(XML_PLUGIN_EDITOR_BOUNDS_STR);
+
+            if (element->hasAttribute(XML_DISPLAY_AREA_STR)) {
+                const juce::String displayString = element->getStringAttribute(XML_DISPLAY_AREA_STR);
+
+                slot.editorBounds.reset(new PluginEditorBounds());
+                *(slot.editorBounds.get()) =  PluginEditorBoundsContainer(
+                    juce::Rectangle<int>::fromString(boundsString),
+                    juce::Rectangle<int>::fromString(displayString)
+                );
+            } else {
+                juce::Logger::writeToLog("Missing attribute " + juce::String(XML_DISPLAY_AREA_STR));
+            }
 
-        int compareElements(const juce::PluginDescription& a, const juce::PluginDescription& b) {
-            return comparePluginDescriptionAgainstTarget(b, _target) - comparePluginDescriptionAgainstTarget(a, _target);
+        } else {
+            juce::Logger::writeToLog("Missing attribute " + juce::String(XML_PLUGIN_EDITOR_BOUNDS_STR));
         }
 
-    private:
-        const juce::PluginDescription& _target;
-    };
+        // Restore the plugin's internal state
+        juce::MemoryBlock decodedPluginData;
+        const juce::MemoryBlock* pluginData {nullptr};
 
-    juce::String pluginTypesToString(const juce::Array<juce::PluginDescription>& types) {
-        juce::String retVal;
-        for (const juce::PluginDescription& type : types) {
-            retVal += type.pluginFormatName + " " + type.version + ", ";
+        if (element->hasAttribute(XML_PLUGIN_DATA_STR)) {
+            const juce::String pluginDataString = element->getStringAttribute(XML_PLUGIN_DATA_STR);
+            decodedPluginData.fromBase64Encoding(pluginDataString);
+            pluginData = &decodedPluginData;
+        } else if (element->hasAttribute(XML_PLUGIN_DATA_CHUNK_STR) && sessionReader != nullptr) {
+            // Saved in the binary session format
+            pluginData = sessionReader->getPluginState(element->getIntAttribute(XML_PLUGIN_DATA_CHUNK_STR));
         }
 
-        return retVal;
+        if (pluginData != nullptr) {
+            slot.plugin->setStateInformation(pluginData->getData(), static_cast<int>(pluginData->getSize()));
+
+            // Now that the plugin is restored, we can restore the modulation config
+            juce::XmlElement* modulationConfigElement = element->getChildByName(XML_MODULATION_CONFIG_STR);
+            if (modulationConfigElement != nullptr) {
+                slot.modulationConfig = XmlReader::restorePluginModulationConfig(modulationConfigElement);
+                slot.modulationMatrix.compile(*slot.plugin, *slot.modulationConfig);
+            } else {
+                juce::Logger::writeToLog("Missing element " + juce::String(XML_MODULATION_CONFIG_STR));
+            }
+        } else if (element->hasAttribute(XML_PLUGIN_DATA_CHUNK_STR)) {
+            juce::Logger::writeToLog("Missing plugin state chunk " + element->getStringAttribute(XML_PLUGIN_DATA_CHUNK_STR));
+        } else {
+            juce::Logger::writeToLog("Missing attribute " + juce::String(XML_PLUGIN_DATA_STR));
+        }
     }
 }
 
@@ -52,6 +124,21 @@ namespace XmlReader {
             juce::Array<juce::PluginDescription> availableTypes,
             std::function<void(juce::String)> onErrorCallback) {
 
+        PluginInstantiator instantiator(availableTypes);
+        return restoreSplitterFromXml(
+            element, getModulationValueCallback, latencyChangeCallback, configuration, pluginConfigurator, instantiator, onErrorCallback);
+    }
+
+    std::shared_ptr<PluginSplitter> restoreSplitterFromXml(
+            juce::XmlElement* element,
+            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+            std::function<void(int)> latencyChangeCallback,
+            HostConfiguration configuration,
+            const PluginConfigurator& pluginConfigurator,
+            PluginInstantiator& instantiator,
+            std::function<void(juce::String)> onErrorCallback,
+            const SessionFormat::Reader* sessionReader) {
+
         // Default to series
         SPLIT_TYPE splitType = SPLIT_TYPE::SERIES;
 
@@ -93,12 +180,21 @@ namespace XmlReader {
             splitter->chains.erase(splitter->chains.begin());
         }
 
-        // Restore each chain
+        // Create all the plugins up front so they can be loaded concurrently, the chains then take
+        // them as they're restored
         juce::XmlElement* chainsElement = element->getChildByName(XML_CHAINS_STR);
         const int numChains {
             chainsElement == nullptr ? 0 : chainsElement->getNumChildElements()
         };
 
+        const double parseStartTime {juce::Time::getMillisecondCounterHiRes()};
+        const std::vector<juce::PluginDescription> pluginDescriptions = getPluginDescriptions(chainsElement);
+
+        const double instantiateStartTime {juce::Time::getMillisecondCounterHiRes()};
+        instantiator.preload(pluginDescriptions, configuration);
+
+        const double assembleStartTime {juce::Time::getMillisecondCounterHiRes()};
+
         for (int chainNumber {0}; chainNumber < numChains; chainNumber++) {
             juce::Logger::writeToLog("Restoring chain " + juce::String(chainNumber));
 
@@ -118,7 +214,7 @@ namespace XmlReader {
                 // Add the chain to the vector
                 splitter->chains.emplace_back(std::make_shared<PluginChain>(getModulationValueCallback), false);
                 PluginChainWrapper& thisChain = splitter->chains[splitter->chains.size() - 1];
-                thisChain.chain = XmlReader::restoreChainFromXml(thisChainElement, configuration, pluginConfigurator, getModulationValueCallback, availableTypes, onErrorCallback);
+                thisChain.chain = XmlReader::restoreChainFromXml(thisChainElement, configuration, pluginConfigurator, getModulationValueCallback, instantiator, onErrorCallback, PluginConfigurator::isMonoChainSplitType(splitType), sessionReader);
 
                 if (auto multibandSplitter = std::dynamic_pointer_cast<PluginSplitterMultiband>(splitter)) {
                     // Since we deleted all chains at the start to make sure we have a
@@ -161,6 +257,14 @@ namespace XmlReader {
 
         splitter->onLatencyChange();
 
+        const double endTime {juce::Time::getMillisecondCounterHiRes()};
+        juce::Logger::writeToLog(
+            "Restored " + juce::String(static_cast<int>(pluginDescriptions.size())) + " plugins in " + juce::String(numChains) + " chains, " +
+            juce::String(instantiator.getNumReusedPlugins()) + " reused - " +
+            "parse: " + juce::String(instantiateStartTime - parseStartTime, 1) + "ms, " +
+            "instantiate: " + juce::String(assembleStartTime - instantiateStartTime, 1) + "ms, " +
+            "assemble: " + juce::String(endTime - assembleStartTime, 1) + "ms");
+
         return splitter;
     }
 
@@ -170,7 +274,23 @@ namespace XmlReader {
             const PluginConfigurator& pluginConfigurator,
             std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
             juce::Array<juce::PluginDescription> availableTypes,
-            std::function<void(juce::String)> onErrorCallback) {
+            std::function<void(juce::String)> onErrorCallback,
+            bool isMonoChain) {
+
+        PluginInstantiator instantiator(availableTypes);
+        return restoreChainFromXml(
+            element, configuration, pluginConfigurator, getModulationValueCallback, instantiator, onErrorCallback, isMonoChain);
+    }
+
+    std::unique_ptr<PluginChain> restoreChainFromXml(
+            juce::XmlElement* element,
+            HostConfiguration configuration,
+            const PluginConfigurator& pluginConfigurator,
+            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+            PluginInstantiator& instantiator,
+            std::function<void(juce::String)> onErrorCallback,
+            bool isMonoChain,
+            const SessionFormat::Reader* sessionReader) {
 
         auto retVal = std::make_unique<PluginChain>(getModulationValueCallback);
 
@@ -215,56 +335,18 @@ namespace XmlReader {
             }
 
             if (XmlReader::XmlElementIsPlugin(thisPluginElement)) {
-                auto loadPlugin = [&availableTypes](const juce::PluginDescription& description, const HostConfiguration& config) {
-                    juce::AudioPluginFormatManager formatManager;
-                    addDefaultFormatsToManager(formatManager);
-
-                    // First try the exact match
-                    juce::String errorMessage;
-                    std::unique_ptr<juce::AudioPluginInstance> thisPlugin =
-                        formatManager.createPluginInstance(
-                            description, config.sampleRate, config.blockSize, errorMessage);
-
-                    // Failing that, get all possible matches from the available types
-                    if (thisPlugin == nullptr) {
-                        juce::Logger::writeToLog("Failed to load plugin " + description.name + ": " + errorMessage);
-                        juce::Logger::writeToLog("Looking for alternatives");
-
-                        juce::Array<juce::PluginDescription> possibleTypes;
-                        for (const juce::PluginDescription& availableType : availableTypes) {
-                            if (description.manufacturerName == availableType.manufacturerName &&
-                                description.name == availableType.name) {
-                                possibleTypes.add(availableType);
-                            }
-                        }
-
-                        // Sort by best match first
-                        AvailableTypesSorter sorter(description);
-                        possibleTypes.sort(sorter);
-
-                        const juce::String possibleTypesString = pluginTypesToString(possibleTypes);
-                        juce::Logger::writeToLog("Found alternatives: " + possibleTypesString);
-
-                        for (const juce::PluginDescription& possibleType : possibleTypes) {
-                            juce::String newErrorMessage;
-                            thisPlugin = formatManager.createPluginInstance(
-                                possibleType, config.sampleRate, config.blockSize, newErrorMessage);
+                // Use a matching plugin that's already running if there is one, otherwise load it
+                std::unique_ptr<ChainSlotPlugin> newPlugin = XmlReader::restoreReusedChainSlotPlugin(
+                    thisPluginElement, getModulationValueCallback, configuration, pluginConfigurator, instantiator, isMonoChain, sessionReader);
 
-                            if (thisPlugin != nullptr) {
-                                juce::Logger::writeToLog("Loaded " + possibleType.pluginFormatName + " " + possibleType.version);
-                                break;
-                            }
+                if (newPlugin == nullptr) {
+                    auto loadPlugin = [&instantiator](const juce::PluginDescription& description, const HostConfiguration& config) {
+                        return instantiator.loadPlugin(description, config);
+                    };
 
-                            errorMessage += " - " + newErrorMessage;
-                        }
-                    }
-
-                    return std::make_tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String>(
-                        std::move(thisPlugin), juce::String(errorMessage));
-                };
-
-                auto newPlugin = XmlReader::restoreChainSlotPlugin(
-                    thisPluginElement, getModulationValueCallback, configuration, pluginConfigurator, loadPlugin, onErrorCallback);
+                    newPlugin = XmlReader::restoreChainSlotPlugin(
+                        thisPluginElement, getModulationValueCallback, configuration, pluginConfigurator, loadPlugin, onErrorCallback, isMonoChain, sessionReader);
+                }
 
                 if (newPlugin != nullptr) {
                     newPlugin->plugin->addListener(&retVal->latencyListener);
@@ -283,6 +365,8 @@ namespace XmlReader {
             }
         }
 
+        retVal->renderPlan.compile(retVal->chain);
+        retVal->pipeline->compile(retVal->renderPlan);
         retVal->latencyListener.onPluginChainUpdate();
 
         return retVal;
@@ -341,15 +425,12 @@ namespace XmlReader {
             HostConfiguration configuration,
             const PluginConfigurator& pluginConfigurator,
             LoadPluginFunction loadPlugin,
-            std::function<void(juce::String)> onErrorCallback) {
+            std::function<void(juce::String)> onErrorCallback,
+            bool isMonoChain,
+            const SessionFormat::Reader* sessionReader) {
 
         // Restore the plugin level bypass
-        bool isPluginBypassed {false};
-        if (element->hasAttribute(XML_SLOT_IS_BYPASSED_STR)) {
-            isPluginBypassed = element->getBoolAttribute(XML_SLOT_IS_BYPASSED_STR);
-        } else {
-            juce::Logger::writeToLog("Missing attribute " + juce::String(XML_SLOT_IS_BYPASSED_STR));
-        }
+        const bool isPluginBypassed {restoreSlotIsBypassed(element)};
 
         if (element->getNumChildElements() == 0) {
             juce::Logger::writeToLog("Plugin element missing description");
@@ -377,51 +458,58 @@ namespace XmlReader {
 
         std::shared_ptr<juce::AudioPluginInstance> sharedPlugin = std::move(thisPlugin);
 
-        if (pluginConfigurator.configure(sharedPlugin, configuration)) {
+        // A placeholder reports the latency of the plugin it stands in for
+        if (auto placeholder = std::dynamic_pointer_cast<PlaceholderPluginInstance>(sharedPlugin)) {
+            if (element->hasAttribute(XML_PLUGIN_LATENCY_STR)) {
+                placeholder->setExpectedLatency(element->getIntAttribute(XML_PLUGIN_LATENCY_STR));
+            } else {
+                juce::Logger::writeToLog("Missing attribute " + juce::String(XML_PLUGIN_LATENCY_STR));
+            }
+        }
+
+        if (pluginConfigurator.configure(sharedPlugin, configuration, isMonoChain)) {
             retVal.reset(new ChainSlotPlugin(sharedPlugin, isPluginBypassed, getModulationValueCallback, configuration));
+            restorePluginSlotSettings(element, *retVal, sessionReader);
+        } else {
+            juce::Logger::writeToLog("Failed to configure plugin: " + sharedPlugin->getPluginDescription().name);
+            onErrorCallback("Failed to restore " + sharedPlugin->getPluginDescription().name + " as it may be a mono only plugin being restored into a stereo instance of Syndicate or vice versa");
+        }
 
-            // Restore the editor bounds
-            if (element->hasAttribute(XML_PLUGIN_EDITOR_BOUNDS_STR)) {
-                const juce::String boundsString = element->getStringAttribute(XML_PLUGIN_EDITOR_BOUNDS_STR);
+        return retVal;
+    }
 
-                if (element->hasAttribute(XML_DISPLAY_AREA_STR)) {
-                    const juce::String displayString = element->getStringAttribute(XML_DISPLAY_AREA_STR);
+    std::unique_ptr<ChainSlotPlugin> restoreReusedChainSlotPlugin(
+            juce::XmlElement* element,
+            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+            HostConfiguration configuration,
+            const PluginConfigurator& pluginConfigurator,
+            PluginInstantiator& instantiator,
+            bool isMonoChain,
+            const SessionFormat::Reader* sessionReader) {
 
-                    retVal->editorBounds.reset(new PluginEditorBounds());
-                    *(retVal->editorBounds.get()) =  PluginEditorBoundsContainer(
-                        juce::Rectangle<int>::fromString(boundsString),
-                        juce::Rectangle<int>::fromString(displayString)
-                    );
-                } else {
-                    juce::Logger::writeToLog("Missing attribute " + juce::String(XML_DISPLAY_AREA_STR));
-                }
+        // Anything wrong with the element is reported when the plugin is loaded instead
+        juce::PluginDescription pluginDescription;
+        if (element->getNumChildElements() == 0 || !pluginDescription.loadFromXml(*element->getChildElement(0))) {
+            return nullptr;
+        }
 
-            } else {
-                juce::Logger::writeToLog("Missing attribute " + juce::String(XML_PLUGIN_EDITOR_BOUNDS_STR));
-            }
+        // The running plugin keeps the layout it was configured with, so it can only be used if
+        // this chain wants the same one
+        std::shared_ptr<PlaceholderPluginInstance> standIn = instantiator.takeReusablePlugin(
+            pluginDescription,
+            [&](std::shared_ptr<juce::AudioPluginInstance> plugin) {
+                return !pluginConfigurator.needsReconfiguring(plugin, configuration, isMonoChain);
+            });
 
-            // Restore the plugin's internal state
-            if (element->hasAttribute(XML_PLUGIN_DATA_STR)) {
-                const juce::String pluginDataString = element->getStringAttribute(XML_PLUGIN_DATA_STR);
-                juce::MemoryBlock pluginData;
-                pluginData.fromBase64Encoding(pluginDataString);
+        if (standIn == nullptr) {
+            return nullptr;
+        }
 
-                sharedPlugin->setStateInformation(pluginData.getData(), pluginData.getSize());
+        juce::Logger::writeToLog("Reusing plugin " + pluginDescription.name);
 
-                // Now that the plugin is restored, we can restore the modulation config
-                juce::XmlElement* modulationConfigElement = element->getChildByName(XML_MODULATION_CONFIG_STR);
-                if (modulationConfigElement != nullptr) {
-                    retVal->modulationConfig = restorePluginModulationConfig(modulationConfigElement);
-                } else {
-                    juce::Logger::writeToLog("Missing element " + juce::String(XML_MODULATION_CONFIG_STR));
-                }
-            } else {
-                juce::Logger::writeToLog("Missing attribute " + juce::String(XML_PLUGIN_DATA_STR));
-            }
-        } else {
-            juce::Logger::writeToLog("Failed to configure plugin: " + sharedPlugin->getPluginDescription().name);
-            onErrorCallback("Failed to restore " + sharedPlugin->getPluginDescription().name + " as it may be a mono only plugin being restored into a stereo instance of Syndicate or vice versa");
-        }
+        auto retVal = std::make_unique<ChainSlotPlugin>(
+            standIn, restoreSlotIsBypassed(element), getModulationValueCallback, configuration);
+        restorePluginSlotSettings(element, *retVal, sessionReader);
 
         return retVal;
     }
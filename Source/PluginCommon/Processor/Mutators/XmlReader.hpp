@@ -5,6 +5,8 @@
 #include "PluginChain.hpp"
 #include "PluginSplitter.hpp"
 #include "DataModelInterface.hpp"
+#include "PluginInstantiator.hpp"
+#include "SessionFormat.hpp"
 
 // TODO lock on entry so UI can't make changes
 
@@ -18,13 +20,41 @@ namespace XmlReader {
         juce::Array<juce::PluginDescription> availableTypes,
         std::function<void(juce::String)> onErrorCallback);
 
+    /**
+     * Restores in three phases: the plugin descriptions are read from the whole document, the
+     * plugins are created by the instantiator, then the chains are assembled using them.
+     *
+     * sessionReader provides the plugin states if the document was read from the binary session
+     * format.
+     */
+    std::shared_ptr<PluginSplitter> restoreSplitterFromXml(
+        juce::XmlElement* element,
+        std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+        std::function<void(int)> latencyChangeCallback,
+        HostConfiguration configuration,
+        const PluginConfigurator& pluginConfigurator,
+        PluginInstantiator& instantiator,
+        std::function<void(juce::String)> onErrorCallback,
+        const SessionFormat::Reader* sessionReader = nullptr);
+
     std::unique_ptr<PluginChain> restoreChainFromXml(
         juce::XmlElement* element,
         HostConfiguration configuration,
         const PluginConfigurator& pluginConfigurator,
         std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
         juce::Array<juce::PluginDescription> availableTypes,
-        std::function<void(juce::String)> onErrorCallback);
+        std::function<void(juce::String)> onErrorCallback,
+        bool isMonoChain = false);
+
+    std::unique_ptr<PluginChain> restoreChainFromXml(
+        juce::XmlElement* element,
+        HostConfiguration configuration,
+        const PluginConfigurator& pluginConfigurator,
+        std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+        PluginInstantiator& instantiator,
+        std::function<void(juce::String)> onErrorCallback,
+        bool isMonoChain = false,
+        const SessionFormat::Reader* sessionReader = nullptr);
 
     bool XmlElementIsPlugin(juce::XmlElement* element);
     bool XmlElementIsGainStage(juce::XmlElement* element);
@@ -42,7 +72,25 @@ namespace XmlReader {
             HostConfiguration configuration,
             const PluginConfigurator& pluginConfigurator,
             LoadPluginFunction loadPlugin,
-            std::function<void(juce::String)> onErrorCallback);
+            std::function<void(juce::String)> onErrorCallback,
+            bool isMonoChain = false,
+            const SessionFormat::Reader* sessionReader = nullptr);
+
+    /**
+     * Restores the slot for a running plugin from the instantiator, if it has one that matches and
+     * doesn't need reconfiguring. The slot holds the instantiator's stand-in until the plugin is
+     * swapped in, so only the plugin's state has to be restored rather than creating it again.
+     * Returns nullptr if there isn't a plugin that can be reused.
+     */
+    std::unique_ptr<ChainSlotPlugin> restoreReusedChainSlotPlugin(
+            juce::XmlElement* element,
+            std::function<float(int, MODULATION_TYPE)> getModulationValueCallback,
+            HostConfiguration configuration,
+            const PluginConfigurator& pluginConfigurator,
+            PluginInstantiator& instantiator,
+            bool isMonoChain = false,
+            const SessionFormat::Reader* sessionReader = nullptr);
+
     std::unique_ptr<PluginModulationConfig> restorePluginModulationConfig(juce::XmlElement* element);
     std::unique_ptr<PluginParameterModulationConfig> restorePluginParameterModulationConfig(juce::XmlElement* element);
     std::unique_ptr<PluginParameterModulationSource> restorePluginParameterModulationSource(juce::XmlElement* element);
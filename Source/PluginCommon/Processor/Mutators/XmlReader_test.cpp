@@ -592,6 +592,133 @@ SCENARIO("XmlReader: Can restore ChainSlotPlugin") {
     }
 }
 
+SCENARIO("XmlReader: Can restore ChainSlotPlugin from a session") {
+    GIVEN("A ChainSlotPlugin written to a session") {
+        HostConfiguration config {TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo()), SAMPLE_RATE, NUM_SAMPLES};
+        auto modulationCallback = [](int, MODULATION_TYPE) { return 0.0f; };
+
+        auto writtenSlot = std::make_shared<ChainSlotPlugin>(
+            std::make_shared<XMLTestPluginInstance>(), false, modulationCallback, config);
+
+        const bool shouldCompress = GENERATE(false, true);
+
+        juce::MemoryBlock sessionData;
+        {
+            juce::MemoryOutputStream stream(sessionData, false);
+            SessionFormat::Writer writer(stream, shouldCompress);
+
+            juce::XmlElement document("test");
+            XmlWriter::write(writtenSlot, &document, &writer);
+
+            THEN("The plugin state is kept out of the document") {
+                CHECK_FALSE(document.hasAttribute(XML_PLUGIN_DATA_STR));
+                CHECK(document.getIntAttribute(XML_PLUGIN_DATA_CHUNK_STR, -1) == 0);
+            }
+
+            writer.writeDocument(document);
+        }
+
+        SessionFormat::Reader reader;
+        juce::MemoryInputStream stream(sessionData, false);
+        REQUIRE(reader.read(stream));
+        std::unique_ptr<juce::XmlElement> document = reader.takeDocument();
+
+        auto loadPlugin = [](const juce::PluginDescription& description, const HostConfiguration&) {
+            return std::make_tuple<std::unique_ptr<juce::AudioPluginInstance>, juce::String>(
+                std::make_unique<XMLTestPluginInstance>(description), ""
+            );
+        };
+
+        WHEN("Asked to restore a ChainSlotPlugin from it with the session") {
+            auto slot = XmlReader::restoreChainSlotPlugin(
+                document.get(), modulationCallback, config, PluginConfigurator(), loadPlugin, [](juce::String) {}, false, &reader);
+
+            THEN("The plugin state is restored from the session") {
+                REQUIRE(slot != nullptr);
+
+                auto plugin = dynamic_cast<XMLTestPluginInstance*>(slot->plugin.get());
+                REQUIRE(plugin != nullptr);
+                CHECK(plugin->retrievedData == "testPluginData");
+            }
+        }
+
+        WHEN("Asked to restore a ChainSlotPlugin from it without the session") {
+            auto slot = XmlReader::restoreChainSlotPlugin(
+                document.get(), modulationCallback, config, PluginConfigurator(), loadPlugin, [](juce::String) {});
+
+            THEN("The plugin is restored without its state") {
+                REQUIRE(slot != nullptr);
+
+                auto plugin = dynamic_cast<XMLTestPluginInstance*>(slot->plugin.get());
+                REQUIRE(plugin != nullptr);
+                CHECK(plugin->retrievedData.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("XmlReader: Placeholders stand in for plugins restored in the background") {
+    GIVEN("An XmlElement for a plugin with saved state and latency") {
+        juce::XmlElement e("test");
+        e.setAttribute(XML_SLOT_IS_BYPASSED_STR, true);
+        e.setAttribute(XML_PLUGIN_LATENCY_STR, 64);
+
+        const std::string testData("testPluginData");
+        juce::MemoryBlock pluginData(testData.c_str(), testData.size());
+        e.setAttribute(XML_PLUGIN_DATA_STR, pluginData.toBase64Encoding());
+
+        juce::PluginDescription description;
+        description.name = "testPlugin";
+        description.manufacturerName = "testManufacturer";
+        e.addChildElement(description.createXml().release());
+
+        WHEN("Asked to restore a ChainSlotPlugin from it using placeholders") {
+            PluginInstantiator instantiator({}, [](const juce::PluginDescription&, const HostConfiguration&, juce::String& errorMessage) {
+                errorMessage = "Shouldn't create plugins";
+                return std::unique_ptr<juce::AudioPluginInstance>();
+            });
+            instantiator.setCreatePlaceholders(true);
+
+            auto slot = XmlReader::restoreChainSlotPlugin(
+                &e,
+                [](int, MODULATION_TYPE) { return 0.0f; },
+                HostConfiguration{TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo()), 44100, 64},
+                PluginConfigurator(),
+                [&instantiator](const juce::PluginDescription& description, const HostConfiguration& config) {
+                    return instantiator.loadPlugin(description, config);
+                },
+                [](juce::String errorMsg) { FAIL("Unexpected error: " << errorMsg); });
+
+            THEN("The slot holds a placeholder with the plugin's latency, state and description") {
+                REQUIRE(slot != nullptr);
+                CHECK(slot->isBypassed);
+
+                auto placeholder = std::dynamic_pointer_cast<PlaceholderPluginInstance>(slot->plugin);
+                REQUIRE(placeholder != nullptr);
+                CHECK(placeholder->getLatencySamples() == 64);
+                CHECK(placeholder->getSavedState() == pluginData);
+                CHECK(placeholder->getPluginDescription().name == "testPlugin");
+                CHECK(placeholder->getPluginDescription().manufacturerName == "testManufacturer");
+            }
+
+            AND_WHEN("The slot is written back to XML") {
+                juce::XmlElement written("written");
+                XmlWriter::write(std::shared_ptr<ChainSlotPlugin>(std::move(slot)), &written);
+
+                THEN("Nothing about the plugin has been lost") {
+                    CHECK(written.getIntAttribute(XML_PLUGIN_LATENCY_STR) == 64);
+                    CHECK(written.getStringAttribute(XML_PLUGIN_DATA_STR) == pluginData.toBase64Encoding());
+
+                    juce::PluginDescription writtenDescription;
+                    REQUIRE(written.getNumChildElements() > 0);
+                    REQUIRE(writtenDescription.loadFromXml(*written.getChildElement(0)));
+                    CHECK(writtenDescription.name == "testPlugin");
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("XmlReader: Can restore PluginModulationConfig") {
     GIVEN("An XmlElement that has no attributes") {
         juce::XmlElement e("test");
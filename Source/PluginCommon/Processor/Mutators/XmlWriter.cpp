@@ -5,7 +5,7 @@
 #include "ModulationMutators.hpp"
 
 namespace XmlWriter {
-    void write(std::shared_ptr<PluginSplitter> splitter, juce::XmlElement* element) {
+    void write(std::shared_ptr<PluginSplitter> splitter, juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
         juce::Logger::writeToLog("Storing splitter state");
 
         const char* splitTypeString = XML_SPLIT_TYPE_SERIES_STR;
@@ -32,7 +32,7 @@ namespace XmlWriter {
             PluginChainWrapper& thisChain = splitter->chains[chainNumber];
 
             thisChainElement->setAttribute(XML_IS_CHAIN_SOLOED_STR, thisChain.isSoloed);
-            XmlWriter::write(thisChain.chain, thisChainElement);
+            XmlWriter::write(thisChain.chain, thisChainElement, sessionWriter);
         }
 
         if (auto multibandSplitter = std::dynamic_pointer_cast<PluginSplitterMultiband>(splitter)) {
@@ -44,7 +44,7 @@ namespace XmlWriter {
         }
     }
 
-    void write(std::shared_ptr<PluginChain> chain, juce::XmlElement* element) {
+    void write(std::shared_ptr<PluginChain> chain, juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
         // Store chain level bypass, mute, and name
         element->setAttribute(XML_IS_CHAIN_BYPASSED_STR, chain->isChainBypassed);
         element->setAttribute(XML_IS_CHAIN_MUTED_STR, chain->isChainMuted);
@@ -60,7 +60,7 @@ namespace XmlWriter {
             if (auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(chain->chain[pluginNumber])) {
                 XmlWriter::write(gainStage, thisPluginElement);
             } else if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(chain->chain[pluginNumber])) {
-                XmlWriter::write(pluginSlot, thisPluginElement);
+                XmlWriter::write(pluginSlot, thisPluginElement, sessionWriter);
             }
         }
     }
@@ -73,7 +73,7 @@ namespace XmlWriter {
         element->setAttribute(XML_GAIN_STAGE_PAN_STR, gainStage->pan);
     }
 
-    void write(std::shared_ptr<ChainSlotPlugin> chainSlot, juce::XmlElement* element) {
+    void write(std::shared_ptr<ChainSlotPlugin> chainSlot, juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
         element->setAttribute(XML_SLOT_TYPE_STR, XML_SLOT_TYPE_PLUGIN_STR);
 
         // Store the plugin level bypass
@@ -87,7 +87,16 @@ namespace XmlWriter {
         // Store the plugin's internal state
         juce::MemoryBlock pluginMemoryBlock;
         chainSlot->plugin->getStateInformation(pluginMemoryBlock);
-        element->setAttribute(XML_PLUGIN_DATA_STR, pluginMemoryBlock.toBase64Encoding());
+
+        const int chunkIndex {sessionWriter != nullptr ? sessionWriter->writePluginState(pluginMemoryBlock) : -1};
+        if (chunkIndex >= 0) {
+            element->setAttribute(XML_PLUGIN_DATA_CHUNK_STR, chunkIndex);
+        } else {
+            element->setAttribute(XML_PLUGIN_DATA_STR, pluginMemoryBlock.toBase64Encoding());
+        }
+
+        // Store the latency so a placeholder can report it while the plugin is loaded on restore
+        element->setAttribute(XML_PLUGIN_LATENCY_STR, chainSlot->plugin->getLatencySamples());
 
         // Store the modulation config
         juce::XmlElement* modulationConfigElement = element->createNewChildElement(XML_MODULATION_CONFIG_STR);
@@ -5,17 +5,28 @@
 #include "PluginChain.hpp"
 #include "PluginSplitter.hpp"
 #include "DataModelInterface.hpp"
+#include "SessionFormat.hpp"
 
 // TODO lock on entry so UI can't make changes
 
 namespace XmlWriter {
-    void write(std::shared_ptr<PluginSplitter> splitter, juce::XmlElement* element);
+    /**
+     * If sessionWriter is given, plugin states are written to it and the slots refer to them by
+     * index rather than holding them in the document.
+     */
+    void write(std::shared_ptr<PluginSplitter> splitter,
+               juce::XmlElement* element,
+               SessionFormat::Writer* sessionWriter = nullptr);
 
-    void write(std::shared_ptr<PluginChain> chain, juce::XmlElement* element);
+    void write(std::shared_ptr<PluginChain> chain,
+               juce::XmlElement* element,
+               SessionFormat::Writer* sessionWriter = nullptr);
 
     void write(std::shared_ptr<ChainSlotGainStage> gainStage, juce::XmlElement* element);
 
-    void write(std::shared_ptr<ChainSlotPlugin> chainSlot, juce::XmlElement* element);
+    void write(std::shared_ptr<ChainSlotPlugin> chainSlot,
+               juce::XmlElement* element,
+               SessionFormat::Writer* sessionWriter = nullptr);
     void write(std::shared_ptr<PluginModulationConfig> config, juce::XmlElement* element);
     void write(std::shared_ptr<PluginParameterModulationConfig> config, juce::XmlElement* element);
     void write(std::shared_ptr<PluginParameterModulationSource> source, juce::XmlElement* element);
@@ -1,60 +1,343 @@
 #include "ChainProcessors.hpp"
 
 #include "ChainSlotProcessors.hpp"
+#include "ChainWorkerPool.hpp"
+#include "ModulationProcessors.hpp"
+
+namespace {
+    constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    // How quickly the measured cost of a plugin follows changes, between 0 and 1
+    constexpr float PROCESSING_COST_SMOOTHING {0.1f};
+
+    bool isModulationActive(const ChainSlotPlugin& slot) {
+        return !slot.isBypassed && slot.modulationConfig->isActive && !slot.modulationMatrix.parameters.empty();
+    }
+
+    bool hasActiveModulation(const PluginChain& chain, int opStart, int opEnd) {
+        for (int opIndex {opStart}; opIndex < opEnd; opIndex++) {
+            const RenderOp& op = chain.renderPlan.ops[opIndex];
+            if (op.type == RENDER_OP_TYPE::PLUGIN && isModulationActive(*static_cast<ChainSlotPlugin*>(op.slot))) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool areAllPluginsSleeping(const PluginChain& chain) {
+        bool hasPlugins {false};
+
+        for (const RenderOp& op : chain.renderPlan.ops) {
+            if (op.type == RENDER_OP_TYPE::PLUGIN) {
+                if (!ChainProcessors::isSleeping(*static_cast<ChainSlotPlugin*>(op.slot))) {
+                    return false;
+                }
+
+                hasPlugins = true;
+            }
+        }
+
+        return hasPlugins;
+    }
+
+    /**
+     * Calculates the modulation for every plugin in the range of ops at the current read position.
+     * Returns true if any parameter would change.
+     */
+    bool updateModulation(PluginChain& chain, int opStart, int opEnd) {
+        bool hasChanged {false};
+
+        for (int opIndex {opStart}; opIndex < opEnd; opIndex++) {
+            const RenderOp& op = chain.renderPlan.ops[opIndex];
+            if (op.type == RENDER_OP_TYPE::PLUGIN) {
+                ChainSlotPlugin& slot = *static_cast<ChainSlotPlugin*>(op.slot);
+
+                // Don't short circuit, every plugin needs its values updated
+                if (isModulationActive(slot) && ChainProcessors::updateModulation(slot)) {
+                    hasChanged = true;
+                }
+            }
+        }
+
+        return hasChanged;
+    }
+
+    void applyModulation(PluginChain& chain, int opStart, int opEnd) {
+        for (int opIndex {opStart}; opIndex < opEnd; opIndex++) {
+            const RenderOp& op = chain.renderPlan.ops[opIndex];
+            if (op.type == RENDER_OP_TYPE::PLUGIN) {
+                ChainSlotPlugin& slot = *static_cast<ChainSlotPlugin*>(op.slot);
+
+                if (isModulationActive(slot)) {
+                    ChainProcessors::applyModulation(slot);
+                }
+            }
+        }
+    }
+
+    /**
+     * Updates the measured cost of the plugin from the time it took to process numSamples.
+     */
+    void updateProcessingCost(ChainSlotPlugin& slot, juce::int64 startTicks, juce::int64 endTicks, int numSamples) {
+        if (numSamples > 0) {
+            const float cost {static_cast<float>(juce::Time::highResolutionTicksToSeconds(endTicks - startTicks) / numSamples)};
+            const float previousCost {slot.processingCost.load(std::memory_order_relaxed)};
+            const float newCost {previousCost > 0 ? previousCost + (cost - previousCost) * PROCESSING_COST_SMOOTHING : cost};
+            slot.processingCost.store(newCost, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Processes the ops from opStart to opEnd in slices of (at least) modulationControlRate
+     * samples, updating the modulation of their plugins before each one. sliceMidi and outputMidi
+     * are used to split up the MIDI, so must not be in use by anything else processing at the same
+     * time. Measures the cost of each plugin if shouldMeasure is true.
+     *
+     * While the modulation isn't changing slices are merged, so an idle modulation source doesn't
+     * cost any more plugin calls than modulating once per block.
+     */
+    void processBlockInSlices(PluginChain& chain,
+                              int opStart,
+                              int opEnd,
+                              juce::AudioBuffer<float>& buffer,
+                              juce::MidiBuffer& midiMessages,
+                              juce::AudioPlayHead* newPlayHead,
+                              int modulationControlRate,
+                              juce::AudioBuffer<float>* spareBuffer,
+                              juce::MidiBuffer& sliceMidi,
+                              juce::MidiBuffer& outputMidi,
+                              bool shouldMeasure,
+                              bool isSleepingEnabled) {
+        const int numSamples {buffer.getNumSamples()};
+        outputMidi.clear();
+
+        int sliceStart {0};
+        while (sliceStart < numSamples) {
+            // Each slice uses the modulation values from its last sample, so that a single slice
+            // covering the whole block gets the same values as modulating once per block
+            int sliceEnd {std::min(sliceStart + modulationControlRate, numSamples)};
+            ModulationProcessors::setModulationReadPosition(sliceEnd - 1);
+
+            if (updateModulation(chain, opStart, opEnd)) {
+                applyModulation(chain, opStart, opEnd);
+            } else {
+                // Nothing has changed, extend this slice until something does
+                while (sliceEnd < numSamples) {
+                    const int nextSliceEnd {std::min(sliceEnd + modulationControlRate, numSamples)};
+                    ModulationProcessors::setModulationReadPosition(nextSliceEnd - 1);
+
+                    if (updateModulation(chain, opStart, opEnd)) {
+                        break;
+                    }
+
+                    sliceEnd = nextSliceEnd;
+                }
+            }
+
+            // Refers to the original buffer, doesn't copy or allocate
+            juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), sliceStart, sliceEnd - sliceStart);
+
+            sliceMidi.clear();
+            sliceMidi.addEvents(midiMessages, sliceStart, sliceEnd - sliceStart, -sliceStart);
+
+            for (int opIndex {opStart}; opIndex < opEnd; opIndex++) {
+                const RenderOp& op = chain.renderPlan.ops[opIndex];
+
+                switch (op.type) {
+                    case RENDER_OP_TYPE::GAIN_STAGE:
+                        ChainProcessors::processBlock(*static_cast<ChainSlotGainStage*>(op.slot), slice);
+                        break;
+                    case RENDER_OP_TYPE::PLUGIN: {
+                        ChainSlotPlugin& slot = *static_cast<ChainSlotPlugin*>(op.slot);
+                        const juce::int64 startTicks {shouldMeasure ? juce::Time::getHighResolutionTicks() : 0};
+                        ChainProcessors::processBlockWithoutModulation(slot, slice, sliceMidi, newPlayHead, spareBuffer, isSleepingEnabled);
+
+                        if (shouldMeasure) {
+                            updateProcessingCost(slot, startTicks, juce::Time::getHighResolutionTicks(), slice.getNumSamples());
+                        }
+                        break;
+                    }
+                }
+            }
+
+            outputMidi.addEvents(sliceMidi, 0, -1, sliceStart);
+            sliceStart = sliceEnd;
+        }
+
+        ModulationProcessors::setModulationReadPosition(-1);
+
+        // Copy rather than swap, so each buffer keeps the storage that was reserved for it
+        midiMessages.clear();
+        midiMessages.addEvents(outputMidi, 0, -1, 0);
+    }
+
+    /**
+     * Processes the plugin and updates its measured cost.
+     */
+    void processBlockMeasured(ChainSlotPlugin& slot,
+                              juce::AudioBuffer<float>& buffer,
+                              juce::MidiBuffer& midiMessages,
+                              juce::AudioPlayHead* newPlayHead,
+                              juce::AudioBuffer<float>* spareBuffer,
+                              bool isSleepingEnabled) {
+        const juce::int64 startTicks {juce::Time::getHighResolutionTicks()};
+        ChainProcessors::processBlock(slot, buffer, midiMessages, newPlayHead, spareBuffer, isSleepingEnabled);
+        updateProcessingCost(slot, startTicks, juce::Time::getHighResolutionTicks(), buffer.getNumSamples());
+    }
+
+    /**
+     * Gives this block to the first stage of the pipeline, processes every stage on the audio in
+     * flight, and replaces the block with what comes out of the last stage.
+     */
+    void processBlockPipelined(PluginChain& chain,
+                               juce::AudioBuffer<float>& buffer,
+                               juce::MidiBuffer& midiMessages,
+                               juce::AudioPlayHead* newPlayHead,
+                               int modulationControlRate,
+                               ScratchArena* scratchArena,
+                               ChainWorkerPool* workerPool,
+                               bool isSleepingEnabled) {
+        ChainPipeline& pipeline = *chain.pipeline;
+
+        // Stages without anything in flight are skipped while the pipeline fills back up
+        const int numStages {pipeline.getNumStagesToProcess()};
+
+        pipeline.pushInput(buffer, midiMessages);
+
+        const bool useWorkerPool {
+            workerPool != nullptr
+            && workerPool->canRun(numStages, buffer.getNumChannels(), buffer.getNumSamples())
+        };
+
+        if (useWorkerPool) {
+            for (int stageIndex {0}; stageIndex < numStages; stageIndex++) {
+                workerPool->setStageTask(stageIndex, chain, stageIndex, pipeline.getStageBuffer(stageIndex), pipeline.getStageMidi(stageIndex), newPlayHead, modulationControlRate, scratchArena, isSleepingEnabled);
+            }
+
+            workerPool->run(numStages);
+
+            // Each stage processed a copy of its MIDI
+            for (int stageIndex {0}; stageIndex < numStages; stageIndex++) {
+                juce::MidiBuffer& stageMidi = pipeline.getStageMidi(stageIndex);
+                stageMidi.clear();
+                stageMidi.addEvents(workerPool->getMidiOutput(stageIndex), 0, -1, 0);
+            }
+        } else {
+            for (int stageIndex {0}; stageIndex < numStages; stageIndex++) {
+                ChainProcessors::processStage(chain, stageIndex, pipeline.getStageBuffer(stageIndex), pipeline.getStageMidi(stageIndex), newPlayHead, modulationControlRate, scratchArena, isSleepingEnabled);
+            }
+        }
+
+        pipeline.popOutput(buffer, midiMessages);
+    }
+
+    /**
+     * Processes the blocks in flight through the rest of the stages, oldest first, before a block
+     * is processed without pipelining. Their output becomes the start of the pipeline's pending
+     * output. Returns the number of blocks that were flushed, their MIDI is left in the stage MIDI
+     * buffers.
+     */
+    int flushPipeline(PluginChain& chain,
+                      juce::AudioPlayHead* newPlayHead,
+                      int modulationControlRate,
+                      ScratchArena* scratchArena,
+                      bool isSleepingEnabled) {
+        ChainPipeline& pipeline = *chain.pipeline;
+        const int numBuffersInFlight {pipeline.getNumBuffersInFlight()};
+
+        for (int bufferStageIndex {numBuffersInFlight}; bufferStageIndex > 0; bufferStageIndex--) {
+            juce::AudioBuffer<float>& stageBuffer = pipeline.getStageBuffer(bufferStageIndex);
+            juce::MidiBuffer& stageMidi = pipeline.getStageMidi(bufferStageIndex);
+
+            for (int stageIndex {bufferStageIndex}; stageIndex < pipeline.getNumStages(); stageIndex++) {
+                ChainProcessors::processStage(chain, stageIndex, stageBuffer, stageMidi, newPlayHead, modulationControlRate, scratchArena, isSleepingEnabled);
+            }
+
+            pipeline.pushFlushedBlock(stageBuffer);
+        }
+
+        pipeline.finishFlush();
+
+        return numBuffersInFlight;
+    }
+}
 
 namespace ChainProcessors {
-    void prepareToPlay(PluginChain& chain, HostConfiguration config) {
-        chain.latencyCompLine->prepare({
-            config.sampleRate,
-            static_cast<juce::uint32>(config.blockSize),
-            static_cast<juce::uint32>(getTotalNumInputChannels(config.layout))
-        });
+    void prepareToPlay(PluginChain& chain, HostConfiguration config, int maxPipelineStages) {
+        chain.latencyCompLine->prepare(getTotalNumInputChannels(config.layout), config.blockSize, config.maxLatencyCompensationSamples);
 
-        for (std::shared_ptr<ChainSlotBase> slot : chain.chain) {
-            if (auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(slot)) {
-                ChainProcessors::prepareToPlay(*gainStage.get(), config);
-            } else if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
-                ChainProcessors::prepareToPlay(*pluginSlot.get(), config);
+        chain.sliceMidiBuffer.ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+        chain.outputMidiBuffer.ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+
+        for (const RenderOp& op : chain.renderPlan.ops) {
+            switch (op.type) {
+                case RENDER_OP_TYPE::GAIN_STAGE:
+                    ChainProcessors::prepareToPlay(*static_cast<ChainSlotGainStage*>(op.slot), config);
+                    break;
+                case RENDER_OP_TYPE::PLUGIN:
+                    ChainProcessors::prepareToPlay(*static_cast<ChainSlotPlugin*>(op.slot), config);
+                    break;
             }
         }
+
+        // The block size may have changed, so the pipeline's latency may have too
+        const int previousPipelineLatency {chain.pipeline->getLatencySamples()};
+        chain.pipeline->prepare(getTotalNumInputChannels(config.layout), config.blockSize, maxPipelineStages);
+        chain.pipeline->compile(chain.renderPlan);
+
+        if (chain.pipeline->getLatencySamples() != previousPipelineLatency) {
+            chain.latencyListener.onPluginChainUpdate();
+        }
     }
 
     void releaseResources(PluginChain& chain) {
-        for (std::shared_ptr<ChainSlotBase> slot : chain.chain) {
-            if (auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(slot)) {
-                ChainProcessors::releaseResources(*gainStage.get());
-            } else if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
-                ChainProcessors::releaseResources(*pluginSlot.get());
+        for (const RenderOp& op : chain.renderPlan.ops) {
+            switch (op.type) {
+                case RENDER_OP_TYPE::GAIN_STAGE:
+                    ChainProcessors::releaseResources(*static_cast<ChainSlotGainStage*>(op.slot));
+                    break;
+                case RENDER_OP_TYPE::PLUGIN:
+                    ChainProcessors::releaseResources(*static_cast<ChainSlotPlugin*>(op.slot));
+                    break;
             }
         }
     }
 
     void reset(PluginChain& chain) {
-        for (std::shared_ptr<ChainSlotBase> slot : chain.chain) {
-            if (auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(slot)) {
-                ChainProcessors::reset(*gainStage.get());
-            } else if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
-                ChainProcessors::reset(*pluginSlot.get());
+        for (const RenderOp& op : chain.renderPlan.ops) {
+            switch (op.type) {
+                case RENDER_OP_TYPE::GAIN_STAGE:
+                    ChainProcessors::reset(*static_cast<ChainSlotGainStage*>(op.slot));
+                    break;
+                case RENDER_OP_TYPE::PLUGIN:
+                    ChainProcessors::reset(*static_cast<ChainSlotPlugin*>(op.slot));
+                    break;
             }
         }
+
+        chain.pipeline->reset();
     }
 
     void processBlock(PluginChain& chain,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead) {
-        // Add the latency compensation
-        juce::dsp::AudioBlock<float> bufferBlock(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(bufferBlock);
+                      juce::AudioPlayHead* newPlayHead,
+                      int modulationControlRate,
+                      ScratchArena* scratchArena,
+                      ChainWorkerPool* workerPool,
+                      bool isSleepingEnabled) {
+        // Add the latency compensation. This is always done, even while the chain is asleep, so the
+        // delay line has the right history when it wakes up.
+        chain.latencyCompLine->process(buffer);
 
-        {
-            WECore::AudioSpinTryLock lock(chain.latencyCompLineMutex);
-            if (lock.isLocked()) {
-                chain.latencyCompLine->process(context);
-            }
+        // Mute gets priority over bypass
+        if (chain.isChainMuted || chain.isChainBypassed) {
+            // Whatever was in flight was from before the chain stopped being processed, so drop it
+            // rather than output it when the chain is processed again
+            chain.pipeline->discard();
         }
 
-        // Mute gets priority over bypass
         if (chain.isChainMuted) {
             // Muted - return empty buffers (including sidechains since we don't need them)
             for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
@@ -62,14 +345,186 @@ namespace ChainProcessors {
             }
         } else if (chain.isChainBypassed) {
             // Bypassed - do nothing
+        } else if (chain.pipeline->canProcess(buffer)) {
+            // Each stage borrows its own spare buffer as they may be processed at the same time
+            processBlockPipelined(chain, buffer, midiMessages, newPlayHead, modulationControlRate, scratchArena, workerPool, isSleepingEnabled);
         } else {
-            // Chain is active - process as normal
-            for (std::shared_ptr<ChainSlotBase> slot : chain.chain) {
-                if (auto gainStage = std::dynamic_pointer_cast<ChainSlotGainStage>(slot)) {
-                    ChainProcessors::processBlock(*gainStage.get(), buffer);
-                } else if (auto pluginSlot = std::dynamic_pointer_cast<ChainSlotPlugin>(slot)) {
-                    ChainProcessors::processBlock(*pluginSlot.get(), buffer, midiMessages, newPlayHead);
+            // A pipelined chain has to finish the blocks in flight first so the plugins in the later
+            // stages see the audio in order
+            const bool isPipelined {chain.pipeline->getNumStages() > 1};
+            const int numFlushedBlocks {isPipelined ? flushPipeline(chain, newPlayHead, modulationControlRate, scratchArena, isSleepingEnabled) : 0};
+
+            // One spare buffer is shared by all the plugins in the chain as they're processed one
+            // at a time
+            juce::AudioBuffer<float> spareBuffer;
+            if (scratchArena != nullptr && !chain.renderPlan.ops.empty()) {
+                spareBuffer = scratchArena->borrow(scratchArena->getNumChannels(), buffer.getNumSamples());
+            }
+
+            const int numOps {static_cast<int>(chain.renderPlan.ops.size())};
+
+            if (modulationControlRate > 0 && modulationControlRate < buffer.getNumSamples() && hasActiveModulation(chain, 0, numOps)) {
+                // Modulating faster than once per block
+                processBlockInSlices(chain,
+                                     0,
+                                     numOps,
+                                     buffer,
+                                     midiMessages,
+                                     newPlayHead,
+                                     modulationControlRate,
+                                     &spareBuffer,
+                                     chain.sliceMidiBuffer,
+                                     chain.outputMidiBuffer,
+                                     false,
+                                     isSleepingEnabled);
+            } else {
+                // Chain is active - process as normal
+                for (const RenderOp& op : chain.renderPlan.ops) {
+                    switch (op.type) {
+                        case RENDER_OP_TYPE::GAIN_STAGE:
+                            ChainProcessors::processBlock(*static_cast<ChainSlotGainStage*>(op.slot), buffer);
+                            break;
+                        case RENDER_OP_TYPE::PLUGIN:
+                            ChainProcessors::processBlock(*static_cast<ChainSlotPlugin*>(op.slot), buffer, midiMessages, newPlayHead, &spareBuffer, isSleepingEnabled);
+                            break;
+                    }
+                }
+            }
+
+            // A pipelined chain still has to add its latency when the block can't be pipelined
+            if (isPipelined) {
+                chain.pipeline->delayUnpipelinedBlock(buffer);
+
+                // The MIDI of the flushed blocks is output now rather than being lost, oldest first.
+                // Each event keeps its position, limited to this block in case it's shorter.
+                const int lastSample {std::max(buffer.getNumSamples() - 1, 0)};
+
+                for (int bufferStageIndex {numFlushedBlocks}; bufferStageIndex > 0; bufferStageIndex--) {
+                    for (const juce::MidiMessageMetadata metadata : chain.pipeline->getStageMidi(bufferStageIndex)) {
+                        midiMessages.addEvent(metadata.data, metadata.numBytes, std::min(metadata.samplePosition, lastSample));
+                    }
+
+                    chain.pipeline->getStageMidi(bufferStageIndex).clear();
+                }
+            }
+        }
+
+        // Each plugin decides whether it's asleep, the chain is asleep if they all are
+        chain.isSleeping.store(!chain.isChainMuted && !chain.isChainBypassed && areAllPluginsSleeping(chain),
+                               std::memory_order_relaxed);
+    }
+
+    void processStage(PluginChain& chain,
+                      int stageIndex,
+                      juce::AudioBuffer<float>& buffer,
+                      juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* newPlayHead,
+                      int modulationControlRate,
+                      ScratchArena* scratchArena,
+                      bool isSleepingEnabled) {
+        const int numOps {static_cast<int>(chain.renderPlan.ops.size())};
+        const int stageStart {std::min(chain.pipeline->getStageStart(stageIndex), numOps)};
+        const int stageEnd {chain.pipeline->getStageEnd(stageIndex, numOps)};
+
+        juce::AudioBuffer<float> spareBuffer;
+        if (scratchArena != nullptr && stageEnd > stageStart) {
+            spareBuffer = scratchArena->borrow(scratchArena->getNumChannels(), buffer.getNumSamples());
+        }
+
+        if (modulationControlRate > 0
+                && modulationControlRate < buffer.getNumSamples()
+                && scratchArena != nullptr
+                && hasActiveModulation(chain, stageStart, stageEnd)) {
+            // Stages may be processed at the same time, so each borrows its own MIDI buffers to
+            // slice with. If there aren't enough the stage is modulated once per block instead.
+            juce::MidiBuffer* sliceMidi {scratchArena->borrowMidi()};
+            juce::MidiBuffer* outputMidi {scratchArena->borrowMidi()};
+
+            if (sliceMidi != nullptr && outputMidi != nullptr) {
+                processBlockInSlices(chain,
+                                     stageStart,
+                                     stageEnd,
+                                     buffer,
+                                     midiMessages,
+                                     newPlayHead,
+                                     modulationControlRate,
+                                     &spareBuffer,
+                                     *sliceMidi,
+                                     *outputMidi,
+                                     true,
+                                     isSleepingEnabled);
+                return;
+            }
+        }
+
+        for (int opIndex {stageStart}; opIndex < stageEnd; opIndex++) {
+            const RenderOp& op = chain.renderPlan.ops[opIndex];
+
+            switch (op.type) {
+                case RENDER_OP_TYPE::GAIN_STAGE:
+                    ChainProcessors::processBlock(*static_cast<ChainSlotGainStage*>(op.slot), buffer);
+                    break;
+                case RENDER_OP_TYPE::PLUGIN:
+                    processBlockMeasured(*static_cast<ChainSlotPlugin*>(op.slot), buffer, midiMessages, newPlayHead, &spareBuffer, isSleepingEnabled);
+                    break;
+            }
+        }
+    }
+
+    bool hasMonoPlugin(const PluginChain& chain) {
+        for (const RenderOp& op : chain.renderPlan.ops) {
+            if (op.type == RENDER_OP_TYPE::PLUGIN
+                    && static_cast<ChainSlotPlugin*>(op.slot)->plugin->getMainBusNumInputChannels() == 1) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void mergeMidiOutput(const juce::MidiBuffer& inputMidi,
+                         const juce::MidiBuffer& chainOutput,
+                         MidiMergeState& state,
+                         juce::MidiBuffer& mergedOutput) {
+        // Input events already matched to an event from this chain, so a repeat isn't matched twice
+        std::bitset<MidiMergeState::MAX_NUM_TRACKED_EVENTS> isMatched;
+
+        // Both buffers are in time order, so the input is walked once alongside the output and only
+        // the input events at the same time as each output event are compared
+        auto inputGroupStart = inputMidi.cbegin();
+        int inputGroupStartIndex {0};
+
+        for (const juce::MidiMessageMetadata event : chainOutput) {
+            while (inputGroupStart != inputMidi.cend() && (*inputGroupStart).samplePosition < event.samplePosition) {
+                ++inputGroupStart;
+                inputGroupStartIndex++;
+            }
+
+            bool isAlreadyPassedThrough {false};
+            int inputIndex {inputGroupStartIndex};
+
+            for (auto iterator = inputGroupStart;
+                 iterator != inputMidi.cend() && inputIndex < MidiMergeState::MAX_NUM_TRACKED_EVENTS;
+                 ++iterator, inputIndex++) {
+                const juce::MidiMessageMetadata inputEvent = *iterator;
+
+                if (inputEvent.samplePosition != event.samplePosition) {
+                    break;
                 }
+
+                if (!isMatched[inputIndex]
+                        && inputEvent.numBytes == event.numBytes
+                        && std::memcmp(inputEvent.data, event.data, event.numBytes) == 0) {
+                    // The chain passed this input event through unchanged
+                    isMatched[inputIndex] = true;
+                    isAlreadyPassedThrough = state.isPassedThrough[inputIndex];
+                    state.isPassedThrough[inputIndex] = true;
+                    break;
+                }
+            }
+
+            if (!isAlreadyPassedThrough) {
+                mergedOutput.addEvent(event.data, event.numBytes, event.samplePosition);
             }
         }
     }
@@ -1,14 +1,74 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <bitset>
 #include "PluginChain.hpp"
+#include "ScratchArena.hpp"
+
+class ChainWorkerPool;
 
 namespace ChainProcessors {
-    void prepareToPlay(PluginChain& chain, HostConfiguration config);
+    /**
+     * maxPipelineStages is the most stages the chain can be split into, see ChainPipeline.
+     */
+    void prepareToPlay(PluginChain& chain, HostConfiguration config, int maxPipelineStages = 1);
     void releaseResources(PluginChain& chain);
     void reset(PluginChain& chain);
+
+    /**
+     * If the chain is pipelined its stages are run on the worker pool when one is given, or one
+     * after another on this thread if not.
+     */
     void processBlock(PluginChain& chain,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead);
+                      juce::AudioPlayHead* newPlayHead,
+                      int modulationControlRate = 0,
+                      ScratchArena* scratchArena = nullptr,
+                      ChainWorkerPool* workerPool = nullptr,
+                      bool isSleepingEnabled = false);
+
+    /**
+     * Processes a single stage of a pipelined chain in place. Modulating faster than once per block
+     * needs two MIDI buffers from the scratch arena.
+     */
+    void processStage(PluginChain& chain,
+                      int stageIndex,
+                      juce::AudioBuffer<float>& buffer,
+                      juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* newPlayHead,
+                      int modulationControlRate = 0,
+                      ScratchArena* scratchArena = nullptr,
+                      bool isSleepingEnabled = false);
+
+    /**
+     * True if any plugin in the chain, bypassed or not, is configured with a mono main input. These
+     * only process the first channel so need the chain's signal there.
+     */
+    bool hasMonoPlugin(const PluginChain& chain);
+
+    /**
+     * Which events of the input MIDI have been passed through to the merged output by a chain, so
+     * the chains after it don't pass them on again. Use a new one for each block.
+     */
+    struct MidiMergeState {
+        // Events after this many in a block aren't tracked, so are passed on by every chain
+        static constexpr int MAX_NUM_TRACKED_EVENTS {256};
+
+        std::bitset<MAX_NUM_TRACKED_EVENTS> isPassedThrough;
+    };
+
+    /**
+     * Adds the events from a chain's output to the MIDI merged from the chains before it. Chains that each
+     * processed their own copy of the same input usually pass most of it through, so an event that
+     * matches one from the input at the same time is only passed on by the first chain to output
+     * it. Anything else is kept, including repeats and identical events from different chains.
+     *
+     * Merging the chains in the same order every block means the result doesn't depend on which
+     * chain finished first.
+     */
+    void mergeMidiOutput(const juce::MidiBuffer& inputMidi,
+                         const juce::MidiBuffer& chainOutput,
+                         MidiMergeState& state,
+                         juce::MidiBuffer& mergedOutput);
 }
@@ -3,6 +3,8 @@
 
 #include "ChainMutators.hpp"
 #include "ChainProcessors.hpp"
+#include "ChainSlotProcessors.hpp"
+#include "ChainWorkerPool.hpp"
 
 namespace {
     constexpr int NUM_SAMPLES {64};
@@ -14,9 +16,14 @@ namespace {
         std::optional<std::function<void()>> onReleaseResources;
         std::optional<std::function<void()>> onReset;
         std::optional<std::function<void(juce::AudioBuffer<float>&, juce::MidiBuffer&)>> onProcess;
+        double tailLengthSeconds {0};
 
         ProcessorTestPluginInstance() = default;
 
+        double getTailLengthSeconds() const override {
+            return tailLengthSeconds;
+        }
+
         void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override {
             if (onPrepareToPlay.has_value()) {
                 onPrepareToPlay.value()(sampleRate, maximumExpectedSamplesPerBlock);
@@ -243,26 +250,33 @@ SCENARIO("ChainProcessors: Latency is applied correctly") {
 
         constexpr int sampleDelay {10};
 
-        WHEN("The latency mutex is locked and the buffer is processed") {
+        WHEN("The latency is increased after a buffer has been processed") {
             juce::MidiBuffer midiBuffer;
 
             ChainProcessors::prepareToPlay(*(chain.get()), {layout, SAMPLE_RATE, NUM_SAMPLES});
-            ChainMutators::setRequiredLatency(chain, sampleDelay, {layout, SAMPLE_RATE, NUM_SAMPLES});
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
 
-            {
-                WECore::AudioSpinTryLock lock(chain->latencyCompLineMutex);
-                ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
-            }
+            // Process a block of silence with a latency longer than a block
+            ChainMutators::setRequiredLatency(chain, NUM_SAMPLES + sampleDelay);
+            juce::AudioBuffer<float> nextBuffer(buffer.getNumChannels(), NUM_SAMPLES);
+            nextBuffer.clear();
+            ChainProcessors::processBlock(*(chain.get()), nextBuffer, midiBuffer, nullptr);
 
-            THEN("The buffer is unchanged") {
+            THEN("The first buffer is unchanged and the second is delayed using the history from the first") {
                 for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
                     const auto readPtr = buffer.getReadPointer(channelIdx);
+                    const auto nextReadPtr = nextBuffer.getReadPointer(channelIdx);
 
                     for (int sampleIdx {0}; sampleIdx < buffer.getNumSamples(); sampleIdx++) {
                         const float expectedSample {
                             sampleIdx == 0 && !isChainMuted ? 1.0f : 0.0f
                         };
                         CHECK(readPtr[sampleIdx] == expectedSample);
+
+                        const float expectedNextSample {
+                            sampleIdx == sampleDelay && !isChainMuted ? 1.0f : 0.0f
+                        };
+                        CHECK(nextReadPtr[sampleIdx] == expectedNextSample);
                     }
                 }
             }
@@ -272,7 +286,7 @@ SCENARIO("ChainProcessors: Latency is applied correctly") {
             juce::MidiBuffer midiBuffer;
 
             ChainProcessors::prepareToPlay(*(chain.get()), {layout, SAMPLE_RATE, NUM_SAMPLES});
-                ChainMutators::setRequiredLatency(chain, sampleDelay, {layout, SAMPLE_RATE, NUM_SAMPLES});
+            ChainMutators::setRequiredLatency(chain, sampleDelay);
 
             ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
 
@@ -374,3 +388,489 @@ SCENARIO("ChainProcessors: Plugin methods are called correctly") {
         }
     }
 }
+
+SCENARIO("ChainProcessors: Plugins sleep while their input is silent and their tail has finished") {
+    GIVEN("A chain with a plugin") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        const double tailLengthSeconds = GENERATE(0.0, 2.0, std::numeric_limits<double>::infinity());
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+        plugin->tailLengthSeconds = tailLengthSeconds;
+        ChainMutators::insertPlugin(chain, plugin, 0, hostConfig);
+
+        int numProcessCalls {0};
+        plugin->onProcess = [&numProcessCalls](juce::AudioBuffer<float>&, juce::MidiBuffer&) {
+            numProcessCalls++;
+        };
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        juce::MidiBuffer midiBuffer;
+
+        WHEN("Silence is processed for longer than the tail") {
+            constexpr int NUM_BLOCKS {2000};
+            for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                buffer.clear();
+                ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, 0, nullptr, nullptr, true);
+            }
+
+            THEN("The plugin is processed until its tail has finished, then it sleeps") {
+                if (std::isfinite(tailLengthSeconds)) {
+                    // Plugins are always given at least a second
+                    const int tailLengthSamples {static_cast<int>(std::max(tailLengthSeconds, 1.0) * SAMPLE_RATE)};
+                    CHECK(numProcessCalls == (tailLengthSamples + NUM_SAMPLES - 1) / NUM_SAMPLES);
+                    CHECK(chain->isSleeping);
+                } else {
+                    CHECK(numProcessCalls == NUM_BLOCKS);
+                    CHECK_FALSE(chain->isSleeping);
+                }
+            }
+
+            AND_WHEN("The input is no longer silent") {
+                const int previousNumProcessCalls {numProcessCalls};
+                buffer.clear();
+                buffer.setSample(0, 0, 0.5f);
+                ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, 0, nullptr, nullptr, true);
+
+                THEN("The plugin wakes up") {
+                    CHECK(numProcessCalls == previousNumProcessCalls + 1);
+                    CHECK_FALSE(chain->isSleeping);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Modulation is applied in slices when a control rate is set") {
+    GIVEN("A chain with a plugin that has a modulated parameter") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.5f;
+        };
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+        auto parameter = new juce::AudioParameterFloat("param", "Param", 0, 1, 0);
+        plugin->addParameter(parameter);
+        ChainMutators::insertPlugin(chain, plugin, 0, hostConfig);
+
+        auto parameterConfig = std::make_shared<PluginParameterModulationConfig>();
+        parameterConfig->targetParameterName = "Param";
+        parameterConfig->sources.push_back(
+            std::make_shared<PluginParameterModulationSource>(ModulationSourceDefinition(1, MODULATION_TYPE::MACRO), 1.0f));
+
+        PluginModulationConfig modulationConfig;
+        modulationConfig.isActive = true;
+        modulationConfig.parameterConfigs.push_back(parameterConfig);
+        ChainMutators::setPluginModulationConfig(chain, modulationConfig, 0);
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig);
+
+        std::vector<int> processedBlockSizes;
+        plugin->onProcess = [&processedBlockSizes](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+            processedBlockSizes.push_back(buffer.getNumSamples());
+        };
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiBuffer;
+
+        WHEN("The buffer is processed with a control rate") {
+            constexpr int CONTROL_RATE {16};
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, CONTROL_RATE);
+
+            THEN("The slice where the modulation changed is processed on its own and the idle slices are merged") {
+                REQUIRE(processedBlockSizes.size() == 2);
+                CHECK(processedBlockSizes[0] == CONTROL_RATE);
+                CHECK(processedBlockSizes[1] == NUM_SAMPLES - CONTROL_RATE);
+                CHECK(parameter->get() == Approx(0.5f));
+            }
+        }
+
+        WHEN("The buffer is processed without a control rate") {
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+            THEN("The whole block is processed at once") {
+                REQUIRE(processedBlockSizes.size() == 1);
+                CHECK(processedBlockSizes[0] == NUM_SAMPLES);
+                CHECK(parameter->get() == Approx(0.5f));
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Pipelined chains match unpipelined chains delayed by the pipeline latency") {
+    auto messageManager = juce::MessageManager::getInstance();
+
+    GIVEN("A chain of plugins split into two stages") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        constexpr int NUM_PLUGINS {4};
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int pluginIndex {0}; pluginIndex < NUM_PLUGINS; pluginIndex++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+                for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
+                    juce::FloatVectorOperations::multiply(buffer.getWritePointer(channelIndex), 2.0f, buffer.getNumSamples());
+                }
+            };
+            ChainMutators::insertPlugin(chain, plugin, pluginIndex, hostConfig);
+        }
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig, 2);
+
+        REQUIRE(chain->pipeline->getNumStages() == 2);
+        CHECK(chain->latencyListener.calculatedTotalPluginLatency == NUM_SAMPLES);
+
+        const bool useWorkerPool = GENERATE(false, true);
+        ChainWorkerPool workerPool(1);
+        workerPool.prepare(2, NUM_SAMPLES, ChainWorkerPool::DEFAULT_NUM_TASKS);
+
+        WHEN("Several blocks are processed") {
+            constexpr int NUM_BLOCKS {4};
+            std::vector<float> outputs;
+
+            for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                for (int channelIndex {0}; channelIndex < 2; channelIndex++) {
+                    juce::FloatVectorOperations::fill(buffer.getWritePointer(channelIndex), blockIndex + 1, NUM_SAMPLES);
+                }
+
+                juce::MidiBuffer midiBuffer;
+                ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, 0, nullptr, useWorkerPool ? &workerPool : nullptr);
+
+                CHECK(buffer.getSample(0, 0) == buffer.getSample(1, NUM_SAMPLES - 1));
+                outputs.push_back(buffer.getSample(0, 0));
+            }
+
+            THEN("Each block comes out of the last stage a block later, processed by every plugin") {
+                // The first block out of the last stage is silence that was in flight
+                CHECK(outputs[0] == 0.0f);
+
+                for (int blockIndex {1}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                    CHECK(outputs[blockIndex] == Approx(blockIndex * 16.0f));
+                }
+            }
+
+            AND_THEN("The cost of each plugin was measured") {
+                for (const auto& slot : chain->chain) {
+                    CHECK(std::dynamic_pointer_cast<ChainSlotPlugin>(slot)->processingCost >= 0);
+                }
+            }
+        }
+
+        WHEN("A block smaller than the prepared size is processed") {
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES / 2);
+            buffer.clear();
+            buffer.setSample(0, 0, 1.0f);
+
+            juce::MidiBuffer midiBuffer;
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+            THEN("It's processed without pipelining and delayed by the same latency") {
+                for (int sampleIndex {0}; sampleIndex < buffer.getNumSamples(); sampleIndex++) {
+                    CHECK(buffer.getSample(0, sampleIndex) == 0.0f);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Pipelined chains output continuous audio when the block size changes") {
+    GIVEN("A chain of plugins split into two stages") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        constexpr int NUM_PLUGINS {4};
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int pluginIndex {0}; pluginIndex < NUM_PLUGINS; pluginIndex++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+                for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
+                    juce::FloatVectorOperations::multiply(buffer.getWritePointer(channelIndex), 2.0f, buffer.getNumSamples());
+                }
+            };
+            ChainMutators::insertPlugin(chain, plugin, pluginIndex, hostConfig);
+        }
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig, 2);
+        REQUIRE(chain->pipeline->getNumStages() == 2);
+
+        const bool useWorkerPool = GENERATE(false, true);
+        ChainWorkerPool workerPool(1);
+        workerPool.prepare(2, NUM_SAMPLES, ChainWorkerPool::DEFAULT_NUM_TASKS);
+
+        WHEN("A ramp is processed in blocks that are sometimes smaller than the prepared size") {
+            // Includes a smaller block while the pipeline is still filling back up after another
+            const std::vector<int> blockSizes {
+                NUM_SAMPLES, NUM_SAMPLES / 2, NUM_SAMPLES, NUM_SAMPLES / 4, NUM_SAMPLES, NUM_SAMPLES,
+                NUM_SAMPLES, NUM_SAMPLES - 1, NUM_SAMPLES / 2, NUM_SAMPLES, NUM_SAMPLES, NUM_SAMPLES
+            };
+
+            std::vector<float> outputs;
+            int numSamplesProcessed {0};
+
+            for (int blockSize : blockSizes) {
+                juce::AudioBuffer<float> buffer(2, blockSize);
+                for (int sampleIndex {0}; sampleIndex < blockSize; sampleIndex++) {
+                    buffer.setSample(0, sampleIndex, numSamplesProcessed + sampleIndex + 1);
+                    buffer.setSample(1, sampleIndex, numSamplesProcessed + sampleIndex + 1);
+                }
+
+                juce::MidiBuffer midiBuffer;
+                ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, 0, nullptr, useWorkerPool ? &workerPool : nullptr);
+
+                for (int sampleIndex {0}; sampleIndex < blockSize; sampleIndex++) {
+                    outputs.push_back(buffer.getSample(0, sampleIndex));
+                }
+
+                numSamplesProcessed += blockSize;
+            }
+
+            THEN("The output is the processed ramp delayed by the pipeline latency without any gaps") {
+                const int latency {chain->pipeline->getLatencySamples()};
+                REQUIRE(latency == NUM_SAMPLES);
+
+                for (int sampleIndex {0}; sampleIndex < outputs.size(); sampleIndex++) {
+                    const float expected {sampleIndex < latency ? 0.0f : 16.0f * (sampleIndex - latency + 1)};
+                    CHECK(outputs[sampleIndex] == expected);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Pipelined chains drop what's in flight when muted or bypassed") {
+    GIVEN("A chain of plugins split into two stages") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        constexpr int NUM_PLUGINS {4};
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int pluginIndex {0}; pluginIndex < NUM_PLUGINS; pluginIndex++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+                for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
+                    juce::FloatVectorOperations::multiply(buffer.getWritePointer(channelIndex), 2.0f, buffer.getNumSamples());
+                }
+            };
+            ChainMutators::insertPlugin(chain, plugin, pluginIndex, hostConfig);
+        }
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig, 2);
+        REQUIRE(chain->pipeline->getNumStages() == 2);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(0), 1.0f, NUM_SAMPLES);
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(1), 1.0f, NUM_SAMPLES);
+
+        juce::MidiBuffer midiBuffer;
+        midiBuffer.addEvent(juce::MidiMessage::noteOn(1, 60, 0.5f), 10);
+        ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+        const bool isMuted = GENERATE(false, true);
+
+        WHEN("The chain is muted or bypassed for a block and then processed again") {
+            if (isMuted) {
+                chain->isChainMuted = true;
+            } else {
+                chain->isChainBypassed = true;
+            }
+
+            buffer.clear();
+            midiBuffer.clear();
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+            chain->isChainMuted = false;
+            chain->isChainBypassed = false;
+
+            buffer.clear();
+            midiBuffer.clear();
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+            THEN("The block that was in flight before isn't output") {
+                for (int sampleIndex {0}; sampleIndex < NUM_SAMPLES; sampleIndex++) {
+                    CHECK(buffer.getSample(0, sampleIndex) == 0.0f);
+                }
+
+                CHECK(midiBuffer.isEmpty());
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: MIDI in flight keeps its position when a pipelined chain is flushed") {
+    GIVEN("A chain of plugins split into two stages with a block of MIDI in flight") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        constexpr int NUM_PLUGINS {2};
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int pluginIndex {0}; pluginIndex < NUM_PLUGINS; pluginIndex++) {
+            ChainMutators::insertPlugin(chain, std::make_shared<ProcessorTestPluginInstance>(), pluginIndex, hostConfig);
+        }
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig, 2);
+        REQUIRE(chain->pipeline->getNumStages() == 2);
+
+        constexpr int EARLY_POSITION {10};
+        constexpr int LATE_POSITION {NUM_SAMPLES - 10};
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiBuffer;
+        midiBuffer.addEvent(juce::MidiMessage::noteOn(1, 60, 0.5f), EARLY_POSITION);
+        midiBuffer.addEvent(juce::MidiMessage::noteOff(1, 60), LATE_POSITION);
+        ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+
+        WHEN("A block smaller than the prepared size is processed") {
+            constexpr int SMALL_BLOCK_SIZE {NUM_SAMPLES / 2};
+            juce::AudioBuffer<float> smallBuffer(2, SMALL_BLOCK_SIZE);
+            smallBuffer.clear();
+            midiBuffer.clear();
+            ChainProcessors::processBlock(*(chain.get()), smallBuffer, midiBuffer, nullptr);
+
+            THEN("The flushed events keep their positions, limited to the block") {
+                std::vector<int> positions;
+                for (const juce::MidiMessageMetadata metadata : midiBuffer) {
+                    positions.push_back(metadata.samplePosition);
+                }
+
+                REQUIRE(positions.size() == 2);
+                CHECK(positions[0] == EARLY_POSITION);
+                CHECK(positions[1] == SMALL_BLOCK_SIZE - 1);
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Pipelined stages apply modulation in slices when a control rate is set") {
+    GIVEN("A chain split into two stages with a modulated plugin in the first") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.5f;
+        };
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+        auto parameter = new juce::AudioParameterFloat("param", "Param", 0, 1, 0);
+        plugin->addParameter(parameter);
+        ChainMutators::insertPlugin(chain, plugin, 0, hostConfig);
+        ChainMutators::insertPlugin(chain, std::make_shared<ProcessorTestPluginInstance>(), 1, hostConfig);
+
+        auto parameterConfig = std::make_shared<PluginParameterModulationConfig>();
+        parameterConfig->targetParameterName = "Param";
+        parameterConfig->sources.push_back(
+            std::make_shared<PluginParameterModulationSource>(ModulationSourceDefinition(1, MODULATION_TYPE::MACRO), 1.0f));
+
+        PluginModulationConfig modulationConfig;
+        modulationConfig.isActive = true;
+        modulationConfig.parameterConfigs.push_back(parameterConfig);
+        ChainMutators::setPluginModulationConfig(chain, modulationConfig, 0);
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig, 2);
+        REQUIRE(chain->pipeline->getNumStages() == 2);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(2, NUM_SAMPLES, ScratchArena::DEFAULT_NUM_BUFFERS);
+
+        std::vector<int> processedBlockSizes;
+        plugin->onProcess = [&processedBlockSizes](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+            processedBlockSizes.push_back(buffer.getNumSamples());
+        };
+
+        WHEN("A block is processed with a control rate") {
+            constexpr int CONTROL_RATE {16};
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+            buffer.clear();
+            juce::MidiBuffer midiBuffer;
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr, CONTROL_RATE, &scratchArena);
+
+            THEN("The slice where the modulation changed is processed on its own and the idle slices are merged") {
+                REQUIRE(processedBlockSizes.size() == 2);
+                CHECK(processedBlockSizes[0] == CONTROL_RATE);
+                CHECK(processedBlockSizes[1] == NUM_SAMPLES - CONTROL_RATE);
+                CHECK(parameter->get() == Approx(0.5f));
+            }
+        }
+    }
+}
+
+// Hidden by default, run with the [benchmark] tag
+SCENARIO("ChainProcessors: Per block overhead of processing a chain", "[.][benchmark]") {
+    GIVEN("A chain of gain stages and plugins that do nothing") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        const int numSlots = GENERATE(1, 2, 4, 8, 16, 32, 64);
+
+        auto chain = std::make_shared<PluginChain>(modulationCallback);
+        for (int slotIndex {0}; slotIndex < numSlots; slotIndex++) {
+            if (slotIndex % 2 == 0) {
+                ChainMutators::insertPlugin(chain, std::make_shared<ProcessorTestPluginInstance>(), slotIndex, hostConfig);
+            } else {
+                ChainMutators::insertGainStage(chain, slotIndex, hostConfig);
+            }
+        }
+
+        ChainProcessors::prepareToPlay(*(chain.get()), hostConfig);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiBuffer;
+
+        BENCHMARK("processBlock with " + std::to_string(numSlots) + " slots") {
+            ChainProcessors::processBlock(*(chain.get()), buffer, midiBuffer, nullptr);
+        };
+    }
+}
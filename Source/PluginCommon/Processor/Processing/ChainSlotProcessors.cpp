@@ -1,28 +1,116 @@
 #include "ChainSlotProcessors.hpp"
 
+#include <array>
 #include <assert.h>
 #include "PluginUtils.h"
 
 namespace {
-    void applyModulationForParamter(ChainSlotPlugin& slot,
-                                    juce::AudioProcessorParameter* targetParameter,
-                                    const std::shared_ptr<PluginParameterModulationConfig> parameterConfig) {
-        // Start from the rest value
-        float paramValue {parameterConfig->restValue};
-
-        for (const auto source : parameterConfig->sources) {
-            // Add the modulation from each source
-            const float valueForThisSource {
-                slot.getModulationValueCallback(source->definition.id, source->definition.type)
-                    * source->modulationAmount
-            };
+    // Less than the number of channels juce::AudioBuffer can refer to without allocating
+    constexpr int MAX_NUM_PADDED_CHANNELS {16};
+
+    // About -100dB
+    constexpr float SILENCE_THRESHOLD {0.00001f};
+
+    // Some plugins report a shorter tail than they really have (or none at all), so always wait at
+    // least this long before putting one to sleep
+    constexpr double MIN_SLEEP_DELAY_SECONDS {1.0};
 
-            paramValue += valueForThisSource;
+    bool isSilent(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages) {
+        if (!midiMessages.isEmpty()) {
+            return false;
         }
 
-        // Clamp to valid range - plugins may crash with out-of-range values
-        paramValue = juce::jlimit(0.0f, 1.0f, paramValue);
-        targetParameter->setValue(paramValue);
+        for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
+            if (buffer.getMagnitude(channelIndex, 0, buffer.getNumSamples()) > SILENCE_THRESHOLD) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Updates the silence detection with the block about to be processed. Returns true if the
+     * plugin would only output silence for it.
+     */
+    bool updateIsSleeping(ChainSlotPlugin& slot, const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages, bool isSleepingEnabled) {
+        if (slot.tailLengthSamples < 0 || !isSleepingEnabled) {
+            slot.numSilentSamples.store(0, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (!isSilent(buffer, midiMessages)) {
+            slot.numSilentSamples.store(0, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Keep processing until the last of the signal has made it through the latency and the tail
+        const bool retVal {ChainProcessors::isSleeping(slot)};
+
+        // Saturate rather than overflow after a long silence
+        const int numSilentSamples {slot.numSilentSamples.load(std::memory_order_relaxed)};
+        slot.numSilentSamples.store(std::min(numSilentSamples, std::numeric_limits<int>::max() / 2) + buffer.getNumSamples(),
+                                    std::memory_order_relaxed);
+
+        return retVal;
+    }
+
+    /**
+     * Passes the audio through a suspended plugin, delayed by the latency it would have added.
+     */
+    void processSuspended(ChainSlotPlugin& slot, juce::AudioBuffer<float>& buffer) {
+        if (slot.suspendedPassthrough == nullptr) {
+            return;
+        }
+
+        SuspendedPassthrough& passthrough = *slot.suspendedPassthrough;
+
+        if (!passthrough.isActive) {
+            // The line only has audio from the last time the plugin was suspended, start it silent
+            // as the plugin's own output for that time isn't available
+            passthrough.line.reset();
+            passthrough.isActive = true;
+        }
+
+        passthrough.line.setDelay(slot.plugin->getLatencySamples());
+        passthrough.line.process(buffer);
+    }
+
+    /**
+     * Processes a copy of the input with the plugin the slot's plugin replaced, ready to be
+     * crossfaded out by applySwapCrossfade(). Returns false if it can't be.
+     */
+    bool processReplacedPlugin(ChainSlotPlugin& slot, const juce::AudioBuffer<float>& buffer) {
+        PluginSwapCrossfade& crossfade = *slot.swapCrossfade;
+
+        if (buffer.getNumSamples() > crossfade.replacedOutput.getNumSamples()) {
+            return false;
+        }
+
+        const int numChannels {std::min(buffer.getNumChannels(), crossfade.replacedOutput.getNumChannels())};
+        juce::AudioBuffer<float> replacedOutput(crossfade.replacedOutput.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+
+        for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+            replacedOutput.copyFrom(channelIndex, 0, buffer, channelIndex, 0, buffer.getNumSamples());
+        }
+
+        crossfade.replacedMidi.clear();
+        crossfade.replacedPlugin->processBlock(replacedOutput, crossfade.replacedMidi);
+
+        return true;
+    }
+
+    /**
+     * Fades the new plugin's output in over the block, and the replaced plugin's output out.
+     */
+    void applySwapCrossfade(ChainSlotPlugin& slot, juce::AudioBuffer<float>& buffer) {
+        const juce::AudioBuffer<float>& replacedOutput = slot.swapCrossfade->replacedOutput;
+        const int numChannels {std::min(buffer.getNumChannels(), replacedOutput.getNumChannels())};
+
+        for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+            buffer.applyGainRamp(channelIndex, 0, buffer.getNumSamples(), 0, 1);
+            buffer.addFromWithRamp(channelIndex, 0, replacedOutput.getReadPointer(channelIndex), buffer.getNumSamples(), 1, 0);
+        }
     }
 }
 
@@ -31,9 +119,7 @@ namespace ChainProcessors {
         gainStage.numMainChannels = config.layout.getMainInputChannels();
         assert(gainStage.numMainChannels <= 2);
 
-        for (auto& env : gainStage.meterEnvelopes) {
-            env.setSampleRate(config.sampleRate);
-        }
+        gainStage.meter->setSampleRate(config.sampleRate);
     }
 
     void releaseResources(ChainSlotGainStage& /*gainStage*/) {
@@ -41,9 +127,7 @@ namespace ChainProcessors {
     }
 
     void reset(ChainSlotGainStage& gainStage) {
-        for (auto& env : gainStage.meterEnvelopes) {
-            env.reset();
-        }
+        gainStage.meter->reset();
     }
 
     void processBlock(ChainSlotGainStage& gainStage, juce::AudioBuffer<float>& buffer) {
@@ -61,18 +145,33 @@ namespace ChainProcessors {
             }
         }
 
-        // Update the envelope follower
-        for (int sampleIndex {0}; sampleIndex < buffer.getNumSamples(); sampleIndex++) {
-            for (int channel {0}; channel < gainStage.numMainChannels; channel++) {
-                gainStage.meterEnvelopes[channel].getNextOutput(buffer.getReadPointer(channel)[sampleIndex]);
-            }
-        }
+        // Only measured while the UI is displaying the meter
+        gainStage.meter->processBlock(buffer, gainStage.numMainChannels);
     }
 
     void prepareToPlay(ChainSlotPlugin& slot, HostConfiguration config) {
         slot.plugin->setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
         slot.plugin->prepareToPlay(config.sampleRate, config.blockSize);
-        slot.spareSCBuffer.reset(new juce::AudioBuffer<float>(config.layout.getMainInputChannels() * 2, config.blockSize));
+
+        // Instruments and MIDI generators can make sound from silence, and an infinite tail never
+        // ends, so these are never put to sleep
+        const double tailLengthSeconds {slot.plugin->getTailLengthSeconds()};
+        const bool canSleep {
+            std::isfinite(tailLengthSeconds)
+            && !slot.plugin->getPluginDescription().isInstrument
+            && !slot.plugin->producesMidi()
+        };
+
+        slot.tailLengthSamples = canSleep ?
+            static_cast<int>(std::ceil(std::max(tailLengthSeconds, MIN_SLEEP_DELAY_SECONDS) * config.sampleRate)) : -1;
+        slot.numSilentSamples.store(0, std::memory_order_relaxed);
+
+        // Sized for the latency the plugin has now, a new one as a clone may still be using the old
+        slot.suspendedPassthrough = std::make_shared<SuspendedPassthrough>(slot.plugin->getLatencySamples());
+        slot.suspendedPassthrough->line.prepare(config.layout.getMainInputChannels(), config.blockSize);
+
+        // The plugin's parameters may have changed
+        slot.modulationMatrix.compile(*slot.plugin, *slot.modulationConfig);
     }
 
     void releaseResources(ChainSlotPlugin& slot) {
@@ -81,55 +180,169 @@ namespace ChainProcessors {
 
     void reset(ChainSlotPlugin& slot) {
         slot.plugin->reset();
-        slot.spareSCBuffer->clear();
+    }
+
+    bool updateModulation(ChainSlotPlugin& slot) {
+        ModulationMatrix& matrix = slot.modulationMatrix;
+
+        const int numParameters {static_cast<int>(matrix.parameters.size())};
+        const int numConnections {static_cast<int>(matrix.connectionAmounts.size())};
+
+        if (numParameters == 0) {
+            return false;
+        }
+
+        // Take a snapshot of each source once, even if it's used by several parameters
+        for (int sourceIndex {0}; sourceIndex < matrix.sources.size(); sourceIndex++) {
+            const ModulationSourceDefinition& source = matrix.sources[sourceIndex];
+            matrix.sourceValues[sourceIndex] = slot.getModulationValueCallback(source.id, source.type);
+        }
+
+        // Scale each connection by its amount
+        for (int connectionIndex {0}; connectionIndex < numConnections; connectionIndex++) {
+            matrix.connectionValues[connectionIndex] =
+                matrix.sourceValues[matrix.connectionSourceIndices[connectionIndex]]
+                * matrix.connectionAmounts[connectionIndex].load(std::memory_order_relaxed);
+        }
+
+        // Start from the rest values and add the modulation from each source
+        for (int parameterIndex {0}; parameterIndex < numParameters; parameterIndex++) {
+            matrix.parameterValues[parameterIndex] = matrix.restValues[parameterIndex].load(std::memory_order_relaxed);
+        }
+
+        for (int connectionIndex {0}; connectionIndex < numConnections; connectionIndex++) {
+            matrix.parameterValues[matrix.connectionParameterIndices[connectionIndex]] += matrix.connectionValues[connectionIndex];
+        }
+
+        // Clamp to valid range - plugins may crash with out-of-range values
+        juce::FloatVectorOperations::clip(matrix.parameterValues.data(), matrix.parameterValues.data(), 0.0f, 1.0f, numParameters);
+
+        if (matrix.shouldSetAllParameters.exchange(false, std::memory_order_acquire)) {
+            std::fill(matrix.lastParameterValues.begin(), matrix.lastParameterValues.end(), -1.0f);
+        }
+
+        for (int parameterIndex {0}; parameterIndex < numParameters; parameterIndex++) {
+            if (matrix.parameterValues[parameterIndex] != matrix.lastParameterValues[parameterIndex]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void applyModulation(ChainSlotPlugin& slot) {
+        ModulationMatrix& matrix = slot.modulationMatrix;
+
+        // Only update parameters that have changed, setValue can be expensive for some plugins
+        for (int parameterIndex {0}; parameterIndex < matrix.parameters.size(); parameterIndex++) {
+            const float paramValue {matrix.parameterValues[parameterIndex]};
+
+            if (paramValue != matrix.lastParameterValues[parameterIndex]) {
+                matrix.parameters[parameterIndex]->setValue(paramValue);
+                matrix.lastParameterValues[parameterIndex] = paramValue;
+            }
+        }
     }
 
     void processBlock(ChainSlotPlugin& slot,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead) {
+                      juce::AudioPlayHead* newPlayHead,
+                      juce::AudioBuffer<float>* spareBuffer,
+                      bool isSleepingEnabled) {
+        // Apply parameter modulation
+        if (!slot.isBypassed && slot.modulationConfig->isActive && updateModulation(slot)) {
+            applyModulation(slot);
+        }
+
+        processBlockWithoutModulation(slot, buffer, midiMessages, newPlayHead, spareBuffer, isSleepingEnabled);
+    }
+
+    void processBlockWithoutModulation(ChainSlotPlugin& slot,
+                                       juce::AudioBuffer<float>& buffer,
+                                       juce::MidiBuffer& midiMessages,
+                                       juce::AudioPlayHead* newPlayHead,
+                                       juce::AudioBuffer<float>* spareBuffer,
+                                       bool isSleepingEnabled) {
         if (newPlayHead != nullptr) {
             slot.plugin->setPlayHead(newPlayHead);
         }
 
+        // Only the first block after a swap is crossfaded, if the slot isn't processing the plugin
+        // for that block there's nothing to fade from
+        const bool isSwapPending {
+            slot.swapCrossfade != nullptr && slot.swapCrossfade->isPending.exchange(false, std::memory_order_relaxed)
+        };
+
         if (!slot.isBypassed) {
-            // Apply parameter modulation
-            if (slot.modulationConfig->isActive) {
-                // TODO we need a faster way of retrieving parameters
-                // Try again to get PluginParameterModulationConfig to hold a pointer to the parameter directly
-                const juce::Array<juce::AudioProcessorParameter*>& parameters = slot.plugin->getParameters();
-                for (const auto parameterConfig : slot.modulationConfig->parameterConfigs) {
-                    for (juce::AudioProcessorParameter* targetParameter : parameters) {
-                        if (targetParameter->getName(PluginParameterModulationConfig::PLUGIN_PARAMETER_NAME_LENGTH_LIMIT) == parameterConfig->targetParameterName) {
-                            applyModulationForParamter(slot, targetParameter, parameterConfig);
-                        }
-                    }
+            // The plugin is suspended while its layout is changed, pass the audio through until
+            // that's finished
+            const juce::ScopedTryLock callbackLock(slot.plugin->getCallbackLock());
+            if (!callbackLock.isLocked() || slot.plugin->isSuspended()) {
+                processSuspended(slot, buffer);
+                return;
+            }
+
+            if (slot.suspendedPassthrough != nullptr) {
+                slot.suspendedPassthrough->isActive = false;
+            }
+
+            if (updateIsSleeping(slot, buffer, midiMessages, isSleepingEnabled)) {
+                // The input is silent and so would the output be, skip the plugin
+                const int numOutputChannels {std::min(buffer.getNumChannels(), slot.plugin->getMainBusNumOutputChannels())};
+                for (int channelIndex {0}; channelIndex < numOutputChannels; channelIndex++) {
+                    juce::FloatVectorOperations::fill(buffer.getWritePointer(channelIndex), 0, buffer.getNumSamples());
                 }
+
+                return;
             }
 
+            const bool isCrossfading {isSwapPending && processReplacedPlugin(slot, buffer)};
+
             const int numPluginInputs {getTotalNumInputChannels(slot.plugin->getBusesLayout())};
 
+            // AUs always require a sidechain input, but if Syndicate is loaded as a VST3 it might not
+            // have one, as VST3s don't require a sidechain input. So we use the spare buffer to provide
+            // an empty sidechain for AUs if needed.
             const bool useSpareSidechainBuffer = {
-                buffer.getNumChannels() < numPluginInputs && slot.spareSCBuffer->getNumChannels() == numPluginInputs
+                buffer.getNumChannels() < numPluginInputs
+                && spareBuffer != nullptr
+                && spareBuffer->getNumChannels() >= numPluginInputs
+                && spareBuffer->getNumSamples() >= buffer.getNumSamples()
+                && numPluginInputs <= MAX_NUM_PADDED_CHANNELS
             };
 
             if (useSpareSidechainBuffer) {
-                // Copy from the real input buffer into our buffer with the correct number of channels
+                // Point the plugin at the real input channels, and at channels of the spare buffer for
+                // the rest. Nothing is copied, but the spare channels are cleared each time as another
+                // plugin may have written to them.
+                std::array<float*, MAX_NUM_PADDED_CHANNELS> channels;
+
                 for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
-                    slot.spareSCBuffer->copyFrom(channelIndex, 0, buffer, channelIndex, 0, buffer.getNumSamples());
+                    channels[channelIndex] = buffer.getWritePointer(channelIndex);
                 }
 
-                // Do processing
-                slot.plugin->processBlock(*slot.spareSCBuffer, midiMessages);
-
-                // Copy back to the real buffer
-                for (int channelIndex {0}; channelIndex < buffer.getNumChannels(); channelIndex++) {
-                    buffer.copyFrom(channelIndex, 0, *slot.spareSCBuffer, channelIndex, 0, buffer.getNumSamples());
+                for (int channelIndex {buffer.getNumChannels()}; channelIndex < numPluginInputs; channelIndex++) {
+                    spareBuffer->clear(channelIndex, 0, buffer.getNumSamples());
+                    channels[channelIndex] = spareBuffer->getWritePointer(channelIndex);
                 }
+
+                // Do processing
+                juce::AudioBuffer<float> paddedBuffer(channels.data(), numPluginInputs, buffer.getNumSamples());
+                slot.plugin->processBlock(paddedBuffer, midiMessages);
             } else {
                 // Do processing
                 slot.plugin->processBlock(buffer, midiMessages);
             }
+
+            if (isCrossfading) {
+                applySwapCrossfade(slot, buffer);
+            }
         }
     }
+
+    bool isSleeping(const ChainSlotPlugin& slot) {
+        return slot.tailLengthSamples >= 0
+            && slot.numSilentSamples.load(std::memory_order_relaxed) >= slot.tailLengthSamples + slot.plugin->getLatencySamples();
+    }
 }
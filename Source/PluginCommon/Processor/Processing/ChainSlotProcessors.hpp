@@ -12,8 +12,45 @@ namespace ChainProcessors {
     void prepareToPlay(ChainSlotPlugin& slot, HostConfiguration config);
     void releaseResources(ChainSlotPlugin& slot);
     void reset(ChainSlotPlugin& slot);
+
+    /**
+     * spareBuffer is used to provide a sidechain to plugins that need one when the buffer doesn't
+     * have one. It's borrowed by the chain from the scratch arena.
+     *
+     * The plugin is only put to sleep while its input is silent if isSleepingEnabled is true.
+     */
     void processBlock(ChainSlotPlugin& slot,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead);
+                      juce::AudioPlayHead* newPlayHead,
+                      juce::AudioBuffer<float>* spareBuffer = nullptr,
+                      bool isSleepingEnabled = false);
+
+    /**
+     * Calculates the modulated parameter values at the current modulation read position. Returns
+     * true if any of them differ from the values last sent to the plugin.
+     */
+    bool updateModulation(ChainSlotPlugin& slot);
+
+    /**
+     * Sends the values calculated by updateModulation() to the plugin.
+     */
+    void applyModulation(ChainSlotPlugin& slot);
+
+    /**
+     * Processes the plugin with whatever parameter values it already has. Used when the chain is
+     * applying the modulation itself.
+     */
+    void processBlockWithoutModulation(ChainSlotPlugin& slot,
+                                       juce::AudioBuffer<float>& buffer,
+                                       juce::MidiBuffer& midiMessages,
+                                       juce::AudioPlayHead* newPlayHead,
+                                       juce::AudioBuffer<float>* spareBuffer = nullptr,
+                                       bool isSleepingEnabled = false);
+
+    /**
+     * True if the plugin's input has been silent for longer than its latency and tail, so it's
+     * being skipped.
+     */
+    bool isSleeping(const ChainSlotPlugin& slot);
 }
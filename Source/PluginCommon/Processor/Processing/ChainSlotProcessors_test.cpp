@@ -2,6 +2,7 @@
 #include "TestUtils.hpp"
 
 #include "ChainSlotProcessors.hpp"
+#include "PlaceholderPluginInstance.hpp"
 
 namespace {
     constexpr int NUM_SAMPLES {64};
@@ -50,6 +51,35 @@ namespace {
             addHostedParameter(std::make_unique<PluginParameter>("param3"));
         }
     };
+
+    /**
+     * Evaluates the slot's modulation config one parameter at a time, as it was done before being
+     * compiled into a matrix. Returns the value each of the plugin's parameters should have.
+     */
+    std::vector<float> evaluateModulationPerParameter(const ChainSlotPlugin& slot) {
+        const juce::Array<juce::AudioProcessorParameter*>& parameters = slot.plugin->getParameters();
+
+        std::vector<float> retVal;
+        for (juce::AudioProcessorParameter* parameter : parameters) {
+            retVal.push_back(parameter->getValue());
+        }
+
+        for (const std::shared_ptr<PluginParameterModulationConfig>& parameterConfig : slot.modulationConfig->parameterConfigs) {
+            for (int parameterIndex {0}; parameterIndex < parameters.size(); parameterIndex++) {
+                if (parameters[parameterIndex]->getName(PluginParameterModulationConfig::PLUGIN_PARAMETER_NAME_LENGTH_LIMIT) == parameterConfig->targetParameterName) {
+                    float paramValue {parameterConfig->restValue};
+
+                    for (const std::shared_ptr<PluginParameterModulationSource>& source : parameterConfig->sources) {
+                        paramValue += slot.getModulationValueCallback(source->definition.id, source->definition.type) * source->modulationAmount;
+                    }
+
+                    retVal[parameterIndex] = juce::jlimit(0.0f, 1.0f, paramValue);
+                }
+            }
+        }
+
+        return retVal;
+    }
 }
 
 SCENARIO("ChainProcessors: Gain stage silence in = silence out") {
@@ -399,6 +429,13 @@ SCENARIO("ChainProcessors: Spare SC buffer is used when plugin is expecting a si
             CHECK(buffer.getNumChannels() == 4);
             CHECK(buffer.getNumSamples() == 64);
 
+            // The sidechain should be silent
+            for (int channelIdx {2}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                for (int sampleIdx {0}; sampleIdx < buffer.getNumSamples(); sampleIdx++) {
+                    CHECK(buffer.getReadPointer(channelIdx)[sampleIdx] == 0);
+                }
+            }
+
             juce::FloatVectorOperations::fill(buffer.getWritePointer(0), 0.1, buffer.getNumSamples());
             juce::FloatVectorOperations::fill(buffer.getWritePointer(1), 0.2, buffer.getNumSamples());
         };
@@ -411,13 +448,19 @@ SCENARIO("ChainProcessors: Spare SC buffer is used when plugin is expecting a si
         REQUIRE(plugin->setBusesLayout(pluginLayout));
 
         ChainSlotPlugin slot(plugin, false, [](int id, MODULATION_TYPE type) { return 0.0f; }, hostConfig);
-        REQUIRE(slot.spareSCBuffer->getNumChannels() == 4);
+
+        // Fill the spare buffer with something other than silence, as a previous plugin may have
+        // left data in it
+        juce::AudioBuffer<float> spareBuffer(4, NUM_SAMPLES);
+        for (int channelIdx {0}; channelIdx < spareBuffer.getNumChannels(); channelIdx++) {
+            juce::FloatVectorOperations::fill(spareBuffer.getWritePointer(channelIdx), 0.5, spareBuffer.getNumSamples());
+        }
 
         WHEN("The buffer is processed") {
             juce::MidiBuffer midiBuffer;
 
             ChainProcessors::prepareToPlay(slot, {hostConfig.layout, SAMPLE_RATE, NUM_SAMPLES});
-            ChainProcessors::processBlock(slot, buffer, midiBuffer, nullptr);
+            ChainProcessors::processBlock(slot, buffer, midiBuffer, nullptr, &spareBuffer);
 
             THEN("The buffer is processed and modulation is applied correctly") {
                 CHECK(didCallProcess);
@@ -435,3 +478,281 @@ SCENARIO("ChainProcessors: Spare SC buffer is used when plugin is expecting a si
         }
     }
 }
+
+SCENARIO("ChainProcessors: Compiled modulation matrix matches evaluating each parameter config") {
+    GIVEN("A plugin with sources shared between parameters, a missing target and values that need clamping") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = 44100;
+        hostConfig.blockSize = 10;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        std::shared_ptr<ProcessorTestPluginInstance> plugin(ProcessorTestPluginInstance::create());
+        plugin->onProcess = [](juce::AudioBuffer<float>&, juce::MidiBuffer&) { };
+
+        // Changed between blocks to simulate the sources moving
+        float macroValue {0.1f};
+        float lfoValue {0.2f};
+        float envelopeValue {0.3f};
+
+        ChainSlotPlugin slot(plugin,
+                             false,
+                             [&](int id, MODULATION_TYPE type) {
+            if (type == MODULATION_TYPE::MACRO) {
+                return macroValue;
+            } else if (type == MODULATION_TYPE::LFO) {
+                return lfoValue;
+            }
+
+            return envelopeValue;
+        },
+        hostConfig);
+
+        auto addParameterConfig = [&slot](juce::String name, float restValue) {
+            slot.modulationConfig->parameterConfigs.push_back(std::make_shared<PluginParameterModulationConfig>());
+            slot.modulationConfig->parameterConfigs.back()->targetParameterName = name;
+            slot.modulationConfig->parameterConfigs.back()->restValue = restValue;
+        };
+
+        auto addSource = [&slot](ModulationSourceDefinition definition, float amount) {
+            slot.modulationConfig->parameterConfigs.back()->sources.push_back(
+                std::make_shared<PluginParameterModulationSource>(definition, amount));
+        };
+
+        slot.modulationConfig->isActive = true;
+
+        addParameterConfig("param1", 0.4f);
+        addSource(ModulationSourceDefinition(1, MODULATION_TYPE::MACRO), 0.5f);
+        addSource(ModulationSourceDefinition(2, MODULATION_TYPE::LFO), -0.3f);
+
+        addParameterConfig("notAParam", 0.5f);
+        addSource(ModulationSourceDefinition(1, MODULATION_TYPE::MACRO), 0.5f);
+
+        addParameterConfig("param2", 0.9f);
+        addSource(ModulationSourceDefinition(1, MODULATION_TYPE::MACRO), 0.8f);
+        addSource(ModulationSourceDefinition(3, MODULATION_TYPE::ENVELOPE), 0.2f);
+
+        addParameterConfig("param3", 0.1f);
+
+        ChainProcessors::prepareToPlay(slot, {hostConfig.layout, SAMPLE_RATE, NUM_SAMPLES});
+
+        auto processAndCheck = [&](ChainSlotPlugin& slotToProcess) {
+            const std::vector<float> sourceValues {0.0f, 0.25f, 0.5f, 1.0f, -1.0f};
+
+            for (const float sourceValue : sourceValues) {
+                macroValue = sourceValue;
+                lfoValue = 1.0f - sourceValue;
+                envelopeValue = sourceValue / 2;
+
+                const std::vector<float> expectedValues = evaluateModulationPerParameter(slotToProcess);
+
+                juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                buffer.clear();
+                juce::MidiBuffer midiBuffer;
+                ChainProcessors::processBlock(slotToProcess, buffer, midiBuffer, nullptr);
+
+                for (int parameterIdx {0}; parameterIdx < expectedValues.size(); parameterIdx++) {
+                    CHECK(plugin->getHostedParameter(parameterIdx)->getValue() == Approx(expectedValues[parameterIdx]));
+                }
+            }
+        };
+
+        WHEN("Blocks are processed with different source values") {
+            THEN("The parameters have the same values as evaluating each config") {
+                processAndCheck(slot);
+            }
+        }
+
+        WHEN("The rest values and amounts are updated in place") {
+            slot.modulationConfig->parameterConfigs[0]->restValue = 0.7f;
+            slot.modulationConfig->parameterConfigs[0]->sources[1]->modulationAmount = 0.6f;
+            slot.modulationConfig->parameterConfigs[2]->sources[0]->modulationAmount = -0.9f;
+            REQUIRE(slot.modulationMatrix.updateValues(*slot.modulationConfig));
+
+            THEN("The parameters have the same values as evaluating each config") {
+                processAndCheck(slot);
+            }
+        }
+
+        WHEN("The slot is cloned") {
+            std::unique_ptr<ChainSlotPlugin> clonedSlot(slot.clone());
+
+            THEN("The cloned matrix has the same structure") {
+                CHECK(clonedSlot->modulationMatrix.parameters == slot.modulationMatrix.parameters);
+                CHECK(clonedSlot->modulationMatrix.connectionSourceIndices == slot.modulationMatrix.connectionSourceIndices);
+            }
+
+            AND_THEN("The parameters have the same values as evaluating each config") {
+                processAndCheck(*clonedSlot);
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: Suspended plugin passes audio through delayed by its latency") {
+    GIVEN("A plugin with latency that's suspended") {
+        constexpr int LATENCY {5};
+        constexpr int BLOCK_SIZE {4};
+
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = BLOCK_SIZE;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        std::shared_ptr<ProcessorTestPluginInstance> plugin(ProcessorTestPluginInstance::create());
+        plugin->onProcess = [](juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+            // This should never be called while suspended
+            CHECK(false);
+        };
+        plugin->setLatencySamples(LATENCY);
+
+        ChainSlotPlugin slot(plugin,
+                             false,
+                             [](int, MODULATION_TYPE) { return 0.0f; },
+                             hostConfig);
+
+        ChainProcessors::prepareToPlay(slot, hostConfig);
+        plugin->suspendProcessing(true);
+
+        WHEN("Several blocks are processed") {
+            juce::MidiBuffer midiBuffer;
+            std::vector<float> output;
+
+            for (int blockIdx {0}; blockIdx < 4; blockIdx++) {
+                juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+                for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                    const float value {static_cast<float>(blockIdx * BLOCK_SIZE + sampleIdx + 1)};
+                    buffer.setSample(0, sampleIdx, value);
+                    buffer.setSample(1, sampleIdx, -value);
+                }
+
+                ChainProcessors::processBlock(slot, buffer, midiBuffer, nullptr);
+
+                for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                    CHECK(buffer.getSample(1, sampleIdx) == -buffer.getSample(0, sampleIdx));
+                    output.push_back(buffer.getSample(0, sampleIdx));
+                }
+            }
+
+            THEN("The input comes out after the plugin's latency, with silence before it") {
+                for (int sampleIdx {0}; sampleIdx < output.size(); sampleIdx++) {
+                    const float expected {sampleIdx < LATENCY ? 0.0f : static_cast<float>(sampleIdx - LATENCY + 1)};
+                    CHECK(output[sampleIdx] == expected);
+                }
+            }
+        }
+
+        plugin->suspendProcessing(false);
+    }
+}
+
+SCENARIO("ChainProcessors: Placeholder delays audio by the latency of the plugin it stands in for") {
+    GIVEN("A placeholder with latency") {
+        constexpr int LATENCY {5};
+        constexpr int BLOCK_SIZE {4};
+
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = BLOCK_SIZE;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        juce::PluginDescription description;
+        description.name = "TestPlugin";
+        auto placeholder = std::make_shared<PlaceholderPluginInstance>(description);
+        placeholder->setExpectedLatency(LATENCY);
+
+        ChainSlotPlugin slot(placeholder,
+                             false,
+                             [](int, MODULATION_TYPE) { return 0.0f; },
+                             hostConfig);
+
+        ChainProcessors::prepareToPlay(slot, hostConfig);
+
+        WHEN("Several blocks are processed") {
+            juce::MidiBuffer midiBuffer;
+            std::vector<float> output;
+
+            for (int blockIdx {0}; blockIdx < 4; blockIdx++) {
+                juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+                for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                    const float value {static_cast<float>(blockIdx * BLOCK_SIZE + sampleIdx + 1)};
+                    buffer.setSample(0, sampleIdx, value);
+                    buffer.setSample(1, sampleIdx, -value);
+                }
+
+                ChainProcessors::processBlock(slot, buffer, midiBuffer, nullptr);
+
+                for (int sampleIdx {0}; sampleIdx < BLOCK_SIZE; sampleIdx++) {
+                    CHECK(buffer.getSample(1, sampleIdx) == -buffer.getSample(0, sampleIdx));
+                    output.push_back(buffer.getSample(0, sampleIdx));
+                }
+            }
+
+            THEN("The input comes out after the latency, with silence before it") {
+                for (int sampleIdx {0}; sampleIdx < output.size(); sampleIdx++) {
+                    const float expected {sampleIdx < LATENCY ? 0.0f : static_cast<float>(sampleIdx - LATENCY + 1)};
+                    CHECK(output[sampleIdx] == expected);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("ChainProcessors: A swapped in plugin is crossfaded from the plugin it replaced") {
+    GIVEN("A slot whose placeholder has just been replaced by a plugin that outputs silence") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        juce::PluginDescription description;
+        description.name = "TestPlugin";
+        auto placeholder = std::make_shared<PlaceholderPluginInstance>(description);
+        placeholder->prepareToPlay(SAMPLE_RATE, NUM_SAMPLES);
+
+        std::shared_ptr<ProcessorTestPluginInstance> plugin(ProcessorTestPluginInstance::create());
+        plugin->onProcess = [](juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+            buffer.clear();
+        };
+
+        ChainSlotPlugin slot(plugin,
+                             false,
+                             [](int, MODULATION_TYPE) { return 0.0f; },
+                             hostConfig);
+
+        ChainProcessors::prepareToPlay(slot, hostConfig);
+        slot.swapCrossfade = std::make_shared<PluginSwapCrossfade>(placeholder, 2, NUM_SAMPLES);
+
+        WHEN("Two blocks are processed") {
+            juce::MidiBuffer midiBuffer;
+            juce::AudioBuffer<float> firstBuffer(2, NUM_SAMPLES);
+            juce::AudioBuffer<float> secondBuffer(2, NUM_SAMPLES);
+
+            for (juce::AudioBuffer<float>* buffer : {&firstBuffer, &secondBuffer}) {
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    juce::FloatVectorOperations::fill(buffer->getWritePointer(channelIdx), 1, NUM_SAMPLES);
+                }
+
+                ChainProcessors::processBlock(slot, *buffer, midiBuffer, nullptr);
+            }
+
+            THEN("The first block fades from the placeholder's output to the plugin's") {
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        const float expected {1.0f - static_cast<float>(sampleIdx) / NUM_SAMPLES};
+                        CHECK(firstBuffer.getSample(channelIdx, sampleIdx) == Approx(expected).margin(0.0001));
+                    }
+                }
+
+                CHECK_FALSE(slot.swapCrossfade->isPending);
+            }
+
+            AND_THEN("The second block is only the plugin's output") {
+                CHECK(secondBuffer.getMagnitude(0, NUM_SAMPLES) == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,285 @@
+#include "ChainWorkerPool.hpp"
+
+#include "ChainProcessors.hpp"
+
+namespace {
+    constexpr juce::uint32 TASKS_CLOSED {0xFFFFFFFF};
+    constexpr int WORKER_WAIT_TIMEOUT_MS {100};
+
+    // How long a worker keeps polling for the next block before it sleeps. Long enough to cover the
+    // gap between blocks at large buffer sizes, so workers only sleep once the host stops processing
+    constexpr double WORKER_POLL_TIMEOUT_MS {50};
+
+    // Number of times a thread checks for new work or completed tasks before it starts yielding.
+    // Chains usually finish close together so this catches most blocks without a context switch,
+    // but keeps a slow chain from spinning a core for the whole time it runs
+    constexpr int MAX_SPIN_ITERATIONS {256};
+
+    juce::uint64 packWork(juce::uint32 generation, juce::uint32 taskIndex) {
+        return (static_cast<juce::uint64>(generation) << 32) | taskIndex;
+    }
+
+    juce::uint32 getWorkGeneration(juce::uint64 work) {
+        return static_cast<juce::uint32>(work >> 32);
+    }
+
+    juce::uint32 getWorkTaskIndex(juce::uint64 work) {
+        return static_cast<juce::uint32>(work & 0xFFFFFFFF);
+    }
+}
+
+ChainWorkerPool::Worker::Worker(ChainWorkerPool& pool, int index)
+        : juce::Thread("Chain Worker " + juce::String(index)), _pool(pool), _isSleeping(false) {
+}
+
+ChainWorkerPool::Worker::~Worker() {
+    signalThreadShouldExit();
+    _wakeEvent.signal();
+    stopThread(1000);
+}
+
+void ChainWorkerPool::Worker::run() {
+    // Guest plugins expect the same floating point environment as the audio thread
+    juce::ScopedNoDenormals noDenormals;
+
+    juce::uint32 lastGeneration {0};
+
+    while (!threadShouldExit()) {
+        const juce::uint32 generation {_pool._getGeneration()};
+
+        if (generation != lastGeneration) {
+            lastGeneration = generation;
+            while (_pool._processNextTask(generation)) {
+                // Keep taking tasks until there are none left for this block
+            }
+        }
+
+        if (!_waitForNextGeneration(lastGeneration)) {
+            // The host has stopped processing, sleep until run() wakes us
+            _isSleeping.store(true, std::memory_order_seq_cst);
+
+            // Check again in case a block was published before the flag was seen
+            if (_pool._getGeneration() == lastGeneration) {
+                _wakeEvent.wait(WORKER_WAIT_TIMEOUT_MS);
+            }
+
+            _isSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ChainWorkerPool::Worker::wakeIfSleeping() {
+    if (_isSleeping.load(std::memory_order_seq_cst)) {
+        _wakeEvent.signal();
+    }
+}
+
+bool ChainWorkerPool::Worker::_waitForNextGeneration(juce::uint32 lastGeneration) {
+    const double startTime {juce::Time::getMillisecondCounterHiRes()};
+    int iteration {0};
+
+    while (!threadShouldExit()) {
+        if (_pool._getGeneration() != lastGeneration) {
+            return true;
+        }
+
+        if (iteration < MAX_SPIN_ITERATIONS) {
+            iteration++;
+        } else if (juce::Time::getMillisecondCounterHiRes() - startTime < WORKER_POLL_TIMEOUT_MS) {
+            juce::Thread::yield();
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ChainWorkerPool::ChainWorkerPool(int numWorkers) :
+        _work(packWork(0, TASKS_CLOSED)),
+        _numTasksInBlock(0),
+        _numTasksRemaining(0),
+        _generation(0),
+        _numTasksAllocated(0),
+        _numChannels(0),
+        _blockSize(0) {
+    _addTasks(DEFAULT_NUM_TASKS);
+
+    for (int index {0}; index < std::min(numWorkers, MAX_NUM_WORKERS); index++) {
+        _workers.push_back(std::make_unique<Worker>(*this, index));
+
+        if (!_workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{})) {
+            juce::Logger::writeToLog("ChainWorkerPool: Couldn't start real time worker, using highest priority");
+            _workers.back()->startThread(juce::Thread::Priority::highest);
+        }
+    }
+
+    juce::Logger::writeToLog("ChainWorkerPool: Started " + juce::String(_workers.size()) + " workers");
+}
+
+ChainWorkerPool::~ChainWorkerPool() {
+    // Stop the workers before the tasks they might be reading are destroyed
+    _workers.clear();
+}
+
+void ChainWorkerPool::prepare(int numChannels, int blockSize, int numTasks) {
+    _numChannels = numChannels;
+    _blockSize = blockSize;
+
+    for (int index {0}; index < _numTasksAllocated.load(std::memory_order_relaxed); index++) {
+        _tasks[index]->scratchBuffer.setSize(_numChannels, _blockSize);
+    }
+
+    ensureCapacity(numTasks);
+}
+
+void ChainWorkerPool::ensureCapacity(int numTasks) {
+    const int numTasksAllocated {_numTasksAllocated.load(std::memory_order_relaxed)};
+    const int numTasksNeeded {std::min(numTasks, MAX_NUM_TASKS)};
+
+    if (numTasksNeeded > numTasksAllocated) {
+        _addTasks(numTasksNeeded - numTasksAllocated);
+    }
+}
+
+bool ChainWorkerPool::canRun(int numTasks, int numChannels, int numSamples) const {
+    return numTasks <= _numTasksAllocated.load(std::memory_order_acquire) && numChannels <= _numChannels && numSamples <= _blockSize;
+}
+
+juce::AudioBuffer<float>& ChainWorkerPool::getScratchBuffer(int taskIndex, int numSamples) {
+    // Crop the scratch buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
+    ChainTask& task = *_tasks[taskIndex];
+    task.bufferView.setDataToReferTo(task.scratchBuffer.getArrayOfWritePointers(), task.scratchBuffer.getNumChannels(), numSamples);
+    return task.bufferView;
+}
+
+void ChainWorkerPool::setTask(int taskIndex,
+                              PluginChain& chain,
+                              juce::AudioBuffer<float>& buffer,
+                              const juce::MidiBuffer& midiMessages,
+                              juce::AudioPlayHead* playHead,
+                              int modulationControlRate,
+                              ScratchArena* scratchArena,
+                              bool isSleepingEnabled) {
+    ChainTask& task = *_tasks[taskIndex];
+    task.chain = &chain;
+    task.stageIndex = -1;
+    task.playHead = playHead;
+    task.modulationControlRate = modulationControlRate;
+    task.scratchArena = scratchArena;
+    task.isSleepingEnabled = isSleepingEnabled;
+
+    if (&buffer != &task.bufferView) {
+        task.bufferView.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), buffer.getNumSamples());
+    }
+
+    task.midiMessages.clear();
+    task.midiMessages.addEvents(midiMessages, 0, -1, 0);
+}
+
+void ChainWorkerPool::setStageTask(int taskIndex,
+                                   PluginChain& chain,
+                                   int stageIndex,
+                                   juce::AudioBuffer<float>& buffer,
+                                   const juce::MidiBuffer& midiMessages,
+                                   juce::AudioPlayHead* playHead,
+                                   int modulationControlRate,
+                                   ScratchArena* scratchArena,
+                                   bool isSleepingEnabled) {
+    setTask(taskIndex, chain, buffer, midiMessages, playHead, modulationControlRate, scratchArena, isSleepingEnabled);
+    _tasks[taskIndex]->stageIndex = stageIndex;
+}
+
+void ChainWorkerPool::run(int numTasks) {
+    if (numTasks <= 0) {
+        return;
+    }
+
+    _generation++;
+    if (_generation == 0) {
+        // Workers start with a generation of 0, so skip it when we wrap around
+        _generation++;
+    }
+
+    _numTasksInBlock.store(numTasks, std::memory_order_relaxed);
+    _numTasksRemaining.store(numTasks, std::memory_order_relaxed);
+    _work.store(packWork(_generation, 0), std::memory_order_seq_cst);
+
+    // This thread will take a task too, so only wake as many workers as we need for the rest. Workers
+    // that are still polling from the last block will see the new work without being woken
+    const int numWorkersToWake {std::min(numTasks - 1, static_cast<int>(_workers.size()))};
+    for (int index {0}; index < numWorkersToWake; index++) {
+        _workers[index]->wakeIfSleeping();
+    }
+
+    while (_processNextTask(_generation)) {
+        // Keep taking tasks until there are none left to claim
+    }
+
+    // Every task has been claimed at this point, so we only need to wait for the ones the workers
+    // are still processing. Spin briefly in case they're almost done, then yield to other threads
+    // rather than blocking on an event, which would cost an OS wake up and could leave the audio
+    // thread waiting on a lower priority thread to signal it
+    int iteration {0};
+    while (_numTasksRemaining.load(std::memory_order_acquire) > 0) {
+        if (iteration < MAX_SPIN_ITERATIONS) {
+            iteration++;
+        } else {
+            juce::Thread::yield();
+        }
+    }
+
+    // Stop any late workers from claiming tasks once we start setting up the next block
+    _work.store(packWork(_generation, TASKS_CLOSED), std::memory_order_release);
+}
+
+int ChainWorkerPool::getDefaultNumWorkers() {
+    // Leave a core for the host's own audio thread
+    return std::max(0, juce::SystemStats::getNumCpus() - 1);
+}
+
+juce::uint32 ChainWorkerPool::_getGeneration() const {
+    return getWorkGeneration(_work.load(std::memory_order_acquire));
+}
+
+bool ChainWorkerPool::_processNextTask(juce::uint32 generation) {
+    juce::uint64 work {_work.load(std::memory_order_acquire)};
+
+    while (true) {
+        if (getWorkGeneration(work) != generation) {
+            return false;
+        }
+
+        const juce::uint32 taskIndex {getWorkTaskIndex(work)};
+        if (taskIndex >= static_cast<juce::uint32>(_numTasksInBlock.load(std::memory_order_relaxed))) {
+            return false;
+        }
+
+        if (_work.compare_exchange_weak(work, work + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            ChainTask& task = *_tasks[taskIndex];
+            if (task.stageIndex < 0) {
+                ChainProcessors::processBlock(*task.chain, task.bufferView, task.midiMessages, task.playHead, task.modulationControlRate, task.scratchArena, nullptr, task.isSleepingEnabled);
+            } else {
+                ChainProcessors::processStage(*task.chain, task.stageIndex, task.bufferView, task.midiMessages, task.playHead, task.modulationControlRate, task.scratchArena, task.isSleepingEnabled);
+            }
+
+            _numTasksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+}
+
+void ChainWorkerPool::_addTasks(int numTasks) {
+    const int firstIndex {_numTasksAllocated.load(std::memory_order_relaxed)};
+    const int lastIndex {std::min(firstIndex + numTasks, MAX_NUM_TASKS)};
+
+    for (int index {firstIndex}; index < lastIndex; index++) {
+        auto task = std::make_unique<ChainTask>();
+        task->scratchBuffer.setSize(_numChannels, _blockSize);
+        task->midiMessages.ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+        _tasks[index] = std::move(task);
+    }
+
+    // The new tasks are fully constructed before the audio thread can see them
+    _numTasksAllocated.store(lastIndex, std::memory_order_release);
+}
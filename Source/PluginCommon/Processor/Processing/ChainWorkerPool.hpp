@@ -0,0 +1,157 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "PluginChain.hpp"
+#include "ScratchArena.hpp"
+
+/**
+ * A pool of worker threads used to process independent plugin chains (or crossover bands) at the
+ * same time within a single block.
+ *
+ * The task graph for a block is a fork/join built by the splitter processors from the structure of
+ * the splitter: the input is split into one task per chain, the tasks are run concurrently, then
+ * the outputs are summed on the calling thread in chain order so the result doesn't depend on which
+ * thread finished first. A pipelined series chain is run the same way with one task per stage.
+ *
+ * All memory is allocated in prepare() and ensureCapacity(). run() doesn't allocate, and the
+ * calling thread takes tasks from the queue too so a block will still complete even if none of the
+ * workers wake up in time. Once the queue is empty the calling thread only waits for the tasks
+ * already being processed, spinning briefly and then yielding, it never blocks on the OS.
+ *
+ * Workers run at real time priority where the OS allows it. After a block they keep polling for the
+ * next one for a while so they don't need to be woken, and only sleep once the host has stopped
+ * calling run(). Sleeping workers are woken with an event.
+ *
+ * Tasks live in a fixed size table and are never moved once created, so ensureCapacity() can be
+ * called from a mutator thread while the audio thread is using the pool.
+ */
+class ChainWorkerPool {
+public:
+    static constexpr int DEFAULT_NUM_TASKS {16};
+    static constexpr int MAX_NUM_TASKS {64};
+    static constexpr int MAX_NUM_WORKERS {7};
+    static constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    struct ChainTask {
+        PluginChain* chain;
+
+        // The stage of a pipelined chain to process, or -1 for the whole chain
+        int stageIndex;
+
+        juce::AudioPlayHead* playHead;
+        int modulationControlRate;
+        ScratchArena* scratchArena;
+        bool isSleepingEnabled;
+
+        // View of the buffer the chain will process, this may refer to the scratch buffer or to a
+        // buffer owned by the splitter
+        juce::AudioBuffer<float> bufferView;
+
+        // Preallocated space owned by this task
+        juce::AudioBuffer<float> scratchBuffer;
+        juce::MidiBuffer midiMessages;
+
+        ChainTask() : chain(nullptr), stageIndex(-1), playHead(nullptr), modulationControlRate(0), scratchArena(nullptr), isSleepingEnabled(false) { }
+    };
+
+    explicit ChainWorkerPool(int numWorkers);
+    ~ChainWorkerPool();
+
+    /**
+     * Allocates the scratch buffers for each task. Must not be called while run() is in progress.
+     */
+    void prepare(int numChannels, int blockSize, int numTasks);
+
+    /**
+     * Adds tasks if needed so that at least numTasks (up to MAX_NUM_TASKS) can be run in one block.
+     * Safe to call while run() is in progress, but not concurrently with itself or prepare().
+     */
+    void ensureCapacity(int numTasks);
+
+    /**
+     * Returns true if numTasks chains with the given buffer size can be run using the preallocated
+     * scratch space.
+     */
+    bool canRun(int numTasks, int numChannels, int numSamples) const;
+
+    juce::AudioBuffer<float>& getScratchBuffer(int taskIndex, int numSamples);
+
+    /**
+     * Sets up a task to process the given buffer. Takes a copy of the MIDI so that chains running
+     * concurrently don't share the same MidiBuffer.
+     */
+    void setTask(int taskIndex,
+                 PluginChain& chain,
+                 juce::AudioBuffer<float>& buffer,
+                 const juce::MidiBuffer& midiMessages,
+                 juce::AudioPlayHead* playHead,
+                 int modulationControlRate = 0,
+                 ScratchArena* scratchArena = nullptr,
+                 bool isSleepingEnabled = false);
+
+    /**
+     * Sets up a task to process a single stage of a pipelined chain, see ChainPipeline.
+     */
+    void setStageTask(int taskIndex,
+                      PluginChain& chain,
+                      int stageIndex,
+                      juce::AudioBuffer<float>& buffer,
+                      const juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* playHead,
+                      int modulationControlRate = 0,
+                      ScratchArena* scratchArena = nullptr,
+                      bool isSleepingEnabled = false);
+
+    const juce::MidiBuffer& getMidiOutput(int taskIndex) const { return _tasks[taskIndex]->midiMessages; }
+
+    /**
+     * Processes tasks 0 to numTasks - 1 and returns once they have all completed.
+     */
+    void run(int numTasks);
+
+    int getNumWorkers() const { return static_cast<int>(_workers.size()); }
+
+    static int getDefaultNumWorkers();
+
+private:
+    class Worker : public juce::Thread {
+    public:
+        Worker(ChainWorkerPool& pool, int index);
+        ~Worker() override;
+
+        /**
+         * Wakes the worker if it is sleeping. Called after the work for a new block is published.
+         */
+        void wakeIfSleeping();
+
+        void run() override;
+
+    private:
+        ChainWorkerPool& _pool;
+        juce::WaitableEvent _wakeEvent;
+        std::atomic<bool> _isSleeping;
+
+        bool _waitForNextGeneration(juce::uint32 lastGeneration);
+    };
+
+    // Upper 32 bits are the generation of the current block, lower 32 bits are the index of the
+    // next task to be claimed
+    std::atomic<juce::uint64> _work;
+    std::atomic<int> _numTasksInBlock;
+    std::atomic<int> _numTasksRemaining;
+    juce::uint32 _generation;
+
+    std::array<std::unique_ptr<ChainTask>, MAX_NUM_TASKS> _tasks;
+    std::atomic<int> _numTasksAllocated;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    int _numChannels;
+    int _blockSize;
+
+    juce::uint32 _getGeneration() const;
+    bool _processNextTask(juce::uint32 generation);
+    void _addTasks(int numTasks);
+
+    JUCE_DECLARE_NON_COPYABLE(ChainWorkerPool)
+};
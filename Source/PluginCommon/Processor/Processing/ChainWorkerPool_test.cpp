@@ -0,0 +1,200 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+#include "SplitterMutators.hpp"
+#include "SplitterProcessors.hpp"
+#include "ChainWorkerPool.hpp"
+#include "XmlConsts.hpp"
+
+namespace {
+    constexpr int NUM_SAMPLES {10};
+    constexpr int SAMPLE_RATE {2000};
+
+    class PoolTestPluginInstance : public TestUtils::TestPluginInstance {
+    public:
+        std::atomic<int> numProcessCalls;
+        float amountToAdd;
+        int processTimeMs;
+
+        PoolTestPluginInstance(float newAmountToAdd, int newProcessTimeMs = 0) :
+                numProcessCalls(0), amountToAdd(newAmountToAdd), processTimeMs(newProcessTimeMs) {}
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override {
+            if (processTimeMs > 0) {
+                juce::Thread::sleep(processTimeMs);
+            }
+
+            numProcessCalls++;
+
+            for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                juce::FloatVectorOperations::add(buffer.getWritePointer(channelIdx), amountToAdd, buffer.getNumSamples());
+            }
+        }
+    };
+
+    std::shared_ptr<PluginSplitter> createSplitter(const juce::String& splitTypeString, HostConfiguration config) {
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        std::shared_ptr<PluginSplitter> splitter;
+
+        if (splitTypeString == XML_SPLIT_TYPE_PARALLEL_STR) {
+            auto splitterParallel = std::make_shared<PluginSplitterParallel>(config, modulationCallback, latencyCallback);
+            SplitterMutators::addChain(splitterParallel);
+            SplitterMutators::addChain(splitterParallel);
+            SplitterMutators::addChain(splitterParallel);
+            splitter = std::dynamic_pointer_cast<PluginSplitter>(splitterParallel);
+        } else if (splitTypeString == XML_SPLIT_TYPE_LEFTRIGHT_STR) {
+            auto splitterLeftRight = std::make_shared<PluginSplitterLeftRight>(config, modulationCallback, latencyCallback);
+            splitter = std::dynamic_pointer_cast<PluginSplitter>(splitterLeftRight);
+        } else if (splitTypeString == XML_SPLIT_TYPE_MIDSIDE_STR) {
+            auto splitterMidSide = std::make_shared<PluginSplitterMidSide>(config, modulationCallback, latencyCallback);
+            splitter = std::dynamic_pointer_cast<PluginSplitter>(splitterMidSide);
+        }
+
+        return splitter;
+    }
+}
+
+SCENARIO("ChainWorkerPool: Processing with a worker pool matches single threaded processing") {
+    GIVEN("Two identical splitters with a plugin on each chain") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        const juce::String splitTypeString = GENERATE(
+            juce::String(XML_SPLIT_TYPE_PARALLEL_STR),
+            juce::String(XML_SPLIT_TYPE_LEFTRIGHT_STR),
+            juce::String(XML_SPLIT_TYPE_MIDSIDE_STR)
+        );
+
+        std::shared_ptr<PluginSplitter> singleThreadedSplitter = createSplitter(splitTypeString, config);
+        std::shared_ptr<PluginSplitter> multiThreadedSplitter = createSplitter(splitTypeString, config);
+
+        std::vector<std::shared_ptr<PoolTestPluginInstance>> multiThreadedPlugins;
+        for (int chainIdx {0}; chainIdx < singleThreadedSplitter->chains.size(); chainIdx++) {
+            const float amountToAdd {0.1f * (chainIdx + 1)};
+            SplitterMutators::insertPlugin(singleThreadedSplitter, std::make_shared<PoolTestPluginInstance>(amountToAdd), chainIdx, 0);
+
+            multiThreadedPlugins.push_back(std::make_shared<PoolTestPluginInstance>(amountToAdd));
+            SplitterMutators::insertPlugin(multiThreadedSplitter, multiThreadedPlugins.back(), chainIdx, 0);
+        }
+
+        ChainWorkerPool workerPool(2);
+        workerPool.prepare(2, NUM_SAMPLES, ChainWorkerPool::DEFAULT_NUM_TASKS);
+
+        WHEN("The same buffer is processed by each") {
+            juce::AudioBuffer<float> singleThreadedBuffer(2, NUM_SAMPLES);
+            juce::AudioBuffer<float> multiThreadedBuffer(2, NUM_SAMPLES);
+
+            for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                juce::FloatVectorOperations::fill(singleThreadedBuffer.getWritePointer(channelIdx), 0.5f + channelIdx, NUM_SAMPLES);
+                juce::FloatVectorOperations::fill(multiThreadedBuffer.getWritePointer(channelIdx), 0.5f + channelIdx, NUM_SAMPLES);
+            }
+
+            juce::MidiBuffer singleThreadedMidi;
+            juce::MidiBuffer multiThreadedMidi;
+
+            SplitterProcessors::prepareToPlay(*singleThreadedSplitter.get(), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+            SplitterProcessors::prepareToPlay(*multiThreadedSplitter.get(), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+            ScratchArena scratchArena;
+            scratchArena.prepare(2, NUM_SAMPLES, SplitterProcessors::getNumScratchBuffersRequired(*singleThreadedSplitter.get()));
+
+            SplitterProcessors::processBlock(*singleThreadedSplitter.get(), singleThreadedBuffer, singleThreadedMidi, nullptr, scratchArena);
+            SplitterProcessors::processBlock(*multiThreadedSplitter.get(), multiThreadedBuffer, multiThreadedMidi, nullptr, scratchArena, &workerPool);
+
+            THEN("The outputs are the same") {
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        CHECK(multiThreadedBuffer.getReadPointer(channelIdx)[sampleIdx] == Approx(singleThreadedBuffer.getReadPointer(channelIdx)[sampleIdx]));
+                    }
+                }
+            }
+
+            AND_THEN("Each chain was processed exactly once") {
+                for (const auto& plugin : multiThreadedPlugins) {
+                    CHECK(plugin->numProcessCalls == 1);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("ChainWorkerPool: canRun checks the preallocated space") {
+    GIVEN("A prepared worker pool") {
+        ChainWorkerPool workerPool(1);
+        workerPool.prepare(2, NUM_SAMPLES, 4);
+
+        THEN("It can run tasks that fit in its scratch buffers") {
+            CHECK(workerPool.canRun(ChainWorkerPool::DEFAULT_NUM_TASKS, 2, NUM_SAMPLES));
+            CHECK(workerPool.canRun(2, 1, NUM_SAMPLES / 2));
+        }
+
+        AND_THEN("It can't run tasks that don't fit") {
+            CHECK_FALSE(workerPool.canRun(ChainWorkerPool::DEFAULT_NUM_TASKS + 1, 2, NUM_SAMPLES));
+            CHECK_FALSE(workerPool.canRun(2, 4, NUM_SAMPLES));
+            CHECK_FALSE(workerPool.canRun(2, 2, NUM_SAMPLES * 2));
+        }
+
+        WHEN("The capacity is increased") {
+            workerPool.ensureCapacity(ChainWorkerPool::DEFAULT_NUM_TASKS + 1);
+
+            THEN("It can run the extra task") {
+                CHECK(workerPool.canRun(ChainWorkerPool::DEFAULT_NUM_TASKS + 1, 2, NUM_SAMPLES));
+            }
+        }
+    }
+}
+
+SCENARIO("ChainWorkerPool: run waits for chains that are still being processed") {
+    GIVEN("A parallel splitter with a slow plugin on each chain") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        std::shared_ptr<PluginSplitter> splitter = createSplitter(XML_SPLIT_TYPE_PARALLEL_STR, config);
+
+        // Long enough that the audio thread has to block rather than spin
+        constexpr int PROCESS_TIME_MS {20};
+
+        std::vector<std::shared_ptr<PoolTestPluginInstance>> plugins;
+        for (int chainIdx {0}; chainIdx < splitter->chains.size(); chainIdx++) {
+            plugins.push_back(std::make_shared<PoolTestPluginInstance>(0.1f, PROCESS_TIME_MS));
+            SplitterMutators::insertPlugin(splitter, plugins.back(), chainIdx, 0);
+        }
+
+        const int numChains {static_cast<int>(splitter->chains.size())};
+        ChainWorkerPool workerPool(numChains);
+        workerPool.prepare(2, NUM_SAMPLES, numChains);
+
+        SplitterProcessors::prepareToPlay(*splitter.get(), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(2, NUM_SAMPLES, SplitterProcessors::getNumScratchBuffersRequired(*splitter.get()));
+
+        WHEN("Several blocks are processed") {
+            constexpr int NUM_BLOCKS {3};
+
+            THEN("Every chain has finished before each block returns") {
+                for (int blockIdx {0}; blockIdx < NUM_BLOCKS; blockIdx++) {
+                    juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                    buffer.clear();
+                    juce::MidiBuffer midiBuffer;
+
+                    SplitterProcessors::processBlock(*splitter.get(), buffer, midiBuffer, nullptr, scratchArena, &workerPool);
+
+                    for (const auto& plugin : plugins) {
+                        CHECK(plugin->numProcessCalls == blockIdx + 1);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -9,18 +9,10 @@ namespace CrossoverProcessors {
             filter->prepare({sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(numFilterChannels)});
         }
 
-        for (std::shared_ptr<CloneableLRFilter<float>>& filter : state.highpassFilters) {
-            filter->prepare({sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(numFilterChannels)});
-        }
-
         for (std::shared_ptr<CloneableLRFilter<float>>& filter : state.allpassFilters) {
             filter->prepare({sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(numFilterChannels)});
         }
 
-        for (juce::AudioBuffer<float>& buffer : state.buffers) {
-            buffer.setSize(getTotalNumInputChannels(layout), samplesPerBlock);
-        }
-
         state.config.sampleRate = sampleRate;
         state.config.blockSize = samplesPerBlock;
         state.config.layout = layout;
@@ -31,76 +23,124 @@ namespace CrossoverProcessors {
             filter->reset();
         }
 
-        for (std::shared_ptr<CloneableLRFilter<float>>& filter : state.highpassFilters) {
-            filter->reset();
-        }
-
         for (std::shared_ptr<CloneableLRFilter<float>>& filter : state.allpassFilters) {
             filter->reset();
         }
-
-        for (juce::AudioBuffer<float>& buffer : state.buffers) {
-            buffer.clear();
-        }
     }
 
-    void processBlock(CrossoverState& state, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
+    void processBlock(CrossoverState& state,
+                      juce::AudioBuffer<float>& buffer,
+                      juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* newPlayHead,
+                      ScratchArena& scratchArena,
+                      ChainWorkerPool* workerPool,
+                      int modulationControlRate,
+                      bool isSleepingEnabled) {
         const int numFilterChannels {canDoStereoSplitTypes(state.config.layout) ? 2 : 1};
-        const size_t numCrossovers {state.bands.size() - 1};
+        const int numCrossovers {static_cast<int>(state.bands.size()) - 1};
+
+        // Bands at the top that have been merged don't need their crossovers splitting
+        const int numMergedBands {state.numBandsSoloed == 0 ? std::clamp(state.numMergedBands, 0, numCrossovers) : 0};
+        const int numSplits {numCrossovers - numMergedBands};
 
-        // First split everything into bands and apply the processing
-        for (int crossoverNumber {0}; crossoverNumber < numCrossovers; crossoverNumber++) {
-            // We need to make a copy of the input buffer before processing
-            // lowBuffer will be lowpassed, highBuffer will be highpassed
+        // Borrow a buffer for each band above the first, the first band is processed in place. They
+        // don't need clearing as each one is overwritten by a copy of the band below it.
+        for (int crossoverNumber {0}; crossoverNumber < numSplits; crossoverNumber++) {
+            state.buffers[crossoverNumber] = scratchArena.borrow(buffer.getNumChannels(), buffer.getNumSamples());
+        }
+
+        // First split everything into bands
+        for (int crossoverNumber {0}; crossoverNumber < numSplits; crossoverNumber++) {
+            // lowBuffer is split in place, keeping the low band and writing the high band to
+            // highBuffer in the same pass
             juce::AudioBuffer<float>& lowBuffer = crossoverNumber == 0 ? buffer : state.buffers[crossoverNumber - 1];
             juce::AudioBuffer<float>& highBuffer = state.buffers[crossoverNumber];
 
-            highBuffer.makeCopyOf(lowBuffer);
+            // The sidechain channels aren't filtered, but each band needs its own copy as its
+            // plugins may write to them
+            for (int channelNumber {numFilterChannels}; channelNumber < lowBuffer.getNumChannels(); channelNumber++) {
+                highBuffer.copyFrom(channelNumber, 0, lowBuffer, channelNumber, 0, lowBuffer.getNumSamples());
+            }
 
-            {
-                juce::dsp::AudioBlock<float> block(juce::dsp::AudioBlock<float>(lowBuffer).getSubsetChannelBlock(0, numFilterChannels));
-                juce::dsp::ProcessContextReplacing context(block);
-                state.lowpassFilters[crossoverNumber]->process(context);
+            state.lowpassFilters[crossoverNumber]->processSplit(lowBuffer.getArrayOfReadPointers(),
+                                                                lowBuffer.getArrayOfWritePointers(),
+                                                                highBuffer.getArrayOfWritePointers(),
+                                                                numFilterChannels,
+                                                                lowBuffer.getNumSamples());
+        }
 
-                // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-                juce::AudioBuffer<float> lowBufferCropped(lowBuffer.getArrayOfWritePointers(), lowBuffer.getNumChannels(), buffer.getNumSamples());
-                ChainProcessors::processBlock(*state.bands[crossoverNumber].chain.get(), lowBufferCropped, midiMessages, newPlayHead);
+        // Then apply the processing - the bands don't depend on each other so can be processed
+        // concurrently if there's a worker pool available
+        const int numBands {numSplits + 1};
+        const bool useWorkerPool {
+            workerPool != nullptr && numBands > 1 && workerPool->canRun(numBands, buffer.getNumChannels(), buffer.getNumSamples())
+        };
+
+        // Each band processes its own copy of the MIDI, the outputs are merged in band order
+        juce::MidiBuffer* bandMidi {useWorkerPool ? nullptr : scratchArena.borrowMidi()};
+        juce::MidiBuffer* mergedMidi {scratchArena.borrowMidi()};
+        ChainProcessors::MidiMergeState mergeState;
+
+        for (int bandNumber {0}; bandNumber < numBands; bandNumber++) {
+            juce::AudioBuffer<float>& bandBuffer = bandNumber == 0 ? buffer : state.buffers[bandNumber - 1];
+
+            if (useWorkerPool) {
+                workerPool->setTask(bandNumber, *state.bands[bandNumber].chain.get(), bandBuffer, midiMessages, newPlayHead, modulationControlRate, &scratchArena, isSleepingEnabled);
+            } else {
+                bandMidi->clear();
+                bandMidi->addEvents(midiMessages, 0, -1, 0);
+                ChainProcessors::processBlock(*state.bands[bandNumber].chain.get(), bandBuffer, *bandMidi, newPlayHead, modulationControlRate, &scratchArena, nullptr, isSleepingEnabled);
+                ChainProcessors::mergeMidiOutput(midiMessages, *bandMidi, mergeState, *mergedMidi);
             }
+        }
 
-            {
-                juce::dsp::AudioBlock<float> block(juce::dsp::AudioBlock<float>(highBuffer).getSubsetChannelBlock(0, numFilterChannels));
-                juce::dsp::ProcessContextReplacing context(block);
-                state.highpassFilters[crossoverNumber]->process(context);
+        if (useWorkerPool) {
+            workerPool->run(numBands);
 
-                // If this is the last band we need to apply the processing
-                if (crossoverNumber + 1 == numCrossovers) {
-                    // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-                    juce::AudioBuffer<float> highBufferCropped(highBuffer.getArrayOfWritePointers(), highBuffer.getNumChannels(), buffer.getNumSamples());
-                    ChainProcessors::processBlock(*state.bands[crossoverNumber + 1].chain.get(), highBufferCropped, midiMessages, newPlayHead);
-                }
+            for (int bandNumber {0}; bandNumber < numBands; bandNumber++) {
+                ChainProcessors::mergeMidiOutput(midiMessages, workerPool->getMidiOutput(bandNumber), mergeState, *mergedMidi);
             }
         }
 
+        midiMessages.clear();
+        midiMessages.addEvents(*mergedMidi, 0, -1, 0);
 
         // Finally add the bands back together
         if (state.numBandsSoloed > 0 && !state.bands[0].isSoloed) {
             buffer.clear();
         }
 
-        for (int crossoverNumber {0}; crossoverNumber < numCrossovers; crossoverNumber++) {
-            // If there is another crossover after this one, we need to use an allpass to rotate the phase of the lower bands
-            if (crossoverNumber + 1 < numCrossovers) {
-                juce::dsp::AudioBlock<float> block(juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, numFilterChannels));
-                juce::dsp::ProcessContextReplacing context(block);
-                state.allpassFilters[crossoverNumber]->process(context);
-
-            }
+        for (int crossoverNumber {0}; crossoverNumber < numSplits; crossoverNumber++) {
+            const bool shouldAddBand {state.numBandsSoloed == 0 || state.bands[crossoverNumber + 1].isSoloed};
 
-            if (state.numBandsSoloed == 0 || state.bands[crossoverNumber + 1].isSoloed) {
+            // If there is another crossover after this one, we need to use an allpass to rotate the phase of the lower bands
+            if (crossoverNumber + 1 < numSplits) {
+                if (shouldAddBand) {
+                    // Rotate and add the next band in the same pass
+                    state.allpassFilters[crossoverNumber]->processAllpassAndAdd(buffer.getArrayOfWritePointers(),
+                                                                                state.buffers[crossoverNumber].getArrayOfReadPointers(),
+                                                                                numFilterChannels,
+                                                                                buffer.getNumSamples());
+                } else {
+                    juce::dsp::AudioBlock<float> block(juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, numFilterChannels));
+                    juce::dsp::ProcessContextReplacing context(block);
+                    state.allpassFilters[crossoverNumber]->process(context);
+                }
+            } else if (shouldAddBand) {
                 for (int channelNumber {0}; channelNumber < numFilterChannels; channelNumber++) {
                     buffer.addFrom(channelNumber, 0, state.buffers[crossoverNumber], channelNumber, 0, buffer.getNumSamples());
                 }
             }
         }
+
+        // Splitting the merged bands and adding them back together would be the same as rotating
+        // them by the allpass of each of their crossovers. The lower bands need the same rotation,
+        // so it's done once to everything.
+        for (int crossoverNumber {numSplits}; crossoverNumber < numCrossovers; crossoverNumber++) {
+            // There's no allpass for the first crossover, but its lowpass isn't being used to
+            // split so can be used as one
+            CloneableLRFilter<float>& allpassFilter = crossoverNumber == 0 ? *state.lowpassFilters[0] : *state.allpassFilters[crossoverNumber - 1];
+            allpassFilter.processAllpass(buffer.getArrayOfWritePointers(), numFilterChannels, buffer.getNumSamples());
+        }
     }
 }
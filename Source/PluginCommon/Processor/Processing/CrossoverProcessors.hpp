@@ -1,9 +1,18 @@
 #pragma once
 
 #include "CrossoverState.hpp"
+#include "ChainWorkerPool.hpp"
+#include "ScratchArena.hpp"
 
 namespace CrossoverProcessors {
     void prepareToPlay(CrossoverState& state, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout);
     void reset(CrossoverState& state);
-    void processBlock(CrossoverState& state, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead);
+    void processBlock(CrossoverState& state,
+                      juce::AudioBuffer<float>& buffer,
+                      juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* newPlayHead,
+                      ScratchArena& scratchArena,
+                      ChainWorkerPool* workerPool = nullptr,
+                      int modulationControlRate = 0,
+                      bool isSleepingEnabled = false);
 }
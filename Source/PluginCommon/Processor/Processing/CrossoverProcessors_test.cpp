@@ -0,0 +1,259 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+
+#include "ChainMutators.hpp"
+#include "CrossoverMutators.hpp"
+#include "CrossoverProcessors.hpp"
+
+namespace {
+    constexpr int NUM_SAMPLES {64};
+    constexpr int SAMPLE_RATE {44100};
+
+    std::shared_ptr<CrossoverState> createCrossover(int numBands, HostConfiguration hostConfig) {
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto crossover = createDefaultCrossoverState(hostConfig);
+        while (crossover->bands.size() < numBands) {
+            CrossoverMutators::addBand(crossover);
+        }
+
+        for (int bandIndex {0}; bandIndex < numBands; bandIndex++) {
+            CrossoverMutators::setPluginChain(crossover, bandIndex, std::make_shared<PluginChain>(modulationCallback));
+        }
+
+        CrossoverProcessors::prepareToPlay(*crossover.get(), SAMPLE_RATE, NUM_SAMPLES, hostConfig.layout);
+        CrossoverProcessors::reset(*crossover.get());
+
+        return crossover;
+    }
+}
+
+SCENARIO("CrossoverProcessors: Bands with empty chains sum to an allpass of the input") {
+    GIVEN("A two band crossover with a sidechain") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        auto crossover = createCrossover(2, hostConfig);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(4, NUM_SAMPLES, ScratchArena::DEFAULT_NUM_BUFFERS);
+
+        // An allpass at the crossover frequency is what the bands should add up to
+        CloneableLRFilter<float> expectedFilter;
+        expectedFilter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+        expectedFilter.prepare({SAMPLE_RATE, NUM_SAMPLES, 2});
+        expectedFilter.setCutoffFrequency(CrossoverMutators::getCrossoverFrequency(crossover, 0));
+
+        WHEN("A block is processed") {
+            juce::AudioBuffer<float> buffer(4, NUM_SAMPLES);
+            for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                    buffer.setSample(channelIdx, sampleIdx, std::sin(0.1f * sampleIdx * (channelIdx + 1)));
+                }
+            }
+
+            juce::AudioBuffer<float> expectedBuffer;
+            expectedBuffer.makeCopyOf(buffer);
+            {
+                juce::dsp::AudioBlock<float> block(juce::dsp::AudioBlock<float>(expectedBuffer).getSubsetChannelBlock(0, 2));
+                juce::dsp::ProcessContextReplacing context(block);
+                expectedFilter.process(context);
+            }
+
+            juce::MidiBuffer midiBuffer;
+            CrossoverProcessors::processBlock(*crossover.get(), buffer, midiBuffer, nullptr, scratchArena);
+
+            THEN("The main channels are the allpassed input and the sidechain is untouched") {
+                for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        CHECK(buffer.getSample(channelIdx, sampleIdx) == Approx(expectedBuffer.getSample(channelIdx, sampleIdx)).margin(0.0001));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("CrossoverProcessors: Empty bands at the top are merged without changing the output") {
+    GIVEN("Two identical four band crossovers") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        constexpr int NUM_BANDS {4};
+        auto mergedCrossover = createCrossover(NUM_BANDS, hostConfig);
+        auto splitCrossover = createCrossover(NUM_BANDS, hostConfig);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(2, NUM_SAMPLES, ScratchArena::DEFAULT_NUM_BUFFERS);
+
+        WHEN("All the bands are empty") {
+            CrossoverMutators::updateMergedBands(mergedCrossover);
+
+            THEN("They're all merged into the first band") {
+                CHECK(mergedCrossover->numMergedBands == NUM_BANDS - 1);
+            }
+        }
+
+        WHEN("Only the lowest band has a plugin") {
+            for (auto crossover : {mergedCrossover, splitCrossover}) {
+                ChainMutators::insertPlugin(crossover->bands[0].chain, std::make_shared<TestUtils::TestPluginInstance>(), 0, hostConfig);
+                CrossoverMutators::updateMergedBands(crossover);
+            }
+
+            THEN("The empty bands above it are merged into one") {
+                CHECK(mergedCrossover->numMergedBands == NUM_BANDS - 2);
+            }
+        }
+
+        WHEN("A band in the middle has a plugin") {
+            for (auto crossover : {mergedCrossover, splitCrossover}) {
+                ChainMutators::insertPlugin(crossover->bands[2].chain, std::make_shared<TestUtils::TestPluginInstance>(), 0, hostConfig);
+                CrossoverMutators::updateMergedBands(crossover);
+            }
+
+            THEN("Only the bands above it can be merged") {
+                CHECK(mergedCrossover->numMergedBands == 0);
+            }
+
+            AND_WHEN("The band is bypassed") {
+                ChainMutators::setChainBypass(mergedCrossover->bands[2].chain, true);
+                CrossoverMutators::updateMergedBands(mergedCrossover);
+
+                THEN("It can be merged") {
+                    CHECK(mergedCrossover->numMergedBands == NUM_BANDS - 1);
+                }
+
+                AND_WHEN("A band is soloed") {
+                    CrossoverMutators::setIsSoloed(mergedCrossover, 1, true);
+
+                    THEN("Nothing is merged") {
+                        CHECK(mergedCrossover->numMergedBands == 0);
+                    }
+                }
+            }
+        }
+
+        WHEN("Several blocks are processed with and without merging") {
+            const int firstActiveBand = GENERATE(-1, 0, 1);
+            for (auto crossover : {mergedCrossover, splitCrossover}) {
+                if (firstActiveBand >= 0) {
+                    ChainMutators::insertPlugin(crossover->bands[firstActiveBand].chain, std::make_shared<TestUtils::TestPluginInstance>(), 0, hostConfig);
+                }
+
+                CrossoverMutators::updateMergedBands(crossover);
+            }
+
+            splitCrossover->numMergedBands = 0;
+            REQUIRE(mergedCrossover->numMergedBands == NUM_BANDS - 2 - firstActiveBand);
+
+            for (int blockIndex {0}; blockIndex < 4; blockIndex++) {
+                juce::AudioBuffer<float> mergedBuffer(2, NUM_SAMPLES);
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        const int time {blockIndex * NUM_SAMPLES + sampleIdx};
+                        mergedBuffer.setSample(channelIdx, sampleIdx, std::sin(0.05f * time * (channelIdx + 1)) + 0.3f * std::sin(0.9f * time));
+                    }
+                }
+
+                juce::AudioBuffer<float> splitBuffer;
+                splitBuffer.makeCopyOf(mergedBuffer);
+
+                juce::MidiBuffer midiBuffer;
+                scratchArena.reset();
+                CrossoverProcessors::processBlock(*mergedCrossover.get(), mergedBuffer, midiBuffer, nullptr, scratchArena);
+                scratchArena.reset();
+                CrossoverProcessors::processBlock(*splitCrossover.get(), splitBuffer, midiBuffer, nullptr, scratchArena);
+
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        CHECK(mergedBuffer.getSample(channelIdx, sampleIdx) == Approx(splitBuffer.getSample(channelIdx, sampleIdx)).margin(0.0001));
+                    }
+                }
+            }
+        }
+
+        WHEN("Blocks are processed split, then the top bands are merged and split again") {
+            ChainMutators::insertPlugin(mergedCrossover->bands[NUM_BANDS - 1].chain, std::make_shared<TestUtils::TestPluginInstance>(), 0, hostConfig);
+            CrossoverMutators::updateMergedBands(mergedCrossover);
+            REQUIRE(mergedCrossover->numMergedBands == 0);
+
+            auto processBlocks = [&]() {
+                for (int blockIndex {0}; blockIndex < 4; blockIndex++) {
+                    juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                    for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                        for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                            buffer.setSample(channelIdx, sampleIdx, std::sin(0.05f * (blockIndex * NUM_SAMPLES + sampleIdx)));
+                        }
+                    }
+
+                    juce::MidiBuffer midiBuffer;
+                    scratchArena.reset();
+                    CrossoverProcessors::processBlock(*mergedCrossover.get(), buffer, midiBuffer, nullptr, scratchArena);
+                }
+            };
+
+            processBlocks();
+
+            ChainMutators::setChainBypass(mergedCrossover->bands[NUM_BANDS - 1].chain, true);
+            CrossoverMutators::updateMergedBands(mergedCrossover);
+            REQUIRE(mergedCrossover->numMergedBands == NUM_BANDS - 1);
+
+            processBlocks();
+
+            ChainMutators::setChainBypass(mergedCrossover->bands[NUM_BANDS - 1].chain, false);
+            CrossoverMutators::updateMergedBands(mergedCrossover);
+            REQUIRE(mergedCrossover->numMergedBands == 0);
+
+            THEN("The filters of the crossovers being split again start from silence") {
+                juce::AudioBuffer<float> silence(2, NUM_SAMPLES);
+                silence.clear();
+                juce::AudioBuffer<float> lowBuffer(2, NUM_SAMPLES);
+                juce::AudioBuffer<float> highBuffer(2, NUM_SAMPLES);
+
+                for (auto& filter : mergedCrossover->lowpassFilters) {
+                    filter->processSplit(silence.getArrayOfReadPointers(),
+                                         lowBuffer.getArrayOfWritePointers(),
+                                         highBuffer.getArrayOfWritePointers(),
+                                         2,
+                                         NUM_SAMPLES);
+
+                    CHECK(lowBuffer.getMagnitude(0, NUM_SAMPLES) == 0);
+                    CHECK(highBuffer.getMagnitude(0, NUM_SAMPLES) == 0);
+                }
+            }
+        }
+    }
+}
+
+// Hidden by default, run with the [benchmark] tag
+SCENARIO("CrossoverProcessors: Cost of splitting and recombining bands", "[.][benchmark]") {
+    GIVEN("A crossover with empty chains") {
+        HostConfiguration hostConfig;
+        hostConfig.sampleRate = SAMPLE_RATE;
+        hostConfig.blockSize = NUM_SAMPLES;
+        hostConfig.layout = TestUtils::createLayoutWithChannels(
+            juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+        const int numBands = GENERATE(2, 4, 8, 16);
+        auto crossover = createCrossover(numBands, hostConfig);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(4, NUM_SAMPLES, numBands);
+
+        juce::AudioBuffer<float> buffer(4, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiBuffer;
+
+        BENCHMARK("processBlock with " + std::to_string(numBands) + " bands") {
+            scratchArena.reset();
+            CrossoverProcessors::processBlock(*crossover.get(), buffer, midiBuffer, nullptr, scratchArena);
+        };
+    }
+}
@@ -0,0 +1,89 @@
+#include "GraphCrossfader.hpp"
+
+GraphCrossfader::GraphCrossfader() :
+        _currentLine(std::make_unique<LatencyCompensationLine>()),
+        _outgoingLine(std::make_unique<LatencyCompensationLine>()),
+        _fadeLength(0),
+        _fadePosition(0) {
+}
+
+void GraphCrossfader::prepare(int numChannels, int maxBlockSize, int maxDelayInSamples) {
+    _outgoingBuffer.setSize(numChannels, maxBlockSize);
+    _outgoingMidi.ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+
+    _currentLine->prepare(numChannels, maxBlockSize, maxDelayInSamples);
+    _outgoingLine->prepare(numChannels, maxBlockSize, maxDelayInSamples);
+
+    reset();
+}
+
+void GraphCrossfader::reset() {
+    _fadeLength = 0;
+    _fadePosition = 0;
+
+    _currentLine->reset();
+    _outgoingLine->reset();
+}
+
+void GraphCrossfader::startFade(int numSamples) {
+    // The outgoing graph keeps the line it's been using
+    std::swap(_currentLine, _outgoingLine);
+    _currentLine->reset();
+
+    _fadeLength = std::max(numSamples, 0);
+    _fadePosition = 0;
+}
+
+bool GraphCrossfader::copyInputForOutgoing(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages) {
+    if (buffer.getNumSamples() > _outgoingBuffer.getNumSamples()) {
+        _fadePosition = _fadeLength;
+        return false;
+    }
+
+    const int numChannels {std::min(buffer.getNumChannels(), _outgoingBuffer.getNumChannels())};
+    for (int channel {0}; channel < numChannels; channel++) {
+        juce::FloatVectorOperations::copy(_outgoingBuffer.getWritePointer(channel), buffer.getReadPointer(channel), buffer.getNumSamples());
+    }
+
+    _outgoingMidi.clear();
+    _outgoingMidi.addEvents(midiMessages, 0, -1, 0);
+
+    return true;
+}
+
+juce::AudioBuffer<float> GraphCrossfader::getOutgoingBuffer(int numSamples) {
+    // Refers to the preallocated memory rather than copying it
+    return juce::AudioBuffer<float>(_outgoingBuffer.getArrayOfWritePointers(), _outgoingBuffer.getNumChannels(), numSamples);
+}
+
+void GraphCrossfader::alignCurrent(juce::AudioBuffer<float>& buffer, int delaySamples) {
+    _currentLine->setDelay(delaySamples);
+    _currentLine->process(buffer);
+}
+
+void GraphCrossfader::alignOutgoing(juce::AudioBuffer<float>& buffer, int delaySamples) {
+    _outgoingLine->setDelay(delaySamples);
+    _outgoingLine->process(buffer);
+}
+
+bool GraphCrossfader::mix(juce::AudioBuffer<float>& buffer) {
+    const int numChannels {std::min(buffer.getNumChannels(), _outgoingBuffer.getNumChannels())};
+    const int numFadeSamples {
+        std::min({buffer.getNumSamples(), _outgoingBuffer.getNumSamples(), _fadeLength - _fadePosition})
+    };
+
+    for (int channel {0}; channel < numChannels; channel++) {
+        float* output {buffer.getWritePointer(channel)};
+        const float* outgoing {_outgoingBuffer.getReadPointer(channel)};
+
+        for (int sampleIndex {0}; sampleIndex < numFadeSamples; sampleIndex++) {
+            // Equal-power, so the level stays constant when the graphs are uncorrelated
+            const float angle {juce::MathConstants<float>::halfPi * (_fadePosition + sampleIndex) / _fadeLength};
+            output[sampleIndex] = output[sampleIndex] * std::sin(angle) + outgoing[sampleIndex] * std::cos(angle);
+        }
+    }
+
+    _fadePosition += std::max(numFadeSamples, 0);
+
+    return !isFading();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatencyCompensationLine.hpp"
+
+/**
+ * Mixes the graph being switched to with the graph being switched away from using an equal-power
+ * crossfade, and delays each of them so they have the same latency.
+ *
+ * Each graph has its own delay line. When a fade starts the current graph's line is handed to the
+ * outgoing graph, so its audio carries on without a jump, and the incoming graph starts with an
+ * empty line.
+ *
+ * Only used by the audio thread, apart from prepare(). Nothing is allocated while processing.
+ */
+class GraphCrossfader {
+public:
+    static constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    GraphCrossfader();
+
+    /**
+     * Allocates the buffers and delay lines. Must not be called while the audio thread is
+     * processing.
+     */
+    void prepare(int numChannels, int maxBlockSize, int maxDelayInSamples);
+
+    /**
+     * Stops any fade and clears the delay lines.
+     */
+    void reset();
+
+    /**
+     * Starts fading to a new current graph over numSamples. A length of 0 switches immediately.
+     */
+    void startFade(int numSamples);
+
+    bool isFading() const { return _fadePosition < _fadeLength; }
+
+    /**
+     * Copies the block's input so the outgoing graph can process it after the current graph has
+     * processed the block in place. Returns false if the block is bigger than prepare() allowed
+     * for, in which case the fade is finished early.
+     */
+    bool copyInputForOutgoing(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages);
+
+    /**
+     * The outgoing graph's copy of the block's audio and MIDI, valid after copyInputForOutgoing().
+     */
+    juce::AudioBuffer<float> getOutgoingBuffer(int numSamples);
+    juce::MidiBuffer& getOutgoingMidi() { return _outgoingMidi; }
+
+    /**
+     * Delays the output of the current and outgoing graphs.
+     */
+    void alignCurrent(juce::AudioBuffer<float>& buffer, int delaySamples);
+    void alignOutgoing(juce::AudioBuffer<float>& buffer, int delaySamples);
+
+    /**
+     * Mixes the outgoing graph's output into the current graph's output in buffer, and advances
+     * the fade. Returns true once the fade has finished.
+     */
+    bool mix(juce::AudioBuffer<float>& buffer);
+
+private:
+    juce::AudioBuffer<float> _outgoingBuffer;
+    juce::MidiBuffer _outgoingMidi;
+
+    std::unique_ptr<LatencyCompensationLine> _currentLine;
+    std::unique_ptr<LatencyCompensationLine> _outgoingLine;
+
+    int _fadeLength;
+    int _fadePosition;
+};
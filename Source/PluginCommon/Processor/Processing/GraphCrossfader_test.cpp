@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "GraphCrossfader.hpp"
+
+namespace {
+    constexpr int NUM_CHANNELS {2};
+    constexpr int BLOCK_SIZE {16};
+
+    juce::AudioBuffer<float> createBuffer(float value, int numSamples = BLOCK_SIZE) {
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, numSamples);
+        for (int channel {0}; channel < NUM_CHANNELS; channel++) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(channel), value, numSamples);
+        }
+
+        return buffer;
+    }
+}
+
+SCENARIO("GraphCrossfader: Fades between the graphs with constant power") {
+    GIVEN("A crossfader fading over two blocks") {
+        GraphCrossfader crossfader;
+        crossfader.prepare(NUM_CHANNELS, BLOCK_SIZE, LatencyCompensationLine::DEFAULT_MAX_DELAY_SAMPLES);
+        crossfader.startFade(2 * BLOCK_SIZE);
+
+        REQUIRE(crossfader.isFading());
+
+        WHEN("The outgoing graph outputs its input and the current graph outputs silence") {
+            std::vector<float> output;
+            std::vector<bool> isFinished;
+
+            for (int blockIndex {0}; blockIndex < 3; blockIndex++) {
+                juce::AudioBuffer<float> buffer = createBuffer(1);
+                REQUIRE(crossfader.copyInputForOutgoing(buffer, juce::MidiBuffer()));
+
+                buffer.clear();
+                isFinished.push_back(crossfader.mix(buffer));
+
+                for (int sampleIndex {0}; sampleIndex < BLOCK_SIZE; sampleIndex++) {
+                    CHECK(buffer.getSample(0, sampleIndex) == buffer.getSample(1, sampleIndex));
+                    output.push_back(buffer.getSample(0, sampleIndex));
+                }
+            }
+
+            THEN("The outgoing graph follows the outgoing half of an equal-power curve") {
+                for (int sampleIndex {0}; sampleIndex < 2 * BLOCK_SIZE; sampleIndex++) {
+                    const float expected {std::cos(juce::MathConstants<float>::halfPi * sampleIndex / (2 * BLOCK_SIZE))};
+                    CHECK(output[sampleIndex] == Approx(expected).margin(0.0001));
+                }
+            }
+
+            THEN("Only the current graph is heard once the fade has finished") {
+                for (int sampleIndex {2 * BLOCK_SIZE}; sampleIndex < 3 * BLOCK_SIZE; sampleIndex++) {
+                    CHECK(output[sampleIndex] == 0.0f);
+                }
+
+                CHECK(isFinished == std::vector<bool>{false, true, true});
+                CHECK_FALSE(crossfader.isFading());
+            }
+        }
+
+        WHEN("Both graphs output the same signal") {
+            juce::AudioBuffer<float> buffer = createBuffer(1);
+            REQUIRE(crossfader.copyInputForOutgoing(buffer, juce::MidiBuffer()));
+            crossfader.mix(buffer);
+
+            THEN("The level rises by up to 3dB in the middle of the fade, as expected for correlated signals") {
+                for (int sampleIndex {0}; sampleIndex < BLOCK_SIZE; sampleIndex++) {
+                    CHECK(buffer.getSample(0, sampleIndex) >= 1.0f - 0.0001f);
+                    CHECK(buffer.getSample(0, sampleIndex) <= std::sqrt(2.0f) + 0.0001f);
+                }
+            }
+        }
+
+        WHEN("A block bigger than the prepared size is given") {
+            const bool isCopied {crossfader.copyInputForOutgoing(createBuffer(1, 2 * BLOCK_SIZE), juce::MidiBuffer())};
+
+            THEN("The fade is finished early") {
+                CHECK_FALSE(isCopied);
+                CHECK_FALSE(crossfader.isFading());
+            }
+        }
+    }
+
+    GIVEN("A crossfader starting a fade with no length") {
+        GraphCrossfader crossfader;
+        crossfader.prepare(NUM_CHANNELS, BLOCK_SIZE, LatencyCompensationLine::DEFAULT_MAX_DELAY_SAMPLES);
+        crossfader.startFade(0);
+
+        THEN("It switches immediately") {
+            CHECK_FALSE(crossfader.isFading());
+        }
+    }
+}
+
+SCENARIO("GraphCrossfader: The outgoing graph keeps its delay line") {
+    GIVEN("A crossfader delaying the current graph") {
+        constexpr int DELAY {3};
+
+        GraphCrossfader crossfader;
+        crossfader.prepare(NUM_CHANNELS, BLOCK_SIZE, LatencyCompensationLine::DEFAULT_MAX_DELAY_SAMPLES);
+
+        juce::AudioBuffer<float> firstBuffer = createBuffer(1);
+        crossfader.alignCurrent(firstBuffer, DELAY);
+
+        WHEN("A fade starts and the outgoing graph's next block is aligned") {
+            crossfader.startFade(BLOCK_SIZE);
+
+            juce::AudioBuffer<float> outgoingBuffer = createBuffer(2);
+            crossfader.alignOutgoing(outgoingBuffer, DELAY);
+
+            juce::AudioBuffer<float> currentBuffer = createBuffer(5);
+            crossfader.alignCurrent(currentBuffer, DELAY);
+
+            THEN("The outgoing graph carries on from its previous block") {
+                for (int sampleIndex {0}; sampleIndex < BLOCK_SIZE; sampleIndex++) {
+                    CHECK(outgoingBuffer.getSample(0, sampleIndex) == (sampleIndex < DELAY ? 1.0f : 2.0f));
+                }
+            }
+
+            THEN("The current graph starts from silence") {
+                for (int sampleIndex {0}; sampleIndex < BLOCK_SIZE; sampleIndex++) {
+                    CHECK(currentBuffer.getSample(0, sampleIndex) == (sampleIndex < DELAY ? 0.0f : 5.0f));
+                }
+            }
+        }
+    }
+}
@@ -3,61 +3,296 @@
 #include "WEFilters/PerlinSource.hpp"
 #include "WEFilters/StepSequencer.h"
 
+#include <optional>
+
 namespace Mi = ModelInterface;
 
-namespace ModulationProcessors {
-    void prepareToPlay(Mi::ModulationSourcesState& state, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
-        state.hostConfig.sampleRate = sampleRate;
-        state.hostConfig.blockSize = samplesPerBlock;
-        state.hostConfig.layout = layout;
+namespace {
+    /**
+     * Finds the strongly connected components of a graph using Tarjan's algorithm. Components are
+     * found in reverse topological order.
+     */
+    class ComponentFinder {
+    public:
+        std::vector<std::vector<int>> components;
 
-        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
-            lfo->setSampleRate(sampleRate);
+        explicit ComponentFinder(const std::vector<std::vector<int>>& edges) :
+                _edges(edges),
+                _nextIndex(0),
+                _indices(edges.size(), -1),
+                _lowLinks(edges.size(), 0),
+                _isOnStack(edges.size(), false) {
+            for (int nodeIndex {0}; nodeIndex < _edges.size(); nodeIndex++) {
+                if (_indices[nodeIndex] == -1) {
+                    _visit(nodeIndex);
+                }
+            }
         }
 
-        for (std::shared_ptr<Mi::EnvelopeWrapper>& env : state.envelopes) {
-            env->envelope->setSampleRate(sampleRate);
+    private:
+        const std::vector<std::vector<int>>& _edges;
+        int _nextIndex;
+        std::vector<int> _indices;
+        std::vector<int> _lowLinks;
+        std::vector<bool> _isOnStack;
+        std::vector<int> _stack;
+
+        void _visit(int nodeIndex) {
+            _indices[nodeIndex] = _nextIndex;
+            _lowLinks[nodeIndex] = _nextIndex;
+            _nextIndex++;
+            _stack.push_back(nodeIndex);
+            _isOnStack[nodeIndex] = true;
+
+            for (int nextNodeIndex : _edges[nodeIndex]) {
+                if (_indices[nextNodeIndex] == -1) {
+                    _visit(nextNodeIndex);
+                    _lowLinks[nodeIndex] = std::min(_lowLinks[nodeIndex], _lowLinks[nextNodeIndex]);
+                } else if (_isOnStack[nextNodeIndex]) {
+                    _lowLinks[nodeIndex] = std::min(_lowLinks[nodeIndex], _indices[nextNodeIndex]);
+                }
+            }
+
+            if (_lowLinks[nodeIndex] == _indices[nodeIndex]) {
+                components.emplace_back();
+
+                int componentNodeIndex {-1};
+                do {
+                    componentNodeIndex = _stack.back();
+                    _stack.pop_back();
+                    _isOnStack[componentNodeIndex] = false;
+                    components.back().push_back(componentNodeIndex);
+                } while (componentNodeIndex != nodeIndex);
+            }
         }
+    };
 
-        for (std::shared_ptr<WECore::Perlin::PerlinSource>& random : state.randomSources) {
-            random->setSampleRate(sampleRate);
+    /**
+     * Where the graph is while rendering a block. Sources modulated by other sources read their
+     * values from here rather than the sources' last outputs.
+     */
+    struct RenderCursor {
+        const Mi::ModulationSourcesState* state;
+        int nodeIndex;
+        int sampleIndex;
+    };
+
+    // Only set on the thread that's rendering, so other threads reading modulation values (eg. the
+    // UI) still see the sources' last outputs
+    thread_local RenderCursor* renderCursor {nullptr};
+
+    // Set by the chains when modulating plugin parameters part way through a block
+    thread_local int modulationReadPosition {-1};
+
+    std::optional<double> getRenderedValue(const Mi::ModulationSourcesState& state, ModulationSourceDefinition definition) {
+        if (renderCursor == nullptr || renderCursor->state != &state) {
+            // Not rendering, but a chain may want a value from part way through the last block
+            const int nodeIndex {state.graph.getNodeIndex(definition)};
+            if (nodeIndex >= 0 && modulationReadPosition >= 0 && modulationReadPosition < state.graph.numRenderedSamples) {
+                return state.graph.outputs[nodeIndex][modulationReadPosition];
+            }
+
+            return {};
         }
 
-        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
-            seq->setSampleRate(sampleRate);
+        const int nodeIndex {state.graph.getNodeIndex(definition)};
+        if (nodeIndex < 0) {
+            return {};
         }
+
+        // Sources before this one in the node order have already been stepped for this sample,
+        // anything else (including this source) is read from the previous sample
+        const int sampleIndex {nodeIndex < renderCursor->nodeIndex ? renderCursor->sampleIndex : renderCursor->sampleIndex - 1};
+
+        return sampleIndex >= 0 ? state.graph.outputs[nodeIndex][sampleIndex] : state.graph.previousOutputs[nodeIndex];
     }
 
-    void reset(Mi::ModulationSourcesState& state) {
-        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
-            lfo->reset();
+    void addEdges(const ModulationGraph& graph,
+                  std::vector<std::vector<int>>& edges,
+                  int nodeIndex,
+                  const std::vector<WECore::ModulationSourceWrapper<double>>& sources) {
+        for (const WECore::ModulationSourceWrapper<double>& source : sources) {
+            if (auto provider = std::dynamic_pointer_cast<ModulationSourceProvider>(source.source)) {
+                const int sourceNodeIndex {graph.getNodeIndex(provider->definition)};
+
+                if (sourceNodeIndex >= 0) {
+                    edges[sourceNodeIndex].push_back(nodeIndex);
+                }
+            }
         }
+    }
 
-        for (std::shared_ptr<Mi::EnvelopeWrapper>& env : state.envelopes) {
-            env->envelope->reset();
+    double getLastOutput(Mi::ModulationSourcesState& state, const ModulationGraph::Node& node) {
+        switch (node.type) {
+            case MODULATION_TYPE::LFO:
+                return state.lfos[node.index]->getLastOutput();
+            case MODULATION_TYPE::ENVELOPE:
+                return state.envelopes[node.index]->envelope->getLastOutput();
+            case MODULATION_TYPE::RANDOM:
+                return state.randomSources[node.index]->getLastOutput();
+            case MODULATION_TYPE::STEP_SEQUENCER:
+                return state.stepSequencers[node.index]->getLastOutput();
+            case MODULATION_TYPE::MACRO:
+                return 0;
         }
 
-        for (std::shared_ptr<WECore::Perlin::PerlinSource>& random : state.randomSources) {
-            random->reset();
+        return 0;
+    }
+
+    double getNextOutput(Mi::ModulationSourcesState& state, const ModulationGraph::Node& node, int sampleIndex) {
+        switch (node.type) {
+            case MODULATION_TYPE::LFO:
+                return state.lfos[node.index]->getNextOutput(0);
+            case MODULATION_TYPE::ENVELOPE: {
+                const Mi::EnvelopeWrapper& env = *state.envelopes[node.index];
+                const int mixdownChannel {env.useSidechainInput ? ModulationGraph::SIDECHAIN_MIXDOWN_CHANNEL : ModulationGraph::MAIN_MIXDOWN_CHANNEL};
+                return env.envelope->getNextOutput(state.graph.mixdownBuffer.getReadPointer(mixdownChannel)[sampleIndex]);
+            }
+            case MODULATION_TYPE::RANDOM:
+                return state.randomSources[node.index]->getNextOutput(0);
+            case MODULATION_TYPE::STEP_SEQUENCER:
+                return state.stepSequencers[node.index]->getNextOutput(0);
+            case MODULATION_TYPE::MACRO:
+                return 0;
         }
 
-        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
-            seq->reset();
+        return 0;
+    }
+
+    /**
+     * Renders a whole block for a source that doesn't have a block interface of its own. The
+     * cursor is only kept up to date if the source is modulated by another node.
+     */
+    template <typename SourceType>
+    void renderSourceBlock(SourceType& source, RenderCursor& cursor, bool isModulated, double* output, int numSamples) {
+        if (isModulated) {
+            for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+                cursor.sampleIndex = sampleIndex;
+                output[sampleIndex] = source.getNextOutput(0);
+            }
+        } else {
+            for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+                output[sampleIndex] = source.getNextOutput(0);
+            }
         }
     }
 
-    void processBlock(Mi::ModulationSourcesState& state, juce::AudioBuffer<float>& buffer, juce::AudioPlayHead::CurrentPositionInfo tempoInfo) {
-        const int totalNumInputChannels = buffer.getNumChannels();
+    /**
+     * Renders a whole block for a source that isn't part of a cycle. LFOs and envelopes are
+     * rendered by the source itself, so the per sample call isn't dispatched virtually.
+     */
+    void renderNodeBlock(Mi::ModulationSourcesState& state, const ModulationGraph::Node& node, RenderCursor& cursor, bool isModulated, double* output, int numSamples) {
+        switch (node.type) {
+            case MODULATION_TYPE::LFO:
+                if (isModulated) {
+                    state.lfos[node.index]->getNextOutputs(output, numSamples, [&cursor](int sampleIndex) {
+                        // The LFO may read its modulation sources for each sample
+                        cursor.sampleIndex = sampleIndex;
+                    });
+                } else {
+                    state.lfos[node.index]->getNextOutputs(output, numSamples, [](int) { });
+                }
+                break;
+            case MODULATION_TYPE::ENVELOPE: {
+                // Envelopes aren't modulated by anything so don't need the cursor
+                const Mi::EnvelopeWrapper& env = *state.envelopes[node.index];
+                const int mixdownChannel {env.useSidechainInput ? ModulationGraph::SIDECHAIN_MIXDOWN_CHANNEL : ModulationGraph::MAIN_MIXDOWN_CHANNEL};
+                env.envelope->getNextOutputs(state.graph.mixdownBuffer.getReadPointer(mixdownChannel), output, numSamples);
+                break;
+            }
+            case MODULATION_TYPE::RANDOM:
+                renderSourceBlock(*state.randomSources[node.index], cursor, isModulated, output, numSamples);
+                break;
+            case MODULATION_TYPE::STEP_SEQUENCER:
+                renderSourceBlock(*state.stepSequencers[node.index], cursor, isModulated, output, numSamples);
+                break;
+            case MODULATION_TYPE::MACRO:
+                // Macros are set by the host rather than rendered
+                std::fill(output, output + numSamples, 0.0);
+                break;
+        }
+    }
 
-        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
-            lfo->prepareForNextBuffer(tempoInfo.bpm, tempoInfo.timeInSeconds);
+    /**
+     * Averages the given channels into one channel of the mixdown buffer, or fills it with silence
+     * if there are no channels.
+     */
+    void mixdown(const juce::AudioBuffer<float>& buffer, int startChannel, int endChannel, juce::AudioBuffer<float>& mixdownBuffer, int mixdownChannel) {
+        float* writePointer {mixdownBuffer.getWritePointer(mixdownChannel)};
+        const int numSamples {buffer.getNumSamples()};
+
+        if (endChannel <= startChannel) {
+            juce::FloatVectorOperations::clear(writePointer, numSamples);
+            return;
         }
 
-        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
-            seq->prepareForNextBuffer(tempoInfo.bpm, tempoInfo.timeInSeconds);
+        juce::FloatVectorOperations::copy(writePointer, buffer.getReadPointer(startChannel), numSamples);
+        for (int channelIndex {startChannel + 1}; channelIndex < endChannel; channelIndex++) {
+            juce::FloatVectorOperations::add(writePointer, buffer.getReadPointer(channelIndex), numSamples);
+        }
+
+        juce::FloatVectorOperations::multiply(writePointer, 1.0f / (endChannel - startChannel), numSamples);
+    }
+
+    void processBlockGraph(Mi::ModulationSourcesState& state, juce::AudioBuffer<float>& buffer) {
+        ModulationGraph& graph = state.graph;
+        const int numSamples {buffer.getNumSamples()};
+        const int numMainChannels {state.hostConfig.layout.getMainInputChannels()};
+
+        // Mix down the inputs once for all the envelopes
+        if (graph.numEnvelopes > 0) {
+            mixdown(buffer, 0, std::min(numMainChannels, buffer.getNumChannels()), graph.mixdownBuffer, ModulationGraph::MAIN_MIXDOWN_CHANNEL);
+            mixdown(buffer, numMainChannels, buffer.getNumChannels(), graph.mixdownBuffer, ModulationGraph::SIDECHAIN_MIXDOWN_CHANNEL);
         }
 
-        // TODO this could be faster
+        for (int nodeIndex {0}; nodeIndex < graph.nodes.size(); nodeIndex++) {
+            graph.previousOutputs[nodeIndex] = getLastOutput(state, graph.nodes[nodeIndex]);
+        }
+
+        RenderCursor cursor {&state, 0, 0};
+        renderCursor = &cursor;
+
+        for (int groupIndex {0}; groupIndex < graph.groupStarts.size(); groupIndex++) {
+            const int groupStart {graph.groupStarts[groupIndex]};
+            const int groupEnd {groupIndex + 1 < graph.groupStarts.size() ? graph.groupStarts[groupIndex + 1] : static_cast<int>(graph.renderOrder.size())};
+
+            if (!graph.groupIsCycle[groupIndex]) {
+                // Everything this source depends on has already been rendered, so do the whole block
+                const int nodeIndex {graph.renderOrder[groupStart]};
+                cursor.nodeIndex = nodeIndex;
+                renderNodeBlock(state, graph.nodes[nodeIndex], cursor, graph.isModulated[nodeIndex], graph.outputs[nodeIndex].data(), numSamples);
+            } else {
+                // These sources depend on each other, so advance them one sample at a time
+                for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+                    cursor.sampleIndex = sampleIndex;
+
+                    for (int orderIndex {groupStart}; orderIndex < groupEnd; orderIndex++) {
+                        const int nodeIndex {graph.renderOrder[orderIndex]};
+                        cursor.nodeIndex = nodeIndex;
+                        graph.outputs[nodeIndex][sampleIndex] = getNextOutput(state, graph.nodes[nodeIndex], sampleIndex);
+                    }
+                }
+            }
+        }
+
+        renderCursor = nullptr;
+        graph.numRenderedSamples = numSamples;
+    }
+
+    template <typename SourceType, typename GetValuesFunction>
+    void writeSourceValues(const std::vector<std::shared_ptr<SourceType>>& sources,
+                           UITelemetry::SourceTypeValues& values,
+                           GetValuesFunction getValues) {
+        values.numSources = std::min(static_cast<int>(sources.size()), UITelemetry::MAX_NUM_SOURCES_PER_TYPE);
+
+        for (int index {0}; index < values.numSources; index++) {
+            values.sources[index] = getValues(*sources[index]);
+        }
+    }
+
+    void processBlockPerSample(Mi::ModulationSourcesState& state, juce::AudioBuffer<float>& buffer) {
+        const int totalNumInputChannels = buffer.getNumChannels();
+
         // We go through each sample then each source - sources can be dependent on each other, so
         // we only advance each of them one sample at a time
         for (int sampleIndex {0}; sampleIndex < buffer.getNumSamples(); sampleIndex++) {
@@ -67,7 +302,7 @@ namespace ModulationProcessors {
             }
 
             // ENVs
-            for (std::shared_ptr<Mi::EnvelopeWrapper> env : state.envelopes) {
+            for (std::shared_ptr<Mi::EnvelopeWrapper>& env : state.envelopes) {
                 // Figure out which channels we need to be looking at
                 int startChannel {0};
                 int endChannel {0};
@@ -85,7 +320,10 @@ namespace ModulationProcessors {
                 for (int channelIndex {startChannel}; channelIndex < endChannel; channelIndex++) {
                     averageSample += buffer.getReadPointer(channelIndex)[sampleIndex];
                 }
-                averageSample /= (endChannel - startChannel);
+
+                if (endChannel > startChannel) {
+                    averageSample /= (endChannel - startChannel);
+                }
 
                 env->envelope->getNextOutput(averageSample);
             }
@@ -101,9 +339,171 @@ namespace ModulationProcessors {
             }
         }
     }
+}
+
+namespace ModulationProcessors {
+    void prepareToPlay(Mi::ModulationSourcesState& state, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
+        state.hostConfig.sampleRate = sampleRate;
+        state.hostConfig.blockSize = samplesPerBlock;
+        state.hostConfig.layout = layout;
+
+        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
+            lfo->setSampleRate(sampleRate);
+        }
+
+        for (std::shared_ptr<Mi::EnvelopeWrapper>& env : state.envelopes) {
+            env->envelope->setSampleRate(sampleRate);
+        }
+
+        for (std::shared_ptr<WECore::Perlin::PerlinSource>& random : state.randomSources) {
+            random->setSampleRate(sampleRate);
+        }
+
+        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
+            seq->setSampleRate(sampleRate);
+        }
+
+        prepareGraph(state);
+    }
+
+    void reset(Mi::ModulationSourcesState& state) {
+        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
+            lfo->reset();
+        }
+
+        for (std::shared_ptr<Mi::EnvelopeWrapper>& env : state.envelopes) {
+            env->envelope->reset();
+        }
+
+        for (std::shared_ptr<WECore::Perlin::PerlinSource>& random : state.randomSources) {
+            random->reset();
+        }
+
+        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
+            seq->reset();
+        }
+    }
+
+    void processBlock(Mi::ModulationSourcesState& state, juce::AudioBuffer<float>& buffer, juce::AudioPlayHead::CurrentPositionInfo tempoInfo) {
+        for (std::shared_ptr<Mi::CloneableLFO>& lfo : state.lfos) {
+            lfo->prepareForNextBuffer(tempoInfo.bpm, tempoInfo.timeInSeconds);
+        }
+
+        for (std::shared_ptr<WECore::StepSeq::StepSequencer>& seq : state.stepSequencers) {
+            seq->prepareForNextBuffer(tempoInfo.bpm, tempoInfo.timeInSeconds);
+        }
+
+        const bool canUseGraph {
+            state.graph.canRender(static_cast<int>(state.lfos.size()),
+                                  static_cast<int>(state.envelopes.size()),
+                                  static_cast<int>(state.randomSources.size()),
+                                  static_cast<int>(state.stepSequencers.size()),
+                                  buffer.getNumSamples())
+        };
+
+        if (canUseGraph) {
+            processBlockGraph(state, buffer);
+        } else {
+            state.graph.numRenderedSamples = 0;
+            processBlockPerSample(state, buffer);
+        }
+    }
+
+    void prepareGraph(Mi::ModulationSourcesState& state) {
+        ModulationGraph& graph = state.graph;
+        graph.isValid = false;
+
+        graph.numLfos = static_cast<int>(state.lfos.size());
+        graph.numEnvelopes = static_cast<int>(state.envelopes.size());
+        graph.numRandomSources = static_cast<int>(state.randomSources.size());
+        graph.numStepSequencers = static_cast<int>(state.stepSequencers.size());
+        graph.maxBlockSize = std::max(state.hostConfig.blockSize, 1);
+
+        graph.nodes.clear();
+        for (int index {0}; index < graph.numLfos; index++) {
+            graph.nodes.emplace_back(MODULATION_TYPE::LFO, index);
+        }
+
+        for (int index {0}; index < graph.numEnvelopes; index++) {
+            graph.nodes.emplace_back(MODULATION_TYPE::ENVELOPE, index);
+        }
+
+        for (int index {0}; index < graph.numRandomSources; index++) {
+            graph.nodes.emplace_back(MODULATION_TYPE::RANDOM, index);
+        }
+
+        for (int index {0}; index < graph.numStepSequencers; index++) {
+            graph.nodes.emplace_back(MODULATION_TYPE::STEP_SEQUENCER, index);
+        }
+
+        // Edges go from each source to the sources it modulates
+        std::vector<std::vector<int>> edges(graph.nodes.size());
+        for (int nodeIndex {0}; nodeIndex < graph.nodes.size(); nodeIndex++) {
+            const ModulationGraph::Node& node = graph.nodes[nodeIndex];
+
+            if (node.type == MODULATION_TYPE::LFO) {
+                addEdges(graph, edges, nodeIndex, state.lfos[node.index]->getFreqModulationSources());
+                addEdges(graph, edges, nodeIndex, state.lfos[node.index]->getDepthModulationSources());
+                addEdges(graph, edges, nodeIndex, state.lfos[node.index]->getPhaseModulationSources());
+            } else if (node.type == MODULATION_TYPE::RANDOM) {
+                addEdges(graph, edges, nodeIndex, state.randomSources[node.index]->getFreqModulationSources());
+                addEdges(graph, edges, nodeIndex, state.randomSources[node.index]->getDepthModulationSources());
+            } else if (node.type == MODULATION_TYPE::STEP_SEQUENCER) {
+                addEdges(graph, edges, nodeIndex, state.stepSequencers[node.index]->getFreqModulationSources());
+                addEdges(graph, edges, nodeIndex, state.stepSequencers[node.index]->getDepthModulationSources());
+            }
+        }
+
+        graph.isModulated.assign(graph.nodes.size(), false);
+        for (const std::vector<int>& modulatedNodeIndices : edges) {
+            for (int modulatedNodeIndex : modulatedNodeIndices) {
+                graph.isModulated[modulatedNodeIndex] = true;
+            }
+        }
+
+        // Each group must be rendered after the groups it depends on
+        ComponentFinder finder(edges);
+
+        graph.renderOrder.clear();
+        graph.groupStarts.clear();
+        graph.groupIsCycle.clear();
+
+        for (auto componentItr = finder.components.rbegin(); componentItr != finder.components.rend(); componentItr++) {
+            std::vector<int>& component = *componentItr;
+
+            // Sources in a cycle are stepped in the same order as they always have been
+            std::sort(component.begin(), component.end());
+
+            const int firstNodeIndex {component[0]};
+            const bool isSelfModulating {
+                std::find(edges[firstNodeIndex].begin(), edges[firstNodeIndex].end(), firstNodeIndex) != edges[firstNodeIndex].end()
+            };
+
+            graph.groupStarts.push_back(static_cast<int>(graph.renderOrder.size()));
+            graph.groupIsCycle.push_back(component.size() > 1 || isSelfModulating);
+            graph.renderOrder.insert(graph.renderOrder.end(), component.begin(), component.end());
+        }
+
+        graph.outputs.assign(graph.nodes.size(), std::vector<double>(graph.maxBlockSize, 0.0));
+        graph.previousOutputs.assign(graph.nodes.size(), 0.0);
+        graph.mixdownBuffer.setSize(2, graph.maxBlockSize);
+
+        graph.numRenderedSamples = 0;
+        graph.isValid = true;
+    }
+
+    void setModulationReadPosition(int sampleIndex) {
+        modulationReadPosition = sampleIndex;
+    }
 
     double getLfoModulationValue(Mi::ModulationSourcesState& state, int lfoNumber) {
         const int index {lfoNumber - 1};
+
+        const std::optional<double> renderedValue {getRenderedValue(state, ModulationSourceDefinition(lfoNumber, MODULATION_TYPE::LFO))};
+        if (renderedValue.has_value()) {
+            return renderedValue.value();
+        }
+
         if (state.lfos.size() > index) {
             return state.lfos[index]->getLastOutput();
         }
@@ -113,6 +513,12 @@ namespace ModulationProcessors {
 
     double getEnvelopeModulationValue(Mi::ModulationSourcesState& state, int envelopeNumber) {
         const int index {envelopeNumber - 1};
+
+        const std::optional<double> renderedValue {getRenderedValue(state, ModulationSourceDefinition(envelopeNumber, MODULATION_TYPE::ENVELOPE))};
+        if (renderedValue.has_value()) {
+            return renderedValue.value() * state.envelopes[index]->amount;
+        }
+
         if (state.envelopes.size() > index) {
             return state.envelopes[index]->envelope->getLastOutput() * state.envelopes[index]->amount;
         }
@@ -122,6 +528,12 @@ namespace ModulationProcessors {
 
     double getRandomModulationValue(ModelInterface::ModulationSourcesState& state, int randomNumber) {
         const int index {randomNumber - 1};
+
+        const std::optional<double> renderedValue {getRenderedValue(state, ModulationSourceDefinition(randomNumber, MODULATION_TYPE::RANDOM))};
+        if (renderedValue.has_value()) {
+            return renderedValue.value();
+        }
+
         if (state.randomSources.size() > index) {
             return state.randomSources[index]->getLastOutput();
         }
@@ -131,10 +543,51 @@ namespace ModulationProcessors {
 
     double getStepSeqModulationValue(ModelInterface::ModulationSourcesState& state, int stepSeqNumber) {
         const int index {stepSeqNumber - 1};
+
+        const std::optional<double> renderedValue {getRenderedValue(state, ModulationSourceDefinition(stepSeqNumber, MODULATION_TYPE::STEP_SEQUENCER))};
+        if (renderedValue.has_value()) {
+            return renderedValue.value();
+        }
+
         if (state.stepSequencers.size() > index) {
             return state.stepSequencers[index]->getLastOutput();
         }
 
         return 0;
     }
+
+    void writeTelemetry(ModelInterface::ModulationSourcesState& state, UITelemetry::Snapshot& snapshot) {
+        writeSourceValues(state.lfos, snapshot.lfos, [](CloneableLFO& lfo) {
+            return UITelemetry::SourceValues {
+                static_cast<float>(lfo.getLastOutput()),
+                static_cast<float>(lfo.getModulatedFreqValue()),
+                static_cast<float>(lfo.getModulatedDepthValue()),
+                static_cast<float>(lfo.getModulatedPhaseValue())
+            };
+        });
+
+        writeSourceValues(state.envelopes, snapshot.envelopes, [](Mi::EnvelopeWrapper& env) {
+            return UITelemetry::SourceValues {
+                static_cast<float>(env.envelope->getLastOutput() * env.amount), 0, 0, 0
+            };
+        });
+
+        writeSourceValues(state.randomSources, snapshot.randomSources, [](WECore::Perlin::PerlinSource& source) {
+            return UITelemetry::SourceValues {
+                static_cast<float>(source.getLastOutput()),
+                static_cast<float>(source.getModulatedFreqValue()),
+                static_cast<float>(source.getModulatedDepthValue()),
+                0
+            };
+        });
+
+        writeSourceValues(state.stepSequencers, snapshot.stepSequencers, [](WECore::StepSeq::StepSequencer& seq) {
+            return UITelemetry::SourceValues {
+                static_cast<float>(seq.getLastOutput()),
+                static_cast<float>(seq.getModulatedFreqValue()),
+                static_cast<float>(seq.getModulatedDepthValue()),
+                0
+            };
+        });
+    }
 }
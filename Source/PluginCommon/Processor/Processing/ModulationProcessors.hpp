@@ -9,8 +9,30 @@ namespace ModulationProcessors {
     void reset(ModelInterface::ModulationSourcesState& state);
     void processBlock(ModelInterface::ModulationSourcesState& state, juce::AudioBuffer<float>& buffer, juce::AudioPlayHead::CurrentPositionInfo tempoInfo);
 
+    /**
+     * Builds the dependency graph between the sources and allocates the space needed to render
+     * them. Must be called whenever sources are added or removed, or their modulation sources
+     * change, and not on a state the audio thread might be using.
+     *
+     * Until this is called processBlock() falls back to stepping each source one sample at a time.
+     */
+    void prepareGraph(ModelInterface::ModulationSourcesState& state);
+
+    /**
+     * Sets the sample within the current block that modulation values are read at on the calling
+     * thread, so that plugin parameters can be modulated more than once per block. -1 (the default)
+     * reads the values at the end of the block.
+     */
+    void setModulationReadPosition(int sampleIndex);
+
     double getLfoModulationValue(ModelInterface::ModulationSourcesState& state, int lfoNumber);
     double getEnvelopeModulationValue(ModelInterface::ModulationSourcesState& state, int envelopeNumber);
     double getRandomModulationValue(ModelInterface::ModulationSourcesState& state, int randomNumber);
     double getStepSeqModulationValue(ModelInterface::ModulationSourcesState& state, int stepSeqNumber);
+
+    /**
+     * Copies the values the UI displays for each source into the snapshot. Called by the audio
+     * thread after processing the block.
+     */
+    void writeTelemetry(ModelInterface::ModulationSourcesState& state, UITelemetry::Snapshot& snapshot);
 }
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+#include "TestUtils.hpp"
+
+#include "ModulationMutators.hpp"
+#include "ModulationProcessors.hpp"
+
+SCENARIO("ModulationProcessors: prepareGraph only steps cycles one sample at a time") {
+    GIVEN("Three LFOs and a random source") {
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto sources = std::make_shared<ModelInterface::ModulationSourcesState>(modulationCallback);
+        sources->hostConfig.sampleRate = 44100;
+        sources->hostConfig.blockSize = 10;
+        sources->hostConfig.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        ModulationMutators::addLfo(sources);
+        ModulationMutators::addLfo(sources);
+        ModulationMutators::addLfo(sources);
+        ModulationMutators::addRandom(sources);
+
+        WHEN("LFO 1 and 2 modulate each other, and the random source modulates LFO 3") {
+            ModulationMutators::addSourceToLFOFreq(sources, 0, ModulationSourceDefinition(2, MODULATION_TYPE::LFO));
+            ModulationMutators::addSourceToLFODepth(sources, 1, ModulationSourceDefinition(1, MODULATION_TYPE::LFO));
+            ModulationMutators::addSourceToLFOPhase(sources, 2, ModulationSourceDefinition(1, MODULATION_TYPE::RANDOM));
+
+            ModulationProcessors::prepareGraph(*sources);
+            const ModulationGraph& graph = sources->graph;
+
+            THEN("The cycle is grouped together and the random source is rendered before LFO 3") {
+                REQUIRE(graph.isValid);
+                REQUIRE(graph.groupStarts.size() == 3);
+
+                const auto getGroupPosition = [&graph](int nodeIndex) {
+                    const int orderIndex = std::find(graph.renderOrder.begin(), graph.renderOrder.end(), nodeIndex) - graph.renderOrder.begin();
+                    return std::upper_bound(graph.groupStarts.begin(), graph.groupStarts.end(), orderIndex) - graph.groupStarts.begin() - 1;
+                };
+
+                const int randomNodeIndex {graph.getNodeIndex(ModulationSourceDefinition(1, MODULATION_TYPE::RANDOM))};
+
+                CHECK(getGroupPosition(0) == getGroupPosition(1));
+                CHECK(graph.groupIsCycle[getGroupPosition(0)]);
+                CHECK(getGroupPosition(randomNodeIndex) < getGroupPosition(2));
+                CHECK_FALSE(graph.groupIsCycle[getGroupPosition(2)]);
+                CHECK_FALSE(graph.groupIsCycle[getGroupPosition(randomNodeIndex)]);
+            }
+
+            AND_THEN("Only the LFOs are marked as modulated") {
+                const int randomNodeIndex {graph.getNodeIndex(ModulationSourceDefinition(1, MODULATION_TYPE::RANDOM))};
+
+                CHECK(graph.isModulated[0]);
+                CHECK(graph.isModulated[1]);
+                CHECK(graph.isModulated[2]);
+                CHECK_FALSE(graph.isModulated[randomNodeIndex]);
+            }
+
+            AND_THEN("It can render blocks up to the host's block size") {
+                CHECK(graph.canRender(3, 0, 1, 0, 10));
+                CHECK_FALSE(graph.canRender(3, 0, 1, 0, 11));
+                CHECK_FALSE(graph.canRender(4, 0, 1, 0, 10));
+            }
+        }
+    }
+}
+
+SCENARIO("ModulationProcessors: Rendering a block at a time matches stepping each source per sample") {
+    GIVEN("Two identical sets of LFOs and an envelope, where some modulate others") {
+        constexpr int NUM_SAMPLES {64};
+        constexpr int SAMPLE_RATE {44100};
+
+        // Each set reads the values of the sources modulating it from itself
+        auto createSources = [](ModelInterface::ModulationSourcesState*& statePtr) {
+            auto modulationCallback = [&statePtr](int id, MODULATION_TYPE type) -> float {
+                switch (type) {
+                    case MODULATION_TYPE::LFO:
+                        return ModulationProcessors::getLfoModulationValue(*statePtr, id);
+                    case MODULATION_TYPE::ENVELOPE:
+                        return ModulationProcessors::getEnvelopeModulationValue(*statePtr, id);
+                    default:
+                        return 0.0f;
+                }
+            };
+
+            auto sources = std::make_shared<ModelInterface::ModulationSourcesState>(modulationCallback);
+            statePtr = sources.get();
+
+            ModulationMutators::addLfo(sources);
+            ModulationMutators::addLfo(sources);
+            ModulationMutators::addLfo(sources);
+            ModulationMutators::addEnvelope(sources);
+
+            ModulationMutators::setLfoFreq(sources, 0, 5);
+            ModulationMutators::setLfoFreq(sources, 1, 11);
+            ModulationMutators::setLfoFreq(sources, 2, 3);
+            ModulationMutators::setEnvAmount(sources, 0, 1);
+
+            // LFO 2 reads LFO 1 from the same sample, LFO 3 reads the envelope from the previous one
+            ModulationMutators::addSourceToLFODepth(sources, 1, ModulationSourceDefinition(1, MODULATION_TYPE::LFO));
+            ModulationMutators::addSourceToLFOFreq(sources, 2, ModulationSourceDefinition(1, MODULATION_TYPE::ENVELOPE));
+
+            ModulationProcessors::prepareToPlay(*sources, SAMPLE_RATE, NUM_SAMPLES, TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo()));
+
+            return sources;
+        };
+
+        ModelInterface::ModulationSourcesState* blockStatePtr {nullptr};
+        ModelInterface::ModulationSourcesState* perSampleStatePtr {nullptr};
+        auto blockSources = createSources(blockStatePtr);
+        auto perSampleSources = createSources(perSampleStatePtr);
+
+        REQUIRE(blockSources->graph.isValid);
+        REQUIRE_FALSE(blockSources->graph.groupIsCycle[0]);
+
+        // Without the graph the sources are stepped one sample at a time as they were before
+        perSampleSources->graph.isValid = false;
+
+        WHEN("Several blocks of a sine wave are processed") {
+            juce::AudioPlayHead::CurrentPositionInfo tempoInfo;
+            tempoInfo.bpm = 120;
+
+            THEN("Each source has the same output at the end of every block") {
+                for (int blockIdx {0}; blockIdx < 10; blockIdx++) {
+                    juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                    for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                        const float value {std::sin((blockIdx * NUM_SAMPLES + sampleIdx) * 0.01f)};
+                        buffer.setSample(0, sampleIdx, value);
+                        buffer.setSample(1, sampleIdx, value);
+                    }
+
+                    tempoInfo.timeInSeconds = static_cast<double>(blockIdx * NUM_SAMPLES) / SAMPLE_RATE;
+
+                    ModulationProcessors::processBlock(*blockSources, buffer, tempoInfo);
+                    ModulationProcessors::processBlock(*perSampleSources, buffer, tempoInfo);
+
+                    CHECK(blockSources->graph.numRenderedSamples == NUM_SAMPLES);
+                    CHECK(perSampleSources->graph.numRenderedSamples == 0);
+
+                    for (int lfoIdx {0}; lfoIdx < 3; lfoIdx++) {
+                        CHECK(blockSources->lfos[lfoIdx]->getLastOutput() == Approx(perSampleSources->lfos[lfoIdx]->getLastOutput()));
+                    }
+
+                    CHECK(blockSources->envelopes[0]->envelope->getLastOutput() == Approx(perSampleSources->envelopes[0]->envelope->getLastOutput()));
+                }
+            }
+        }
+    }
+}
@@ -3,6 +3,131 @@
 #include "SplitterProcessors.hpp"
 #include "ModulationProcessors.hpp"
 
+namespace {
+    /**
+     * Processes one state's modulation sources and splitter. Only the current state updates the
+     * telemetry and the FFT, the state being faded out only contributes its audio.
+     */
+    void processState(ModelInterface::StateManager& manager,
+                      ModelInterface::StateWrapper& state,
+                      juce::AudioBuffer<float>& buffer,
+                      juce::MidiBuffer& midiMessages,
+                      juce::AudioPlayHead* newPlayHead,
+                      juce::AudioPlayHead::CurrentPositionInfo tempoInfo,
+                      ChainWorkerPool* workerPool,
+                      bool isCurrentState) {
+        ModelInterface::SplitterState& splitter = *state.splitterState;
+        ModelInterface::ModulationSourcesState& sources = *state.modulationSourcesState;
+
+        // Advance the modulation sources
+        // (the envelopes need to be done now before we overwrite the buffer)
+        ModulationProcessors::processBlock(sources, buffer, tempoInfo);
+
+        if (isCurrentState) {
+            ModulationProcessors::writeTelemetry(sources, manager.telemetry.getSnapshotToWrite());
+            manager.telemetry.publish();
+        }
+
+        if (splitter.splitter != nullptr) {
+            if (isCurrentState && splitter.splitter->splitType == SPLIT_TYPE::MULTIBAND) {
+                // Only copies the input for the UI to analyse, and only if it's visible
+                manager.fftProvider.pushSamples(buffer);
+            }
+
+            const bool didProcess {
+                SplitterProcessors::processBlock(*splitter.splitter,
+                                                 buffer,
+                                                 midiMessages,
+                                                 newPlayHead,
+                                                 manager.scratchArena,
+                                                 workerPool,
+                                                 manager.modulationControlRate.load(std::memory_order_relaxed),
+                                                 manager.isSleepingEnabled.load(std::memory_order_relaxed))
+            };
+
+            if (!didProcess) {
+                // The host gave us more channels than it said it would in prepareToPlay
+                manager.numSkippedBlocks++;
+            }
+        }
+    }
+
+    int getLatencySamples(const ModelInterface::StateWrapper& state) {
+        const std::shared_ptr<PluginSplitter>& splitter = state.splitterState->splitter;
+        return splitter != nullptr ? splitter->getLatencySamples() : 0;
+    }
+
+    /**
+     * Processes the current state, and the one being faded out if there is one. fadingState is set
+     * to nullptr once its crossfade has finished.
+     */
+    void processStates(ModelInterface::StateManager& manager,
+                       ModelInterface::StateWrapper& state,
+                       ModelInterface::StateWrapper*& fadingState,
+                       juce::AudioBuffer<float>& buffer,
+                       juce::MidiBuffer& midiMessages,
+                       juce::AudioPlayHead* newPlayHead,
+                       juce::AudioPlayHead::CurrentPositionInfo tempoInfo,
+                       ChainWorkerPool* workerPool) {
+        GraphCrossfader& crossfader = manager.crossfader;
+
+        if (fadingState != nullptr && fadingState != manager.crossfaderState) {
+            crossfader.startFade(manager.crossfadeLengthSamples.load(std::memory_order_relaxed));
+            manager.crossfaderState = fadingState;
+        }
+
+        const bool isFading {
+            fadingState != nullptr && crossfader.isFading() && crossfader.copyInputForOutgoing(buffer, midiMessages)
+        };
+
+        processState(manager, state, buffer, midiMessages, newPlayHead, tempoInfo, workerPool, true);
+
+        // With a standby both graphs are delayed to the latency of the slower one
+        const int currentLatency {getLatencySamples(state)};
+        const int otherLatency {
+            fadingState != nullptr ? getLatencySamples(*fadingState) : manager.standbyLatencySamples.load(std::memory_order_relaxed)
+        };
+        const int alignedLatency {std::max(currentLatency, otherLatency)};
+
+        // Always run so the line holds the current graph's recent output when a fade starts
+        crossfader.alignCurrent(buffer, alignedLatency - currentLatency);
+
+        if (isFading) {
+            juce::AudioBuffer<float> outgoingBuffer {crossfader.getOutgoingBuffer(buffer.getNumSamples())};
+
+            manager.isProcessingFadingState.store(true, std::memory_order_release);
+            processState(manager, *fadingState, outgoingBuffer, crossfader.getOutgoingMidi(), newPlayHead, tempoInfo, workerPool, false);
+            manager.isProcessingFadingState.store(false, std::memory_order_release);
+
+            crossfader.alignOutgoing(outgoingBuffer, alignedLatency - getLatencySamples(*fadingState));
+        }
+
+        if (fadingState != nullptr && (!isFading || crossfader.mix(buffer))) {
+            // Finished, unless another switch has started a new fade in the meantime
+            ModelInterface::StateWrapper* finishedState {fadingState};
+            manager.fadingState.compare_exchange_strong(finishedState, nullptr, std::memory_order_seq_cst);
+            manager.crossfaderState = nullptr;
+            fadingState = nullptr;
+        }
+    }
+
+    /**
+     * Returns the position at the given offset into a block starting at tempoInfo.
+     */
+    juce::AudioPlayHead::CurrentPositionInfo advancePosition(juce::AudioPlayHead::CurrentPositionInfo tempoInfo,
+                                                             int numSamples,
+                                                             double sampleRate) {
+        if (sampleRate > 0) {
+            const double numSeconds {numSamples / sampleRate};
+            tempoInfo.timeInSamples += numSamples;
+            tempoInfo.timeInSeconds += numSeconds;
+            tempoInfo.ppqPosition += numSeconds * tempoInfo.bpm / 60;
+        }
+
+        return tempoInfo;
+    }
+}
+
 namespace ModelInterface {
     void prepareToPlay(StateManager& manager, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
         WECore::AudioSpinLock lock(manager.sharedMutex);
@@ -11,8 +136,34 @@ namespace ModelInterface {
 
         ModulationProcessors::prepareToPlay(sources, sampleRate, samplesPerBlock, layout);
 
+        manager.fftProvider.setSampleRate(sampleRate);
+        manager.fftProvider.setIsStereo(canDoStereoSplitTypes(layout));
+        manager.fftProvider.reset();
+
+        const int maxLatencyCompensationSamples {manager.maxLatencyCompensationSamples.load(std::memory_order_relaxed)};
+        manager.crossfader.prepare(getTotalNumInputChannels(layout), samplesPerBlock, maxLatencyCompensationSamples);
+        manager.crossfaderState = nullptr;
+
+        if (manager.standbyState != nullptr) {
+            ModulationProcessors::prepareToPlay(*manager.standbyState->modulationSourcesState, sampleRate, samplesPerBlock, layout);
+
+            if (manager.standbyState->splitterState->splitter != nullptr) {
+                SplitterProcessors::prepareToPlay(*manager.standbyState->splitterState->splitter, sampleRate, samplesPerBlock, layout, maxLatencyCompensationSamples);
+            }
+        }
+
         if (splitter.splitter != nullptr) {
-            SplitterProcessors::prepareToPlay(*splitter.splitter, sampleRate, samplesPerBlock, layout);
+            SplitterProcessors::prepareToPlay(*splitter.splitter, sampleRate, samplesPerBlock, layout, maxLatencyCompensationSamples);
+
+            manager.scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(layout),
+                                         samplesPerBlock,
+                                         std::max(SplitterProcessors::getNumScratchBuffersRequired(*splitter.splitter), ScratchArena::DEFAULT_NUM_BUFFERS));
+
+            if (manager.workerPool != nullptr) {
+                manager.workerPool->prepare(getTotalNumInputChannels(layout),
+                                            samplesPerBlock,
+                                            std::max(static_cast<int>(splitter.splitter->chains.size()), ChainWorkerPool::DEFAULT_NUM_TASKS));
+            }
         }
     }
 
@@ -23,6 +174,15 @@ namespace ModelInterface {
         if (splitter.splitter != nullptr) {
             SplitterProcessors::releaseResources(*splitter.splitter.get());
         }
+
+        if (manager.standbyState != nullptr && manager.standbyState->splitterState->splitter != nullptr) {
+            SplitterProcessors::releaseResources(*manager.standbyState->splitterState->splitter);
+        }
+
+        // Nothing is processed until the next prepareToPlay(), so don't leave undo and redo waiting
+        // for a crossfade that won't finish
+        manager.fadingState.store(nullptr, std::memory_order_seq_cst);
+        manager.crossfaderState = nullptr;
     }
 
     void reset(StateManager& manager) {
@@ -35,6 +195,17 @@ namespace ModelInterface {
         if (splitter.splitter != nullptr) {
             SplitterProcessors::reset(*splitter.splitter.get());
         }
+
+        if (manager.standbyState != nullptr) {
+            ModulationProcessors::reset(*manager.standbyState->modulationSourcesState);
+
+            if (manager.standbyState->splitterState->splitter != nullptr) {
+                SplitterProcessors::reset(*manager.standbyState->splitterState->splitter);
+            }
+        }
+
+        manager.crossfader.reset();
+        manager.crossfaderState = nullptr;
     }
 
     void processBlock(StateManager& manager,
@@ -42,43 +213,157 @@ namespace ModelInterface {
                       juce::MidiBuffer& midiMessages,
                       juce::AudioPlayHead* newPlayHead,
                       juce::AudioPlayHead::CurrentPositionInfo tempoInfo) {
-        // Use the try lock on the audio thread
-        WECore::AudioSpinTryLock lock(manager.sharedMutex);
+        // Never block or skip on the audio thread - process whichever state was most recently
+        // published, any newer state will be picked up on the next block
+        StateWrapper* state {manager.acquireStateForProcessing()};
+        StateWrapper* fadingState {manager.acquireFadingStateForProcessing()};
+        ChainWorkerPool* workerPool {manager.acquireWorkerPoolForProcessing()};
+
+        // The fading state is set just before the state it's switching to is published, so for a
+        // block it can be the same as the current one
+        if (fadingState == state) {
+            fadingState = nullptr;
+        }
+
+        if (state != nullptr) {
+            // Everything is prepared for the block size given in prepareToPlay
+            const int maxBlockSize {manager.scratchArena.getBlockSize()};
+            const int numSamples {buffer.getNumSamples()};
+
+            if (maxBlockSize <= 0 || numSamples <= maxBlockSize) {
+                processStates(manager, *state, fadingState, buffer, midiMessages, newPlayHead, tempoInfo, workerPool);
+            } else {
+                // The host gave us a bigger block than it said it would, so process it in sub-blocks
+                // of the prepared size rather than passing it through
+                const double sampleRate {state->splitterState->splitter != nullptr ? state->splitterState->splitter->config.sampleRate : 0};
+                juce::MidiBuffer& subBlockMidi = manager.subBlockMidiBuffer;
+                juce::MidiBuffer& outputMidi = manager.subBlockOutputMidiBuffer;
+                outputMidi.clear();
+
+                for (int subBlockStart {0}; subBlockStart < numSamples; subBlockStart += maxBlockSize) {
+                    const int subBlockSize {std::min(maxBlockSize, numSamples - subBlockStart)};
 
-        if (lock.isLocked()) {
-            SplitterState& splitter = manager.getSplitterStateUnsafe();
-            ModulationSourcesState& sources = *manager.getSourcesStateUnsafe();
+                    // Refers to the host's buffer, doesn't copy or allocate
+                    juce::AudioBuffer<float> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), subBlockStart, subBlockSize);
 
-            // Advance the modulation sources
-            // (the envelopes need to be done now before we overwrite the buffer)
-            ModulationProcessors::processBlock(sources, buffer, tempoInfo);
+                    subBlockMidi.clear();
+                    subBlockMidi.addEvents(midiMessages, subBlockStart, subBlockSize, -subBlockStart);
 
-            // TODO LFOs should still be advanced even if the lock is not acquired to stop them
-            // drifting out of sync
+                    processStates(manager,
+                                  *state,
+                                  fadingState,
+                                  subBlock,
+                                  subBlockMidi,
+                                  newPlayHead,
+                                  advancePosition(tempoInfo, subBlockStart, sampleRate),
+                                  workerPool);
 
-            if (splitter.splitter != nullptr) {
-                SplitterProcessors::processBlock(*splitter.splitter, buffer, midiMessages, newPlayHead);
+                    outputMidi.addEvents(subBlockMidi, 0, -1, subBlockStart);
+                }
+
+                midiMessages.clear();
+                midiMessages.addEvents(outputMidi, 0, -1, 0);
             }
+        } else {
+            manager.numSkippedBlocks++;
         }
+
+        manager.releaseWorkerPoolForProcessing();
+        manager.releaseFadingStateForProcessing();
+        manager.releaseStateForProcessing();
+    }
+
+    juce::uint64 getNumSkippedBlocks(StateManager& manager) {
+        return manager.numSkippedBlocks.load();
+    }
+
+    void setMultiCoreProcessingEnabled(StateManager& manager, bool isEnabled) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+
+        if (isEnabled == (manager.workerPool != nullptr)) {
+            return;
+        }
+
+        std::unique_ptr<ChainWorkerPool> newPool;
+        if (isEnabled) {
+            const int numWorkers {ChainWorkerPool::getDefaultNumWorkers()};
+            if (numWorkers == 0) {
+                juce::Logger::writeToLog("ModelInterface::setMultiCoreProcessingEnabled: Only one core available, staying single threaded");
+                return;
+            }
+
+            newPool = std::make_unique<ChainWorkerPool>(numWorkers);
+
+            const PluginSplitter& splitter = *manager.getSplitterStateUnsafe().splitter;
+            newPool->prepare(getTotalNumInputChannels(splitter.config.layout),
+                             splitter.config.blockSize,
+                             std::max(static_cast<int>(splitter.chains.size()), ChainWorkerPool::DEFAULT_NUM_TASKS));
+        }
+
+        std::swap(manager.workerPool, newPool);
+        manager.publishedWorkerPool.store(manager.workerPool.get(), std::memory_order_seq_cst);
+
+        if (newPool != nullptr) {
+            // Multi-core processing was just disabled and newPool now holds the old pool. The audio
+            // thread may have picked it up before it was unpublished, so it's retired like a state
+            // and only deleted (stopping its workers) once the audio thread has finished with it.
+            manager.retiredWorkerPools.push_back(std::move(newPool));
+        }
+
+        manager.reclaimRetiredStates();
+    }
+
+    bool getMultiCoreProcessingEnabled(StateManager& manager) {
+        std::scoped_lock lock(manager.mutatorsMutex);
+        return manager.workerPool != nullptr;
+    }
+
+    void setModulationControlRate(StateManager& manager, int numSamples) {
+        if (numSamples != 0 && numSamples < MIN_MODULATION_CONTROL_RATE) {
+            juce::Logger::writeToLog("ModelInterface::setModulationControlRate: " + juce::String(numSamples) + " is too fast, using " + juce::String(MIN_MODULATION_CONTROL_RATE));
+            numSamples = MIN_MODULATION_CONTROL_RATE;
+        }
+
+        manager.modulationControlRate.store(numSamples, std::memory_order_relaxed);
+    }
+
+    int getModulationControlRate(StateManager& manager) {
+        return manager.modulationControlRate.load(std::memory_order_relaxed);
+    }
+
+    void setSleepingEnabled(StateManager& manager, bool isEnabled) {
+        manager.isSleepingEnabled.store(isEnabled, std::memory_order_relaxed);
+    }
+
+    bool getSleepingEnabled(StateManager& manager) {
+        return manager.isSleepingEnabled.load(std::memory_order_relaxed);
+    }
+
+    void setMaxLatencyCompensationSamples(StateManager& manager, int numSamples) {
+        manager.maxLatencyCompensationSamples.store(std::max(numSamples, 0), std::memory_order_relaxed);
+    }
+
+    int getMaxLatencyCompensationSamples(StateManager& manager) {
+        return manager.maxLatencyCompensationSamples.load(std::memory_order_relaxed);
     }
 
     double getLfoModulationValue(StateManager& manager, int lfoNumber) {
-        // No locks here - they're called from ChainSlotProcessors::prepareToPlay so will already be locked
-        return ModulationProcessors::getLfoModulationValue(*manager.getSourcesStateUnsafe(), lfoNumber);
+        // No locks here - they're called from the audio thread while processing the chains
+        return ModulationProcessors::getLfoModulationValue(*manager.getProcessingStateUnsafe()->modulationSourcesState, lfoNumber);
     }
 
     double getEnvelopeModulationValue(StateManager& manager, int envelopeNumber) {
-        // No locks here - they're called from ChainSlotProcessors::prepareToPlay so will already be locked
-        return ModulationProcessors::getEnvelopeModulationValue(*manager.getSourcesStateUnsafe(), envelopeNumber);
+        // No locks here - they're called from the audio thread while processing the chains
+        return ModulationProcessors::getEnvelopeModulationValue(*manager.getProcessingStateUnsafe()->modulationSourcesState, envelopeNumber);
     }
 
     double getRandomModulationValue(StateManager& manager, int randomNumber) {
-        // No locks here - they're called from ChainSlotProcessors::prepareToPlay so will already be locked
-        return ModulationProcessors::getRandomModulationValue(*manager.getSourcesStateUnsafe(), randomNumber);
+        // No locks here - they're called from the audio thread while processing the chains
+        return ModulationProcessors::getRandomModulationValue(*manager.getProcessingStateUnsafe()->modulationSourcesState, randomNumber);
     }
 
     double getStepSeqModulationValue(StateManager& manager, int stepSeqNumber) {
-        // No locks here - they're called from ChainSlotProcessors::prepareToPlay so will already be locked
-        return ModulationProcessors::getStepSeqModulationValue(*manager.getSourcesStateUnsafe(), stepSeqNumber);
+        // No locks here - they're called from the audio thread while processing the chains
+        return ModulationProcessors::getStepSeqModulationValue(*manager.getProcessingStateUnsafe()->modulationSourcesState, stepSeqNumber);
     }
 }
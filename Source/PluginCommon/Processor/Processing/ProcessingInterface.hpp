@@ -8,7 +8,26 @@ namespace ModelInterface {
     void reset(StateManager& manager);
     void processBlock(StateManager& manager, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, juce::AudioPlayHead::CurrentPositionInfo tempoInfo);
 
-    // Do not call from anything outside the model - they assume the locks are already held
+    juce::uint64 getNumSkippedBlocks(StateManager& manager);
+
+    void setMultiCoreProcessingEnabled(StateManager& manager, bool isEnabled);
+    bool getMultiCoreProcessingEnabled(StateManager& manager);
+
+    // Number of samples between plugin parameter modulation updates, 0 updates once per block
+    constexpr int MIN_MODULATION_CONTROL_RATE {16};
+    void setModulationControlRate(StateManager& manager, int numSamples);
+    int getModulationControlRate(StateManager& manager);
+
+    // Plugins are only put to sleep while their input is silent if this is enabled
+    void setSleepingEnabled(StateManager& manager, bool isEnabled);
+    bool getSleepingEnabled(StateManager& manager);
+
+    // The longest delay the latency compensation of a chain can add, takes effect the next time
+    // the graph is prepared
+    void setMaxLatencyCompensationSamples(StateManager& manager, int numSamples);
+    int getMaxLatencyCompensationSamples(StateManager& manager);
+
+    // Do not call from anything outside the model - they assume they're called while processing
     double getLfoModulationValue(StateManager& manager, int lfoNumber);
     double getEnvelopeModulationValue(StateManager& manager, int envelopeNumber);
     double getRandomModulationValue(StateManager& manager, int randomNumber);
@@ -0,0 +1,375 @@
+#include "RenderAheadQueue.hpp"
+
+#include <cstring>
+
+namespace {
+    constexpr int RENDER_WAIT_TIMEOUT_MS {100};
+
+    // Enough for typical blocks of MIDI without allocating on the render thread
+    constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    /**
+     * Copies source into the regions of the ring buffer given by the FIFO. Channels missing from
+     * source are cleared.
+     */
+    void writeToRing(juce::AudioBuffer<float>& ring, const juce::AbstractFifo::ScopedWrite& scope, const juce::AudioBuffer<float>& source) {
+        for (int channelIndex {0}; channelIndex < ring.getNumChannels(); channelIndex++) {
+            if (channelIndex < source.getNumChannels()) {
+                ring.copyFrom(channelIndex, scope.startIndex1, source, channelIndex, 0, scope.blockSize1);
+                ring.copyFrom(channelIndex, scope.startIndex2, source, channelIndex, scope.blockSize1, scope.blockSize2);
+            } else {
+                ring.clear(channelIndex, scope.startIndex1, scope.blockSize1);
+                ring.clear(channelIndex, scope.startIndex2, scope.blockSize2);
+            }
+        }
+    }
+
+    void readFromRing(const juce::AudioBuffer<float>& ring, const juce::AbstractFifo::ScopedRead& scope, juce::AudioBuffer<float>& destination) {
+        for (int channelIndex {0}; channelIndex < std::min(ring.getNumChannels(), destination.getNumChannels()); channelIndex++) {
+            destination.copyFrom(channelIndex, 0, ring, channelIndex, scope.startIndex1, scope.blockSize1);
+            destination.copyFrom(channelIndex, scope.blockSize1, ring, channelIndex, scope.startIndex2, scope.blockSize2);
+        }
+    }
+
+    /**
+     * Queues a MIDI message at an absolute sample position. Drops it if the FIFO is full or the
+     * message is too long to store, which will only happen for large sysex messages.
+     */
+    template <typename EventType>
+    void pushMidiEvent(juce::AbstractFifo& fifo,
+                       std::vector<EventType>& events,
+                       const juce::MidiMessageMetadata& metadata,
+                       juce::int64 samplePosition) {
+        if (fifo.getFreeSpace() < 1 || metadata.numBytes > static_cast<int>(sizeof(EventType::data))) {
+            return;
+        }
+
+        const auto scope = fifo.write(1);
+        EventType& event = events[scope.startIndex1];
+        event.samplePosition = samplePosition;
+        event.numBytes = metadata.numBytes;
+        std::memcpy(event.data, metadata.data, metadata.numBytes);
+    }
+}
+
+RenderAheadQueue::RenderThread::RenderThread(RenderAheadQueue& queue)
+        : juce::Thread("Render Ahead"), _queue(queue) {
+}
+
+RenderAheadQueue::RenderThread::~RenderThread() {
+    signalThreadShouldExit();
+    _wakeEvent.signal();
+    stopThread(1000);
+}
+
+void RenderAheadQueue::RenderThread::run() {
+    // Guest plugins expect the same floating point environment as the audio thread
+    juce::ScopedNoDenormals noDenormals;
+
+    while (!threadShouldExit()) {
+        while (!threadShouldExit() && _queue._renderNextBlock()) {
+            // Keep rendering until the input runs out or the output is full
+        }
+
+        _wakeEvent.wait(RENDER_WAIT_TIMEOUT_MS);
+    }
+}
+
+RenderAheadQueue::RenderAheadQueue(RenderFunction render) :
+        _render(render),
+        _isEnabled(true),
+        _shouldFlush(false),
+        _isActive(false),
+        _isRendering(false),
+        _numUnderruns(0),
+        _numChannels(0),
+        _blockSize(0),
+        _sampleRate(44100),
+        _numLookaheadBlocks(0),
+        _inputFifo(1),
+        _outputFifo(1),
+        _inputMidiFifo(MAX_NUM_MIDI_EVENTS),
+        _outputMidiFifo(MAX_NUM_MIDI_EVENTS),
+        _positionFifo(MAX_NUM_POSITIONS),
+        _inputMidiEvents(MAX_NUM_MIDI_EVENTS),
+        _outputMidiEvents(MAX_NUM_MIDI_EVENTS),
+        _positions(MAX_NUM_POSITIONS),
+        _numSamplesQueued(0),
+        _numSamplesOutput(0),
+        _numSamplesToSkip(0),
+        _numSamplesRendered(0),
+        _lastPosition{0, juce::AudioPlayHead::PositionInfo()} {
+    _renderMidi.ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+}
+
+RenderAheadQueue::~RenderAheadQueue() {
+    // Stop the render thread before the buffers it might be using are destroyed
+    release();
+}
+
+void RenderAheadQueue::prepare(int numChannels, int blockSize, double sampleRate, int numLookaheadBlocks) {
+    release();
+
+    _numChannels = numChannels;
+    _blockSize = blockSize;
+    _sampleRate = sampleRate;
+    _numLookaheadBlocks = juce::jlimit(0, MAX_LOOKAHEAD_BLOCKS, numLookaheadBlocks);
+
+    if (_numLookaheadBlocks == 0 || _numChannels <= 0 || _blockSize <= 0) {
+        _numLookaheadBlocks = 0;
+        return;
+    }
+
+    // Room for the primed latency, the block being rendered, and the block being queued by the host
+    // (AbstractFifo can only hold one less than its size)
+    const int fifoSize {(_numLookaheadBlocks + 2) * _blockSize + 1};
+    _inputFifo.setTotalSize(fifoSize);
+    _outputFifo.setTotalSize(fifoSize);
+    _inputBuffer.setSize(_numChannels, fifoSize);
+    _outputBuffer.setSize(_numChannels, fifoSize);
+    _renderBuffer.setSize(_numChannels, _blockSize);
+
+    _reset();
+
+    _thread = std::make_unique<RenderThread>(*this);
+    _thread->startThread(juce::Thread::Priority::highest);
+}
+
+void RenderAheadQueue::release() {
+    _isActive.store(false);
+    _thread.reset();
+}
+
+bool RenderAheadQueue::process(juce::AudioBuffer<float>& buffer,
+                               juce::MidiBuffer& midiMessages,
+                               const juce::AudioPlayHead::PositionInfo& position) {
+    const bool shouldBeActive {
+        isEnabled()
+        && _thread != nullptr
+        && buffer.getNumSamples() <= _blockSize
+        && buffer.getNumChannels() <= _numChannels
+    };
+
+    // This store and the load of _isRendering pair with the opposite order on the render thread, so
+    // at least one of the threads always sees the other and they never both use the graph
+    if (!shouldBeActive) {
+        _isActive.store(false);
+
+        if (!_isRendering.load()) {
+            return false;
+        }
+
+        // The render thread is still finishing a block and can't share the graph yet
+        buffer.clear();
+        midiMessages.clear();
+        return true;
+    }
+
+    if (_shouldFlush.exchange(false)) {
+        // Handled the same way as starting again after falling behind
+        _isActive.store(false);
+    }
+
+    if (!_isActive.load(std::memory_order_relaxed) || _inputFifo.getFreeSpace() < buffer.getNumSamples()) {
+        // Either just enabled or flushed, or the render thread has fallen too far behind to catch
+        // up, start again from silence once the render thread has stopped using the FIFOs
+        _isActive.store(false);
+
+        if (_isRendering.load()) {
+            buffer.clear();
+            midiMessages.clear();
+            return true;
+        }
+
+        _reset();
+        _isActive.store(true);
+    }
+
+    _pushInput(buffer, midiMessages, position);
+    _thread->wake();
+    _popOutput(buffer, midiMessages);
+
+    return true;
+}
+
+void RenderAheadQueue::_reset() {
+    _inputFifo.reset();
+    _outputFifo.reset();
+    _inputMidiFifo.reset();
+    _outputMidiFifo.reset();
+    _positionFifo.reset();
+
+    _numSamplesQueued = 0;
+    _numSamplesOutput = 0;
+    _numSamplesToSkip = 0;
+    _numSamplesRendered = 0;
+    _lastPosition = {0, juce::AudioPlayHead::PositionInfo()};
+
+    // Prime the output with silence for the length of the latency
+    const int latencySamples {getLatencySamples()};
+    const auto scope = _outputFifo.write(latencySamples);
+    _outputBuffer.clear(scope.startIndex1, scope.blockSize1);
+    _outputBuffer.clear(scope.startIndex2, scope.blockSize2);
+}
+
+void RenderAheadQueue::_pushInput(const juce::AudioBuffer<float>& buffer,
+                                  const juce::MidiBuffer& midiMessages,
+                                  const juce::AudioPlayHead::PositionInfo& position) {
+    // MIDI and the position are written before the audio, so they're ready by the time the render
+    // thread sees the audio
+    for (const juce::MidiMessageMetadata metadata : midiMessages) {
+        pushMidiEvent(_inputMidiFifo, _inputMidiEvents, metadata, _numSamplesQueued + metadata.samplePosition);
+    }
+
+    if (_positionFifo.getFreeSpace() > 0) {
+        const auto scope = _positionFifo.write(1);
+        _positions[scope.startIndex1] = {_numSamplesQueued, position};
+    }
+
+    const auto scope = _inputFifo.write(buffer.getNumSamples());
+    writeToRing(_inputBuffer, scope, buffer);
+
+    _numSamplesQueued += buffer.getNumSamples();
+}
+
+void RenderAheadQueue::_popOutput(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+    const int numSamples {buffer.getNumSamples()};
+
+    // Discard audio that was replaced with silence during an underrun, so the latency stays the
+    // same as the one reported
+    const int numSamplesToSkip {static_cast<int>(std::min<juce::int64>(_numSamplesToSkip, _outputFifo.getNumReady()))};
+    if (numSamplesToSkip > 0) {
+        _outputFifo.finishedRead(numSamplesToSkip);
+        _numSamplesOutput += numSamplesToSkip;
+        _numSamplesToSkip -= numSamplesToSkip;
+    }
+
+    int numSamplesRead {0};
+    if (_numSamplesToSkip == 0 && _outputFifo.getNumReady() >= numSamples) {
+        const auto scope = _outputFifo.read(numSamples);
+        readFromRing(_outputBuffer, scope, buffer);
+        numSamplesRead = numSamples;
+    } else {
+        buffer.clear();
+        _numSamplesToSkip += numSamples;
+        _numUnderruns++;
+    }
+
+    // Rendered MIDI is output at the same position as the audio it was rendered with, anything
+    // belonging to skipped audio is dropped
+    midiMessages.clear();
+    const juce::int64 latencySamples {getLatencySamples()};
+
+    while (_outputMidiFifo.getNumReady() > 0) {
+        int start1, size1, start2, size2;
+        _outputMidiFifo.prepareToRead(1, start1, size1, start2, size2);
+        const MidiEvent& event = _outputMidiEvents[start1];
+
+        const juce::int64 outputPosition {event.samplePosition + latencySamples};
+        if (outputPosition >= _numSamplesOutput + numSamplesRead) {
+            break;
+        }
+
+        if (outputPosition >= _numSamplesOutput) {
+            midiMessages.addEvent(event.data, event.numBytes, static_cast<int>(outputPosition - _numSamplesOutput));
+        }
+
+        _outputMidiFifo.finishedRead(1);
+    }
+
+    _numSamplesOutput += numSamplesRead;
+}
+
+bool RenderAheadQueue::_renderNextBlock() {
+    // See process() for the other half of this
+    _isRendering.store(true);
+
+    const bool canRender {
+        _isActive.load()
+        && _inputFifo.getNumReady() >= _blockSize
+        && _outputFifo.getFreeSpace() >= _blockSize
+    };
+
+    if (canRender) {
+        _renderBlock();
+    }
+
+    _isRendering.store(false);
+
+    return canRender;
+}
+
+void RenderAheadQueue::_renderBlock() {
+    const juce::int64 blockStart {_numSamplesRendered};
+
+    {
+        const auto scope = _inputFifo.read(_blockSize);
+        readFromRing(_inputBuffer, scope, _renderBuffer);
+    }
+
+    _renderMidi.clear();
+    while (_inputMidiFifo.getNumReady() > 0) {
+        int start1, size1, start2, size2;
+        _inputMidiFifo.prepareToRead(1, start1, size1, start2, size2);
+        const MidiEvent& event = _inputMidiEvents[start1];
+
+        if (event.samplePosition >= blockStart + _blockSize) {
+            break;
+        }
+
+        _renderMidi.addEvent(event.data, event.numBytes, static_cast<int>(std::max<juce::int64>(0, event.samplePosition - blockStart)));
+        _inputMidiFifo.finishedRead(1);
+    }
+
+    _playHead.position = _getPositionForBlock(blockStart);
+    _render(_renderBuffer, _renderMidi, &_playHead, _playHead.position);
+
+    for (const juce::MidiMessageMetadata metadata : _renderMidi) {
+        pushMidiEvent(_outputMidiFifo, _outputMidiEvents, metadata, blockStart + metadata.samplePosition);
+    }
+
+    {
+        const auto scope = _outputFifo.write(_blockSize);
+        writeToRing(_outputBuffer, scope, _renderBuffer);
+    }
+
+    _numSamplesRendered += _blockSize;
+}
+
+juce::AudioPlayHead::PositionInfo RenderAheadQueue::_getPositionForBlock(juce::int64 blockStart) {
+    // Use the last position the host gave at or before the start of this block
+    while (_positionFifo.getNumReady() > 0) {
+        int start1, size1, start2, size2;
+        _positionFifo.prepareToRead(1, start1, size1, start2, size2);
+
+        if (_positions[start1].samplePosition > blockStart) {
+            break;
+        }
+
+        _lastPosition = _positions[start1];
+        _positionFifo.finishedRead(1);
+    }
+
+    juce::AudioPlayHead::PositionInfo retVal = _lastPosition.position;
+
+    // If the host's blocks are smaller than ours it may not have given a position for the start of
+    // this block, so move the last one forward
+    if (retVal.getIsPlaying() && blockStart != _lastPosition.samplePosition) {
+        const juce::int64 offsetSamples {blockStart - _lastPosition.samplePosition};
+        const double offsetSeconds {offsetSamples / _sampleRate};
+
+        if (const auto timeInSamples = retVal.getTimeInSamples()) {
+            retVal.setTimeInSamples(*timeInSamples + offsetSamples);
+        }
+
+        if (const auto timeInSeconds = retVal.getTimeInSeconds()) {
+            retVal.setTimeInSeconds(*timeInSeconds + offsetSeconds);
+        }
+
+        if (const auto ppqPosition = retVal.getPpqPosition()) {
+            retVal.setPpqPosition(*ppqPosition + offsetSeconds * retVal.getBpm().orFallback(120.0) / 60.0);
+        }
+    }
+
+    return retVal;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+ * Renders the processing graph a number of blocks ahead of the host on a dedicated thread, so
+ * plugin work isn't tied to the deadline of each host callback and a CPU spike in one block can be
+ * absorbed by the blocks around it. The cost is getLatencySamples() of extra latency.
+ *
+ * The host callback only copies its input into a FIFO and copies finished audio out of another, in
+ * internal blocks of the size given to prepare(). MIDI and the playhead position are queued with
+ * the audio and replayed to the graph at the right sample, and a playhead is provided to the graph
+ * which extrapolates the position from the most recent host block.
+ *
+ * The FIFOs are single producer single consumer and lock free. If the render thread falls behind
+ * the output is filled with silence and counted as an underrun, the host callback never waits.
+ *
+ * Enabling and disabling is handed over between the threads so that the graph is never processed
+ * by both at once: process() returns false when the caller should process the graph itself.
+ */
+class RenderAheadQueue {
+public:
+    static constexpr int MAX_LOOKAHEAD_BLOCKS {8};
+    static constexpr int MAX_NUM_MIDI_EVENTS {2048};
+    static constexpr int MAX_MIDI_EVENT_BYTES {16};
+    static constexpr int MAX_NUM_POSITIONS {1024};
+
+    typedef std::function<void(juce::AudioBuffer<float>&,
+                               juce::MidiBuffer&,
+                               juce::AudioPlayHead*,
+                               const juce::AudioPlayHead::PositionInfo&)> RenderFunction;
+
+    explicit RenderAheadQueue(RenderFunction render);
+    ~RenderAheadQueue();
+
+    /**
+     * Allocates the FIFOs and starts the render thread. Must not be called while process() is in
+     * progress. numLookaheadBlocks is limited to MAX_LOOKAHEAD_BLOCKS, 0 disables rendering ahead.
+     */
+    void prepare(int numChannels, int blockSize, double sampleRate, int numLookaheadBlocks);
+
+    /**
+     * Stops the render thread.
+     */
+    void release();
+
+    /**
+     * Requests rendering ahead to be turned on or off. Takes effect on the next call to process().
+     */
+    void setEnabled(bool isEnabled) { _isEnabled.store(isEnabled); }
+    bool isEnabled() const { return _isEnabled.load() && _numLookaheadBlocks > 0; }
+
+    /**
+     * Discards the audio and MIDI that has been queued or rendered, the output is silent for the
+     * latency again as if rendering ahead had just started. Safe to call from any thread, including
+     * the audio thread, as it doesn't stop the render thread. Takes effect on the next call to
+     * process().
+     */
+    void flush() { _shouldFlush.store(true); }
+
+    /**
+     * The latency to report to the host while enabled.
+     */
+    int getLatencySamples() const { return _numLookaheadBlocks * _blockSize; }
+
+    /**
+     * Called from the host callback. If rendering ahead is active, queues the buffer and MIDI to be
+     * rendered and replaces them with the audio and MIDI rendered getLatencySamples() earlier.
+     *
+     * Returns false if rendering ahead isn't active, in which case the buffers are untouched and the
+     * caller must process the graph itself.
+     */
+    bool process(juce::AudioBuffer<float>& buffer,
+                 juce::MidiBuffer& midiMessages,
+                 const juce::AudioPlayHead::PositionInfo& position);
+
+    /**
+     * The number of rendered samples waiting to be output.
+     */
+    int getNumSamplesReady() const { return _outputFifo.getNumReady(); }
+
+    juce::uint64 getNumUnderruns() const { return _numUnderruns.load(); }
+
+private:
+    struct MidiEvent {
+        juce::int64 samplePosition;
+        int numBytes;
+        juce::uint8 data[MAX_MIDI_EVENT_BYTES];
+    };
+
+    struct PositionSnapshot {
+        juce::int64 samplePosition;
+        juce::AudioPlayHead::PositionInfo position;
+    };
+
+    class RenderPlayHead : public juce::AudioPlayHead {
+    public:
+        juce::AudioPlayHead::PositionInfo position;
+
+        juce::Optional<juce::AudioPlayHead::PositionInfo> getPosition() const override { return position; }
+    };
+
+    class RenderThread : public juce::Thread {
+    public:
+        explicit RenderThread(RenderAheadQueue& queue);
+        ~RenderThread();
+
+        void wake() { _wakeEvent.signal(); }
+        void run() override;
+
+    private:
+        RenderAheadQueue& _queue;
+        juce::WaitableEvent _wakeEvent;
+    };
+
+    RenderFunction _render;
+
+    // Requested by the message thread
+    std::atomic<bool> _isEnabled;
+
+    // Set by flush(), cleared by the host callback when it starts again from silence
+    std::atomic<bool> _shouldFlush;
+
+    // Owned by the host callback, the render thread only renders while this is set
+    std::atomic<bool> _isActive;
+
+    // Set by the render thread while it may be using the graph
+    std::atomic<bool> _isRendering;
+
+    std::atomic<juce::uint64> _numUnderruns;
+
+    int _numChannels;
+    int _blockSize;
+    double _sampleRate;
+    int _numLookaheadBlocks;
+
+    juce::AbstractFifo _inputFifo;
+    juce::AbstractFifo _outputFifo;
+    juce::AbstractFifo _inputMidiFifo;
+    juce::AbstractFifo _outputMidiFifo;
+    juce::AbstractFifo _positionFifo;
+    juce::AudioBuffer<float> _inputBuffer;
+    juce::AudioBuffer<float> _outputBuffer;
+    std::vector<MidiEvent> _inputMidiEvents;
+    std::vector<MidiEvent> _outputMidiEvents;
+    std::vector<PositionSnapshot> _positions;
+
+    // Only used by the host callback
+    juce::int64 _numSamplesQueued;
+    juce::int64 _numSamplesOutput;
+    juce::int64 _numSamplesToSkip;
+
+    // Only used by the render thread
+    juce::int64 _numSamplesRendered;
+    PositionSnapshot _lastPosition;
+    RenderPlayHead _playHead;
+    juce::AudioBuffer<float> _renderBuffer;
+    juce::MidiBuffer _renderMidi;
+
+    std::unique_ptr<RenderThread> _thread;
+
+    void _reset();
+    void _pushInput(const juce::AudioBuffer<float>& buffer,
+                    const juce::MidiBuffer& midiMessages,
+                    const juce::AudioPlayHead::PositionInfo& position);
+    void _popOutput(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    bool _renderNextBlock();
+    void _renderBlock();
+    juce::AudioPlayHead::PositionInfo _getPositionForBlock(juce::int64 blockStart);
+
+    JUCE_DECLARE_NON_COPYABLE(RenderAheadQueue)
+};
@@ -0,0 +1,174 @@
+#include "catch.hpp"
+#include "RenderAheadQueue.hpp"
+
+namespace {
+    constexpr int NUM_SAMPLES {10};
+    constexpr int SAMPLE_RATE {2000};
+    constexpr int NUM_LOOKAHEAD_BLOCKS {2};
+    constexpr int NUM_BLOCKS {6};
+
+    void renderDouble(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/, juce::AudioPlayHead* /*playHead*/, const juce::AudioPlayHead::PositionInfo& /*position*/) {
+        buffer.applyGain(2);
+    }
+
+    // Gives the render thread time to render the block that was just queued
+    bool waitForSamplesReady(const RenderAheadQueue& queue, int numSamples) {
+        for (int attempt {0}; attempt < 1000; attempt++) {
+            if (queue.getNumSamplesReady() >= numSamples) {
+                return true;
+            }
+
+            juce::Thread::sleep(1);
+        }
+
+        return false;
+    }
+}
+
+SCENARIO("RenderAheadQueue: Audio and MIDI are rendered ahead and delayed by the reported latency") {
+    GIVEN("A queue that renders ahead") {
+        RenderAheadQueue queue(renderDouble);
+        queue.prepare(2, NUM_SAMPLES, SAMPLE_RATE, NUM_LOOKAHEAD_BLOCKS);
+
+        REQUIRE(queue.isEnabled());
+        REQUIRE(queue.getLatencySamples() == NUM_LOOKAHEAD_BLOCKS * NUM_SAMPLES);
+
+        WHEN("Several blocks are processed") {
+            std::vector<juce::AudioBuffer<float>> outputs;
+            std::vector<juce::MidiBuffer> outputMidi;
+
+            for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+                for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                    juce::FloatVectorOperations::fill(buffer.getWritePointer(channelIdx), blockIndex + 1, NUM_SAMPLES);
+                }
+
+                juce::MidiBuffer midiMessages;
+                if (blockIndex == 0) {
+                    midiMessages.addEvent(juce::MidiMessage::noteOn(1, 60, 0.5f), 3);
+                }
+
+                CHECK(queue.process(buffer, midiMessages, juce::AudioPlayHead::PositionInfo()));
+                CHECK(waitForSamplesReady(queue, queue.getLatencySamples()));
+
+                outputs.push_back(buffer);
+                outputMidi.push_back(midiMessages);
+            }
+
+            THEN("The output is silent for the latency, then is the rendered input") {
+                for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                    const float expectedValue {blockIndex < NUM_LOOKAHEAD_BLOCKS ? 0.0f : 2.0f * (blockIndex - NUM_LOOKAHEAD_BLOCKS + 1)};
+
+                    for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                        for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                            CHECK(outputs[blockIndex].getReadPointer(channelIdx)[sampleIdx] == Approx(expectedValue));
+                        }
+                    }
+                }
+            }
+
+            AND_THEN("The MIDI is delayed by the same amount") {
+                for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                    if (blockIndex == NUM_LOOKAHEAD_BLOCKS) {
+                        REQUIRE(outputMidi[blockIndex].getNumEvents() == 1);
+                        const juce::MidiMessageMetadata metadata = *outputMidi[blockIndex].begin();
+                        CHECK(metadata.samplePosition == 3);
+                        CHECK(metadata.getMessage().isNoteOn());
+                    } else {
+                        CHECK(outputMidi[blockIndex].isEmpty());
+                    }
+                }
+            }
+
+            AND_THEN("There were no underruns") {
+                CHECK(queue.getNumUnderruns() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("RenderAheadQueue: Flushing discards what was rendered and starts again from silence") {
+    GIVEN("A queue that has rendered some blocks ahead") {
+        RenderAheadQueue queue(renderDouble);
+        queue.prepare(2, NUM_SAMPLES, SAMPLE_RATE, NUM_LOOKAHEAD_BLOCKS);
+
+        auto processBlock = [&queue](float value) {
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+            for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                juce::FloatVectorOperations::fill(buffer.getWritePointer(channelIdx), value, NUM_SAMPLES);
+            }
+
+            juce::MidiBuffer midiMessages;
+            CHECK(queue.process(buffer, midiMessages, juce::AudioPlayHead::PositionInfo()));
+            CHECK(waitForSamplesReady(queue, queue.getLatencySamples()));
+
+            return buffer;
+        };
+
+        for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+            processBlock(1);
+        }
+
+        WHEN("It's flushed and more blocks are processed") {
+            queue.flush();
+
+            std::vector<juce::AudioBuffer<float>> outputs;
+            for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                outputs.push_back(processBlock(blockIndex + 10));
+            }
+
+            THEN("The output is silent for the latency, then is the input given after the flush") {
+                // The first block may be silence while the render thread finishes a block, in which
+                // case the queue starts again from the block after
+                const int numSilentBlocks {outputs[NUM_LOOKAHEAD_BLOCKS].getSample(0, 0) == 0 ? NUM_LOOKAHEAD_BLOCKS + 1 : NUM_LOOKAHEAD_BLOCKS};
+
+                for (int blockIndex {0}; blockIndex < NUM_BLOCKS; blockIndex++) {
+                    const float expectedValue {blockIndex < numSilentBlocks ? 0.0f : 2.0f * (blockIndex - NUM_LOOKAHEAD_BLOCKS + 10)};
+
+                    for (int channelIdx {0}; channelIdx < 2; channelIdx++) {
+                        for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+                            CHECK(outputs[blockIndex].getReadPointer(channelIdx)[sampleIdx] == Approx(expectedValue));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("RenderAheadQueue: The caller processes directly when rendering ahead isn't active") {
+    GIVEN("A queue") {
+        RenderAheadQueue queue(renderDouble);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiMessages;
+
+        WHEN("It's prepared with no lookahead") {
+            queue.prepare(2, NUM_SAMPLES, SAMPLE_RATE, 0);
+
+            THEN("It isn't enabled and has no latency") {
+                CHECK_FALSE(queue.isEnabled());
+                CHECK(queue.getLatencySamples() == 0);
+                CHECK_FALSE(queue.process(buffer, midiMessages, juce::AudioPlayHead::PositionInfo()));
+            }
+        }
+
+        WHEN("It's prepared with lookahead but disabled") {
+            queue.prepare(2, NUM_SAMPLES, SAMPLE_RATE, NUM_LOOKAHEAD_BLOCKS);
+            queue.setEnabled(false);
+
+            THEN("The buffer isn't processed") {
+                CHECK_FALSE(queue.process(buffer, midiMessages, juce::AudioPlayHead::PositionInfo()));
+            }
+        }
+
+        WHEN("The host gives a block larger than the prepared block size") {
+            queue.prepare(2, NUM_SAMPLES / 2, SAMPLE_RATE, NUM_LOOKAHEAD_BLOCKS);
+
+            THEN("The buffer isn't processed") {
+                CHECK_FALSE(queue.process(buffer, midiMessages, juce::AudioPlayHead::PositionInfo()));
+            }
+        }
+    }
+}
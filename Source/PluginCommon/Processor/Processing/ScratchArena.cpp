@@ -0,0 +1,92 @@
+#include "ScratchArena.hpp"
+
+ScratchArena::ScratchArena() :
+        _numBuffersAllocated(0),
+        _numBuffersBorrowed(0),
+        _numMidiBuffersBorrowed(0),
+        _numChannels(0),
+        _blockSize(0) {
+}
+
+void ScratchArena::prepare(int numChannels, int blockSize, int numBuffers) {
+    _numChannels = numChannels;
+    _blockSize = blockSize;
+
+    for (int index {0}; index < _numBuffersAllocated.load(std::memory_order_relaxed); index++) {
+        _buffers[index]->setSize(_numChannels, _blockSize);
+        _buffers[index]->clear();
+    }
+
+    ensureCapacity(numBuffers);
+    reset();
+}
+
+void ScratchArena::ensureCapacity(int numBuffers) {
+    const int numBuffersAllocated {_numBuffersAllocated.load(std::memory_order_relaxed)};
+    const int numBuffersNeeded {std::min(numBuffers, MAX_NUM_BUFFERS)};
+
+    if (numBuffersNeeded > numBuffersAllocated) {
+        _addBuffers(numBuffersNeeded - numBuffersAllocated);
+    }
+}
+
+bool ScratchArena::canBorrow(int numBuffers, int numChannels, int numSamples) const {
+    const int numBuffersAvailable {
+        _numBuffersAllocated.load(std::memory_order_acquire) - _numBuffersBorrowed.load(std::memory_order_relaxed)
+    };
+
+    return numBuffers <= numBuffersAvailable && numChannels <= _numChannels && numSamples <= _blockSize;
+}
+
+juce::AudioBuffer<float> ScratchArena::borrow(int numChannels, int numSamples) {
+    if (numChannels > _numChannels || numSamples > _blockSize) {
+        return juce::AudioBuffer<float>();
+    }
+
+    const int index {_numBuffersBorrowed.fetch_add(1, std::memory_order_relaxed)};
+    if (index >= _numBuffersAllocated.load(std::memory_order_acquire)) {
+        return juce::AudioBuffer<float>();
+    }
+
+    // Crop the buffer in case the DAW has provided a buffer smaller than the specified block size
+    // in prepareToPlay. Referring to existing data doesn't allocate.
+    return juce::AudioBuffer<float>(_buffers[index]->getArrayOfWritePointers(), numChannels, numSamples);
+}
+
+bool ScratchArena::canBorrowMidi(int numBuffers) const {
+    const int numBuffersAvailable {
+        _numBuffersAllocated.load(std::memory_order_acquire) - _numMidiBuffersBorrowed.load(std::memory_order_relaxed)
+    };
+
+    return numBuffers <= numBuffersAvailable;
+}
+
+juce::MidiBuffer* ScratchArena::borrowMidi() {
+    const int index {_numMidiBuffersBorrowed.fetch_add(1, std::memory_order_relaxed)};
+    if (index >= _numBuffersAllocated.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // Clearing keeps the reserved space
+    juce::MidiBuffer* midiBuffer {_midiBuffers[index].get()};
+    midiBuffer->clear();
+    return midiBuffer;
+}
+
+void ScratchArena::_addBuffers(int numBuffers) {
+    const int firstIndex {_numBuffersAllocated.load(std::memory_order_relaxed)};
+    const int lastIndex {std::min(firstIndex + numBuffers, MAX_NUM_BUFFERS)};
+
+    for (int index {firstIndex}; index < lastIndex; index++) {
+        auto buffer = std::make_unique<juce::AudioBuffer<float>>(_numChannels, _blockSize);
+        buffer->clear();
+        _buffers[index] = std::move(buffer);
+
+        auto midiBuffer = std::make_unique<juce::MidiBuffer>();
+        midiBuffer->ensureSize(MIDI_BUFFER_RESERVED_BYTES);
+        _midiBuffers[index] = std::move(midiBuffer);
+    }
+
+    // Publish the new buffers only once they're fully constructed
+    _numBuffersAllocated.store(lastIndex, std::memory_order_release);
+}
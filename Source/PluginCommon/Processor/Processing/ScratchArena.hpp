@@ -0,0 +1,91 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Audio and MIDI buffers shared by all the processors in a plugin instance, so the data model
+ * doesn't need to own any audio memory of its own.
+ *
+ * Buffers are borrowed for the duration of a block and all returned at once by reset() at the
+ * start of the next one. Borrowing is a single atomic increment, so chains running concurrently on
+ * the worker pool can borrow at the same time without locking.
+ *
+ * All memory is allocated in prepare() and ensureCapacity(). Buffers live in a fixed size table and
+ * are never moved once created, so ensureCapacity() can be called from a mutator thread while the
+ * audio thread is borrowing.
+ */
+class ScratchArena {
+public:
+    static constexpr int DEFAULT_NUM_BUFFERS {8};
+    static constexpr int MAX_NUM_BUFFERS {128};
+    static constexpr int MIDI_BUFFER_RESERVED_BYTES {2048};
+
+    ScratchArena();
+
+    /**
+     * Allocates the buffers. Must not be called while the audio thread is processing.
+     */
+    void prepare(int numChannels, int blockSize, int numBuffers);
+
+    /**
+     * Adds buffers if needed so that at least numBuffers (up to MAX_NUM_BUFFERS) can be borrowed in
+     * one block. Safe to call while the audio thread is processing, but not concurrently with
+     * itself or prepare().
+     */
+    void ensureCapacity(int numBuffers);
+
+    /**
+     * Returns true if numBuffers more buffers of the given size can be borrowed in this block.
+     */
+    bool canBorrow(int numBuffers, int numChannels, int numSamples) const;
+
+    /**
+     * Returns a buffer which refers to the arena's memory and is valid until the next call to
+     * reset(). The contents are whatever was left there by the last block, so callers must clear it
+     * if they need silence.
+     *
+     * Returns an empty buffer if there isn't space left.
+     */
+    juce::AudioBuffer<float> borrow(int numChannels, int numSamples);
+
+    /**
+     * Returns true if numBuffers more MIDI buffers can be borrowed in this block. There are as many
+     * MIDI buffers as audio buffers, but they're borrowed separately.
+     */
+    bool canBorrowMidi(int numBuffers) const;
+
+    /**
+     * Returns an empty MIDI buffer with space reserved when the arena was prepared, which is valid
+     * until the next call to reset().
+     *
+     * Returns nullptr if there isn't one left.
+     */
+    juce::MidiBuffer* borrowMidi();
+
+    /**
+     * Returns all borrowed buffers. Called at the start of each block once nothing from the
+     * previous block is still in use.
+     */
+    void reset() {
+        _numBuffersBorrowed.store(0, std::memory_order_relaxed);
+        _numMidiBuffersBorrowed.store(0, std::memory_order_relaxed);
+    }
+
+    int getNumChannels() const { return _numChannels; }
+    int getBlockSize() const { return _blockSize; }
+
+private:
+    std::array<std::unique_ptr<juce::AudioBuffer<float>>, MAX_NUM_BUFFERS> _buffers;
+    std::array<std::unique_ptr<juce::MidiBuffer>, MAX_NUM_BUFFERS> _midiBuffers;
+    std::atomic<int> _numBuffersAllocated;
+    std::atomic<int> _numBuffersBorrowed;
+    std::atomic<int> _numMidiBuffersBorrowed;
+    int _numChannels;
+    int _blockSize;
+
+    void _addBuffers(int numBuffers);
+
+    JUCE_DECLARE_NON_COPYABLE(ScratchArena)
+};
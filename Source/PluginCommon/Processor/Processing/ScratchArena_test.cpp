@@ -0,0 +1,119 @@
+#include "catch.hpp"
+
+#include "ScratchArena.hpp"
+
+namespace {
+    constexpr int NUM_CHANNELS {4};
+    constexpr int BLOCK_SIZE {16};
+}
+
+SCENARIO("ScratchArena: Buffers can be borrowed until the arena is full") {
+    GIVEN("A prepared arena") {
+        ScratchArena scratchArena;
+        scratchArena.prepare(NUM_CHANNELS, BLOCK_SIZE, 2);
+
+        THEN("It can lend buffers that fit in its preallocated space") {
+            CHECK(scratchArena.canBorrow(2, NUM_CHANNELS, BLOCK_SIZE));
+            CHECK(scratchArena.canBorrow(1, 2, BLOCK_SIZE / 2));
+        }
+
+        AND_THEN("It can't lend buffers that don't fit") {
+            CHECK_FALSE(scratchArena.canBorrow(3, NUM_CHANNELS, BLOCK_SIZE));
+            CHECK_FALSE(scratchArena.canBorrow(1, NUM_CHANNELS + 1, BLOCK_SIZE));
+            CHECK_FALSE(scratchArena.canBorrow(1, NUM_CHANNELS, BLOCK_SIZE + 1));
+        }
+
+        WHEN("Two buffers are borrowed") {
+            juce::AudioBuffer<float> firstBuffer {scratchArena.borrow(2, BLOCK_SIZE / 2)};
+            juce::AudioBuffer<float> secondBuffer {scratchArena.borrow(NUM_CHANNELS, BLOCK_SIZE)};
+
+            THEN("They have the requested size and don't overlap") {
+                CHECK(firstBuffer.getNumChannels() == 2);
+                CHECK(firstBuffer.getNumSamples() == BLOCK_SIZE / 2);
+                CHECK(secondBuffer.getNumChannels() == NUM_CHANNELS);
+                CHECK(secondBuffer.getNumSamples() == BLOCK_SIZE);
+
+                firstBuffer.clear();
+                juce::FloatVectorOperations::fill(secondBuffer.getWritePointer(0), 1, BLOCK_SIZE);
+                CHECK(firstBuffer.getSample(0, 0) == 0);
+            }
+
+            AND_THEN("There's no space for another") {
+                CHECK_FALSE(scratchArena.canBorrow(1, NUM_CHANNELS, BLOCK_SIZE));
+                CHECK(scratchArena.borrow(NUM_CHANNELS, BLOCK_SIZE).getNumChannels() == 0);
+            }
+
+            AND_WHEN("The arena is reset") {
+                float* const firstBufferData {firstBuffer.getWritePointer(0)};
+                scratchArena.reset();
+
+                THEN("The same memory is lent again") {
+                    juce::AudioBuffer<float> thirdBuffer {scratchArena.borrow(NUM_CHANNELS, BLOCK_SIZE)};
+                    CHECK(thirdBuffer.getWritePointer(0) == firstBufferData);
+                }
+            }
+        }
+
+        WHEN("The capacity is increased") {
+            scratchArena.ensureCapacity(3);
+
+            THEN("It can lend the extra buffer") {
+                CHECK(scratchArena.canBorrow(3, NUM_CHANNELS, BLOCK_SIZE));
+            }
+        }
+
+        WHEN("The capacity is increased beyond the maximum") {
+            scratchArena.ensureCapacity(ScratchArena::MAX_NUM_BUFFERS + 1);
+
+            THEN("It's limited to the maximum") {
+                CHECK(scratchArena.canBorrow(ScratchArena::MAX_NUM_BUFFERS, NUM_CHANNELS, BLOCK_SIZE));
+                CHECK_FALSE(scratchArena.canBorrow(ScratchArena::MAX_NUM_BUFFERS + 1, NUM_CHANNELS, BLOCK_SIZE));
+            }
+        }
+    }
+}
+
+SCENARIO("ScratchArena: MIDI buffers can be borrowed separately from audio buffers") {
+    GIVEN("A prepared arena") {
+        ScratchArena scratchArena;
+        scratchArena.prepare(NUM_CHANNELS, BLOCK_SIZE, 2);
+
+        WHEN("All the audio buffers are borrowed") {
+            scratchArena.borrow(NUM_CHANNELS, BLOCK_SIZE);
+            scratchArena.borrow(NUM_CHANNELS, BLOCK_SIZE);
+
+            THEN("The MIDI buffers can still be borrowed") {
+                CHECK(scratchArena.canBorrowMidi(2));
+                CHECK_FALSE(scratchArena.canBorrowMidi(3));
+            }
+        }
+
+        WHEN("Two MIDI buffers are borrowed") {
+            juce::MidiBuffer* firstBuffer {scratchArena.borrowMidi()};
+            juce::MidiBuffer* secondBuffer {scratchArena.borrowMidi()};
+
+            THEN("They're different, empty buffers") {
+                REQUIRE(firstBuffer != nullptr);
+                REQUIRE(secondBuffer != nullptr);
+                CHECK(firstBuffer != secondBuffer);
+                CHECK(firstBuffer->isEmpty());
+                CHECK(secondBuffer->isEmpty());
+            }
+
+            AND_THEN("There's no space for another") {
+                CHECK(scratchArena.borrowMidi() == nullptr);
+            }
+
+            AND_WHEN("The arena is reset") {
+                firstBuffer->addEvent(juce::MidiMessage::noteOn(1, 60, 0.5f), 0);
+                scratchArena.reset();
+
+                THEN("The same buffer is lent again, cleared") {
+                    juce::MidiBuffer* thirdBuffer {scratchArena.borrowMidi()};
+                    CHECK(thirdBuffer == firstBuffer);
+                    CHECK(thirdBuffer->isEmpty());
+                }
+            }
+        }
+    }
+}
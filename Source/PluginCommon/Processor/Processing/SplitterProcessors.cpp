@@ -1,7 +1,12 @@
 #include "SplitterProcessors.hpp"
+
+#include <array>
 #include "ChainProcessors.hpp"
 
 namespace {
+    // Less than the number of channels juce::AudioBuffer can refer to without allocating
+    constexpr int MAX_NUM_ROUTED_CHANNELS {16};
+
     void copyBuffer(juce::AudioBuffer<float>& source, juce::AudioBuffer<float>& destination) {
         if (source.getNumSamples() == destination.getNumSamples()) {
             const int channelsToCopy {std::min(source.getNumChannels(), destination.getNumChannels())};
@@ -30,50 +35,213 @@ namespace {
         }
     }
 
-    void processBlockSeries(PluginSplitterSeries& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
-        ChainProcessors::processBlock(*(splitter.chains[0].chain.get()), buffer, midiMessages, newPlayHead);
+    /**
+     * Creates a buffer which refers to inputChannel of the buffer at outputChannel, and to the
+     * channels of the scratch buffer everywhere else. The scratch channels are cleared, but nothing
+     * is copied or allocated.
+     */
+    juce::AudioBuffer<float> createSingleChannelView(juce::AudioBuffer<float>& buffer,
+                                                     int inputChannel,
+                                                     int outputChannel,
+                                                     juce::AudioBuffer<float>& scratchBuffer) {
+        std::array<float*, MAX_NUM_ROUTED_CHANNELS> channels;
+        const int numChannels {std::min(scratchBuffer.getNumChannels(), MAX_NUM_ROUTED_CHANNELS)};
+
+        for (int channelIndex {0}; channelIndex < numChannels; channelIndex++) {
+            if (channelIndex == outputChannel) {
+                channels[channelIndex] = buffer.getWritePointer(inputChannel);
+            } else {
+                scratchBuffer.clear(channelIndex, 0, buffer.getNumSamples());
+                channels[channelIndex] = scratchBuffer.getWritePointer(channelIndex);
+            }
+        }
+
+        return juce::AudioBuffer<float>(channels.data(), numChannels, buffer.getNumSamples());
+    }
+
+    /**
+     * Converts left/right to mid/side in place in a single pass. Written so the compiler can
+     * vectorise it.
+     */
+    void encodeMidSide(float* leftToMid, float* rightToSide, int numSamples) {
+        for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+            const float left {leftToMid[sampleIndex]};
+            const float right {rightToSide[sampleIndex]};
+            leftToMid[sampleIndex] = 0.5f * (left + right);
+            rightToSide[sampleIndex] = 0.5f * (left - right);
+        }
+    }
+
+    /**
+     * Converts mid/side back to left/right in place in a single pass.
+     */
+    void decodeMidSide(float* midToLeft, float* sideToRight, int numSamples) {
+        for (int sampleIndex {0}; sampleIndex < numSamples; sampleIndex++) {
+            const float mid {midToLeft[sampleIndex]};
+            const float side {sideToRight[sampleIndex]};
+            midToLeft[sampleIndex] = mid + side;
+            sideToRight[sampleIndex] = mid - side;
+        }
     }
 
-    void processBlockParallel(PluginSplitterParallel& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
-        splitter.outputBuffer->clear();
+    /**
+     * Processes the chain with its own copy of the input MIDI, then merges what it outputs with the
+     * output of the chains processed before it.
+     */
+    void processBlockWithMidiCopy(PluginChain& chain,
+                                  juce::AudioBuffer<float>& buffer,
+                                  const juce::MidiBuffer& inputMidi,
+                                  juce::MidiBuffer& chainMidi,
+                                  ChainProcessors::MidiMergeState& mergeState,
+                                  juce::MidiBuffer& mergedMidi,
+                                  juce::AudioPlayHead* newPlayHead,
+                                  ScratchArena& scratchArena,
+                                  int modulationControlRate,
+                                  bool isSleepingEnabled) {
+        chainMidi.clear();
+        chainMidi.addEvents(inputMidi, 0, -1, 0);
+        ChainProcessors::processBlock(chain, buffer, chainMidi, newPlayHead, modulationControlRate, &scratchArena, nullptr, isSleepingEnabled);
+        ChainProcessors::mergeMidiOutput(inputMidi, chainMidi, mergeState, mergedMidi);
+    }
 
-        // Crop the internal buffers in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-        juce::AudioBuffer<float> inputBufferCropped(splitter.inputBuffer->getArrayOfWritePointers(), splitter.inputBuffer->getNumChannels(), buffer.getNumSamples());
-        juce::AudioBuffer<float> outputBufferCropped(splitter.outputBuffer->getArrayOfWritePointers(), splitter.outputBuffer->getNumChannels(), buffer.getNumSamples());
+    /**
+     * Processes the given chains, concurrently if there's a worker pool available. A nullptr chain
+     * won't be processed.
+     */
+    void processChainPair(PluginChain* firstChain,
+                          juce::AudioBuffer<float>& firstBuffer,
+                          PluginChain* secondChain,
+                          juce::AudioBuffer<float>& secondBuffer,
+                          juce::MidiBuffer& midiMessages,
+                          juce::AudioPlayHead* newPlayHead,
+                          ScratchArena& scratchArena,
+                          ChainWorkerPool* workerPool,
+                          int modulationControlRate,
+                          bool isSleepingEnabled) {
+        const bool useWorkerPool {
+            workerPool != nullptr
+            && firstChain != nullptr
+            && secondChain != nullptr
+            && workerPool->canRun(2, firstBuffer.getNumChannels(), firstBuffer.getNumSamples())
+        };
+
+        if (useWorkerPool) {
+            workerPool->setTask(0, *firstChain, firstBuffer, midiMessages, newPlayHead, modulationControlRate, &scratchArena, isSleepingEnabled);
+            workerPool->setTask(1, *secondChain, secondBuffer, midiMessages, newPlayHead, modulationControlRate, &scratchArena, isSleepingEnabled);
+            workerPool->run(2);
+
+            // Each chain processed its own copy of the MIDI, merge them in chain order
+            juce::MidiBuffer& mergedMidi = *scratchArena.borrowMidi();
+            ChainProcessors::MidiMergeState mergeState;
+            ChainProcessors::mergeMidiOutput(midiMessages, workerPool->getMidiOutput(0), mergeState, mergedMidi);
+            ChainProcessors::mergeMidiOutput(midiMessages, workerPool->getMidiOutput(1), mergeState, mergedMidi);
+
+            midiMessages.clear();
+            midiMessages.addEvents(mergedMidi, 0, -1, 0);
+        } else if (firstChain != nullptr || secondChain != nullptr) {
+            juce::MidiBuffer& chainMidi = *scratchArena.borrowMidi();
+            juce::MidiBuffer& mergedMidi = *scratchArena.borrowMidi();
+            ChainProcessors::MidiMergeState mergeState;
+
+            if (firstChain != nullptr) {
+                processBlockWithMidiCopy(*firstChain, firstBuffer, midiMessages, chainMidi, mergeState, mergedMidi, newPlayHead, scratchArena, modulationControlRate, isSleepingEnabled);
+            }
 
-        for (PluginChainWrapper& chain : splitter.chains) {
-            // Only process if no bands are soloed or this one is soloed
+            if (secondChain != nullptr) {
+                processBlockWithMidiCopy(*secondChain, secondBuffer, midiMessages, chainMidi, mergeState, mergedMidi, newPlayHead, scratchArena, modulationControlRate, isSleepingEnabled);
+            }
+
+            midiMessages.clear();
+            midiMessages.addEvents(mergedMidi, 0, -1, 0);
+        }
+    }
+
+    void processBlockSeries(PluginSplitterSeries& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, ScratchArena& scratchArena, ChainWorkerPool* workerPool, int modulationControlRate, bool isSleepingEnabled) {
+        // The worker pool is only used if the chain is pipelined
+        ChainProcessors::processBlock(*(splitter.chains[0].chain.get()), buffer, midiMessages, newPlayHead, modulationControlRate, &scratchArena, workerPool, isSleepingEnabled);
+    }
+
+    void processBlockParallel(PluginSplitterParallel& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, ScratchArena& scratchArena, ChainWorkerPool* workerPool, int modulationControlRate, bool isSleepingEnabled) {
+        // Only the stereo main channels are summed to the output
+        juce::AudioBuffer<float> outputBuffer {scratchArena.borrow(std::min(buffer.getNumChannels(), 2), buffer.getNumSamples())};
+        outputBuffer.clear();
+
+        int numChainsToProcess {0};
+        for (const PluginChainWrapper& chain : splitter.chains) {
             if (splitter.numChainsSoloed == 0 || chain.isSoloed) {
-                // Make a copy of the input buffer for us to process, preserving the original for the other
-                // chains
-                // TODO: do the same for midi
-                copyBuffer(buffer, inputBufferCropped);
+                numChainsToProcess++;
+            }
+        }
+
+        const bool useWorkerPool {
+            workerPool != nullptr
+            && numChainsToProcess > 1
+            && workerPool->canRun(numChainsToProcess, buffer.getNumChannels(), buffer.getNumSamples())
+        };
+
+        if (useWorkerPool) {
+            // Give each chain its own copy of the input so they can all be processed at the same time
+            int taskIndex {0};
+            for (PluginChainWrapper& chain : splitter.chains) {
+                if (splitter.numChainsSoloed == 0 || chain.isSoloed) {
+                    juce::AudioBuffer<float>& scratchBuffer = workerPool->getScratchBuffer(taskIndex, buffer.getNumSamples());
+                    copyBuffer(buffer, scratchBuffer);
+                    workerPool->setTask(taskIndex, *(chain.chain.get()), scratchBuffer, midiMessages, newPlayHead, modulationControlRate, &scratchArena, isSleepingEnabled);
+                    taskIndex++;
+                }
+            }
+
+            workerPool->run(numChainsToProcess);
 
-                // Process the newly copied buffer
-                ChainProcessors::processBlock(*(chain.chain.get()), inputBufferCropped, midiMessages, newPlayHead);
+            // Sum in chain order so the output doesn't depend on which chain finished first
+            for (int index {0}; index < numChainsToProcess; index++) {
+                addBuffers(workerPool->getScratchBuffer(index, buffer.getNumSamples()), outputBuffer);
+            }
 
-                // Add the output of this chain to the output buffer
-                addBuffers(inputBufferCropped, outputBufferCropped);
+            // Each chain processed its own copy of the MIDI, merge them in chain order
+            juce::MidiBuffer& mergedMidi = *scratchArena.borrowMidi();
+            ChainProcessors::MidiMergeState mergeState;
+            for (int index {0}; index < numChainsToProcess; index++) {
+                ChainProcessors::mergeMidiOutput(midiMessages, workerPool->getMidiOutput(index), mergeState, mergedMidi);
             }
+
+            midiMessages.clear();
+            midiMessages.addEvents(mergedMidi, 0, -1, 0);
+        } else if (numChainsToProcess > 0) {
+            juce::AudioBuffer<float> inputBuffer {scratchArena.borrow(buffer.getNumChannels(), buffer.getNumSamples())};
+            juce::MidiBuffer& chainMidi = *scratchArena.borrowMidi();
+            juce::MidiBuffer& mergedMidi = *scratchArena.borrowMidi();
+            ChainProcessors::MidiMergeState mergeState;
+
+            for (PluginChainWrapper& chain : splitter.chains) {
+                // Only process if no bands are soloed or this one is soloed
+                if (splitter.numChainsSoloed == 0 || chain.isSoloed) {
+                    // Make a copy of the input buffer and MIDI for us to process, preserving the
+                    // original for the other chains
+                    copyBuffer(buffer, inputBuffer);
+
+                    // Process the newly copied buffer
+                    processBlockWithMidiCopy(*(chain.chain.get()), inputBuffer, midiMessages, chainMidi, mergeState, mergedMidi, newPlayHead, scratchArena, modulationControlRate, isSleepingEnabled);
+
+                    // Add the output of this chain to the output buffer
+                    addBuffers(inputBuffer, outputBuffer);
+                }
+            }
+
+            midiMessages.clear();
+            midiMessages.addEvents(mergedMidi, 0, -1, 0);
         }
 
         // Overwrite the original buffer with our own output
-        copyBuffer(outputBufferCropped, buffer);
+        copyBuffer(outputBuffer, buffer);
     }
 
-    void processBlockMultiband(PluginSplitterMultiband& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
-        splitter.fftProvider.processBlock(buffer);
-        CrossoverProcessors::processBlock(*splitter.crossover.get(), buffer, midiMessages, newPlayHead);
+    void processBlockMultiband(PluginSplitterMultiband& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, ScratchArena& scratchArena, ChainWorkerPool* workerPool, int modulationControlRate, bool isSleepingEnabled) {
+        CrossoverProcessors::processBlock(*splitter.crossover.get(), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
     }
 
-    void processBlockLeftRight(PluginSplitterLeftRight& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
-        // TODO: maybe this should be done using mono buffers? (depends if plugins can handle it reliably)
-
-        // Make sure to clear the buffers each time, as on a previous call the plugins may have left
-        // data in the unused channel of each buffer, and since it's not used it won't get implicitly
-        // overwritten (but it'll still be copied to the output)
-        splitter.leftBuffer->clear();
-        splitter.rightBuffer->clear();
+    void processBlockLeftRight(PluginSplitterLeftRight& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, ScratchArena& scratchArena, ChainWorkerPool* workerPool, int modulationControlRate, bool isSleepingEnabled) {
+        const int numSamples {buffer.getNumSamples()};
 
         // We only need to check the first two chains
         // (otherwise if the user is in parallel/multiband and soloes a chain above the first two
@@ -82,126 +250,123 @@ namespace {
         const bool processLeftChain {!isAnythingSoloed || splitter.chains[0].isSoloed};
         const bool processRightChain {!isAnythingSoloed || splitter.chains[1].isSoloed};
 
-        // Copy the left and right channels to separate buffers
-        if (processLeftChain) {
-            const float* leftRead {buffer.getReadPointer(0)};
-            float* leftWrite {splitter.leftBuffer->getWritePointer(0)};
-            juce::FloatVectorOperations::copy(leftWrite, leftRead, buffer.getNumSamples());
+        // Plugins configured as mono only process the first channel, so a right chain with any of
+        // them sees its channel first and only that channel is used for its output. This is
+        // decided from the plugins actually in the chain rather than the config, as plugins that
+        // don't support mono stay stereo.
+        const bool isRightChainMono {processRightChain && ChainProcessors::hasMonoPlugin(*splitter.chains[1].chain)};
+
+        // Each chain processes its own channel in place, and gets silence on the others
+        juce::AudioBuffer<float> leftScratchBuffer {scratchArena.borrow(buffer.getNumChannels(), numSamples)};
+        juce::AudioBuffer<float> rightScratchBuffer {scratchArena.borrow(buffer.getNumChannels(), numSamples)};
+        juce::AudioBuffer<float> leftBuffer {createSingleChannelView(buffer, 0, 0, leftScratchBuffer)};
+        juce::AudioBuffer<float> rightBuffer {createSingleChannelView(buffer, 1, isRightChainMono ? 0 : 1, rightScratchBuffer)};
+
+        // Mute the channel of a chain that isn't processed
+        if (!processLeftChain) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(0), 0, numSamples);
         }
 
-        if (processRightChain) {
-            const float* rightRead {buffer.getReadPointer(1)};
-            float* rightWrite {splitter.rightBuffer->getWritePointer(1)};
-            juce::FloatVectorOperations::copy(rightWrite, rightRead, buffer.getNumSamples());
+        if (!processRightChain) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(1), 0, numSamples);
         }
 
-        // Now the input has been copied we can clear the original
-        buffer.clear();
-
-        // Process the left chain
+        // Process the left and right chains
+        processChainPair(processLeftChain ? splitter.chains[0].chain.get() : nullptr,
+                         leftBuffer,
+                         processRightChain ? splitter.chains[1].chain.get() : nullptr,
+                         rightBuffer,
+                         midiMessages,
+                         newPlayHead,
+                         scratchArena,
+                         workerPool,
+                         modulationControlRate,
+                         isSleepingEnabled);
+
+        // A chain may also output to the other channel (eg. a stereo reverb), so add that in. A mono
+        // plugin in the left chain leaves the other channel silent so this is still fine.
         if (processLeftChain) {
-            // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-            juce::AudioBuffer<float> leftBufferCropped(splitter.leftBuffer->getArrayOfWritePointers(), splitter.leftBuffer->getNumChannels(), buffer.getNumSamples());
-            ChainProcessors::processBlock(*(splitter.chains[0].chain.get()), leftBufferCropped, midiMessages, newPlayHead);
-            addBuffers(leftBufferCropped, buffer);
+            juce::FloatVectorOperations::add(buffer.getWritePointer(1), leftBuffer.getReadPointer(1), numSamples);
         }
 
-        // Process the right chain
-        if (processRightChain) {
-            // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-            juce::AudioBuffer<float> rightBufferCropped(splitter.rightBuffer->getArrayOfWritePointers(), splitter.rightBuffer->getNumChannels(), buffer.getNumSamples());
-            ChainProcessors::processBlock(*(splitter.chains[1].chain.get()), rightBufferCropped, midiMessages, newPlayHead);
-            addBuffers(rightBufferCropped, buffer);
+        if (processRightChain && !isRightChainMono) {
+            juce::FloatVectorOperations::add(buffer.getWritePointer(0), rightBuffer.getReadPointer(0), numSamples);
         }
     }
 
-    void processBlockMidSide(PluginSplitterMidSide& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead) {
-        // TODO: check if this can be done using mono buffers that refer to the original buffer rather
-        // than copying to new ones (guest plugins don't seem to like mono buffers)
-
-        // Make sure to clear the buffers each time, as on a previous call the plugins may have left
-        // data in the unused channel of each buffer, and since it's not used it won't get implicitly
-        // overwritten (but it'll still be copied to the output)
-        splitter.midBuffer->clear();
-        splitter.sideBuffer->clear();
-
-        // Convert the left/right buffer to mid/side
-        const float* leftRead {buffer.getReadPointer(0)};
-        const float* rightRead {buffer.getReadPointer(1)};
-        float* midWrite {splitter.midBuffer->getWritePointer(0)};
-        float* sideWrite {splitter.sideBuffer->getWritePointer(0)};
-
+    void processBlockMidSide(PluginSplitterMidSide& splitter, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* newPlayHead, ScratchArena& scratchArena, ChainWorkerPool* workerPool, int modulationControlRate, bool isSleepingEnabled) {
         const int numSamples {buffer.getNumSamples()};
 
-        // Add the right channel to get the mid, subtract it to get the side
-        juce::FloatVectorOperations::add(midWrite, leftRead, rightRead, numSamples);
-        juce::FloatVectorOperations::subtract(sideWrite, leftRead, rightRead, numSamples);
-
-        // Multiply both by 0.5
-        juce::FloatVectorOperations::multiply(midWrite, 0.5, numSamples);
-        juce::FloatVectorOperations::multiply(sideWrite, 0.5, numSamples);
+        // Convert the left/right buffer to mid/side in place, mid in the left channel and side in
+        // the right
+        encodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
 
         // We only need to check the first two chains
         // (otherwise if the user is in parallel/multiband and soloes a chain above the first two
         // and then switches to mid/side, the output will be muted)
         const bool isAnythingSoloed {splitter.chains[0].isSoloed || splitter.chains[1].isSoloed};
 
+        const bool processMidChain {!isAnythingSoloed || splitter.chains[0].isSoloed};
+        const bool processSideChain {!isAnythingSoloed || splitter.chains[1].isSoloed};
+
+        // Both chains see their signal on the first channel and silence on the others. Only the
+        // first channel of each is used for the output.
+        juce::AudioBuffer<float> midScratchBuffer {scratchArena.borrow(buffer.getNumChannels(), numSamples)};
+        juce::AudioBuffer<float> sideScratchBuffer {scratchArena.borrow(buffer.getNumChannels(), numSamples)};
+        juce::AudioBuffer<float> midBuffer {createSingleChannelView(buffer, 0, 0, midScratchBuffer)};
+        juce::AudioBuffer<float> sideBuffer {createSingleChannelView(buffer, 1, 0, sideScratchBuffer)};
+
         // Process the buffers
-        if (!isAnythingSoloed || splitter.chains[0].isSoloed) {
-            // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-            juce::AudioBuffer<float> midBufferCropped(splitter.midBuffer->getArrayOfWritePointers(), splitter.midBuffer->getNumChannels(), numSamples);
-            ChainProcessors::processBlock(*(splitter.chains[0].chain.get()), midBufferCropped, midiMessages, newPlayHead);
-        } else {
+        processChainPair(processMidChain ? splitter.chains[0].chain.get() : nullptr,
+                         midBuffer,
+                         processSideChain ? splitter.chains[1].chain.get() : nullptr,
+                         sideBuffer,
+                         midiMessages,
+                         newPlayHead,
+                         scratchArena,
+                         workerPool,
+                         modulationControlRate,
+                         isSleepingEnabled);
+
+        if (!processMidChain) {
             // Mute the mid channel if only the other one is soloed
-            juce::FloatVectorOperations::fill(midWrite, 0, numSamples);
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(0), 0, numSamples);
         }
 
-        if (!isAnythingSoloed || splitter.chains[1].isSoloed) {
-            // Crop the internal buffer in case the DAW has provided a buffer smaller than the specified block size in prepareToPlay
-            juce::AudioBuffer<float> sideBufferCropped(splitter.sideBuffer->getArrayOfWritePointers(), splitter.sideBuffer->getNumChannels(), numSamples);
-            ChainProcessors::processBlock(*(splitter.chains[1].chain.get()), sideBufferCropped, midiMessages, newPlayHead);
-        } else {
+        if (!processSideChain) {
             // Mute the side channel if only the other one is soloed
-            juce::FloatVectorOperations::fill(sideWrite, 0, numSamples);
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(1), 0, numSamples);
         }
 
-        // Convert from mid/side back to left/right, overwrite the original buffer with our own output
-        float* leftWrite {buffer.getWritePointer(0)};
-        float* rightWrite {buffer.getWritePointer(1)};
-        const float* midRead {splitter.midBuffer->getReadPointer(0)};
-        const float* sideRead {splitter.sideBuffer->getReadPointer(0)};
-
-        // Add mid and side to get the left buffer, subtract them to get the right buffer
-        juce::FloatVectorOperations::add(leftWrite, midRead, sideRead, numSamples);
-        juce::FloatVectorOperations::subtract(rightWrite, midRead, sideRead, numSamples);
+        // Convert from mid/side back to left/right in place
+        decodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
     }
 }
 
 namespace SplitterProcessors {
-    void prepareToPlay(PluginSplitter& splitter, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout) {
+    void prepareToPlay(PluginSplitter& splitter,
+                       double sampleRate,
+                       int samplesPerBlock,
+                       juce::AudioProcessor::BusesLayout layout,
+                       int maxLatencyCompensationSamples) {
         splitter.config.sampleRate = sampleRate;
         splitter.config.blockSize = samplesPerBlock;
         splitter.config.layout = layout;
+        splitter.config.maxLatencyCompensationSamples = maxLatencyCompensationSamples;
 
-        if (auto parallelSplitter = dynamic_cast<PluginSplitterParallel*>(&splitter)) {
-            parallelSplitter->inputBuffer.reset(new juce::AudioBuffer<float>(getTotalNumInputChannels(layout), samplesPerBlock));
-            parallelSplitter->outputBuffer.reset(new juce::AudioBuffer<float>(2, samplesPerBlock)); // stereo main
-        } else if (auto multibandSplitter = dynamic_cast<PluginSplitterMultiband*>(&splitter)) {
-            CrossoverProcessors::prepareToPlay(*multibandSplitter->crossover.get(), sampleRate, samplesPerBlock, layout);
-            CrossoverProcessors::reset(*multibandSplitter->crossover.get());
-            multibandSplitter->fftProvider.reset();
-            multibandSplitter->fftProvider.setSampleRate(sampleRate);
-            multibandSplitter->fftProvider.setIsStereo(canDoStereoSplitTypes(layout));
-        } else if (auto leftRightSplitter = dynamic_cast<PluginSplitterLeftRight*>(&splitter)) {
-            leftRightSplitter->leftBuffer.reset(new juce::AudioBuffer<float>(getTotalNumInputChannels(layout), samplesPerBlock));
-            leftRightSplitter->rightBuffer.reset(new juce::AudioBuffer<float>(getTotalNumInputChannels(layout), samplesPerBlock));
-        } else if (auto midSideSplitter = dynamic_cast<PluginSplitterMidSide*>(&splitter)) {
-            midSideSplitter->midBuffer.reset(new juce::AudioBuffer<float>(getTotalNumInputChannels(layout), samplesPerBlock));
-            midSideSplitter->sideBuffer.reset(new juce::AudioBuffer<float>(getTotalNumInputChannels(layout), samplesPerBlock));
+        // The buffers each split type needs while processing are borrowed from the scratch arena
+        if (splitter.splitType == SPLIT_TYPE::MULTIBAND) {
+            auto& multibandSplitter = static_cast<PluginSplitterMultiband&>(splitter);
+            CrossoverProcessors::prepareToPlay(*multibandSplitter.crossover.get(), sampleRate, samplesPerBlock, layout);
+            CrossoverProcessors::reset(*multibandSplitter.crossover.get());
         }
 
+        // Only series chains are long enough to be worth pipelining, the other split types already
+        // process their chains at the same time
+        const int maxPipelineStages {splitter.splitType == SPLIT_TYPE::SERIES ? ChainPipeline::getDefaultMaxNumStages() : 1};
+
         for (PluginChainWrapper& chainWrapper : splitter.chains) {
-            ChainProcessors::prepareToPlay(*chainWrapper.chain.get(), splitter.config);
+            ChainProcessors::prepareToPlay(*chainWrapper.chain.get(), splitter.config, maxPipelineStages);
         }
     }
     void releaseResources(PluginSplitter& splitter) {
@@ -216,20 +381,74 @@ namespace SplitterProcessors {
         }
     }
 
-    void processBlock(PluginSplitter& splitter,
+    bool processBlock(PluginSplitter& splitter,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead) {
-        if (auto seriesSplitter = dynamic_cast<PluginSplitterSeries*>(&splitter)) {
-            processBlockSeries(*seriesSplitter, buffer, midiMessages, newPlayHead);
-        } else if (auto parallelSplitter = dynamic_cast<PluginSplitterParallel*>(&splitter)) {
-            processBlockParallel(*parallelSplitter, buffer, midiMessages, newPlayHead);
-        } else if (auto multibandSplitter = dynamic_cast<PluginSplitterMultiband*>(&splitter)) {
-            processBlockMultiband(*multibandSplitter, buffer, midiMessages, newPlayHead);
-        } else if (auto leftRightSplitter = dynamic_cast<PluginSplitterLeftRight*>(&splitter)) {
-            processBlockLeftRight(*leftRightSplitter, buffer, midiMessages, newPlayHead);
-        } else if (auto midSideSplitter = dynamic_cast<PluginSplitterMidSide*>(&splitter)) {
-            processBlockMidSide(*midSideSplitter, buffer, midiMessages, newPlayHead);
+                      juce::AudioPlayHead* newPlayHead,
+                      ScratchArena& scratchArena,
+                      ChainWorkerPool* workerPool,
+                      int modulationControlRate,
+                      bool isSleepingEnabled) {
+        // Nothing from the previous block is still using the arena
+        scratchArena.reset();
+
+        if (!scratchArena.canBorrow(getNumScratchBuffersRequired(splitter), buffer.getNumChannels(), buffer.getNumSamples())
+            || !scratchArena.canBorrowMidi(getNumScratchMidiBuffersRequired(splitter))) {
+            return false;
+        }
+
+        // Dispatch on the type tag rather than casting, this is called every block
+        switch (splitter.splitType) {
+            case SPLIT_TYPE::SERIES:
+                processBlockSeries(static_cast<PluginSplitterSeries&>(splitter), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
+                break;
+            case SPLIT_TYPE::PARALLEL:
+                processBlockParallel(static_cast<PluginSplitterParallel&>(splitter), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
+                break;
+            case SPLIT_TYPE::MULTIBAND:
+                processBlockMultiband(static_cast<PluginSplitterMultiband&>(splitter), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
+                break;
+            case SPLIT_TYPE::LEFTRIGHT:
+                processBlockLeftRight(static_cast<PluginSplitterLeftRight&>(splitter), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
+                break;
+            case SPLIT_TYPE::MIDSIDE:
+                processBlockMidSide(static_cast<PluginSplitterMidSide&>(splitter), buffer, midiMessages, newPlayHead, scratchArena, workerPool, modulationControlRate, isSleepingEnabled);
+                break;
         }
+
+        return true;
+    }
+
+    int getNumScratchBuffersRequired(const PluginSplitter& splitter) {
+        // Each chain may borrow a buffer for plugins expecting a sidechain we can't provide
+        const int numChains {static_cast<int>(splitter.chains.size())};
+
+        switch (splitter.splitType) {
+            case SPLIT_TYPE::SERIES:
+                // Each stage of a pipelined chain borrows its own
+                return numChains + splitter.chains[0].chain->pipeline->getNumStages() - 1;
+            case SPLIT_TYPE::PARALLEL:
+                // Input and output
+                return numChains + 2;
+            case SPLIT_TYPE::MULTIBAND:
+                // One for each band above the first
+                return numChains + static_cast<int>(static_cast<const PluginSplitterMultiband&>(splitter).crossover->bands.size()) - 1;
+            case SPLIT_TYPE::LEFTRIGHT:
+            case SPLIT_TYPE::MIDSIDE:
+                return numChains + 2;
+        }
+
+        return numChains;
+    }
+
+    int getNumScratchMidiBuffersRequired(const PluginSplitter& splitter) {
+        // Each chain processes its own copy of the MIDI one after another, and their outputs are
+        // merged into another. A series chain processes the MIDI in place.
+        return splitter.splitType == SPLIT_TYPE::SERIES ? 0 : 2;
+    }
+
+    int getNumScratchChannelsRequired(juce::AudioProcessor::BusesLayout layout) {
+        // Plugins that expect a sidechain we can't provide need a main and sidechain's worth
+        return std::max(getTotalNumInputChannels(layout), layout.getMainInputChannels() * 2);
     }
 }
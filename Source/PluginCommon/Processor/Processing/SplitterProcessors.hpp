@@ -2,13 +2,43 @@
 
 #include <JuceHeader.h>
 #include "PluginSplitter.hpp"
+#include "ChainWorkerPool.hpp"
+#include "ScratchArena.hpp"
 
 namespace SplitterProcessors {
-    void prepareToPlay(PluginSplitter& splitter, double sampleRate, int samplesPerBlock, juce::AudioProcessor::BusesLayout layout);
+    void prepareToPlay(PluginSplitter& splitter,
+                       double sampleRate,
+                       int samplesPerBlock,
+                       juce::AudioProcessor::BusesLayout layout,
+                       int maxLatencyCompensationSamples = LatencyCompensationLine::DEFAULT_MAX_DELAY_SAMPLES);
     void releaseResources(PluginSplitter& splitter);
     void reset(PluginSplitter& splitter);
-    void processBlock(PluginSplitter& splitter,
+
+    /**
+     * Resets the scratch arena and borrows whatever the splitter needs for this block from it.
+     * Returns false without processing if the arena doesn't have enough space.
+     */
+    bool processBlock(PluginSplitter& splitter,
                       juce::AudioBuffer<float>& buffer,
                       juce::MidiBuffer& midiMessages,
-                      juce::AudioPlayHead* newPlayHead);
+                      juce::AudioPlayHead* newPlayHead,
+                      ScratchArena& scratchArena,
+                      ChainWorkerPool* workerPool = nullptr,
+                      int modulationControlRate = 0,
+                      bool isSleepingEnabled = false);
+
+    /**
+     * The number of buffers processBlock() may borrow from the scratch arena in a single block.
+     */
+    int getNumScratchBuffersRequired(const PluginSplitter& splitter);
+
+    /**
+     * The number of MIDI buffers processBlock() may borrow from the scratch arena in a single block.
+     */
+    int getNumScratchMidiBuffersRequired(const PluginSplitter& splitter);
+
+    /**
+     * The number of channels each buffer in the scratch arena needs for the given layout.
+     */
+    int getNumScratchChannelsRequired(juce::AudioProcessor::BusesLayout layout);
 }
@@ -128,7 +128,13 @@ SCENARIO("SplitterProcessors: Silence in = silence out") {
                 // Skip these - can't use mono for these split types
             } else {
                 SplitterProcessors::prepareToPlay(*(splitter.get()), SAMPLE_RATE, NUM_SAMPLES, layout);
-                SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr);
+
+                ScratchArena scratchArena;
+                scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(layout),
+                                     NUM_SAMPLES,
+                                     SplitterProcessors::getNumScratchBuffersRequired(*(splitter.get())));
+
+                CHECK(SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr, scratchArena));
             }
 
 
@@ -231,7 +237,13 @@ SCENARIO("SplitterProcessors: Gain stage and plugin processing is applied correc
                 // Skip these - can't use mono for these split types
             } else {
                 SplitterProcessors::prepareToPlay(*(splitter.get()), SAMPLE_RATE, NUM_SAMPLES, layout);
-                SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr);
+
+                ScratchArena scratchArena;
+                scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(layout),
+                                     NUM_SAMPLES,
+                                     SplitterProcessors::getNumScratchBuffersRequired(*(splitter.get())));
+
+                CHECK(SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr, scratchArena));
             }
 
             THEN("The buffer contains silence") {
@@ -322,10 +334,6 @@ SCENARIO("SplitterProcessors: Chain methods are called correctly") {
                 CHECK(samplesPerBlock == NUM_SAMPLES);
             };
 
-            // Set the buffers to something random so we can check if they get reset
-            splitterParallel->inputBuffer.reset(new juce::AudioBuffer<float>(1, 5));
-            splitterParallel->outputBuffer.reset(new juce::AudioBuffer<float>(3, 84));
-
             SplitterProcessors::prepareToPlay(*(splitterParallel.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
 
             THEN("Each chain's prepareToPlay is called with the correct arguments") {
@@ -334,11 +342,6 @@ SCENARIO("SplitterProcessors: Chain methods are called correctly") {
 
                 CHECK(splitterParallel->config.sampleRate == SAMPLE_RATE);
                 CHECK(splitterParallel->config.blockSize == NUM_SAMPLES);
-
-                CHECK(splitterParallel->inputBuffer->getNumChannels() == 2);
-                CHECK(splitterParallel->inputBuffer->getNumSamples() == NUM_SAMPLES);
-                CHECK(splitterParallel->outputBuffer->getNumChannels() == 2);
-                CHECK(splitterParallel->outputBuffer->getNumSamples() == NUM_SAMPLES);
             }
 
             WHEN("The splitter is converted to series and prepareToPlay is called") {
@@ -422,3 +425,357 @@ SCENARIO("SplitterProcessors: Chain methods are called correctly") {
         }
     }
 }
+
+SCENARIO("SplitterProcessors: Blocks aren't processed without enough scratch space") {
+    GIVEN("A parallel splitter with a plugin on each of its two chains") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        auto splitterParallel = std::make_shared<PluginSplitterParallel>(config, modulationCallback, latencyCallback);
+        SplitterMutators::addChain(splitterParallel);
+
+        int numProcessCalls {0};
+        for (int chainIdx {0}; chainIdx < 2; chainIdx++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [&numProcessCalls](juce::AudioBuffer<float>&, juce::MidiBuffer&) {
+                numProcessCalls++;
+            };
+            SplitterMutators::insertPlugin(splitterParallel, plugin, chainIdx, 0);
+        }
+
+        SplitterProcessors::prepareToPlay(*(splitterParallel.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        buffer.clear();
+        juce::MidiBuffer midiBuffer;
+
+        WHEN("The scratch arena has one buffer fewer than required") {
+            const int numBuffersRequired {SplitterProcessors::getNumScratchBuffersRequired(*(splitterParallel.get()))};
+            REQUIRE(numBuffersRequired == 4);
+
+            ScratchArena scratchArena;
+            scratchArena.prepare(2, NUM_SAMPLES, numBuffersRequired - 1);
+
+            const bool didProcess {SplitterProcessors::processBlock(*(splitterParallel.get()), buffer, midiBuffer, nullptr, scratchArena)};
+
+            THEN("Nothing is processed") {
+                CHECK_FALSE(didProcess);
+                CHECK(numProcessCalls == 0);
+            }
+
+            AND_WHEN("The capacity is increased") {
+                scratchArena.ensureCapacity(numBuffersRequired);
+
+                const bool didProcessWithCapacity {SplitterProcessors::processBlock(*(splitterParallel.get()), buffer, midiBuffer, nullptr, scratchArena)};
+
+                THEN("Each chain is processed") {
+                    CHECK(didProcessWithCapacity);
+                    CHECK(numProcessCalls == 2);
+                }
+            }
+        }
+
+        WHEN("The block is bigger than the scratch arena was prepared for") {
+            ScratchArena scratchArena;
+            scratchArena.prepare(2, NUM_SAMPLES / 2, ScratchArena::DEFAULT_NUM_BUFFERS);
+
+            const bool didProcess {SplitterProcessors::processBlock(*(splitterParallel.get()), buffer, midiBuffer, nullptr, scratchArena)};
+
+            THEN("Nothing is processed") {
+                CHECK_FALSE(didProcess);
+                CHECK(numProcessCalls == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("SplitterProcessors: Left/right and mid/side splits with empty chains pass the input through") {
+    GIVEN("A stereo buffer with different content in each channel") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        const juce::String splitTypeString = GENERATE(
+            juce::String(XML_SPLIT_TYPE_LEFTRIGHT_STR),
+            juce::String(XML_SPLIT_TYPE_MIDSIDE_STR)
+        );
+
+        std::shared_ptr<PluginSplitter> splitter;
+        if (splitTypeString == XML_SPLIT_TYPE_LEFTRIGHT_STR) {
+            splitter = std::make_shared<PluginSplitterLeftRight>(config, modulationCallback, latencyCallback);
+        } else {
+            splitter = std::make_shared<PluginSplitterMidSide>(config, modulationCallback, latencyCallback);
+        }
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+            buffer.setSample(0, sampleIdx, 0.1f * sampleIdx);
+            buffer.setSample(1, sampleIdx, -0.05f * sampleIdx);
+        }
+
+        juce::AudioBuffer<float> expectedBuffer;
+        expectedBuffer.makeCopyOf(buffer);
+
+        WHEN("The buffer is processed") {
+            juce::MidiBuffer midiBuffer;
+
+            SplitterProcessors::prepareToPlay(*(splitter.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+            ScratchArena scratchArena;
+            scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(config.layout),
+                                 NUM_SAMPLES,
+                                 SplitterProcessors::getNumScratchBuffersRequired(*(splitter.get())));
+
+            REQUIRE(SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr, scratchArena));
+
+            THEN("The output is the same as the input") {
+                for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < buffer.getNumSamples(); sampleIdx++) {
+                        CHECK(buffer.getSample(channelIdx, sampleIdx) == Approx(expectedBuffer.getSample(channelIdx, sampleIdx)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("SplitterProcessors: Left/right chains are routed to suit the layouts of their plugins") {
+    GIVEN("A left/right splitter with a plugin in the right chain that doubles the channels it's configured for") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        auto splitter = std::make_shared<PluginSplitterLeftRight>(config, modulationCallback, latencyCallback);
+
+        // Mono chains being enabled in the config doesn't change the routing, only the plugins do
+        const bool isMonoChainsEnabled = GENERATE(false, true);
+        PluginConfigurator::setMonoChainsEnabled(isMonoChainsEnabled);
+
+        const int numPluginChannels = GENERATE(1, 2);
+
+        auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+        juce::AudioProcessor::BusesLayout pluginLayout;
+        pluginLayout.inputBuses.add(numPluginChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo());
+        pluginLayout.outputBuses.add(numPluginChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo());
+        REQUIRE(plugin->setBusesLayout(pluginLayout));
+
+        plugin->onProcess = [numPluginChannels](juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+            for (int channelIdx {0}; channelIdx < numPluginChannels; channelIdx++) {
+                buffer.applyGain(channelIdx, 0, buffer.getNumSamples(), 2);
+            }
+        };
+        SplitterMutators::insertPlugin(splitter, plugin, 1, 0);
+
+        juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+        for (int sampleIdx {0}; sampleIdx < NUM_SAMPLES; sampleIdx++) {
+            buffer.setSample(0, sampleIdx, 0.1f * sampleIdx);
+            buffer.setSample(1, sampleIdx, -0.05f * sampleIdx);
+        }
+
+        juce::AudioBuffer<float> expectedBuffer;
+        expectedBuffer.makeCopyOf(buffer);
+        expectedBuffer.applyGain(1, 0, NUM_SAMPLES, 2);
+
+        WHEN("The buffer is processed") {
+            juce::MidiBuffer midiBuffer;
+
+            SplitterProcessors::prepareToPlay(*(splitter.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+            ScratchArena scratchArena;
+            scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(config.layout),
+                                 NUM_SAMPLES,
+                                 SplitterProcessors::getNumScratchBuffersRequired(*(splitter.get())));
+
+            REQUIRE(SplitterProcessors::processBlock(*(splitter.get()), buffer, midiBuffer, nullptr, scratchArena));
+
+            THEN("Only the right channel is processed") {
+                for (int channelIdx {0}; channelIdx < buffer.getNumChannels(); channelIdx++) {
+                    for (int sampleIdx {0}; sampleIdx < buffer.getNumSamples(); sampleIdx++) {
+                        CHECK(buffer.getSample(channelIdx, sampleIdx) == Approx(expectedBuffer.getSample(channelIdx, sampleIdx)));
+                    }
+                }
+            }
+        }
+
+        PluginConfigurator::setMonoChainsEnabled(false);
+    }
+}
+
+SCENARIO("SplitterProcessors: Parallel chains each get their own copy of the MIDI") {
+    GIVEN("A parallel splitter with a plugin on each of its two chains that adds a note") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        auto splitterParallel = std::make_shared<PluginSplitterParallel>(config, modulationCallback, latencyCallback);
+        SplitterMutators::addChain(splitterParallel);
+
+        // Each plugin records how many events it was given, then adds its own note
+        std::array<std::atomic<int>, 2> numEventsReceived {0, 0};
+        for (int chainIdx {0}; chainIdx < 2; chainIdx++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [&numEventsReceived, chainIdx](juce::AudioBuffer<float>&, juce::MidiBuffer& midiMessages) {
+                numEventsReceived[chainIdx] = midiMessages.getNumEvents();
+                midiMessages.addEvent(juce::MidiMessage::noteOn(1, 60 + chainIdx, 0.5f), 2);
+            };
+            SplitterMutators::insertPlugin(splitterParallel, plugin, chainIdx, 0);
+        }
+
+        SplitterProcessors::prepareToPlay(*(splitterParallel.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(config.layout),
+                             NUM_SAMPLES,
+                             SplitterProcessors::getNumScratchBuffersRequired(*(splitterParallel.get())));
+
+        const bool useWorkerPool = GENERATE(false, true);
+        ChainWorkerPool workerPool(1);
+        workerPool.prepare(2, NUM_SAMPLES, ChainWorkerPool::DEFAULT_NUM_TASKS);
+
+        WHEN("A block with a controller event is processed") {
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+            buffer.clear();
+
+            juce::MidiBuffer midiBuffer;
+            midiBuffer.addEvent(juce::MidiMessage::controllerEvent(1, 7, 100), 2);
+
+            REQUIRE(SplitterProcessors::processBlock(*(splitterParallel.get()), buffer, midiBuffer, nullptr, scratchArena, useWorkerPool ? &workerPool : nullptr));
+
+            THEN("Each chain only saw the input") {
+                CHECK(numEventsReceived[0] == 1);
+                CHECK(numEventsReceived[1] == 1);
+            }
+
+            AND_THEN("The outputs are merged in chain order with the shared input passed on once") {
+                REQUIRE(midiBuffer.getNumEvents() == 3);
+
+                std::vector<juce::MidiMessage> messages;
+                for (const juce::MidiMessageMetadata metadata : midiBuffer) {
+                    CHECK(metadata.samplePosition == 2);
+                    messages.push_back(metadata.getMessage());
+                }
+
+                CHECK(messages[0].isController());
+                CHECK(messages[1].isNoteOn());
+                CHECK(messages[1].getNoteNumber() == 60);
+                CHECK(messages[2].isNoteOn());
+                CHECK(messages[2].getNoteNumber() == 61);
+            }
+        }
+    }
+}
+
+SCENARIO("SplitterProcessors: Merging MIDI from parallel chains only drops input that was passed through twice") {
+    GIVEN("A parallel splitter where one chain drops its input and both add the same note off") {
+        HostConfiguration config;
+        config.sampleRate = SAMPLE_RATE;
+        config.blockSize = NUM_SAMPLES;
+        config.layout = TestUtils::createLayoutWithInputChannels(juce::AudioChannelSet::stereo());
+
+        auto modulationCallback = [](int, MODULATION_TYPE) {
+            return 0.0f;
+        };
+
+        auto latencyCallback = [](int) {
+            // Do nothing
+        };
+
+        auto splitterParallel = std::make_shared<PluginSplitterParallel>(config, modulationCallback, latencyCallback);
+        SplitterMutators::addChain(splitterParallel);
+        SplitterMutators::addChain(splitterParallel);
+
+        // The first chain drops its input, the others pass it through and repeat the controller
+        for (int chainIdx {0}; chainIdx < 3; chainIdx++) {
+            auto plugin = std::make_shared<ProcessorTestPluginInstance>();
+            plugin->onProcess = [chainIdx](juce::AudioBuffer<float>&, juce::MidiBuffer& midiMessages) {
+                if (chainIdx == 0) {
+                    midiMessages.clear();
+                } else {
+                    midiMessages.addEvent(juce::MidiMessage::controllerEvent(1, 7, 100), 2);
+                }
+
+                midiMessages.addEvent(juce::MidiMessage::noteOff(1, 64), 5);
+            };
+            SplitterMutators::insertPlugin(splitterParallel, plugin, chainIdx, 0);
+        }
+
+        SplitterProcessors::prepareToPlay(*(splitterParallel.get()), SAMPLE_RATE, NUM_SAMPLES, config.layout);
+
+        ScratchArena scratchArena;
+        scratchArena.prepare(SplitterProcessors::getNumScratchChannelsRequired(config.layout),
+                             NUM_SAMPLES,
+                             SplitterProcessors::getNumScratchBuffersRequired(*(splitterParallel.get())));
+
+        const bool useWorkerPool = GENERATE(false, true);
+        ChainWorkerPool workerPool(1);
+        workerPool.prepare(2, NUM_SAMPLES, ChainWorkerPool::DEFAULT_NUM_TASKS);
+
+        WHEN("A block with a controller event is processed") {
+            juce::AudioBuffer<float> buffer(2, NUM_SAMPLES);
+            buffer.clear();
+
+            juce::MidiBuffer midiBuffer;
+            midiBuffer.addEvent(juce::MidiMessage::controllerEvent(1, 7, 100), 2);
+
+            REQUIRE(SplitterProcessors::processBlock(*(splitterParallel.get()), buffer, midiBuffer, nullptr, scratchArena, useWorkerPool ? &workerPool : nullptr));
+
+            THEN("The input is passed on once, and each chain's own events are all kept") {
+                int numControllers {0};
+                int numNoteOffs {0};
+
+                for (const juce::MidiMessageMetadata metadata : midiBuffer) {
+                    const juce::MidiMessage message {metadata.getMessage()};
+
+                    if (message.isController()) {
+                        CHECK(metadata.samplePosition == 2);
+                        numControllers++;
+                    } else if (message.isNoteOff()) {
+                        CHECK(metadata.samplePosition == 5);
+                        numNoteOffs++;
+                    }
+                }
+
+                // The passed through input once, and a repeat from each of the last two chains
+                CHECK(numControllers == 3);
+                CHECK(numNoteOffs == 3);
+            }
+        }
+    }
+}
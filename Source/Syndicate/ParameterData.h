@@ -16,4 +16,6 @@ const juce::Array<juce::String> MACRO_STRS {"Macro1", "Macro2", "Macro3", "Macro
 const juce::String SPLIT_TYPE_STR("SplitType"),
                    GRAPH_STATE_STR("GraphStateParam"),
                    OUTPUTGAIN_STR("OutputGain"),
-                   OUTPUTPAN_STR("OutputPan");
+                   OUTPUTPAN_STR("OutputPan"),
+                   RENDERAHEAD_STR("RenderAhead"),
+                   STANDBY_SWITCH_STR("StandbySwitch");
@@ -14,6 +14,7 @@
 #include "PluginUtils.h"
 #include "XmlReader.hpp"
 #include "XmlWriter.hpp"
+#include "ChainSlotProcessors.hpp"
 
 namespace {
     // Modulation sources
@@ -58,9 +59,28 @@ namespace {
         return retVal;
     }
 
+    juce::XmlElement* findSplitterParentElement(juce::XmlElement* element) {
+        for (juce::XmlElement* child : element->getChildIterator()) {
+            if (child->getChildByName(XML_SPLITTER_STR) != nullptr) {
+                return child;
+            }
+
+            if (juce::XmlElement* found = findSplitterParentElement(child)) {
+                return found;
+            }
+        }
+
+        return nullptr;
+    }
+
     // Window states
     const char* XML_PLUGIN_SELECTOR_STATE_STR {"pluginSelectorState"};
     const char* XML_PLUGIN_PARAMETER_SELECTOR_STATE_STR {"pluginParameterSelectorState"};
+
+    // Binary session format
+    const char* XML_SESSION_STR {"SyndicateSession"};
+    const char* XML_SESSION_PARAMETERS_STR {"Parameters"};
+    const char* XML_SESSION_SPLITTER_PARAMETERS_STR {"SplitterParameters"};
 }
 
 //==============================================================================
@@ -72,7 +92,32 @@ SyndicateAudioProcessor::SyndicateAudioProcessor() :
                 [&](int id, MODULATION_TYPE type) { return getModulationValueForSource(id, type); },
                 [&](int newLatencySamples) { onLatencyChange(newLatencySamples); }),
         _editor(nullptr),
-        _outputGainLinear(1)
+        _outputGainLinear(1),
+        _renderAhead([&](juce::AudioBuffer<float>& buffer,
+                         juce::MidiBuffer& midiMessages,
+                         juce::AudioPlayHead* playHead,
+                         const juce::AudioPlayHead::PositionInfo& position) { _processGraph(buffer, midiMessages, playHead, position); }),
+        _renderAheadBlocks(0),
+        _shouldResetGraph(false),
+        _graphLatencySamples(0),
+        _placeholderLoader(manager,
+                           pluginConfigurator,
+                           [&]() { if (_editor != nullptr) { _editor->needsToRefreshAll(); } },
+                           [&](juce::String errorText) { restoreErrors.push_back(errorText); }),
+        _isBackgroundRestoreEnabled(false),
+        _loadInactivePluginsLast(true),
+        _isPluginReuseEnabled(true),
+        _standbyLoader(manager,
+                       pluginConfigurator,
+                       [&](int id, MODULATION_TYPE type) { return getModulationValueForSource(id, type); },
+                       [&](int newLatencySamples) { onLatencyChange(newLatencySamples); },
+                       [&]() { _updateLatency(); },
+                       [&](juce::String errorText) { restoreErrors.push_back(errorText); }),
+        _standbyCrossfadeMs(50),
+        _standbySwitchPosition(false),
+        _isRestoringState(false),
+        _isBinarySessionFormatEnabled(false),
+        _isSessionCompressionEnabled(false)
 {
 
     const Utils::Config config = Utils::LoadConfig();
@@ -83,6 +128,50 @@ SyndicateAudioProcessor::SyndicateAudioProcessor() :
         juce::Logger::setCurrentLogger(&_nullLogger);
     }
 
+    // Chains are processed on multiple cores unless the config says otherwise
+    ModelInterface::setMultiCoreProcessingEnabled(manager, config.enableMultiCoreProcessing);
+
+    // Plugin parameters are modulated once per block unless the config sets a faster rate
+    ModelInterface::setModulationControlRate(manager, config.modulationControlRate);
+
+    // Limits how far chains can be delayed to line up their latency, applied when the host prepares
+    // the graph
+    ModelInterface::setMaxLatencyCompensationSamples(manager, config.maxLatencyCompensationSamples);
+
+    // Long series chains are split into stages processed on different cores if the config opts in,
+    // at the cost of a block of latency per stage
+    ChainPipeline::setDefaultMaxNumStages(config.maxSeriesPipelineStages);
+
+    // Plugins in left/right and mid/side chains are configured as mono if the config opts in
+    PluginConfigurator::setMonoChainsEnabled(config.enableMonoChains);
+
+    // Plugins with a silent input are skipped once their tails have finished
+    ModelInterface::setSleepingEnabled(manager, config.enableChainSleeping);
+
+    // Undo history is limited by its estimated memory use rather than the number of steps
+    ModelInterface::setUndoHistoryBudget(manager, static_cast<size_t>(config.undoHistoryBudgetMB) * 1024 * 1024);
+
+    // The graph is only rendered ahead of the host if the config asks for it, as it adds latency
+    _renderAheadBlocks = config.renderAheadBlocks;
+
+    // Plugins are only loaded in the background after a restore if the config opts in, until then
+    // their slots pass audio through
+    _isBackgroundRestoreEnabled = config.enableBackgroundRestore;
+    _loadInactivePluginsLast = config.loadInactivePluginsLast;
+
+    // Restoring keeps running plugins that are used again by the restored state unless the config
+    // opts out, for plugins that don't fully reset when their state is restored
+    _isPluginReuseEnabled = config.reusePluginsOnRestore;
+
+    // Switching to the standby crossfades between the two states over this long
+    _standbyCrossfadeMs = config.standbyCrossfadeMs;
+
+    // Sessions are saved in the binary format unless the config opts out, for example to load them
+    // in an older version. Plugin states are only compressed if the config opts in, as it makes
+    // saving slower
+    _isBinarySessionFormatEnabled = config.enableBinarySessionFormat;
+    _isSessionCompressionEnabled = config.compressSessionState;
+
     constexpr float PRECISION {0.01f};
     registerPrivateParameter(_splitterParameters, "SplitterParameters");
 
@@ -93,6 +182,8 @@ SyndicateAudioProcessor::SyndicateAudioProcessor() :
 
     registerParameter(outputGainLog, OUTPUTGAIN_STR, &OUTPUTGAIN, OUTPUTGAIN.defaultValue, PRECISION);
     registerParameter(outputPan, OUTPUTPAN_STR, &OUTPUTPAN, OUTPUTPAN.defaultValue, PRECISION);
+    registerParameter(renderAhead, RENDERAHEAD_STR, true);
+    registerParameter(standbySwitch, STANDBY_SWITCH_STR, false);
 
     // Add a default LFO and envelope
     ModelInterface::createDefaultSources(manager);
@@ -106,18 +197,13 @@ SyndicateAudioProcessor::SyndicateAudioProcessor() :
         macroNames[index] = "Macro " + juce::String(index + 1);
     }
 
-    for (auto& env : meterEnvelopes) {
-        env.setAttackTimeMs(1);
-        env.setReleaseTimeMs(50);
-        env.setFilterEnabled(false);
-    }
-
     addDefaultFormatsToManager(formatManager);
 }
 
 SyndicateAudioProcessor::~SyndicateAudioProcessor()
 {
     pluginScanClient.stopScan();
+    cancelPendingUpdate();
 
     // Logger must be removed before being deleted
     // (this must be the last thing we do before exiting)
@@ -191,27 +277,43 @@ void SyndicateAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    for (auto& env : meterEnvelopes) {
-        env.setSampleRate(sampleRate);
-    }
+    outputMeter.setSampleRate(sampleRate);
+
+    // Stop rendering ahead while the graph is being prepared
+    _renderAhead.release();
 
     juce::Logger::writeToLog("Setting bus layout:\n" + Utils::busesLayoutToString(getBusesLayout()));
     ModelInterface::prepareToPlay(manager, sampleRate, samplesPerBlock, getBusesLayout());
+
+    _prepareRenderAhead();
 }
 
 void SyndicateAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    _renderAhead.release();
     ModelInterface::releaseResources(manager);
+
+    const juce::uint64 numSkippedBlocks {ModelInterface::getNumSkippedBlocks(manager)};
+    if (numSkippedBlocks > 0) {
+        juce::Logger::writeToLog("SyndicateAudioProcessor::releaseResources: Skipped " + juce::String(numSkippedBlocks) + " blocks");
+    }
+
+    const juce::uint64 numUnderruns {_renderAhead.getNumUnderruns()};
+    if (numUnderruns > 0) {
+        juce::Logger::writeToLog("SyndicateAudioProcessor::releaseResources: Render ahead underran " + juce::String(numUnderruns) + " times");
+    }
 }
 
 void SyndicateAudioProcessor::reset() {
-    for (auto& env : meterEnvelopes) {
-        env.reset();
-    }
+    outputMeter.reset();
 
-    ModelInterface::reset(manager);
+    // Any audio already rendered ahead is stale after a reset. Hosts may call this from the audio
+    // thread, so the render thread isn't stopped and the graph is reset by whichever thread
+    // processes it next.
+    _renderAhead.flush();
+    _shouldResetGraph.store(true);
 }
 
 bool SyndicateAudioProcessor::isBusesLayoutSupported(const BusesLayout& layout) const {
@@ -241,17 +343,18 @@ void SyndicateAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Send tempo and playhead information to the LFOs
-    juce::AudioPlayHead::CurrentPositionInfo mTempoInfo;
+    juce::AudioPlayHead::PositionInfo position;
     if (auto* playHead = getPlayHead()) {
         if (auto posInfo = playHead->getPosition()) {
-            mTempoInfo.bpm = posInfo->getBpm().orFallback(120.0);
-            mTempoInfo.timeInSeconds = posInfo->getTimeInSeconds().orFallback(0.0);
+            position = *posInfo;
         }
     }
 
-    // Pass the audio through the splitter (this is also the only safe place to pass the playhead through)
-    ModelInterface::processBlock(manager, buffer, midiMessages, getPlayHead(), mTempoInfo);
+    // If rendering ahead this only swaps the buffer for one that's already been rendered, otherwise
+    // the graph is processed here
+    if (!_renderAhead.process(buffer, midiMessages, position)) {
+        _processGraph(buffer, midiMessages, getPlayHead(), position);
+    }
 
     // Apply the output gain
     for (int channel {0}; channel < getMainBusNumInputChannels(); channel++)
@@ -267,12 +370,8 @@ void SyndicateAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
         Utils::processBalance(outputPan->get(), buffer);
     }
 
-    // After processing everything, update the meter envelopes
-    for (int sampleIndex {0}; sampleIndex < buffer.getNumSamples(); sampleIndex++) {
-        for (int channel {0}; channel < std::min(getMainBusNumInputChannels(), static_cast<int>(meterEnvelopes.size())); channel++) {
-            meterEnvelopes[channel].getNextOutput(buffer.getReadPointer(channel)[sampleIndex]);
-        }
-    }
+    // After processing everything, update the meter (only while the editor is displaying it)
+    outputMeter.processBlock(buffer, getMainBusNumInputChannels());
 }
 
 //==============================================================================
@@ -924,8 +1023,11 @@ bool SyndicateAudioProcessor::onPluginSelectedByUser(std::shared_ptr<juce::Audio
 
     juce::Logger::writeToLog("SyndicateAudioProcessor::onPluginSelectedByUser: Loading plugin");
 
+    const bool isMonoChain {PluginConfigurator::isMonoChainSplitType(ModelInterface::getSplitType(manager))};
+
     if (pluginConfigurator.configure(plugin,
-                                     {getBusesLayout(), getSampleRate(), getBlockSize()})) {
+                                     {getBusesLayout(), getSampleRate(), getBlockSize()},
+                                     isMonoChain)) {
         juce::Logger::writeToLog("SyndicateAudioProcessor::onPluginSelectedByUser: Plugin configured");
 
         // Hand the plugin over to the splitter
@@ -1044,8 +1146,72 @@ void SyndicateAudioProcessor::setPresetMetadata(const PresetMetadata& newMetadat
     }
 }
 
+bool SyndicateAudioProcessor::loadStandbyFromFile(juce::File file) {
+    std::unique_ptr<juce::XmlElement> element = juce::XmlDocument::parse(file);
+
+    if (element == nullptr) {
+        juce::Logger::writeToLog("Failed to load standby from " + file.getFullPathName());
+        return false;
+    }
+
+    // The splitter is written inside the element for its parameter
+    juce::XmlElement* stateElement {element->getChildByName(XML_SPLITTER_STR) != nullptr ?
+        element.get() : findSplitterParentElement(element.get())};
+
+    if (stateElement == nullptr) {
+        juce::Logger::writeToLog("Failed to load standby - missing element " + juce::String(XML_SPLITTER_STR));
+        return false;
+    }
+
+    juce::XmlElement* sourcesElement = stateElement->getChildByName(XML_MODULATION_SOURCES_STR);
+
+    _loadStandby(std::make_unique<juce::XmlElement>(*stateElement->getChildByName(XML_SPLITTER_STR)),
+                 sourcesElement != nullptr ? std::make_unique<juce::XmlElement>(*sourcesElement) : nullptr);
+    return true;
+}
+
+void SyndicateAudioProcessor::captureStandby() {
+    // Restored from XML rather than copied so the standby doesn't share plugins with the current
+    // state
+    auto splitterElement = std::make_unique<juce::XmlElement>(XML_SPLITTER_STR);
+    ModelInterface::writeSplitterToXml(manager, splitterElement.get());
+
+    auto sourcesElement = std::make_unique<juce::XmlElement>(XML_MODULATION_SOURCES_STR);
+    ModelInterface::writeSourcesToXml(manager, sourcesElement.get());
+
+    _loadStandby(std::move(splitterElement), std::move(sourcesElement));
+}
+
+bool SyndicateAudioProcessor::switchToStandby() {
+    const int crossfadeLengthSamples {static_cast<int>(getSampleRate() * _standbyCrossfadeMs / 1000)};
+
+    if (!ModelInterface::switchToStandby(manager, crossfadeLengthSamples)) {
+        return false;
+    }
+
+    _updateLatency();
+
+    if (_editor != nullptr) {
+        _editor->needsToRefreshAll();
+    }
+
+    return true;
+}
+
+void SyndicateAudioProcessor::clearStandby() {
+    _standbyLoader.stop();
+    ModelInterface::setStandby(manager, nullptr);
+    _updateLatency();
+}
+
 void SyndicateAudioProcessor::onLatencyChange(int newLatencySamples) {
-    setLatencySamples(newLatencySamples);
+    _graphLatencySamples.store(newLatencySamples);
+    _updateLatency();
+}
+
+void SyndicateAudioProcessor::setRenderAheadEnabled(bool isEnabled) {
+    _renderAhead.setEnabled(isEnabled);
+    _updateLatency();
 }
 
 std::vector<juce::String> SyndicateAudioProcessor::_provideParamNamesForMigration() {
@@ -1059,13 +1225,84 @@ void SyndicateAudioProcessor::_migrateParamValues(std::vector<float>& /*paramVal
 
 void SyndicateAudioProcessor::_onParameterUpdate() {
     _outputGainLinear = WECore::CoreMath::dBToLinear(outputGainLog->get());
+
+    if (renderAhead->get() != _renderAhead.isEnabled()) {
+        setRenderAheadEnabled(renderAhead->get());
+    }
+
+    if (_isRestoringState.load()) {
+        // Restoring isn't a request to switch, the switch just takes its saved position
+        _standbySwitchPosition.store(standbySwitch->get());
+    } else if (standbySwitch->get() != _standbySwitchPosition.load()) {
+        triggerAsyncUpdate();
+    }
+}
+
+void SyndicateAudioProcessor::handleAsyncUpdate() {
+    const bool newPosition {standbySwitch->get()};
+
+    // Neither position is the standby, every change switches to whichever state isn't current
+    if (newPosition != _standbySwitchPosition.exchange(newPosition)) {
+        switchToStandby();
+    }
+}
+
+void SyndicateAudioProcessor::_processGraph(juce::AudioBuffer<float>& buffer,
+                                            juce::MidiBuffer& midiMessages,
+                                            juce::AudioPlayHead* playHead,
+                                            const juce::AudioPlayHead::PositionInfo& position) {
+    if (_shouldResetGraph.exchange(false)) {
+        ModelInterface::reset(manager);
+    }
+
+    // Send tempo and playhead information to the LFOs
+    juce::AudioPlayHead::CurrentPositionInfo mTempoInfo;
+    mTempoInfo.bpm = position.getBpm().orFallback(120.0);
+    mTempoInfo.timeInSeconds = position.getTimeInSeconds().orFallback(0.0);
+
+    // Pass the audio through the splitter (this is also the only safe place to pass the playhead through)
+    ModelInterface::processBlock(manager, buffer, midiMessages, playHead, mTempoInfo);
+}
+
+void SyndicateAudioProcessor::_prepareRenderAhead() {
+    const int numChannels {std::max(getTotalNumInputChannels(), getTotalNumOutputChannels())};
+    _renderAhead.prepare(numChannels, getBlockSize(), getSampleRate(), _renderAheadBlocks);
+    _updateLatency();
+}
+
+void SyndicateAudioProcessor::_updateLatency() {
+    const int renderAheadLatency {_renderAhead.isEnabled() ? _renderAhead.getLatencySamples() : 0};
+
+    // While there's a standby both states are delayed to match the one with the most latency, so
+    // switching between them doesn't change it
+    const int graphLatency {std::max(_graphLatencySamples.load(), ModelInterface::getStandbyLatencySamples(manager))};
+
+    setLatencySamples(graphLatency + renderAheadLatency);
+}
+
+void SyndicateAudioProcessor::_loadStandby(std::unique_ptr<juce::XmlElement> splitterElement,
+                                           std::unique_ptr<juce::XmlElement> sourcesElement) {
+    _standbyLoader.load(std::move(splitterElement),
+                        std::move(sourcesElement),
+                        pluginScanClient.getPluginTypes(),
+                        {getBusesLayout(), getSampleRate(), getBlockSize()});
 }
 
 void SyndicateAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
 #ifdef DEMO_BUILD
     juce::Logger::writeToLog("Not saving state - demo build");
 #else
-    WECore::JUCEPlugin::CoreAudioProcessor::getStateInformation(destData);
+    if (_isBinarySessionFormatEnabled) {
+        // Plugin states are streamed into destData as the document is written, rather than being
+        // base64 encoded into it
+        juce::MemoryOutputStream stream(destData, false);
+        SessionFormat::Writer writer(stream, _isSessionCompressionEnabled);
+
+        std::unique_ptr<juce::XmlElement> element = _writeSessionToXml(writer);
+        writer.writeDocument(*element);
+    } else {
+        WECore::JUCEPlugin::CoreAudioProcessor::getStateInformation(destData);
+    }
 #endif
 }
 
@@ -1073,7 +1310,24 @@ void SyndicateAudioProcessor::setStateInformation(const void* data, int sizeInBy
 #ifdef DEMO_BUILD
     juce::Logger::writeToLog("Not restoring state - demo build");
 #else
-    WECore::JUCEPlugin::CoreAudioProcessor::setStateInformation(data, sizeInBytes);
+    _isRestoringState.store(true);
+
+    if (SessionFormat::isSessionData(data, static_cast<size_t>(sizeInBytes))) {
+        juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+        SessionFormat::Reader reader;
+
+        if (reader.read(stream)) {
+            std::unique_ptr<juce::XmlElement> element = reader.takeDocument();
+            _restoreSessionFromXml(element.get(), reader);
+        } else {
+            juce::Logger::writeToLog("Failed to read session");
+        }
+    } else {
+        // Saved as XML by an older version or with the binary format turned off
+        WECore::JUCEPlugin::CoreAudioProcessor::setStateInformation(data, sizeInBytes);
+    }
+
+    _isRestoringState.store(false);
 
     // Some DAWs can open the UI before loading the state, so we need to make sure the UI is updated
     if (_editor != nullptr) {
@@ -1082,14 +1336,58 @@ void SyndicateAudioProcessor::setStateInformation(const void* data, int sizeInBy
 #endif
 }
 
+std::unique_ptr<juce::XmlElement> SyndicateAudioProcessor::_writeSessionToXml(SessionFormat::Writer& sessionWriter) {
+    auto element = std::make_unique<juce::XmlElement>(XML_SESSION_STR);
+
+    // Store the normalised parameter values
+    juce::XmlElement* parametersElement = element->createNewChildElement(XML_SESSION_PARAMETERS_STR);
+    for (juce::AudioProcessorParameter* parameter : getParameters()) {
+        if (auto* parameterWithId = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter)) {
+            parametersElement->setAttribute(parameterWithId->paramID, parameter->getValue());
+        }
+    }
+
+    // Store the splitter parameters, streaming the plugin states into the session
+    juce::XmlElement* splitterParametersElement = element->createNewChildElement(XML_SESSION_SPLITTER_PARAMETERS_STR);
+    _splitterParameters->writeToXml(splitterParametersElement, &sessionWriter);
+
+    return element;
+}
+
+void SyndicateAudioProcessor::_restoreSessionFromXml(juce::XmlElement* element, const SessionFormat::Reader& sessionReader) {
+    juce::XmlElement* parametersElement = element->getChildByName(XML_SESSION_PARAMETERS_STR);
+    if (parametersElement != nullptr) {
+        for (juce::AudioProcessorParameter* parameter : getParameters()) {
+            auto* parameterWithId = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+            if (parameterWithId != nullptr && parametersElement->hasAttribute(parameterWithId->paramID)) {
+                parameter->setValueNotifyingHost(
+                    static_cast<float>(parametersElement->getDoubleAttribute(parameterWithId->paramID)));
+            }
+        }
+    } else {
+        juce::Logger::writeToLog("Missing element " + juce::String(XML_SESSION_PARAMETERS_STR));
+    }
+
+    juce::XmlElement* splitterParametersElement = element->getChildByName(XML_SESSION_SPLITTER_PARAMETERS_STR);
+    if (splitterParametersElement != nullptr) {
+        _splitterParameters->restoreFromXml(splitterParametersElement, &sessionReader);
+    } else {
+        juce::Logger::writeToLog("Missing element " + juce::String(XML_SESSION_SPLITTER_PARAMETERS_STR));
+    }
+}
+
 void SyndicateAudioProcessor::SplitterParameters::restoreFromXml(juce::XmlElement* element) {
+    restoreFromXml(element, nullptr);
+}
+
+void SyndicateAudioProcessor::SplitterParameters::restoreFromXml(juce::XmlElement* element, const SessionFormat::Reader* sessionReader) {
     juce::Logger::writeToLog("Restoring plugin state from XML");
 
     if (_processor != nullptr) {
         juce::XmlElement* splitterElement = element->getChildByName(XML_SPLITTER_STR);
         if (splitterElement != nullptr) {
             // Restore the splitter first as we need to know how many chains there are
-            _restoreSplitterFromXml(splitterElement);
+            _restoreSplitterFromXml(splitterElement, sessionReader);
         } else {
             juce::Logger::writeToLog("Missing element " + juce::String(XML_SPLITTER_STR));
         }
@@ -1147,12 +1445,16 @@ void SyndicateAudioProcessor::SplitterParameters::restoreFromXml(juce::XmlElemen
 }
 
 void SyndicateAudioProcessor::SplitterParameters::writeToXml(juce::XmlElement* element) {
+    writeToXml(element, nullptr);
+}
+
+void SyndicateAudioProcessor::SplitterParameters::writeToXml(juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
     juce::Logger::writeToLog("Writing plugin state to XML");
 
     if (_processor != nullptr) {
         // Store the splitter
         juce::XmlElement* splitterElement = element->createNewChildElement(XML_SPLITTER_STR);
-        _writeSplitterToXml(splitterElement);
+        _writeSplitterToXml(splitterElement, sessionWriter);
 
         // Store the LFOs/envelopes
         juce::XmlElement* modulationElement = element->createNewChildElement(XML_MODULATION_SOURCES_STR);
@@ -1180,9 +1482,12 @@ void SyndicateAudioProcessor::SplitterParameters::writeToXml(juce::XmlElement* e
     }
 }
 
-void SyndicateAudioProcessor::SplitterParameters::_restoreSplitterFromXml(juce::XmlElement* element) {
+void SyndicateAudioProcessor::SplitterParameters::_restoreSplitterFromXml(juce::XmlElement* element, const SessionFormat::Reader* sessionReader) {
     SyndicateAudioProcessor* tmpProcessor = _processor;
 
+    // Anything still loading from a previous restore is about to be replaced
+    _processor->_placeholderLoader.stop();
+
     ModelInterface::restoreSplitterFromXml(
         _processor->manager,
         element,
@@ -1191,8 +1496,17 @@ void SyndicateAudioProcessor::SplitterParameters::_restoreSplitterFromXml(juce::
         {_processor->getBusesLayout(), _processor->getSampleRate(), _processor->getBlockSize()},
         _processor->pluginConfigurator,
         _processor->pluginScanClient.getPluginTypes(),
-        [&](juce::String errorText) { _processor->restoreErrors.push_back(errorText); }
+        [&](juce::String errorText) { _processor->restoreErrors.push_back(errorText); },
+        _processor->_isBackgroundRestoreEnabled,
+        _processor->_isPluginReuseEnabled,
+        sessionReader
     );
+
+    // Reused plugins leave placeholders in the undo history, so the loader may have work to do even
+    // if nothing was restored in the background
+    if (_processor->_isBackgroundRestoreEnabled || _processor->_isPluginReuseEnabled) {
+        _processor->_placeholderLoader.start(_processor->pluginScanClient.getPluginTypes(), _processor->_loadInactivePluginsLast);
+    }
 }
 
 void SyndicateAudioProcessor::SplitterParameters::_restoreModulationSourcesFromXml(juce::XmlElement* element) {
@@ -1325,8 +1639,8 @@ void SyndicateAudioProcessor::SplitterParameters::_restoreMainWindowStateFromXml
     }
 }
 
-void SyndicateAudioProcessor::SplitterParameters::_writeSplitterToXml(juce::XmlElement* element) {
-    ModelInterface::writeSplitterToXml(_processor->manager, element);
+void SyndicateAudioProcessor::SplitterParameters::_writeSplitterToXml(juce::XmlElement* element, SessionFormat::Writer* sessionWriter) {
+    ModelInterface::writeSplitterToXml(_processor->manager, element, sessionWriter);
 }
 
 void SyndicateAudioProcessor::SplitterParameters::_writeModulationSourcesToXml(juce::XmlElement* element) {
@@ -22,6 +22,11 @@
 #include "PluginConfigurator.hpp"
 #include "ModelInterface.hpp"
 #include "PresetMetadata.hpp"
+#include "RenderAheadQueue.hpp"
+#include "PlaceholderLoader.hpp"
+#include "StandbyLoader.hpp"
+#include "SessionFormat.hpp"
+#include "LevelMeter.hpp"
 
 class SyndicateAudioProcessorEditor;
 
@@ -48,7 +53,8 @@ struct MainWindowState {
 //==============================================================================
 /**
 */
-class SyndicateAudioProcessor : public WECore::JUCEPlugin::CoreAudioProcessor
+class SyndicateAudioProcessor : public WECore::JUCEPlugin::CoreAudioProcessor,
+                                private juce::AsyncUpdater
 {
 public:
 #if JUCE_IOS
@@ -61,7 +67,7 @@ public:
     ModelInterface::StateManager manager;
     PluginConfigurator pluginConfigurator;
     std::array<juce::String, NUM_MACROS> macroNames;
-    std::array<WECore::AREnv::AREnvelopeFollowerSquareLaw, 2> meterEnvelopes;
+    LevelMeter outputMeter;
     std::vector<juce::String> restoreErrors; // Populated during restore, displayed and cleared when the UI is opened
     juce::AudioPluginFormatManager formatManager;
     MainWindowState mainWindowState;
@@ -104,6 +110,13 @@ public:
     juce::AudioParameterFloat* outputPan;
     std::array<juce::AudioParameterFloat*, NUM_MACROS> macros;
 
+    // Only has an effect if rendering ahead has been configured
+    juce::AudioParameterBool* renderAhead;
+
+    // Each change of value switches to the standby, so switching can be automated. Has no effect
+    // if there isn't a standby
+    juce::AudioParameterBool* standbySwitch;
+
     void setEditor(SyndicateAudioProcessorEditor* editor) { _editor = editor; }
     void removeEditor() { _editor = nullptr; }
 
@@ -232,15 +245,46 @@ public:
 
     void setPresetMetadata(const PresetMetadata& newMetadata);
 
+    /**
+     * Loads a preset file in the background as the standby, so it can be switched to without
+     * waiting for its plugins to be created. Returns false if the file can't be read.
+     */
+    bool loadStandbyFromFile(juce::File file);
+
+    /**
+     * Loads a copy of the current state in the background as the standby, with its own plugins.
+     */
+    void captureStandby();
+
+    /**
+     * Crossfades to the standby, and puts the current state on standby in its place. Returns false
+     * if there isn't a standby yet.
+     */
+    bool switchToStandby();
+
+    void clearStandby();
+    bool hasStandby() { return ModelInterface::hasStandby(manager); }
+
     /**
      * Called by a splitter when its latency has changed, so this processor can update the latency
      * it reports back to the host.
      */
     void onLatencyChange(int newLatencySamples);
 
+    /**
+     * Turns rendering ahead on or off if it's been configured, for example so it can be turned off
+     * while monitoring live input where the extra latency would be noticeable. The latency reported
+     * to the host is updated to match.
+     */
+    void setRenderAheadEnabled(bool isEnabled);
+    bool isRenderAheadEnabled() const { return _renderAhead.isEnabled(); }
+
     /**
      * Override so we can disable conventional save/restore in the demo but still allow it manually using the
      * import/export buttons.
+     *
+     * The state is saved in the binary session format unless the config opts out, states saved as
+     * XML by older versions can still be restored.
      */
     virtual void getStateInformation(juce::MemoryBlock& destData) override;
     virtual void setStateInformation(const void* data, int sizeInBytes) override;
@@ -262,16 +306,23 @@ private:
         void restoreFromXml(juce::XmlElement* element) override;
         void writeToXml(juce::XmlElement* element) override;
 
+        /**
+         * As above, but plugin states are read from or streamed into the given binary session
+         * rather than base64 encoded in the XML. Either may be null.
+         */
+        void restoreFromXml(juce::XmlElement* element, const SessionFormat::Reader* sessionReader);
+        void writeToXml(juce::XmlElement* element, SessionFormat::Writer* sessionWriter);
+
     private:
         SyndicateAudioProcessor* _processor;
 
-        void _restoreSplitterFromXml(juce::XmlElement* element);
+        void _restoreSplitterFromXml(juce::XmlElement* element, const SessionFormat::Reader* sessionReader);
         void _restoreModulationSourcesFromXml(juce::XmlElement* element);
         void _restoreMacroNamesFromXml(juce::XmlElement* element);
         void _restoreMetadataFromXml(juce::XmlElement* element);
         void _restoreMainWindowStateFromXml(juce::XmlElement* element);
 
-        void _writeSplitterToXml(juce::XmlElement* element);
+        void _writeSplitterToXml(juce::XmlElement* element, SessionFormat::Writer* sessionWriter);
         void _writeModulationSourcesToXml(juce::XmlElement* element);
         void _writeMacroNamesToXml(juce::XmlElement* element);
         void _writeMetadataToXml(juce::XmlElement* element);
@@ -283,6 +334,35 @@ private:
     SyndicateAudioProcessorEditor* _editor;
     double _outputGainLinear;
 
+    // Renders the graph ahead of the host when configured, must be destroyed before the manager
+    RenderAheadQueue _renderAhead;
+    int _renderAheadBlocks;
+
+    // Set by reset(), the graph is reset by whichever thread processes it next
+    std::atomic<bool> _shouldResetGraph;
+    std::atomic<int> _graphLatencySamples;
+
+    // Loads plugins in the background after a restore when configured, must be destroyed before the
+    // manager
+    PlaceholderLoader _placeholderLoader;
+    bool _isBackgroundRestoreEnabled;
+    bool _loadInactivePluginsLast;
+    bool _isPluginReuseEnabled;
+
+    // Builds the standby in the background, must be destroyed before the manager
+    StandbyLoader _standbyLoader;
+    int _standbyCrossfadeMs;
+
+    // The standby switch's value when it was last acted on
+    std::atomic<bool> _standbySwitchPosition;
+
+    // Set while setStateInformation() restores the parameters, so the standby switch's saved
+    // position doesn't trigger a switch
+    std::atomic<bool> _isRestoringState;
+
+    bool _isBinarySessionFormatEnabled;
+    bool _isSessionCompressionEnabled;
+
     SplitterParameters* _splitterParameters;
 
 
@@ -291,6 +371,35 @@ private:
 
     void _onParameterUpdate() override;
 
+    /**
+     * Switches to the standby after the standby switch has changed. Switching waits for the
+     * mutators lock, so parameter updates from the audio thread are handed to the message thread.
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * Processes the splitter and modulation sources, either on the audio thread or ahead of time on
+     * the render thread.
+     */
+    void _processGraph(juce::AudioBuffer<float>& buffer,
+                       juce::MidiBuffer& midiMessages,
+                       juce::AudioPlayHead* playHead,
+                       const juce::AudioPlayHead::PositionInfo& position);
+
+    void _prepareRenderAhead();
+    void _updateLatency();
+
+    void _loadStandby(std::unique_ptr<juce::XmlElement> splitterElement,
+                      std::unique_ptr<juce::XmlElement> sourcesElement);
+
+    /**
+     * Builds and restores the document for the binary session format. The session writer/reader
+     * can't be passed through WECore's writeToXml()/restoreFromXml(), so the parameters and splitter
+     * parameters are written here and the session is passed to the splitter parameters directly.
+     */
+    std::unique_ptr<juce::XmlElement> _writeSessionToXml(SessionFormat::Writer& sessionWriter);
+    void _restoreSessionFromXml(juce::XmlElement* element, const SessionFormat::Reader& sessionReader);
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SyndicateAudioProcessor)
 };
@@ -4,7 +4,7 @@
 ChainButtonsComponent::ChainButtonsComponent(SyndicateAudioProcessor& processor,
                                              int chainNumber,
                                              const juce::String& defaultName) :
-        _processor(processor), _chainNumber(chainNumber), _defaultName(defaultName) {
+        _processor(processor), _chainNumber(chainNumber), _defaultName(defaultName), _isSleeping(false) {
     chainLabel.reset(new juce::Label("Chain Label", TRANS("")));
     addAndMakeVisible(chainLabel.get());
     chainLabel->setFont(juce::Font(15.00f, juce::Font::plain).withTypefaceStyle("Regular"));
@@ -74,6 +74,9 @@ ChainButtonsComponent::ChainButtonsComponent(SyndicateAudioProcessor& processor,
     removeButton->onClick = [this] () {
         _removeChainCallback();
     };
+
+    // Poll for the chain going to sleep, which happens on the audio thread
+    startTimerHz(4);
 }
 
 ChainButtonsComponent::ChainButtonsComponent(SyndicateAudioProcessor& processor,
@@ -86,6 +89,7 @@ ChainButtonsComponent::ChainButtonsComponent(SyndicateAudioProcessor& processor,
 }
 
 ChainButtonsComponent::~ChainButtonsComponent() {
+    stopTimer();
     chainLabel = nullptr;
     secondaryLabel = nullptr;
     dragHandle = nullptr;
@@ -127,6 +131,20 @@ void ChainButtonsComponent::refresh() {
     soloBtn->setToggleState(ModelInterface::getChainSolo(_processor.manager, _chainNumber), juce::dontSendNotification);
 }
 
+void ChainButtonsComponent::timerCallback() {
+    const bool isSleeping {ModelInterface::getChainIsSleeping(_processor.manager, _chainNumber)};
+
+    if (isSleeping != _isSleeping) {
+        _isSleeping = isSleeping;
+
+        // Dim the name while the chain is asleep
+        const juce::Colour textColour {_isSleeping ? UIUtils::deactivatedColour : UIUtils::highlightColour};
+        chainLabel->setColour(juce::Label::textColourId, textColour);
+        secondaryLabel->setColour(juce::Label::textColourId, textColour.withBrightness(0.7));
+        chainLabel->setTooltip(_isSleeping ? TRANS("Sleeping - the input is silent so this chain isn't being processed") : "");
+    }
+}
+
 void ChainButtonsComponent::mouseDrag(const juce::MouseEvent& e) {
     if (dragHandle != nullptr && e.originalComponent == dragHandle.get()) {
         juce::DragAndDropContainer* container = juce::DragAndDropContainer::findParentDragContainerFor(this);
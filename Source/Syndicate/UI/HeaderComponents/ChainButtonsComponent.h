@@ -4,7 +4,8 @@
 #include "UIUtils.h"
 #include "PluginProcessor.h"
 
-class ChainButtonsComponent : public juce::Component {
+class ChainButtonsComponent : public juce::Component,
+                              public juce::Timer {
 public:
     ChainButtonsComponent(SyndicateAudioProcessor& processor, int chainNumber, const juce::String& defaultName);
     ChainButtonsComponent(SyndicateAudioProcessor& processor, int chainNumber, const juce::String& defaultName, std::function<void()> removeChainCallback);
@@ -15,6 +16,8 @@ public:
 
     void refresh();
 
+    void timerCallback() override;
+
     std::unique_ptr<juce::Label> chainLabel;
     std::unique_ptr<juce::Label> secondaryLabel;
     std::unique_ptr<UIUtils::DragHandle> dragHandle;
@@ -28,6 +31,7 @@ private:
     int _chainNumber;
     const juce::String _defaultName;
     std::function<void()> _removeChainCallback;
+    bool _isSleeping;
 
     void _setLabelsText();
 
@@ -15,9 +15,19 @@ namespace {
 
 CrossoverImagerComponent::CrossoverImagerComponent(SyndicateAudioProcessor& processor)
         : _processor(processor) {
+    ModelInterface::attachFFTVisualiser(_processor.manager);
     start();
 }
 
+CrossoverImagerComponent::~CrossoverImagerComponent() {
+    ModelInterface::detachFFTVisualiser(_processor.manager);
+}
+
+bool CrossoverImagerComponent::_needsRepaint() {
+    // The outputs only change when there's new audio to analyse
+    return ModelInterface::hasNewFFTSamples(_processor.manager);
+}
+
 void CrossoverImagerComponent::paint(juce::Graphics& g) {
     _stopEvent.reset();
 
@@ -11,9 +11,12 @@
 class CrossoverImagerComponent : public UIUtils::SafeAnimatedComponent {
 public:
     CrossoverImagerComponent(SyndicateAudioProcessor& processor);
+    ~CrossoverImagerComponent() override;
 
     void paint(juce::Graphics& g) override;
 
 private:
     SyndicateAudioProcessor& _processor;
+
+    bool _needsRepaint() override;
 };
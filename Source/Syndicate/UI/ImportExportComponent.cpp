@@ -109,6 +109,15 @@ ImportExportComponent::ImportExportComponent(SyndicateAudioProcessor& processor,
     _initButton->onClick = [&]() {
         _processor.resetAllState();
     };
+
+    _standbyButton.reset(new juce::TextButton("Standby Button"));
+    addAndMakeVisible(_standbyButton.get());
+    _standbyButton->setButtonText(TRANS("A/B"));
+    _standbyButton->setTooltip("Keep a second set of settings on standby to crossfade to");
+    styleButton(_standbyButton.get());
+    _standbyButton->onClick = [&]() {
+        _showStandbyMenu();
+    };
 }
 
 ImportExportComponent::~ImportExportComponent() {
@@ -130,6 +139,8 @@ void ImportExportComponent::resized() {
     _metaButton->setBounds(availableArea.removeFromLeft(BUTTON_WIDTH));
     availableArea.removeFromLeft(SPACER_WIDTH);
     _initButton->setBounds(availableArea.removeFromLeft(BUTTON_WIDTH));
+
+    _standbyButton->setBounds(availableArea.removeFromRight(BUTTON_WIDTH));
 }
 
 void ImportExportComponent::paint(juce::Graphics& g) {
@@ -174,6 +185,51 @@ void ImportExportComponent::_onImportFromFile(juce::File file) {
     }
 }
 
+void ImportExportComponent::_showStandbyMenu() {
+    enum StandbyMenuItem {
+        SWITCH = 1,
+        CAPTURE,
+        LOAD,
+        CLEAR
+    };
+
+    const bool hasStandby {_processor.hasStandby()};
+
+    juce::PopupMenu menu;
+    menu.addItem(SWITCH, TRANS("Switch to standby"), hasStandby);
+    menu.addItem(CAPTURE, TRANS("Copy current settings to standby"));
+    menu.addItem(LOAD, TRANS("Load standby from file..."));
+    menu.addItem(CLEAR, TRANS("Clear standby"), hasStandby);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(_standbyButton.get()), [&](int result) {
+        if (result == SWITCH) {
+            // Through the parameter so the host sees the switch, the processor does the rest
+            juce::AudioParameterBool* standbySwitch {_processor.standbySwitch};
+            standbySwitch->beginChangeGesture();
+            standbySwitch->setValueNotifyingHost(standbySwitch->get() ? 0.0f : 1.0f);
+            standbySwitch->endChangeGesture();
+        } else if (result == CAPTURE) {
+            _processor.captureStandby();
+        } else if (result == LOAD) {
+            const int flags {juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::openMode};
+            _fileChooser.reset(new juce::FileChooser("Load Syndicate Preset To Standby", juce::File(), "*.syn"));
+            _fileChooser->launchAsync(flags, [&](const juce::FileChooser& chooser) {
+#if JUCE_IOS
+                auto urls = chooser.getURLResults();
+                if (urls.size() > 0)
+                    _processor.loadStandbyFromFile(urls[0].getLocalFile());
+#else
+                if (chooser.getResult().existsAsFile()) {
+                    _processor.loadStandbyFromFile(chooser.getResult());
+                }
+#endif
+            });
+        } else if (result == CLEAR) {
+            _processor.clearStandby();
+        }
+    });
+}
+
 #if JUCE_IOS
 void ImportExportComponent::_onExportToURL(juce::URL url) {
     const juce::File file = url.getLocalFile();
@@ -32,11 +32,14 @@ private:
 
     std::unique_ptr<juce::TextButton> _initButton;
 
+    std::unique_ptr<juce::TextButton> _standbyButton;
+
     SyndicateAudioProcessor& _processor;
     SyndicateAudioProcessorEditor& _editor;
 
     void _onExportToFile(juce::File file);
     void _onImportFromFile(juce::File file);
+    void _showStandbyMenu();
 #if JUCE_IOS
     void _onExportToURL(juce::URL url);
     void _onImportFromURL(juce::URL url);
@@ -90,7 +90,7 @@ ModulationBarEnvelope::ModulationBarEnvelope(SyndicateAudioProcessor& processor,
     scInButton->addListener(this);
 
     _envView.reset(new UIUtils::WaveStylusViewer([&processor, envIndex]() {
-        return ModelInterface::getEnvLastOutput(processor.manager, envIndex) * ModelInterface::getEnvAmount(processor.manager, envIndex);
+        return ModelInterface::getEnvOutputWithAmount(processor.manager, envIndex);
     }));
     addAndMakeVisible(_envView.get());
     _envView->setTooltip(TRANS("Output of this envelope follower"));
@@ -45,6 +45,10 @@ void ModulationTargetSlider::paint(juce::Graphics& g) {
 
 void ModulationTargetSlider::timerCallback() {
     // _modulatedValue should be between 0 and 1
-    _modulatedValue = _getModulatedValue() / getRange().getLength();
-    repaint();
+    const float newModulatedValue {static_cast<float>(_getModulatedValue() / getRange().getLength())};
+
+    if (newModulatedValue != _modulatedValue) {
+        _modulatedValue = newModulatedValue;
+        repaint();
+    }
 }
@@ -3,9 +3,34 @@
 #include "OutputComponent.h"
 #include "PluginConfigurator.hpp"
 
-OutputMeter::OutputMeter(const SyndicateAudioProcessor& processor) :
+OutputMeter::OutputMeter(SyndicateAudioProcessor& processor) :
             _processor(processor) {
-    setFramesPerSecond(20);
+    _paintedLevels.fill(0);
+    _processor.outputMeter.attachReader();
+    startTimerHz(20);
+}
+
+OutputMeter::~OutputMeter() {
+    stopTimer();
+    _processor.outputMeter.detachReader();
+}
+
+void OutputMeter::timerCallback() {
+    // Only repaint when the levels have changed
+    bool hasChanged {false};
+
+    for (int channel {0}; channel < LevelMeter::MAX_NUM_CHANNELS; channel++) {
+        const float level {_processor.outputMeter.getRMS(channel)};
+
+        if (level != _paintedLevels[channel]) {
+            _paintedLevels[channel] = level;
+            hasChanged = true;
+        }
+    }
+
+    if (hasChanged) {
+        repaint();
+    }
 }
 
 void OutputMeter::paint(juce::Graphics& g) {
@@ -30,7 +55,7 @@ void OutputMeter::paint(juce::Graphics& g) {
 
 
     for (int channel {0}; channel < numChannels; channel++) {
-        const float gaindB = WECore::CoreMath::linearTodB(_processor.meterEnvelopes[channel].getLastOutput());
+        const float gaindB = WECore::CoreMath::linearTodB(_paintedLevels[channel]);
         const int meterHeight = static_cast<int>(dBToHeight(gaindB));
 
         availableArea.removeFromLeft(MARGIN);
@@ -8,20 +8,20 @@
 /**
  * Displays the output amplitude of this gain stage.
  */
-class OutputMeter : public juce::AnimatedAppComponent,
-                    public juce::SettableTooltipClient {
+class OutputMeter : public juce::Component,
+                    public juce::SettableTooltipClient,
+                    private juce::Timer {
 public:
-    OutputMeter(const SyndicateAudioProcessor& processor);
-    ~OutputMeter() = default;
-
-    void update() override {
-        // Do nothing
-    }
+    OutputMeter(SyndicateAudioProcessor& processor);
+    ~OutputMeter();
 
     void paint(juce::Graphics& g) override;
 
 private:
-    const SyndicateAudioProcessor& _processor;
+    SyndicateAudioProcessor& _processor;
+    std::array<float, LevelMeter::MAX_NUM_CHANNELS> _paintedLevels;
+
+    void timerCallback() override;
 };
 
 class OutputComponent : public juce::Component, public juce::Slider::Listener {
@@ -17,11 +17,22 @@ GainStageMeter::GainStageMeter(const PluginSelectionInterface& pluginSelectionIn
                                int chainNumber,
                                int slotNumber) :
             _pluginSelectionInterface(pluginSelectionInterface),
-            _chainNumber(chainNumber),
-            _slotNumber(slotNumber) {
+            _meter(pluginSelectionInterface.getGainStageMeter(chainNumber, slotNumber)) {
+    _paintedLevels.fill(0);
+
+    if (_meter != nullptr) {
+        _meter->attachReader();
+    }
+
     start();
 }
 
+GainStageMeter::~GainStageMeter() {
+    if (_meter != nullptr) {
+        _meter->detachReader();
+    }
+}
+
 void GainStageMeter::paint(juce::Graphics& g) {
     _stopEvent.reset();
 
@@ -36,7 +47,7 @@ void GainStageMeter::paint(juce::Graphics& g) {
 
 
     for (int channel {0}; channel < numChannels; channel++) {
-        const float gaindB = WECore::CoreMath::linearTodB(_pluginSelectionInterface.getGainStageOutputAmplitude(_chainNumber, _slotNumber, channel));
+        const float gaindB = WECore::CoreMath::linearTodB(_paintedLevels[channel]);
         const int meterWidth = dBToXPos(gaindB, getWidth());
 
         availableArea.removeFromTop(MARGIN);
@@ -60,6 +71,21 @@ void GainStageMeter::paint(juce::Graphics& g) {
     _stopEvent.signal();
 }
 
+bool GainStageMeter::_needsRepaint() {
+    bool hasChanged {false};
+
+    for (int channel {0}; channel < LevelMeter::MAX_NUM_CHANNELS; channel++) {
+        const float level {_meter != nullptr ? _meter->getRMS(channel) : 0.0f};
+
+        if (level != _paintedLevels[channel]) {
+            _paintedLevels[channel] = level;
+            hasChanged = true;
+        }
+    }
+
+    return hasChanged;
+}
+
 GainStageSlotComponent::GainStageSlotComponent(
         PluginSelectionInterface& pluginSelectionInterface,
         int chainNumber,
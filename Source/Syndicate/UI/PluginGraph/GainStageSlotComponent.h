@@ -5,6 +5,7 @@
 #include "UIUtils.h"
 #include "General/CoreMath.h"
 #include "CoreJUCEPlugin/LabelReadoutSlider.h"
+#include "LevelMeter.hpp"
 
 class PluginSelectionInterface;
 
@@ -14,14 +15,16 @@ class PluginSelectionInterface;
 class GainStageMeter : public UIUtils::SafeAnimatedComponent {
 public:
     GainStageMeter(const PluginSelectionInterface& pluginSelectionInterface, int chainNumber, int slotNumber);
-    ~GainStageMeter() = default;
+    ~GainStageMeter();
 
     void paint(juce::Graphics& g) override;
 
 private:
     const PluginSelectionInterface& _pluginSelectionInterface;
-    const int _chainNumber;
-    const int _slotNumber;
+    std::shared_ptr<LevelMeter> _meter;
+    std::array<float, LevelMeter::MAX_NUM_CHANNELS> _paintedLevels;
+
+    bool _needsRepaint() override;
 };
 
 /**
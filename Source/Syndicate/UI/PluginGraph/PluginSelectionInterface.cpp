@@ -295,8 +295,8 @@ int PluginSelectionInterface::getNumMainChannels() const {
     return _processor.getBusesLayout().getMainInputChannels();
 }
 
-float PluginSelectionInterface::getGainStageOutputAmplitude(int chainNumber, int slotNumber, int channelNumber) const {
-    return ModelInterface::getGainStageOutputAmplitude(_processor.manager, chainNumber, slotNumber, channelNumber);
+std::shared_ptr<LevelMeter> PluginSelectionInterface::getGainStageMeter(int chainNumber, int slotNumber) const {
+    return ModelInterface::getGainStageMeter(_processor.manager, chainNumber, slotNumber);
 }
 
 void PluginSelectionInterface::closeGuestPluginWindows() {
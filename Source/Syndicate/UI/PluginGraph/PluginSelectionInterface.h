@@ -39,7 +39,7 @@ public:
     std::tuple<float, float> getGainStageGainAndPan(int chainNumber, int slotNumber);
     void setGainStagePan(int chainNumber, int slotNumber, float pan);
     int getNumMainChannels() const;
-    float getGainStageOutputAmplitude(int chainNumber, int slotNumber, int channelNumber) const;
+    std::shared_ptr<LevelMeter> getGainStageMeter(int chainNumber, int slotNumber) const;
 
     void closeGuestPluginWindows();
 
@@ -644,7 +644,10 @@ namespace UIUtils {
 
     void SafeAnimatedComponent::timerCallback() {
         _onTimerCallback();
-        repaint();
+
+        if (_needsRepaint()) {
+            repaint();
+        }
     }
 
     BypassButton::BypassButton(const juce::String& buttonName) : juce::Button(buttonName) { }
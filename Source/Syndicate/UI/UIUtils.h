@@ -239,6 +239,12 @@ namespace UIUtils {
          */
         virtual void _onTimerCallback() {}
 
+        /**
+         * Can be overidden by inheriting classes to skip repainting when nothing they draw has
+         * changed.
+         */
+        virtual bool _needsRepaint() { return true; }
+
     private:
         void timerCallback() override;
     };